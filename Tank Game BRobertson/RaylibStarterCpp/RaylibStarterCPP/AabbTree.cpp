@@ -0,0 +1,462 @@
+#include "AabbTree.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+const int32_t AabbTree::nullNode;
+
+namespace
+{
+    // Moving objects get their fat box stretched this many ticks of displacement ahead
+    const float displacementLookAhead = 4.0f;
+
+    AabbBounds Union(const AabbBounds& a, const AabbBounds& b)
+    {
+        return { std::min(a.minX, b.minX), std::min(a.minY, b.minY), std::max(a.maxX, b.maxX), std::max(a.maxY, b.maxY) };
+    }
+
+    // Perimeter plays the part surface area plays in 3D: the chance a random query touches the box
+    float Perimeter(const AabbBounds& bounds)
+    {
+        return 2.0f * ((bounds.maxX - bounds.minX) + (bounds.maxY - bounds.minY));
+    }
+}
+
+// Constructor for an empty tree
+AabbTree::AabbTree(float margin)
+    : margin(margin), root(nullNode), freeList(nullNode), proxyCount(0)
+{
+}
+
+// Take a node off the free list, growing the node array when it is empty
+int32_t AabbTree::AllocateNode()
+{
+    if (freeList == nullNode)
+    {
+        nodes.emplace_back();
+        nodes.back().height = -1;
+        nodes.back().parent = nullNode;
+        freeList = (int32_t)nodes.size() - 1;
+    }
+
+    int32_t index = freeList;
+    Node& node = nodes[index];
+    freeList = node.parent;
+    node.parent = nullNode;
+    node.child1 = nullNode;
+    node.child2 = nullNode;
+    node.height = 0;
+    node.userData = -1;
+    return index;
+}
+
+// Put a node back on the free list, threaded through its parent link
+void AabbTree::FreeNode(int32_t index)
+{
+    nodes[index].parent = freeList;
+    nodes[index].height = -1;
+    freeList = index;
+}
+
+// Wrap the box in a fat leaf and hang it in the tree
+int32_t AabbTree::Insert(Rectangle box, int32_t userData)
+{
+    int32_t proxy = AllocateNode();
+    AabbBounds bounds = AabbBounds::FromRectangle(box);
+    nodes[proxy].bounds = { bounds.minX - margin, bounds.minY - margin, bounds.maxX + margin, bounds.maxY + margin };
+    nodes[proxy].userData = userData;
+    InsertLeaf(proxy);
+    proxyCount++;
+    return proxy;
+}
+
+// Unhook the leaf and free it
+void AabbTree::Remove(int32_t proxy)
+{
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+    proxyCount--;
+}
+
+// Only reinsert when the tight box pokes out of the fat one
+bool AabbTree::Move(int32_t proxy, Rectangle box, Vector2 displacement)
+{
+    AabbBounds bounds = AabbBounds::FromRectangle(box);
+    if (nodes[proxy].bounds.Contains(bounds))
+    {
+        return false;
+    }
+
+    RemoveLeaf(proxy);
+    AabbBounds fat = { bounds.minX - margin, bounds.minY - margin, bounds.maxX + margin, bounds.maxY + margin };
+    float aheadX = displacement.x * displacementLookAhead;
+    float aheadY = displacement.y * displacementLookAhead;
+    if (aheadX < 0.0f)
+    {
+        fat.minX += aheadX;
+    }
+    else
+    {
+        fat.maxX += aheadX;
+    }
+    if (aheadY < 0.0f)
+    {
+        fat.minY += aheadY;
+    }
+    else
+    {
+        fat.maxY += aheadY;
+    }
+    nodes[proxy].bounds = fat;
+    InsertLeaf(proxy);
+    return true;
+}
+
+// Walk down picking the cheaper child until stopping here costs less than going further, then pair
+// the leaf with that node under a new parent
+// Going down a child costs the perimeter the child would grow by, plus what every node above already grew
+void AabbTree::InsertLeaf(int32_t leaf)
+{
+    if (root == nullNode)
+    {
+        root = leaf;
+        nodes[root].parent = nullNode;
+        return;
+    }
+
+    AabbBounds leafBounds = nodes[leaf].bounds;
+    int32_t index = root;
+    while (!nodes[index].IsLeaf())
+    {
+        const Node& node = nodes[index];
+        float perimeter = Perimeter(node.bounds);
+        float combined = Perimeter(Union(node.bounds, leafBounds));
+
+        // Cost of a new parent for this node and the leaf, and the growth pushed onto every level below
+        float cost = 2.0f * combined;
+        float inheritedCost = 2.0f * (combined - perimeter);
+
+        float childCosts[2];
+        int32_t children[2] = { node.child1, node.child2 };
+        for (int i = 0; i < 2; ++i)
+        {
+            const Node& child = nodes[children[i]];
+            float grown = Perimeter(Union(leafBounds, child.bounds));
+            childCosts[i] = (child.IsLeaf() ? grown : grown - Perimeter(child.bounds)) + inheritedCost;
+        }
+
+        if (cost < childCosts[0] && cost < childCosts[1])
+        {
+            break;
+        }
+        index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+    }
+
+    int32_t sibling = index;
+    int32_t oldParent = nodes[sibling].parent;
+    int32_t newParent = AllocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].bounds = Union(leafBounds, nodes[sibling].bounds);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent == nullNode)
+    {
+        root = newParent;
+    }
+    else if (nodes[oldParent].child1 == sibling)
+    {
+        nodes[oldParent].child1 = newParent;
+    }
+    else
+    {
+        nodes[oldParent].child2 = newParent;
+    }
+
+    FixUpwards(nodes[leaf].parent);
+}
+
+// Replace the leaf's parent with its sibling, then refit what is above
+void AabbTree::RemoveLeaf(int32_t leaf)
+{
+    if (leaf == root)
+    {
+        root = nullNode;
+        return;
+    }
+
+    int32_t parent = nodes[leaf].parent;
+    int32_t grandParent = nodes[parent].parent;
+    int32_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+    if (grandParent == nullNode)
+    {
+        root = sibling;
+        nodes[sibling].parent = nullNode;
+        FreeNode(parent);
+        return;
+    }
+
+    if (nodes[grandParent].child1 == parent)
+    {
+        nodes[grandParent].child1 = sibling;
+    }
+    else
+    {
+        nodes[grandParent].child2 = sibling;
+    }
+    nodes[sibling].parent = grandParent;
+    FreeNode(parent);
+    FixUpwards(grandParent);
+}
+
+// Balance each node, then recompute its height and box from its children
+void AabbTree::FixUpwards(int32_t index)
+{
+    while (index != nullNode)
+    {
+        index = Balance(index);
+        Node& node = nodes[index];
+        const Node& child1 = nodes[node.child1];
+        const Node& child2 = nodes[node.child2];
+        node.height = 1 + std::max(child1.height, child2.height);
+        node.bounds = Union(child1.bounds, child2.bounds);
+        index = node.parent;
+    }
+}
+
+// With A the node, B and C its children: when C is taller, C takes A's place, A keeps B and the
+// shorter of C's children, and C keeps A and the taller one. The mirror case lifts B.
+int32_t AabbTree::Balance(int32_t a)
+{
+    if (nodes[a].IsLeaf() || nodes[a].height < 2)
+    {
+        return a;
+    }
+
+    int32_t b = nodes[a].child1;
+    int32_t c = nodes[a].child2;
+    int32_t balance = nodes[c].height - nodes[b].height;
+    if (balance >= -1 && balance <= 1)
+    {
+        return a;
+    }
+
+    // Lift the taller child, called up, whose sibling staying under A is called kept
+    bool liftSecond = balance > 1;
+    int32_t up = liftSecond ? c : b;
+    int32_t kept = liftSecond ? b : c;
+    int32_t upChild1 = nodes[up].child1;
+    int32_t upChild2 = nodes[up].child2;
+
+    nodes[up].child1 = a;
+    nodes[up].parent = nodes[a].parent;
+    nodes[a].parent = up;
+    if (nodes[up].parent == nullNode)
+    {
+        root = up;
+    }
+    else if (nodes[nodes[up].parent].child1 == a)
+    {
+        nodes[nodes[up].parent].child1 = up;
+    }
+    else
+    {
+        nodes[nodes[up].parent].child2 = up;
+    }
+
+    // The taller of the lifted node's children stays with it, the shorter moves under A
+    int32_t taller = nodes[upChild1].height > nodes[upChild2].height ? upChild1 : upChild2;
+    int32_t shorter = taller == upChild1 ? upChild2 : upChild1;
+    nodes[up].child2 = taller;
+    if (liftSecond)
+    {
+        nodes[a].child2 = shorter;
+    }
+    else
+    {
+        nodes[a].child1 = shorter;
+    }
+    nodes[shorter].parent = a;
+
+    nodes[a].bounds = Union(nodes[kept].bounds, nodes[shorter].bounds);
+    nodes[a].height = 1 + std::max(nodes[kept].height, nodes[shorter].height);
+    nodes[up].bounds = Union(nodes[a].bounds, nodes[taller].bounds);
+    nodes[up].height = 1 + std::max(nodes[a].height, nodes[taller].height);
+    return up;
+}
+
+// Collect the leaves, free every internal node and split the leaves again from the top
+void AabbTree::Rebuild()
+{
+    PROFILE_SCOPE("AabbTree::Rebuild");
+    std::vector<int32_t> leaves;
+    leaves.reserve(proxyCount);
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        if (nodes[i].height < 0)
+        {
+            continue;
+        }
+        if (nodes[i].IsLeaf())
+        {
+            leaves.push_back((int32_t)i);
+        }
+        else
+        {
+            FreeNode((int32_t)i);
+        }
+    }
+
+    root = leaves.empty() ? nullNode : BuildRange(leaves, 0, leaves.size());
+    if (root != nullNode)
+    {
+        nodes[root].parent = nullNode;
+    }
+}
+
+// Split at the median centre along the longer side of the centres' bounds
+int32_t AabbTree::BuildRange(std::vector<int32_t>& leaves, size_t first, size_t last)
+{
+    if (last - first == 1)
+    {
+        return leaves[first];
+    }
+
+    AabbBounds centres = { INFINITY, INFINITY, -INFINITY, -INFINITY };
+    for (size_t i = first; i < last; ++i)
+    {
+        const AabbBounds& bounds = nodes[leaves[i]].bounds;
+        float x = (bounds.minX + bounds.maxX) * 0.5f;
+        float y = (bounds.minY + bounds.maxY) * 0.5f;
+        centres = Union(centres, { x, y, x, y });
+    }
+    bool splitX = centres.maxX - centres.minX >= centres.maxY - centres.minY;
+
+    size_t middle = first + (last - first) / 2;
+    std::nth_element(leaves.begin() + first, leaves.begin() + middle, leaves.begin() + last, [&](int32_t a, int32_t b) {
+        const AabbBounds& boundsA = nodes[a].bounds;
+        const AabbBounds& boundsB = nodes[b].bounds;
+        return splitX ? boundsA.minX + boundsA.maxX < boundsB.minX + boundsB.maxX : boundsA.minY + boundsA.maxY < boundsB.minY + boundsB.maxY;
+        });
+
+    int32_t child1 = BuildRange(leaves, first, middle);
+    int32_t child2 = BuildRange(leaves, middle, last);
+    int32_t parent = AllocateNode();
+    nodes[parent].child1 = child1;
+    nodes[parent].child2 = child2;
+    nodes[parent].bounds = Union(nodes[child1].bounds, nodes[child2].bounds);
+    nodes[parent].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+    nodes[child1].parent = parent;
+    nodes[child2].parent = parent;
+    return parent;
+}
+
+// Get the value an object was inserted with
+int32_t AabbTree::GetUserData(int32_t proxy) const
+{
+    return nodes[proxy].userData;
+}
+
+// Get the margin-grown box a leaf holds
+const AabbBounds& AabbTree::GetFatBounds(int32_t proxy) const
+{
+    return nodes[proxy].bounds;
+}
+
+// Get the number of objects in the tree
+size_t AabbTree::GetProxyCount() const
+{
+    return proxyCount;
+}
+
+// Get the height of the root
+int AabbTree::GetHeight() const
+{
+    return root == nullNode ? 0 : nodes[root].height;
+}
+
+// Scan every internal node for its children's height difference
+int AabbTree::GetMaxBalance() const
+{
+    int largest = 0;
+    for (const Node& node : nodes)
+    {
+        if (node.height <= 0)
+        {
+            continue;
+        }
+        int balance = std::abs(nodes[node.child2].height - nodes[node.child1].height);
+        largest = std::max(largest, balance);
+    }
+    return largest;
+}
+
+// Sum the perimeters of every internal node, relative to the root's
+float AabbTree::GetAreaRatio() const
+{
+    if (root == nullNode)
+    {
+        return 0.0f;
+    }
+    float total = 0.0f;
+    for (const Node& node : nodes)
+    {
+        if (node.height > 0)
+        {
+            total += Perimeter(node.bounds);
+        }
+    }
+    float rootPerimeter = Perimeter(nodes[root].bounds);
+    return rootPerimeter > 0.0f ? total / rootPerimeter : 0.0f;
+}
+
+// Check every reachable node's parent link, height and box, and that the leaves add up to the proxy count
+bool AabbTree::Validate() const
+{
+    if (root == nullNode)
+    {
+        return proxyCount == 0;
+    }
+    if (nodes[root].parent != nullNode)
+    {
+        return false;
+    }
+
+    size_t leaves = 0;
+    std::vector<int32_t> stack(1, root);
+    while (!stack.empty())
+    {
+        int32_t index = stack.back();
+        stack.pop_back();
+        const Node& node = nodes[index];
+        if (node.IsLeaf())
+        {
+            if (node.height != 0)
+            {
+                return false;
+            }
+            leaves++;
+            continue;
+        }
+
+        const Node& child1 = nodes[node.child1];
+        const Node& child2 = nodes[node.child2];
+        if (child1.parent != index || child2.parent != index || node.height != 1 + std::max(child1.height, child2.height))
+        {
+            return false;
+        }
+        AabbBounds fitted = Union(child1.bounds, child2.bounds);
+        if (fitted.minX != node.bounds.minX || fitted.minY != node.bounds.minY || fitted.maxX != node.bounds.maxX || fitted.maxY != node.bounds.maxY)
+        {
+            return false;
+        }
+        stack.push_back(node.child1);
+        stack.push_back(node.child2);
+    }
+    return leaves == proxyCount;
+}
@@ -0,0 +1,255 @@
+#pragma once
+#include "raylib.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Box as its corners, which is what the tree's overlap and slab tests read
+struct AabbBounds
+{
+    float minX, minY, maxX, maxY;
+
+    static AabbBounds FromRectangle(Rectangle box)
+    {
+        return { box.x, box.y, box.x + box.width, box.y + box.height };
+    }
+
+    bool Overlaps(const AabbBounds& other) const
+    {
+        return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+    }
+
+    bool Contains(const AabbBounds& other) const
+    {
+        return minX <= other.minX && minY <= other.minY && other.maxX <= maxX && other.maxY <= maxY;
+    }
+
+    // Distance along a ray to where it enters the box, 0 when it starts inside
+    // inverseDirection is 1 / direction per component, infinite for an axis the ray runs parallel to
+    bool IntersectRay(Vector2 origin, Vector2 inverseDirection, float maxDistance, float& distance) const
+    {
+        float x1 = (minX - origin.x) * inverseDirection.x;
+        float x2 = (maxX - origin.x) * inverseDirection.x;
+        float y1 = (minY - origin.y) * inverseDirection.y;
+        float y2 = (maxY - origin.y) * inverseDirection.y;
+        float entry = x1 < x2 ? x1 : x2;
+        float exit = x1 < x2 ? x2 : x1;
+        float entryY = y1 < y2 ? y1 : y2;
+        float exitY = y1 < y2 ? y2 : y1;
+        entry = entryY > entry ? entryY : entry;
+        exit = exitY < exit ? exitY : exit;
+        entry = entry > 0.0f ? entry : 0.0f;
+        distance = entry;
+        return entry <= exit && entry <= maxDistance;
+    }
+};
+
+// Dynamic bounding-volume hierarchy over boxes that are added, removed and moved one at a time
+// Every leaf holds a fat box, the object's box grown by a margin, so an object that only drifts
+// stays inside its leaf and Move does nothing. New leaves go next to the sibling that grows the
+// tree's total perimeter least, and every node on the way back up is rotated AVL style when one
+// child is more than one level taller than the other. Rebuild replaces the whole tree with a
+// top-down median split, for when many moves have worn the tree down.
+// Queries walk the tree with a small stack and call back for each leaf whose fat box they touch,
+// so the caller does the exact test against its own tight box.
+class AabbTree
+{
+public:
+    static const int32_t nullNode = -1;
+
+    // margin is how far each fat box reaches past the object's own box on every side
+    explicit AabbTree(float margin);
+
+    // Adds an object and returns its proxy, which stays valid until Remove
+    int32_t Insert(Rectangle box, int32_t userData);
+
+    void Remove(int32_t proxy);
+
+    // Updates an object's box, reinserting it only when the box leaves its fat box
+    // The new fat box is stretched along displacement so an object moving steadily stays inside longer.
+    // Returns true when the object was reinserted.
+    bool Move(int32_t proxy, Rectangle box, Vector2 displacement);
+
+    // Rebuilds every internal node with a top-down median split, keeping the proxies
+    void Rebuild();
+
+    int32_t GetUserData(int32_t proxy) const;
+    const AabbBounds& GetFatBounds(int32_t proxy) const;
+    size_t GetProxyCount() const;
+
+    // Height of the root, 0 for a single leaf
+    int GetHeight() const;
+
+    // Largest height difference between the two children of any node
+    int GetMaxBalance() const;
+
+    // Summed perimeter of the internal nodes over the root's perimeter, lower is a tighter tree
+    float GetAreaRatio() const;
+
+    // Walks the whole tree checking links, heights and boxes, for debugging and the benchmark
+    bool Validate() const;
+
+    // Calls callback(proxy) for every leaf whose fat box overlaps bounds, stopping when it returns false
+    template <typename Callback>
+    void Query(const AabbBounds& bounds, Callback callback) const
+    {
+        NodeStack stack;
+        stack.Push(root);
+        while (!stack.IsEmpty())
+        {
+            int32_t index = stack.Pop();
+            if (index == nullNode)
+            {
+                continue;
+            }
+            const Node& node = nodes[index];
+            if (!node.bounds.Overlaps(bounds))
+            {
+                continue;
+            }
+            if (node.IsLeaf())
+            {
+                if (!callback(index))
+                {
+                    return;
+                }
+            }
+            else
+            {
+                stack.Push(node.child1);
+                stack.Push(node.child2);
+            }
+        }
+    }
+
+    // Calls callback(proxy, maxDistance) for leaves whose fat box the ray enters within maxDistance,
+    // nearer children first. The callback returns the new maxDistance: its hit distance to clip the
+    // ray, the same maxDistance to carry on, or 0 to stop. direction need not be unit length, distances
+    // are measured in multiples of it.
+    template <typename Callback>
+    void RayCast(Vector2 origin, Vector2 direction, float maxDistance, Callback callback) const
+    {
+        Vector2 inverseDirection = { 1.0f / direction.x, 1.0f / direction.y };
+        NodeStack stack;
+        stack.Push(root);
+        while (!stack.IsEmpty())
+        {
+            int32_t index = stack.Pop();
+            if (index == nullNode)
+            {
+                continue;
+            }
+            const Node& node = nodes[index];
+            float entry;
+            if (!node.bounds.IntersectRay(origin, inverseDirection, maxDistance, entry))
+            {
+                continue;
+            }
+            if (node.IsLeaf())
+            {
+                float clipped = callback(index, maxDistance);
+                if (clipped <= 0.0f)
+                {
+                    return;
+                }
+                maxDistance = clipped < maxDistance ? clipped : maxDistance;
+                continue;
+            }
+
+            // Push the farther child first so the nearer one is popped next and can clip the ray early
+            float entry1, entry2;
+            bool hit1 = nodes[node.child1].bounds.IntersectRay(origin, inverseDirection, maxDistance, entry1);
+            bool hit2 = nodes[node.child2].bounds.IntersectRay(origin, inverseDirection, maxDistance, entry2);
+            if (hit1 && hit2)
+            {
+                stack.Push(entry1 <= entry2 ? node.child2 : node.child1);
+                stack.Push(entry1 <= entry2 ? node.child1 : node.child2);
+            }
+            else if (hit1)
+            {
+                stack.Push(node.child1);
+            }
+            else if (hit2)
+            {
+                stack.Push(node.child2);
+            }
+        }
+    }
+
+private:
+    struct Node
+    {
+        AabbBounds bounds;
+        int32_t parent;   // Next free node while the node is on the free list
+        int32_t child1, child2;
+        int32_t height;   // 0 for a leaf, -1 while free
+        int32_t userData;
+
+        bool IsLeaf() const
+        {
+            return child1 == nullNode;
+        }
+    };
+
+    // Traversal stack that lives on the caller's stack and only spills to the heap for very deep trees
+    class NodeStack
+    {
+    public:
+        NodeStack() : count(0) {}
+
+        void Push(int32_t index)
+        {
+            if (count < localSize)
+            {
+                local[count++] = index;
+            }
+            else
+            {
+                spill.push_back(index);
+            }
+        }
+
+        int32_t Pop()
+        {
+            if (!spill.empty())
+            {
+                int32_t index = spill.back();
+                spill.pop_back();
+                return index;
+            }
+            return local[--count];
+        }
+
+        bool IsEmpty() const
+        {
+            return count == 0 && spill.empty();
+        }
+
+    private:
+        static const int localSize = 128;
+        int32_t local[localSize];
+        int count;
+        std::vector<int32_t> spill;
+    };
+
+    int32_t AllocateNode();
+    void FreeNode(int32_t index);
+    void InsertLeaf(int32_t leaf);
+    void RemoveLeaf(int32_t leaf);
+
+    // Rotates the taller grandchild up when a node's children differ in height by more than one
+    // Returns the node now at the top of this subtree
+    int32_t Balance(int32_t index);
+
+    // Refits boxes and heights from a node up to the root, balancing each node on the way
+    void FixUpwards(int32_t index);
+
+    // Builds a subtree over leaves [first, last), returning its root
+    int32_t BuildRange(std::vector<int32_t>& leaves, size_t first, size_t last);
+
+    float margin;
+    int32_t root;
+    int32_t freeList;
+    size_t proxyCount;
+    std::vector<Node> nodes;
+};
@@ -0,0 +1,471 @@
+#include "AiArena.h"
+#include "Bullet.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Grid cells a little smaller than the engage range, so a query usually settles within two rings
+    const float gridCellSize = 256.0f;
+
+    // Enemies further than this are ignored, and tanks without one head for the arena centre
+    const float engageRange = 600.0f;
+
+    // How far ahead along the flow field a tank without a target steers for
+    const float flowLookAhead = 100.0f;
+
+    // Tanks stop closing in at this distance and hold position while they shoot
+    const float holdRange = 300.0f;
+
+    // Bullets are dropped once this far from the tank that fired them
+    const float bulletRange = 700.0f;
+
+    // Push rounds per tick, a second round clears most overlaps the first one causes
+    const int collisionIterations = 2;
+
+    // One shot a second at most, so each tank has only a couple of bullets in flight
+    const float fireCooldownSeconds = 1.0f;
+    const size_t bulletsPerTank = 8;
+
+    // Angles in degrees within which the body counts as facing its goal and the turret as on target
+    const float bodyTolerance = 4.0f;
+    const float aimTolerance = 2.0f;
+    const float driveTolerance = 60.0f;
+
+    // Blast around a hit, reaching a little past the tanks beside the one it hit
+    const float splashRadius = 96.0f;
+    const float splashDamage = 1.0f;
+
+    // Events a tick's explosions can record, several tanks per hit in a crowded fight
+    const size_t splashEventsPerTank = 4;
+
+    // Pixels at least half opaque are solid for bullet hits
+    const unsigned char maskAlphaThreshold = 128;
+
+    // Build a mask from the sprite's pixels, or a solid box when they cannot be read back, as in headless runs
+    void BuildMask(CollisionMask& mask, Sprite sprite)
+    {
+        if (!mask.BuildFromSprite(sprite, maskAlphaThreshold))
+        {
+            mask.BuildSolid((int)sprite.Width(), (int)sprite.Height());
+        }
+    }
+
+    // Half the diagonal of a sprite, the furthest any of its pixels is from its centre
+    float HalfDiagonal(Sprite sprite)
+    {
+        return 0.5f * sqrtf(sprite.Width() * sprite.Width() + sprite.Height() * sprite.Height());
+    }
+
+    // Wrap an angle in degrees into [-180, 180)
+    float WrapDegrees(float angle)
+    {
+        angle = fmodf(angle + 180.0f, 360.0f);
+        if (angle < 0.0f)
+        {
+            angle += 360.0f;
+        }
+        return angle - 180.0f;
+    }
+}
+
+// Constructor reserving every per-tank list and building the collision masks, the grids cover the arena
+// The turret is offset by less than the body's half diagonal and swings at most its own height about
+// its pivot, so a bullet further than both plus the turret's and bullet's half diagonals misses the tank.
+AiArena::AiArena(float width, float height, Sprite bodySprite, Sprite turretSprite, Sprite bulletSprite, size_t tankCapacity)
+    : width(width), height(height), bodySprite(bodySprite), turretSprite(turretSprite), bulletSprite(bulletSprite),
+    bulletPool(tankCapacity * bulletsPerTank * sizeof(Bullet) * 2 + 1024 * 1024),
+    grids{ SpatialGrid(width, height, gridCellSize), SpatialGrid(width, height, gridCellSize) },
+    aimSolver(Bullet::launchSpeed, turretSprite.Height()),
+    splash(width, height, gridCellSize, tankCapacity * splashEventsPerTank + 64), collider(width, height), flowField(nullptr), targeting(AiTargeting::Grid), timings()
+{
+    BuildMask(bodyMask, bodySprite);
+    BuildMask(turretMask, turretSprite);
+    BuildMask(bulletMask, bulletSprite);
+    hitReach = HalfDiagonal(bodySprite) + turretSprite.Height() + HalfDiagonal(turretSprite) + HalfDiagonal(bulletSprite);
+    hits = 0;
+    splashes = 0;
+    explosions.reserve(tankCapacity * bulletsPerTank);
+
+    tanks.reserve(tankCapacity);
+    teams.reserve(tankCapacity);
+    fireCooldowns.reserve(tankCapacity);
+    targets.reserve(tankCapacity);
+    results.reserve(tankCapacity);
+    lastPositions.reserve(tankCapacity);
+    velocities.reserve(tankCapacity);
+    aimSlots.reserve(tankCapacity);
+    for (int team = 0; team < teamCount; ++team)
+    {
+        members[team].reserve(tankCapacity);
+        positions[team].reserve(tankCapacity);
+    }
+}
+
+// Add a tank with a small bullet reserve, AI tanks never have more than a few shots in flight
+void AiArena::Spawn(MathClasses::Vector3 position, int team)
+{
+    members[team].push_back((int32_t)tanks.size());
+    tanks.emplace_back(position, bodySprite, turretSprite, bulletSprite, bulletPool, bulletsPerTank);
+    teams.push_back((uint8_t)team);
+    fireCooldowns.push_back(0.0f);
+    targets.push_back(-1);
+    lastPositions.push_back({ position.x, position.y });
+    velocities.push_back({ 0.0f, 0.0f });
+    aimSlots.push_back(-1);
+}
+
+// Enough columns to keep the lattice's cells close to square for the arena's shape
+void AiArena::SpawnLattice(int count)
+{
+    int columns = (int)ceilf(sqrtf(count * width / height));
+    int rows = (count + columns - 1) / columns;
+    for (int i = 0; i < count; ++i)
+    {
+        int column = i % columns;
+        int row = i / columns;
+        float x = (column + 0.5f) * width / columns;
+        float y = (row + 0.5f) * height / rows;
+        Spawn(MathClasses::Vector3(x, y, 0.0f), (column + row) % 2);
+    }
+}
+
+// Run the tick phase by phase so each one is timed on its own
+void AiArena::Step(float deltaTime)
+{
+    PROFILE_SCOPE("AiArena::Step");
+    timings = AiTimings();
+
+    {
+        ScopedTimer timer(timings.gatherMs);
+        GatherPositions();
+    }
+
+    {
+        ScopedTimer timer(timings.targetMs);
+        if (targeting == AiTargeting::Grid)
+        {
+            FindTargetsWithGrid();
+        }
+        else
+        {
+            FindTargetsBruteForce();
+        }
+    }
+
+    {
+        ScopedTimer timer(timings.aimMs);
+        SolveLeads(deltaTime);
+    }
+
+    {
+        ScopedTimer timer(timings.steerMs);
+        for (size_t i = 0; i < tanks.size(); ++i)
+        {
+            tanks[i].Update(Steer(i, deltaTime), deltaTime);
+        }
+    }
+
+    {
+        ScopedTimer timer(timings.collideMs);
+        collider.Collide(tanks, collisionIterations);
+    }
+
+    // The grids still hold this tick's starting positions, which is close enough to find the nearest
+    // enemy; the masks are then tested against where that tank is now
+    {
+        ScopedTimer timer(timings.cullMs);
+        for (size_t i = 0; i < tanks.size(); ++i)
+        {
+            int enemy = (teams[i] + 1) % teamCount;
+            MathClasses::Vector3 origin = tanks[i].GetPosition();
+            BulletList& bullets = tanks[i].GetBullets();
+            bullets.erase(std::remove_if(bullets.begin(), bullets.end(), [&](const Bullet& bullet) {
+                MathClasses::Vector3 position = bullet.GetPosition();
+                MathClasses::Vector3 offset = position - origin;
+                if (bullet.IsOutOfBounds(width, height) || offset.x * offset.x + offset.y * offset.y > bulletRange * bulletRange)
+                {
+                    return true;
+                }
+                int32_t nearest = grids[enemy].FindNearest({ position.x, position.y }, hitReach);
+                if (nearest >= 0 && BulletHitsTank(bullet, tanks[members[enemy][nearest]]))
+                {
+                    hits++;
+                    explosions.push_back({ { position.x, position.y }, splashRadius, splashDamage });
+                    return true;
+                }
+                return false;
+                }), bullets.end());
+        }
+
+        if (!explosions.empty())
+        {
+            splash.UpdateTanks(tanks);
+        }
+        splash.Explode(explosions.data(), explosions.size());
+        splashes += splash.GetEventCount() + splash.GetDroppedCount();
+        explosions.clear();
+    }
+}
+
+// Copy each team's positions into flat arrays and sort them into the grids, which bullet hits need
+// even when targets are found by brute force
+void AiArena::GatherPositions()
+{
+    for (int team = 0; team < teamCount; ++team)
+    {
+        positions[team].resize(members[team].size());
+        for (size_t i = 0; i < members[team].size(); ++i)
+        {
+            MathClasses::Vector3 position = tanks[members[team][i]].GetPosition();
+            positions[team][i] = { position.x, position.y };
+        }
+        grids[team].Build(positions[team].data(), positions[team].size());
+    }
+}
+
+// Query each team's tanks in their own grid's order against the enemy grid, then scatter the results back
+void AiArena::FindTargetsWithGrid()
+{
+    for (int team = 0; team < teamCount; ++team)
+    {
+        int enemy = (team + 1) % teamCount;
+        const SpatialGrid& own = grids[team];
+        results.resize(own.GetPointCount());
+        grids[enemy].FindNearest(own.GetSortedPoints().data(), own.GetPointCount(), engageRange, results.data());
+
+        const std::vector<int32_t>& order = own.GetSortedIndices();
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            targets[members[team][order[i]]] = results[i] >= 0 ? members[enemy][results[i]] : -1;
+        }
+    }
+}
+
+// Check every enemy for every tank, breaking ties towards the lower index as the grid does
+void AiArena::FindTargetsBruteForce()
+{
+    const float rangeSq = engageRange * engageRange;
+    for (int team = 0; team < teamCount; ++team)
+    {
+        int enemy = (team + 1) % teamCount;
+        const std::vector<Vector2>& enemies = positions[enemy];
+        for (size_t i = 0; i < positions[team].size(); ++i)
+        {
+            Vector2 position = positions[team][i];
+            int32_t best = -1;
+            float bestDistanceSq = rangeSq;
+            for (size_t j = 0; j < enemies.size(); ++j)
+            {
+                float dx = enemies[j].x - position.x;
+                float dy = enemies[j].y - position.y;
+                float distanceSq = dx * dx + dy * dy;
+                if (distanceSq < bestDistanceSq)
+                {
+                    bestDistanceSq = distanceSq;
+                    best = (int32_t)j;
+                }
+            }
+            targets[members[team][i]] = best >= 0 ? members[enemy][best] : -1;
+        }
+    }
+}
+
+// A tank's velocity is its move over the last Step, collision pushes included, which is what its next move will look like
+void AiArena::SolveLeads(float deltaTime)
+{
+    float inverseDeltaTime = deltaTime > 0.0f ? 1.0f / deltaTime : 0.0f;
+    for (size_t i = 0; i < tanks.size(); ++i)
+    {
+        MathClasses::Vector3 position = tanks[i].GetPosition();
+        velocities[i] = { (position.x - lastPositions[i].x) * inverseDeltaTime, (position.y - lastPositions[i].y) * inverseDeltaTime };
+        lastPositions[i] = { position.x, position.y };
+    }
+
+    aimSolver.Clear();
+    for (size_t i = 0; i < tanks.size(); ++i)
+    {
+        int32_t target = targets[i];
+        aimSlots[i] = target >= 0 ? (int32_t)aimSolver.Add(lastPositions[i], lastPositions[target], velocities[target]) : -1;
+    }
+    aimSolver.SolveAll();
+}
+
+// Frames are placed as the sprites are drawn: the body and bullet about their own centres, the turret
+// about the point Draw puts it at, turned by the body's rotation plus its own
+bool AiArena::BulletHitsTank(const Bullet& bullet, const Tank& tank) const
+{
+    MathClasses::Vector3 bulletPosition = bullet.GetPosition();
+    MathClasses::Vector3 tankPosition = tank.GetPosition();
+    Vector2 bulletCentre = { bulletPosition.x, bulletPosition.y };
+    const MaskFrame& bulletFrame = bulletMask.GetFrame(bullet.GetRotation());
+    return CollisionMask::Overlaps(bulletFrame, bulletCentre, bodyMask.GetFrame(tank.GetBodyRotation()), { tankPosition.x, tankPosition.y }) ||
+        CollisionMask::Overlaps(bulletFrame, bulletCentre, turretMask.GetFrame(tank.GetBodyRotation() + tank.GetTurretRotation()), tank.GetTurretPosition());
+}
+
+// Body angles point the tank along (-sin, cos), turret angles fire along (cos, sin) of body + turret + 90
+TankInput AiArena::Steer(size_t index, float deltaTime)
+{
+    TankInput input;
+    const Tank& tank = tanks[index];
+    MathClasses::Vector3 position = tank.GetPosition();
+    int32_t target = targets[index];
+
+    float goalX = width / 2.0f;
+    float goalY = height / 2.0f;
+    if (target >= 0)
+    {
+        MathClasses::Vector3 targetPosition = tanks[target].GetPosition();
+        goalX = targetPosition.x;
+        goalY = targetPosition.y;
+    }
+    else if (flowField != nullptr)
+    {
+        Vector2 flow = flowField->Sample({ position.x, position.y });
+        if (flow.x != 0.0f || flow.y != 0.0f)
+        {
+            goalX = position.x + flow.x * flowLookAhead;
+            goalY = position.y + flow.y * flowLookAhead;
+        }
+    }
+    float dx = goalX - position.x;
+    float dy = goalY - position.y;
+    float distance = sqrtf(dx * dx + dy * dy);
+
+    float headingError = WrapDegrees(atan2f(-dx, dy) * RAD2DEG - tank.GetBodyRotation());
+    input.Set(TankInput::RotateRight, headingError > bodyTolerance);
+    input.Set(TankInput::RotateLeft, headingError < -bodyTolerance);
+    input.Set(TankInput::MoveForward, (target < 0 || distance > holdRange) && fabsf(headingError) < driveTolerance);
+
+    float& cooldown = fireCooldowns[index];
+    cooldown -= deltaTime;
+    if (target >= 0)
+    {
+        // Aim straight at the target when no shot can catch it
+        Vector2 aim = { dx, dy };
+        int32_t slot = aimSlots[index];
+        if (aimSolver.GetTime(slot) >= 0.0f)
+        {
+            aim = aimSolver.GetDirection(slot);
+        }
+        float aimError = WrapDegrees(InterceptSolver::TurretRotationFor(aim, tank.GetBodyRotation()) - tank.GetTurretRotation());
+        input.Set(TankInput::TurretRight, aimError > aimTolerance);
+        input.Set(TankInput::TurretLeft, aimError < -aimTolerance);
+        if (fabsf(aimError) <= aimTolerance && cooldown <= 0.0f)
+        {
+            input.Set(TankInput::Fire, true);
+            cooldown = fireCooldownSeconds;
+        }
+    }
+    return input;
+}
+
+// Draw the markers first so every tank sits on top of its team colour
+void AiArena::Draw()
+{
+    for (size_t i = 0; i < tanks.size(); ++i)
+    {
+        MathClasses::Vector3 position = tanks[i].GetPosition();
+        DrawCircle((int)position.x, (int)position.y, bodySprite.Width() * 0.6f, teams[i] == 0 ? Fade(RED, 0.4f) : Fade(BLUE, 0.4f));
+    }
+    for (Tank& tank : tanks)
+    {
+        tank.Draw();
+    }
+}
+
+// Set the field tanks without a target follow
+void AiArena::SetFlowField(const FlowField* field)
+{
+    flowField = field;
+}
+
+// Choose how targets are found from the next Step on
+void AiArena::SetTargeting(AiTargeting mode)
+{
+    targeting = mode;
+}
+
+// Get how targets are being found
+AiTargeting AiArena::GetTargeting() const
+{
+    return targeting;
+}
+
+// Get the number of tanks spawned
+size_t AiArena::GetTankCount() const
+{
+    return tanks.size();
+}
+
+// Get a tank by spawn order
+const Tank& AiArena::GetTank(size_t index) const
+{
+    return tanks[index];
+}
+
+// Get the team a tank was spawned into
+int AiArena::GetTeam(size_t index) const
+{
+    return teams[index];
+}
+
+// Get the targets chosen on the last Step
+const std::vector<int32_t>& AiArena::GetTargets() const
+{
+    return targets;
+}
+
+// Count the bullets in flight across every tank
+size_t AiArena::GetBulletCount() const
+{
+    size_t count = 0;
+    for (const Tank& tank : tanks)
+    {
+        count += tank.GetBullets().size();
+    }
+    return count;
+}
+
+// Get the bullet pool
+const MemoryPool& AiArena::GetBulletPool() const
+{
+    return bulletPool;
+}
+
+// Get the number of bullets that have hit a tank
+uint64_t AiArena::GetHitCount() const
+{
+    return hits;
+}
+
+// Get the number of tanks caught in explosions
+uint64_t AiArena::GetSplashCount() const
+{
+    return splashes;
+}
+
+// Get the first damage event from the last Step
+const DamageEvent* AiArena::GetDamageEvents() const
+{
+    return splash.GetEvents();
+}
+
+// Get the number of damage events from the last Step
+size_t AiArena::GetDamageEventCount() const
+{
+    return splash.GetEventCount();
+}
+
+// Get the collision counters from the last Step
+const CollisionStats& AiArena::GetCollisionStats() const
+{
+    return collider.GetStats();
+}
+
+// Get how long the last Step's phases took
+const AiTimings& AiArena::GetTimings() const
+{
+    return timings;
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include "raylib.h"
+#include "CollisionMask.h"
+#include "FlowField.h"
+#include "InterceptSolver.h"
+#include "Pool.h"
+#include "SpatialGrid.h"
+#include "SplashDamage.h"
+#include "Sprite.h"
+#include "Tank.h"
+#include "TankCollider.h"
+#include "TankInput.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// How AiArena picks each tank's target
+enum class AiTargeting
+{
+    Grid,       // Batched queries against a spatial grid of the enemy team
+    BruteForce  // Every tank scans every enemy, kept to measure the grid against and check its answers
+};
+
+// Time spent in each phase of the most recent Step
+struct AiTimings
+{
+    float gatherMs;  // Copying tank positions out and rebuilding the grids
+    float targetMs;  // Nearest-enemy queries
+    float aimMs;     // Estimating target velocities and solving where to lead each shot
+    float steerMs;   // Turning targets into inputs and updating the tanks
+    float collideMs; // Pushing overlapping tank bodies apart
+    float cullMs;    // Dropping bullets that left the arena or their tank's range, or hit an enemy tank, and exploding the hits
+};
+
+// Two teams of computer-driven tanks. Every tick each tank targets the nearest enemy in range, turns
+// and drives towards it, aims the turret ahead of the enemy's motion and fires when lined up.
+// Lead angles for every tank with a target are solved in one InterceptSolver batch. Targets are found for a whole
+// team at once: the enemy team goes into a SpatialGrid, and the team's own grid order is used as
+// the query order so tanks close to each other search the same cells back to back.
+// Bullets hit enemy tanks only where the sprites' solid pixels meet: the grid finds the nearest enemy
+// and the collision masks of the bullet and the tank's body and turret decide. Every hit in a tick
+// explodes, and the tick's explosions are run as one SplashDamage batch against every tank.
+class AiArena
+{
+public:
+    static const int teamCount = 2;
+
+    // tankCapacity sizes the tank list and bullet pool up front, so spawning never reallocates
+    AiArena(float width, float height, Sprite bodySprite, Sprite turretSprite, Sprite bulletSprite, size_t tankCapacity);
+
+    // Adds a tank to a team, facing the same way every new Tank does
+    void Spawn(MathClasses::Vector3 position, int team);
+
+    // Spreads count tanks over a lattice filling the arena, with the teams alternating like a checkerboard
+    void SpawnLattice(int count);
+
+    // Picks targets, steers and moves every tank, pushes overlapping tanks apart, then culls bullets
+    void Step(float deltaTime);
+
+    // Draws a team marker under each tank, then the tank and its bullets
+    void Draw();
+
+    // Tanks without a target follow this field instead of heading straight for the centre, null to stop
+    // The field must outlive the arena or be cleared first
+    void SetFlowField(const FlowField* field);
+
+    void SetTargeting(AiTargeting mode);
+    AiTargeting GetTargeting() const;
+
+    size_t GetTankCount() const;
+    const Tank& GetTank(size_t index) const;
+    int GetTeam(size_t index) const;
+
+    // Tank each tank chose on the last Step, or -1 when no enemy was in range
+    const std::vector<int32_t>& GetTargets() const;
+
+    size_t GetBulletCount() const;
+
+    // Pool every tank's bullets are allocated from
+    const MemoryPool& GetBulletPool() const;
+
+    // Bullets that have hit an enemy tank since the arena was made
+    uint64_t GetHitCount() const;
+
+    // Tanks caught in a hit's explosion since the arena was made, counting a tank once per explosion
+    uint64_t GetSplashCount() const;
+
+    // Tanks caught in the last Step's explosions and the damage each took
+    const DamageEvent* GetDamageEvents() const;
+    size_t GetDamageEventCount() const;
+
+    const AiTimings& GetTimings() const;
+    const CollisionStats& GetCollisionStats() const;
+
+private:
+    void GatherPositions();
+    void FindTargetsWithGrid();
+    void FindTargetsBruteForce();
+
+    // Estimates each tank's velocity from its last move, then solves every tank's lead shot in one batch
+    void SolveLeads(float deltaTime);
+
+    // True when the bullet's solid pixels touch the tank's body or turret
+    bool BulletHitsTank(const Bullet& bullet, const Tank& tank) const;
+
+    // Builds one tick of controls for a tank from its target, or from the flow field or arena centre without one
+    TankInput Steer(size_t index, float deltaTime);
+
+    float width, height;
+    Sprite bodySprite, turretSprite, bulletSprite;
+    MemoryPool bulletPool; // Declared before the tanks, whose bullet lists allocate from it
+    std::vector<Tank> tanks;
+    std::vector<uint8_t> teams;
+    std::vector<float> fireCooldowns;            // Seconds until each tank may fire again
+    std::vector<int32_t> targets;
+    std::vector<int32_t> members[teamCount];     // Tank indices in each team, in spawn order
+    std::vector<Vector2> positions[teamCount];   // Positions of each team's tanks, in members order
+    SpatialGrid grids[teamCount];
+    std::vector<int32_t> results;                // Query results for one team, in its grid's order
+    std::vector<Vector2> lastPositions;          // Where each tank was at the start of the last Step
+    std::vector<Vector2> velocities;
+    std::vector<int32_t> aimSlots;               // Each tank's shot in the aim batch, or -1 without a target
+    InterceptSolver aimSolver;
+    CollisionMask bodyMask, turretMask, bulletMask;
+    float hitReach;                              // Furthest a bullet's centre can be from a tank it touches
+    uint64_t hits;
+    std::vector<Explosion> explosions;           // Hits from the current Step, exploded together after the cull
+    SplashDamage splash;
+    uint64_t splashes;
+    TankCollider collider;
+    const FlowField* flowField;
+    AiTargeting targeting;
+    AiTimings timings;
+};
@@ -0,0 +1,151 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#define ALLOCATION_BLOCK_SIZE(memory) _msize(memory)
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#define ALLOCATION_BLOCK_SIZE(memory) malloc_size(memory)
+#else
+#include <malloc.h>
+#define ALLOCATION_BLOCK_SIZE(memory) malloc_usable_size(memory)
+#endif
+
+namespace
+{
+    std::atomic<uint64_t> allocationCount{ 0 };
+    std::atomic<uint64_t> allocationBytes{ 0 };
+    std::atomic<uint64_t> liveBytes{ 0 };
+    std::atomic<uint64_t> peakLiveBytes{ 0 };
+
+    // Count the request and forward it to malloc
+    void* CountedAllocate(size_t size)
+    {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocationBytes.fetch_add(size, std::memory_order_relaxed);
+        void* memory = malloc(size == 0 ? 1 : size);
+        if (memory != nullptr)
+        {
+            uint64_t blockSize = ALLOCATION_BLOCK_SIZE(memory);
+            uint64_t live = liveBytes.fetch_add(blockSize, std::memory_order_relaxed) + blockSize;
+            uint64_t peak = peakLiveBytes.load(std::memory_order_relaxed);
+            while (live > peak && !peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+            {
+            }
+        }
+        return memory;
+    }
+
+    // Uncount the block and return it to malloc
+    void CountedFree(void* memory)
+    {
+        if (memory != nullptr)
+        {
+            liveBytes.fetch_sub(ALLOCATION_BLOCK_SIZE(memory), std::memory_order_relaxed);
+        }
+        free(memory);
+    }
+}
+
+// Count a raw block the same way operator new is counted
+void* AllocationCounter::Allocate(size_t size)
+{
+    return CountedAllocate(size);
+}
+
+// Uncount and release a raw block
+void AllocationCounter::Free(void* memory)
+{
+    CountedFree(memory);
+}
+
+// Get the number of heap allocations
+uint64_t AllocationCounter::GetAllocations()
+{
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+// Get the number of heap bytes requested
+uint64_t AllocationCounter::GetBytes()
+{
+    return allocationBytes.load(std::memory_order_relaxed);
+}
+
+// Get the bytes held by live allocations
+uint64_t AllocationCounter::GetLiveBytes()
+{
+    return liveBytes.load(std::memory_order_relaxed);
+}
+
+// Get the live byte high-water mark
+uint64_t AllocationCounter::GetPeakLiveBytes()
+{
+    return peakLiveBytes.load(std::memory_order_relaxed);
+}
+
+// Start a new high-water mark from the current live bytes
+void AllocationCounter::ResetPeak()
+{
+    peakLiveBytes.store(liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+// Replacements for the global allocation functions
+// Over-aligned allocations use the standard library's own aligned operators and are not counted
+
+void* operator new(size_t size)
+{
+    void* memory = CountedAllocate(size);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAllocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAllocate(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    CountedFree(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    CountedFree(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    CountedFree(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+    CountedFree(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+    CountedFree(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+    CountedFree(memory);
+}
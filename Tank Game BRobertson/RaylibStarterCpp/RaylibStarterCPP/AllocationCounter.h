@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Counts every call to the global operator new, so frames that touch the heap can be spotted
+// Arenas and pools that manage raw blocks take them from Allocate and Free so they are counted too.
+// The counters are process wide and updated with relaxed atomics
+namespace AllocationCounter
+{
+    // Counted malloc, returns null when the heap is exhausted
+    void* Allocate(size_t size);
+
+    // Counted free for memory from Allocate
+    void Free(void* memory);
+
+    // Total heap allocations since startup
+    uint64_t GetAllocations();
+
+    // Total bytes requested from the heap since startup
+    uint64_t GetBytes();
+
+    // Bytes currently held by live allocations, as reported by the C runtime's block sizes
+    uint64_t GetLiveBytes();
+
+    // Highest live byte count since startup or the last ResetPeak
+    uint64_t GetPeakLiveBytes();
+
+    // Restarts peak tracking from the current live byte count
+    void ResetPeak();
+}
@@ -0,0 +1,272 @@
+#include "AssetArchive.h"
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    const char ARCHIVE_MAGIC[4] = { 'T', 'K', 'P', 'A' };
+
+    // Round a byte offset up to the next 16-byte boundary
+    uint64_t AlignPayload(uint64_t offset)
+    {
+        return (offset + 15) & ~static_cast<uint64_t>(15);
+    }
+
+    // True when the entry's payload lies inside the archive and a pixel entry's payload holds exactly
+    // its width x height RGBA pixels, the only pixel format BuildArchive writes
+    bool EntryFits(const ArchiveEntry& entry, size_t size)
+    {
+        if (entry.offset > size || entry.size > size - entry.offset || entry.name[ARCHIVE_NAME_LENGTH - 1] != '\0')
+        {
+            return false;
+        }
+        if (entry.kind != ARCHIVE_ENTRY_PIXELS)
+        {
+            return true;
+        }
+        return entry.format == UNCOMPRESSED_R8G8B8A8 && entry.width > 0 && entry.height > 0 &&
+            entry.width <= INT_MAX && entry.height <= INT_MAX && entry.size == static_cast<uint64_t>(entry.width) * entry.height * 4;
+    }
+
+    // A file found while walking the asset directory
+    struct SourceFile
+    {
+        std::string name; // Path relative to the asset directory, with forward slashes
+        std::string path; // Path to open
+    };
+
+    // Collect every file below a directory, depth first
+    void CollectFiles(const std::string& directory, const std::string& prefix, std::vector<SourceFile>& files)
+    {
+        // GetDirectoryFiles shares one buffer, so copy the names out before recursing
+        int count = 0;
+        char** names = GetDirectoryFiles(directory.c_str(), &count);
+        std::vector<std::string> children(names, names + count);
+        ClearDirectoryFiles();
+
+        for (const std::string& child : children)
+        {
+            if (child == "." || child == "..")
+            {
+                continue;
+            }
+            std::string path = directory + "/" + child;
+            if (IsFileExtension(child.c_str(), ".tkpa"))
+            {
+                // Never pack an earlier archive, or the output itself, into the new one
+                continue;
+            }
+            if (DirectoryExists(path.c_str()))
+            {
+                CollectFiles(path, prefix + child + "/", files);
+            }
+            else
+            {
+                files.push_back({ prefix + child, path });
+            }
+        }
+    }
+}
+
+// Decode or read every file, then write the header, sorted table of contents and aligned payloads
+bool BuildArchive(const char* assetDirectory, const char* outputFile, std::string& error)
+{
+    std::vector<SourceFile> files;
+    CollectFiles(assetDirectory, "", files);
+    std::sort(files.begin(), files.end(), [](const SourceFile& a, const SourceFile& b) { return a.name < b.name; });
+
+    std::vector<ArchiveEntry> entries;
+    std::vector<unsigned char> payloads;
+    for (const SourceFile& source : files)
+    {
+        if (source.name.size() >= ARCHIVE_NAME_LENGTH)
+        {
+            error = "name too long for the archive: " + source.name;
+            return false;
+        }
+
+        ArchiveEntry entry = {};
+        memcpy(entry.name, source.name.c_str(), source.name.size());
+        payloads.resize(AlignPayload(payloads.size()));
+        entry.offset = payloads.size();
+
+        if (IsFileExtension(source.path.c_str(), ".png"))
+        {
+            Image image = LoadImage(source.path.c_str());
+            if (image.data == nullptr)
+            {
+                error = "cannot decode " + source.path;
+                return false;
+            }
+            ImageFormat(&image, UNCOMPRESSED_R8G8B8A8);
+            if (image.format != UNCOMPRESSED_R8G8B8A8)
+            {
+                error = "cannot convert " + source.path + " to RGBA";
+                UnloadImage(image);
+                return false;
+            }
+            entry.kind = ARCHIVE_ENTRY_PIXELS;
+            entry.width = image.width;
+            entry.height = image.height;
+            entry.format = UNCOMPRESSED_R8G8B8A8;
+            entry.size = static_cast<uint64_t>(image.width) * image.height * 4;
+            const unsigned char* pixels = static_cast<const unsigned char*>(image.data);
+            payloads.insert(payloads.end(), pixels, pixels + entry.size);
+            UnloadImage(image);
+        }
+        else
+        {
+            unsigned int length = 0;
+            unsigned char* data = LoadFileData(source.path.c_str(), &length);
+            if (data == nullptr && length != 0)
+            {
+                error = "cannot read " + source.path;
+                return false;
+            }
+            entry.kind = ARCHIVE_ENTRY_BYTES;
+            entry.size = length;
+            payloads.insert(payloads.end(), data, data + length);
+            RL_FREE(data);
+        }
+        entries.push_back(entry);
+    }
+
+    ArchiveHeader header = {};
+    memcpy(header.magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+    header.version = ARCHIVE_VERSION;
+    header.entrySize = sizeof(ArchiveEntry);
+    header.entryCount = static_cast<uint32_t>(entries.size());
+    header.entriesOffset = sizeof(ArchiveHeader);
+    uint64_t payloadStart = AlignPayload(header.entriesOffset + entries.size() * sizeof(ArchiveEntry));
+    header.fileSize = payloadStart + payloads.size();
+    for (ArchiveEntry& entry : entries)
+    {
+        entry.offset += payloadStart;
+    }
+
+    FILE* file = fopen(outputFile, "wb");
+    if (file == nullptr)
+    {
+        error = std::string("cannot write ") + outputFile;
+        return false;
+    }
+    const unsigned char padding[16] = {};
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(entries.data(), sizeof(ArchiveEntry), entries.size(), file);
+    fwrite(padding, 1, payloadStart - (header.entriesOffset + entries.size() * sizeof(ArchiveEntry)), file);
+    fwrite(payloads.data(), 1, payloads.size(), file);
+    bool ok = ferror(file) == 0;
+    ok = fclose(file) == 0 && ok;
+    if (!ok)
+    {
+        // Open would reject the short file anyway, but do not leave it for the game to find
+        remove(outputFile);
+        error = std::string("failed writing ") + outputFile;
+    }
+    return ok;
+}
+
+// Check the header and that every entry lies inside the mapping, with pixel entries exactly the size of their image
+bool AssetArchive::Open(const char* fileName)
+{
+    Close();
+    if (!file.Open(fileName) || file.GetSize() < sizeof(ArchiveHeader))
+    {
+        file.Close();
+        return false;
+    }
+
+    const unsigned char* data = file.GetData();
+    size_t size = file.GetSize();
+    const ArchiveHeader* candidate = reinterpret_cast<const ArchiveHeader*>(data);
+    if (memcmp(candidate->magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0 || candidate->version != ARCHIVE_VERSION ||
+        candidate->entrySize != sizeof(ArchiveEntry) || candidate->fileSize != size ||
+        candidate->entriesOffset > size || static_cast<uint64_t>(candidate->entryCount) * sizeof(ArchiveEntry) > size - candidate->entriesOffset)
+    {
+        file.Close();
+        return false;
+    }
+
+    const ArchiveEntry* table = reinterpret_cast<const ArchiveEntry*>(data + candidate->entriesOffset);
+    for (uint32_t i = 0; i < candidate->entryCount; ++i)
+    {
+        if (!EntryFits(table[i], size))
+        {
+            file.Close();
+            return false;
+        }
+    }
+
+    header = candidate;
+    entries = table;
+    return true;
+}
+
+// Drop the mapping
+void AssetArchive::Close()
+{
+    file.Close();
+    header = nullptr;
+    entries = nullptr;
+}
+
+// Check if an archive is mapped
+bool AssetArchive::IsOpen() const
+{
+    return header != nullptr;
+}
+
+// The table of contents is sorted by name when the archive is built
+const ArchiveEntry* AssetArchive::Find(const char* name) const
+{
+    if (header == nullptr)
+    {
+        return nullptr;
+    }
+    const ArchiveEntry* end = entries + header->entryCount;
+    const ArchiveEntry* found = std::lower_bound(entries, end, name, [](const ArchiveEntry& entry, const char* key) {
+        return strcmp(entry.name, key) < 0;
+        });
+    if (found == end || strcmp(found->name, name) != 0)
+    {
+        return nullptr;
+    }
+    return found;
+}
+
+// Get the number of entries
+uint32_t AssetArchive::GetEntryCount() const
+{
+    return header != nullptr ? header->entryCount : 0;
+}
+
+// Get the table of contents
+const ArchiveEntry* AssetArchive::GetEntries() const
+{
+    return entries;
+}
+
+// Get a pointer to an entry's payload
+const unsigned char* AssetArchive::GetPayload(const ArchiveEntry& entry) const
+{
+    return file.GetData() + entry.offset;
+}
+
+// Wrap a pixel entry as an Image without copying
+Image AssetArchive::ViewImage(const ArchiveEntry& entry) const
+{
+    Image image = {};
+    if (entry.kind != ARCHIVE_ENTRY_PIXELS)
+    {
+        return image;
+    }
+    image.data = const_cast<unsigned char*>(GetPayload(entry));
+    image.width = static_cast<int>(entry.width);
+    image.height = static_cast<int>(entry.height);
+    image.mipmaps = 1;
+    image.format = static_cast<int>(entry.format);
+    return image;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "MappedFile.h"
+#include "raylib.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Packed asset archive layout (little endian, every payload 16-byte aligned):
+//   ArchiveHeader
+//   entryCount x ArchiveEntry, sorted by name
+//   payloads
+// Names are paths relative to the assets directory, such as "images/body.png".
+// PNGs are stored as raw RGBA pixels so they can be uploaded straight from the mapping,
+// every other file is stored as its bytes.
+const uint32_t ARCHIVE_VERSION = 1;
+const uint32_t ARCHIVE_NAME_LENGTH = 64;
+
+enum ArchiveEntryKind : uint32_t
+{
+    ARCHIVE_ENTRY_BYTES = 1,  // File contents as they were on disk
+    ARCHIVE_ENTRY_PIXELS = 2  // Decoded image, width x height pixels in the given raylib pixel format
+};
+
+struct ArchiveHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t entrySize;   // sizeof(ArchiveEntry) when written
+    uint32_t entryCount;
+    uint64_t entriesOffset;
+    uint64_t fileSize;    // Total size, so a truncated archive is rejected
+};
+
+struct ArchiveEntry
+{
+    char name[ARCHIVE_NAME_LENGTH]; // Null terminated
+    uint32_t kind;                  // ArchiveEntryKind
+    uint32_t width;                 // Image size, zero for byte entries
+    uint32_t height;
+    uint32_t format;                // raylib PixelFormat, zero for byte entries
+    uint64_t offset;                // Byte offset of the payload from the start of the archive
+    uint64_t size;                  // Payload length in bytes
+};
+
+// Packs every file under a directory into one archive, decoding PNGs to raw pixels
+// Runs without a window or GPU
+bool BuildArchive(const char* assetDirectory, const char* outputFile, std::string& error);
+
+// Read-only, memory mapped view of an archive; payloads are used in place without copying
+class AssetArchive
+{
+public:
+    // Maps an archive and validates its table of contents
+    bool Open(const char* fileName);
+
+    // Unmaps the archive, invalidating every payload pointer
+    void Close();
+
+    bool IsOpen() const;
+
+    // Looks up an entry by name with a binary search, returns nullptr if it is missing
+    const ArchiveEntry* Find(const char* name) const;
+
+    uint32_t GetEntryCount() const;
+    const ArchiveEntry* GetEntries() const;
+
+    // Returns the start of an entry's payload inside the mapping
+    const unsigned char* GetPayload(const ArchiveEntry& entry) const;
+
+    // Returns an image whose pixels point into the mapping
+    // It can be uploaded with LoadTextureFromImage but must never be passed to UnloadImage
+    Image ViewImage(const ArchiveEntry& entry) const;
+
+private:
+    MappedFile file;
+    const ArchiveHeader* header = nullptr;
+    const ArchiveEntry* entries = nullptr;
+};
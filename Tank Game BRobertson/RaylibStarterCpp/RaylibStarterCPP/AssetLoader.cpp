@@ -0,0 +1,138 @@
+#include "AssetLoader.h"
+#include "Profiler.h"
+
+AssetLoader::AssetLoader(ThreadPool& pool, const ImageCache* cache) : pool(pool), cache(cache), nextUpload(0), decoding(0)
+{
+}
+
+// Workers hold pointers into slots, so they must all be done before the slots go away
+AssetLoader::~AssetLoader()
+{
+    std::unique_lock<std::mutex> lock(decodedMutex);
+    decodedSignal.wait(lock, [this] { return decoding.load() == 0; });
+    lock.unlock();
+
+    for (Slot& slot : slots)
+    {
+        if (slot.state.load() == AssetState::Decoded && slot.ownsImage)
+        {
+            UnloadImage(slot.image);
+        }
+    }
+}
+
+// Decoding only needs the CPU, so it runs on a worker
+AssetHandle AssetLoader::RequestTexture(const char* fileName)
+{
+    slots.emplace_back();
+    Slot* slot = &slots.back();
+    slot->fileName = fileName;
+    decoding++;
+
+    pool.Submit([this, slot] {
+        PROFILE_SCOPE("Asset::Decode");
+        slot->image = cache != nullptr ? cache->Load(slot->fileName.c_str()) : LoadImage(slot->fileName.c_str());
+        slot->state.store(slot->image.data != nullptr ? AssetState::Decoded : AssetState::Failed, std::memory_order_release);
+
+        std::lock_guard<std::mutex> lock(decodedMutex);
+        decoding--;
+        decodedSignal.notify_all();
+    });
+
+    return static_cast<AssetHandle>(slots.size() - 1);
+}
+
+// Archive pixels skip the thread pool entirely
+AssetHandle AssetLoader::RequestTexture(const AssetArchive& archive, const char* name)
+{
+    slots.emplace_back();
+    Slot& slot = slots.back();
+    slot.fileName = name;
+    slot.ownsImage = false;
+
+    const ArchiveEntry* entry = archive.Find(name);
+    if (entry != nullptr && entry->kind == ARCHIVE_ENTRY_PIXELS)
+    {
+        slot.image = archive.ViewImage(*entry);
+        slot.state.store(AssetState::Decoded, std::memory_order_relaxed);
+    }
+    else
+    {
+        slot.state.store(AssetState::Failed, std::memory_order_relaxed);
+    }
+    return static_cast<AssetHandle>(slots.size() - 1);
+}
+
+// Uploads in request order, stopping at the first image that is still decoding
+int AssetLoader::Update(int maxUploads)
+{
+    PROFILE_SCOPE("Asset::Upload");
+    int uploaded = 0;
+    while (nextUpload < slots.size() && uploaded < maxUploads)
+    {
+        Slot& slot = slots[nextUpload];
+        AssetState state = slot.state.load(std::memory_order_acquire);
+        if (state == AssetState::Decoding)
+        {
+            break;
+        }
+        if (state == AssetState::Decoded)
+        {
+            slot.texture = LoadTextureFromImage(slot.image);
+            if (slot.ownsImage)
+            {
+                UnloadImage(slot.image);
+            }
+            slot.image = {};
+            slot.state.store(slot.texture.id != 0 ? AssetState::Ready : AssetState::Failed, std::memory_order_relaxed);
+            uploaded++;
+        }
+        nextUpload++;
+    }
+    return uploaded;
+}
+
+// Upload whatever is decoded, then sleep until a worker finishes the next one
+void AssetLoader::FinishAll()
+{
+    while (!IsFinished())
+    {
+        Update(static_cast<int>(slots.size()));
+        if (nextUpload < slots.size())
+        {
+            std::unique_lock<std::mutex> lock(decodedMutex);
+            decodedSignal.wait(lock, [this] {
+                return slots[nextUpload].state.load(std::memory_order_acquire) != AssetState::Decoding;
+            });
+        }
+    }
+}
+
+// Get the state of a request
+AssetState AssetLoader::GetState(AssetHandle handle) const
+{
+    return slots[handle].state.load(std::memory_order_acquire);
+}
+
+// Get a request's texture, empty until it is ready
+Texture2D AssetLoader::GetTexture(AssetHandle handle) const
+{
+    const Slot& slot = slots[handle];
+    if (slot.state.load(std::memory_order_acquire) != AssetState::Ready)
+    {
+        return {};
+    }
+    return slot.texture;
+}
+
+// Every request has been uploaded or has failed
+bool AssetLoader::IsFinished() const
+{
+    return nextUpload == slots.size();
+}
+
+// Fraction of requests that are finished
+float AssetLoader::GetProgress() const
+{
+    return slots.empty() ? 1.0f : static_cast<float>(nextUpload) / slots.size();
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "raylib.h"
+#include "AssetArchive.h"
+#include "ImageCache.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+
+// Index of a requested texture inside its AssetLoader
+typedef int AssetHandle;
+
+enum class AssetState : uint8_t
+{
+    Decoding,  // Queued or being decoded on a worker
+    Decoded,   // Pixels are in CPU memory, waiting for the main thread to upload them
+    Ready,     // Texture is on the GPU
+    Failed     // The file could not be read or decoded
+};
+
+// Decodes images on a thread pool and uploads them as textures on the main thread
+// Only Update and FinishAll touch the GPU, so they must be called from the thread that owns the window
+class AssetLoader
+{
+public:
+    // Decodes through the image cache when one is given, which must outlive the loader
+    explicit AssetLoader(ThreadPool& pool, const ImageCache* cache = nullptr);
+
+    // Waits for outstanding decodes and frees any pixels that were never uploaded
+    // Uploaded textures belong to the caller and are not unloaded
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    // Queues an image file for decoding and returns a handle to poll
+    AssetHandle RequestTexture(const char* fileName);
+
+    // Queues a pixel entry from a mapped archive; there is nothing to decode, so it is ready to upload at once
+    // The archive must stay open until the texture has been uploaded
+    AssetHandle RequestTexture(const AssetArchive& archive, const char* name);
+
+    // Uploads at most maxUploads decoded images, returns how many were uploaded
+    int Update(int maxUploads);
+
+    // Blocks until every request is either uploaded or failed
+    void FinishAll();
+
+    AssetState GetState(AssetHandle handle) const;
+
+    // Returns the uploaded texture, or an empty texture if the asset is not ready
+    Texture2D GetTexture(AssetHandle handle) const;
+
+    // Returns true once no request is still decoding or waiting for upload
+    bool IsFinished() const;
+
+    // Returns the fraction of requests that are ready or failed
+    float GetProgress() const;
+
+private:
+    // One requested texture; deque storage keeps its address stable while workers hold it
+    struct Slot
+    {
+        std::string fileName;
+        Image image = {};
+        Texture2D texture = {};
+        bool ownsImage = true;    // False when the pixels are borrowed from an archive mapping
+        std::atomic<AssetState> state{ AssetState::Decoding };
+    };
+
+    ThreadPool& pool;
+    const ImageCache* cache;
+    std::deque<Slot> slots;
+    size_t nextUpload;           // Slots before this index are already Ready or Failed
+    std::atomic<int> decoding;   // Requests still on the thread pool
+    std::mutex decodedMutex;
+    std::condition_variable decodedSignal; // Signalled each time a worker finishes a request
+};
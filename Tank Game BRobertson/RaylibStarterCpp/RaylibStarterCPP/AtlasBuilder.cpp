@@ -0,0 +1,165 @@
+#include "AtlasBuilder.h"
+#include "raylib.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    // Smallest power of two that is at least value
+    int NextPowerOfTwo(int value)
+    {
+        int result = 1;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+}
+
+// Shelf packing: fill rows left to right, starting a new row when the next image does not fit
+void PackAtlas(std::vector<AtlasEntry>& entries, int padding, int& atlasWidth, int& atlasHeight)
+{
+    std::vector<AtlasEntry*> order;
+    int area = 0;
+    int widest = 0;
+    for (AtlasEntry& entry : entries)
+    {
+        order.push_back(&entry);
+        area += (int)(entry.source.width + padding) * (int)(entry.source.height + padding);
+        widest = std::max(widest, (int)entry.source.width + padding);
+    }
+
+    std::stable_sort(order.begin(), order.end(), [](const AtlasEntry* a, const AtlasEntry* b) {
+        return a->source.height > b->source.height;
+        });
+
+    // Aim for a roughly square atlas
+    int side = 1;
+    while (side * side < area)
+    {
+        side <<= 1;
+    }
+    atlasWidth = NextPowerOfTwo(std::max(side, widest));
+
+    int x = padding;
+    int y = padding;
+    int shelfHeight = 0;
+    for (AtlasEntry* entry : order)
+    {
+        int width = (int)entry->source.width;
+        int height = (int)entry->source.height;
+        if (x + width + padding > atlasWidth)
+        {
+            x = padding;
+            y += shelfHeight + padding;
+            shelfHeight = 0;
+        }
+        entry->source.x = (float)x;
+        entry->source.y = (float)y;
+        x += width + padding;
+        shelfHeight = std::max(shelfHeight, height);
+    }
+    atlasHeight = NextPowerOfTwo(y + shelfHeight + padding);
+}
+
+// Decode every PNG on the CPU, pack them and copy their pixels into one RGBA image
+bool BuildAtlas(const char* imageDirectory, const char* outputImage, const char* outputTable, std::string& error)
+{
+    int fileCount = 0;
+    char** files = GetDirectoryFiles(imageDirectory, &fileCount);
+    std::vector<std::string> names;
+    for (int i = 0; i < fileCount; ++i)
+    {
+        if (IsFileExtension(files[i], ".png"))
+        {
+            names.push_back(files[i]);
+        }
+    }
+    ClearDirectoryFiles();
+    std::sort(names.begin(), names.end());
+
+    if (names.empty())
+    {
+        error = std::string("no .png files in ") + imageDirectory;
+        return false;
+    }
+
+    std::vector<Image> images;
+    std::vector<AtlasEntry> entries;
+    for (const std::string& name : names)
+    {
+        std::string path = std::string(imageDirectory) + "/" + name;
+        Image image = LoadImage(path.c_str());
+        if (image.data == nullptr)
+        {
+            error = "cannot decode " + path;
+            for (Image& loaded : images)
+            {
+                UnloadImage(loaded);
+            }
+            return false;
+        }
+        ImageFormat(&image, UNCOMPRESSED_R8G8B8A8);
+        images.push_back(image);
+        entries.push_back({ GetFileNameWithoutExt(name.c_str()), { 0.0f, 0.0f, (float)image.width, (float)image.height } });
+    }
+
+    int atlasWidth = 0;
+    int atlasHeight = 0;
+    PackAtlas(entries, 2, atlasWidth, atlasHeight);
+
+    // Copy rows directly rather than ImageDraw, so edge alpha is not blended against the empty atlas
+    Image atlas = GenImageColor(atlasWidth, atlasHeight, BLANK);
+    if (atlas.data == nullptr)
+    {
+        error = "cannot allocate a " + std::to_string(atlasWidth) + "x" + std::to_string(atlasHeight) + " atlas";
+        for (Image& loaded : images)
+        {
+            UnloadImage(loaded);
+        }
+        return false;
+    }
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        const Image& image = images[i];
+        const Rectangle& place = entries[i].source;
+        for (int row = 0; row < image.height; ++row)
+        {
+            const unsigned char* src = static_cast<const unsigned char*>(image.data) + (size_t)row * image.width * 4;
+            unsigned char* dst = static_cast<unsigned char*>(atlas.data) + (((size_t)place.y + row) * atlasWidth + (size_t)place.x) * 4;
+            memcpy(dst, src, (size_t)image.width * 4);
+        }
+        UnloadImage(images[i]);
+    }
+
+    // ExportImage reports nothing, so remove any old atlas first and look for the new one afterwards
+    remove(outputImage);
+    ExportImage(atlas, outputImage);
+    UnloadImage(atlas);
+    if (!FileExists(outputImage))
+    {
+        error = std::string("cannot write ") + outputImage;
+        return false;
+    }
+
+    FILE* table = fopen(outputTable, "w");
+    if (table == nullptr)
+    {
+        error = std::string("cannot write ") + outputTable;
+        return false;
+    }
+    fprintf(table, "# atlas %s %d %d\n", GetFileName(outputImage), atlasWidth, atlasHeight);
+    for (const AtlasEntry& entry : entries)
+    {
+        fprintf(table, "%s %d %d %d %d\n", entry.name.c_str(), (int)entry.source.x, (int)entry.source.y, (int)entry.source.width, (int)entry.source.height);
+    }
+    bool ok = ferror(table) == 0;
+    ok = fclose(table) == 0 && ok;
+    if (!ok)
+    {
+        error = std::string("failed writing ") + outputTable;
+    }
+    return ok;
+}
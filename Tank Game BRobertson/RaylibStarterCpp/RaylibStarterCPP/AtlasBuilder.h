@@ -0,0 +1,13 @@
+#pragma once
+#include "SpriteAtlas.h"
+#include <string>
+#include <vector>
+
+// Offline atlas packing, runs without a window or GPU
+
+// Places rectangles of the given sizes with shelf packing, tallest first
+// Fills in each entry's x/y and returns the power-of-two atlas size
+void PackAtlas(std::vector<AtlasEntry>& entries, int padding, int& atlasWidth, int& atlasHeight);
+
+// Packs every PNG in a directory into one image plus a "name x y w h" rectangle table
+bool BuildAtlas(const char* imageDirectory, const char* outputImage, const char* outputTable, std::string& error);
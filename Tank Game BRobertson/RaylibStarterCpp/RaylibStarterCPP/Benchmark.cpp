@@ -0,0 +1,421 @@
+#include "Benchmark.h"
+#include "AiArena.h"
+#include "AllocationCounter.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+using namespace MathClasses;
+
+namespace
+{
+    const float benchmarkDeltaTime = 1.0f / 120.0f;
+
+    // Integer hash turned into a float in [0, 1), so scenarios are random looking but identical every run
+    float RandomUnit(uint32_t seed)
+    {
+        seed ^= seed >> 16;
+        seed *= 0x7feb352dU;
+        seed ^= seed >> 15;
+        seed *= 0x846ca68bU;
+        seed ^= seed >> 16;
+        return (seed >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // Arena and sprite sizes shared by every scenario
+    SimulationConfig MakeBenchmarkConfig()
+    {
+        SimulationConfig config = {};
+        config.arenaWidth = 1280.0f;
+        config.arenaHeight = 720.0f;
+        config.tankStartX = 640.0f;
+        config.tankStartY = 360.0f;
+        SetShippedSpriteSizes(config);
+        return config;
+    }
+
+    // Adds bullets at random positions and headings until there are count of them
+    void TopUpBullets(Simulation& simulation, size_t count, uint32_t seed)
+    {
+        const SimulationConfig& config = simulation.GetConfig();
+        while (simulation.GetTank().GetBullets().size() < count)
+        {
+            float angle = RandomUnit(seed++) * 2.0f * PI;
+            float x = RandomUnit(seed++) * config.arenaWidth;
+            float y = RandomUnit(seed++) * config.arenaHeight;
+            simulation.SpawnBullet(MathClasses::Vector3(x, y, 0.0f), MathClasses::Vector3(cosf(angle), sinf(angle), 0.0f));
+        }
+    }
+
+    // Scatters count boxes of the given size over the arena
+    void ScatterBoxes(std::vector<Rectangle>& boxes, int count, float size, const SimulationConfig& config, uint32_t seed)
+    {
+        boxes.reserve(boxes.size() + count);
+        for (int i = 0; i < count; ++i)
+        {
+            float x = RandomUnit(seed + i * 2) * (config.arenaWidth - size);
+            float y = RandomUnit(seed + i * 2 + 1) * (config.arenaHeight - size);
+            boxes.push_back({ x, y, size, size });
+        }
+    }
+
+    // "single-tank-fire": one tank spinning its turret and firing every tick in an empty arena
+    void SetupSingleTank(Simulation&)
+    {
+    }
+
+    void TickSingleTank(Simulation&, uint32_t, TankInput& input)
+    {
+        input.Set(TankInput::Fire, true);
+        input.Set(TankInput::TurretRight, true);
+    }
+
+    // "bullets-vs-targets": 10k bullets kept in flight against 1k targets
+    void SetupBulletsVsTargets(Simulation& simulation)
+    {
+        ScatterBoxes(simulation.GetLevel().targets, 1000, 16.0f, simulation.GetConfig(), 1);
+        TopUpBullets(simulation, 10000, 100000);
+    }
+
+    void TickBulletsVsTargets(Simulation& simulation, uint32_t tick, TankInput&)
+    {
+        TopUpBullets(simulation, 10000, 200000 + tick * 4096);
+    }
+
+    // "dense-level": the tank firing through 5k walls and 5k targets
+    void SetupDenseLevel(Simulation& simulation)
+    {
+        ScatterBoxes(simulation.GetLevel().walls, 5000, 8.0f, simulation.GetConfig(), 300000);
+        ScatterBoxes(simulation.GetLevel().targets, 5000, 8.0f, simulation.GetConfig(), 400000);
+    }
+
+    void TickDenseLevel(Simulation&, uint32_t tick, TankInput& input)
+    {
+        input.Set(TankInput::Fire, true);
+        input.Set((tick / 240) % 2 == 0 ? TankInput::TurretLeft : TankInput::TurretRight, true);
+    }
+
+    // A Simulation driven by a scenario's setup and tick functions
+    class SimulationWorld : public BenchmarkWorld
+    {
+    public:
+        explicit SimulationWorld(const BenchmarkScenario& scenario)
+            : scenario(scenario), simulation(MakeBenchmarkConfig())
+        {
+            scenario.setup(simulation);
+        }
+
+        // The scenario's driver is the spawn phase, the simulation reports update and cull itself
+        void Step(uint32_t tick, BenchmarkTick& measured) override
+        {
+            uint64_t spawnStart = Profiler::NowNs();
+            TankInput input;
+            scenario.tick(simulation, tick, input);
+            measured.spawnMs = (Profiler::NowNs() - spawnStart) / 1000000.0;
+
+            simulation.Step(input, benchmarkDeltaTime);
+            measured.updateMs = simulation.GetTimings().updateMs;
+            measured.cullMs = simulation.GetTimings().cullMs;
+            measured.entities = simulation.GetTank().GetBullets().size();
+        }
+
+        PoolStats GetPoolStats() const override
+        {
+            return simulation.GetEntityPool().GetStats();
+        }
+
+    private:
+        const BenchmarkScenario& scenario;
+        Simulation simulation;
+    };
+
+    // "ai-1k": 1000 AI tanks in two teams on a lattice 160 px apart, targeting through the grid
+    class AiWorld : public BenchmarkWorld
+    {
+    public:
+        static const int tankCount = 1000;
+
+        AiWorld()
+            : AiWorld(MakeBenchmarkConfig())
+        {
+        }
+
+        explicit AiWorld(const SimulationConfig& config)
+            : arena(ArenaSide(), ArenaSide(), Sprite::FromSize(config.bodyWidth, config.bodyHeight),
+                Sprite::FromSize(config.turretWidth, config.turretHeight), Sprite::FromSize(config.bulletWidth, config.bulletHeight), tankCount)
+        {
+            arena.SpawnLattice(tankCount);
+        }
+
+        // Nothing is spawned after setup, steering and moving the tanks counts as the update phase
+        void Step(uint32_t, BenchmarkTick& measured) override
+        {
+            arena.Step(benchmarkDeltaTime);
+            const AiTimings& timings = arena.GetTimings();
+            measured.updateMs = timings.gatherMs + timings.targetMs + timings.aimMs + timings.steerMs + timings.collideMs;
+            measured.cullMs = timings.cullMs;
+            measured.entities = arena.GetTankCount() + arena.GetBulletCount();
+        }
+
+        PoolStats GetPoolStats() const override
+        {
+            return arena.GetBulletPool().GetStats();
+        }
+
+    private:
+        // Square arena with a 160 px lattice cell per tank
+        static float ArenaSide()
+        {
+            return ceilf(sqrtf((float)tankCount)) * 160.0f;
+        }
+
+        AiArena arena;
+    };
+
+    std::unique_ptr<BenchmarkWorld> CreateAiWorld()
+    {
+        return std::make_unique<AiWorld>();
+    }
+
+    // Value at a percentile of an already sorted list
+    double Percentile(const std::vector<double>& sorted, double percentile)
+    {
+        if (sorted.empty())
+        {
+            return 0.0;
+        }
+        size_t rank = std::min(sorted.size() - 1, static_cast<size_t>(percentile / 100.0 * sorted.size()));
+        return sorted[rank];
+    }
+
+    // Find "key": in a line and read the number or string after it
+    bool ReadField(const std::string& line, const char* key, double& value)
+    {
+        std::string pattern = std::string("\"") + key + "\":";
+        size_t at = line.find(pattern);
+        return at != std::string::npos && sscanf(line.c_str() + at + pattern.size(), " %lf", &value) == 1;
+    }
+
+    bool ReadField(const std::string& line, const char* key, std::string& value)
+    {
+        std::string pattern = std::string("\"") + key + "\": \"";
+        size_t at = line.find(pattern);
+        if (at == std::string::npos)
+        {
+            return false;
+        }
+        size_t start = at + pattern.size();
+        size_t end = line.find('"', start);
+        if (end == std::string::npos)
+        {
+            return false;
+        }
+        value = line.substr(start, end - start);
+        return true;
+    }
+
+    // Prints one metric's change and returns true if it moved the wrong way by more than the threshold
+    bool CompareMetric(const char* scenario, const char* metric, double current, double baseline, bool higherIsBetter, double thresholdPercent)
+    {
+        double change = baseline != 0.0 ? (current - baseline) / baseline * 100.0 : 0.0;
+        bool regressed = higherIsBetter ? change < -thresholdPercent : change > thresholdPercent;
+        printf("  %-20s %-20s %14.3f -> %14.3f  %+7.1f%%%s\n", scenario, metric, baseline, current, change, regressed ? "  REGRESSION" : "");
+        return regressed;
+    }
+}
+
+// The scenario table, add new workloads here
+const std::vector<BenchmarkScenario>& GetBenchmarkScenarios()
+{
+    static const std::vector<BenchmarkScenario> scenarios = {
+        { "single-tank-fire", "1 tank firing continuously", 20000, SetupSingleTank, TickSingleTank, nullptr },
+        { "bullets-vs-targets", "10k bullets vs 1k targets", 120, SetupBulletsVsTargets, TickBulletsVsTargets, nullptr },
+        { "dense-level", "1 tank firing through 5k walls and 5k targets", 2000, SetupDenseLevel, TickDenseLevel, nullptr },
+        { "ai-1k", "1k AI tanks in two teams with grid targeting", 2400, nullptr, nullptr, CreateAiWorld },
+    };
+    return scenarios;
+}
+
+// Linear search over the table
+const BenchmarkScenario* FindBenchmarkScenario(const char* name)
+{
+    for (const BenchmarkScenario& scenario : GetBenchmarkScenarios())
+    {
+        if (strcmp(scenario.name, name) == 0)
+        {
+            return &scenario;
+        }
+    }
+    return nullptr;
+}
+
+// Set up untimed, then time every tick of the world, which reports its own phases
+BenchmarkResult RunBenchmark(const BenchmarkScenario& scenario, uint32_t ticks)
+{
+    if (ticks == 0)
+    {
+        ticks = scenario.defaultTicks;
+    }
+
+    BenchmarkResult result;
+    result.name = scenario.name;
+    result.ticks = ticks;
+
+    std::vector<double> tickMs;
+    tickMs.reserve(ticks);
+
+    AllocationCounter::ResetPeak();
+    {
+        std::unique_ptr<BenchmarkWorld> world = scenario.createWorld != nullptr ? scenario.createWorld() : std::make_unique<SimulationWorld>(scenario);
+
+        uint64_t allocationsBefore = AllocationCounter::GetAllocations();
+        double entityTicks = 0.0;
+        uint64_t runStart = Profiler::NowNs();
+        for (uint32_t tick = 0; tick < ticks; ++tick)
+        {
+            uint64_t tickStart = Profiler::NowNs();
+            BenchmarkTick measured;
+            world->Step(tick, measured);
+            uint64_t tickEnd = Profiler::NowNs();
+
+            result.spawnMs += measured.spawnMs;
+            result.updateMs += measured.updateMs;
+            result.cullMs += measured.cullMs;
+            entityTicks += measured.entities;
+            tickMs.push_back((tickEnd - tickStart) / 1000000.0);
+        }
+        result.totalMs = (Profiler::NowNs() - runStart) / 1000000.0;
+        result.allocations = AllocationCounter::GetAllocations() - allocationsBefore;
+
+        double seconds = result.totalMs / 1000.0;
+        result.ticksPerSecond = seconds > 0.0 ? ticks / seconds : 0.0;
+        result.entitiesPerSecond = seconds > 0.0 ? entityTicks / seconds : 0.0;
+
+        PoolStats pool = world->GetPoolStats();
+        result.poolCapacityBytes = pool.capacityBytes;
+        result.poolPeakBytes = pool.peakUsedBytes;
+        result.poolOverflowBytes = pool.overflowBytes;
+    }
+    result.peakHeapBytes = AllocationCounter::GetPeakLiveBytes();
+
+    std::sort(tickMs.begin(), tickMs.end());
+    result.tickP50Ms = Percentile(tickMs, 50.0);
+    result.tickP95Ms = Percentile(tickMs, 95.0);
+    result.tickP99Ms = Percentile(tickMs, 99.0);
+    result.tickMaxMs = tickMs.empty() ? 0.0 : tickMs.back();
+    return result;
+}
+
+// Valid JSON, kept to one scenario per line so ReadBenchmarkJson can stay line based
+bool WriteBenchmarkJson(const std::vector<BenchmarkResult>& results, const char* fileName)
+{
+    FILE* file = fopen(fileName, "w");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    fprintf(file, "{\"version\": 1, \"scenarios\": [\n");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchmarkResult& result = results[i];
+        fprintf(file, "{\"name\": \"%s\", \"ticks\": %u, \"total_ms\": %.3f, \"ticks_per_second\": %.1f, \"entities_per_second\": %.1f, "
+            "\"tick_p50_ms\": %.4f, \"tick_p95_ms\": %.4f, \"tick_p99_ms\": %.4f, \"tick_max_ms\": %.4f, "
+            "\"spawn_ms\": %.3f, \"update_ms\": %.3f, \"cull_ms\": %.3f, \"peak_heap_bytes\": %llu, \"allocations\": %llu, "
+            "\"pool_capacity_bytes\": %llu, \"pool_peak_bytes\": %llu, \"pool_overflow_bytes\": %llu}%s\n",
+            result.name.c_str(), result.ticks, result.totalMs, result.ticksPerSecond, result.entitiesPerSecond,
+            result.tickP50Ms, result.tickP95Ms, result.tickP99Ms, result.tickMaxMs,
+            result.spawnMs, result.updateMs, result.cullMs, (unsigned long long)result.peakHeapBytes, (unsigned long long)result.allocations,
+            (unsigned long long)result.poolCapacityBytes, (unsigned long long)result.poolPeakBytes, (unsigned long long)result.poolOverflowBytes,
+            i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "]}\n");
+
+    bool ok = ferror(file) == 0;
+    ok = fclose(file) == 0 && ok;
+    return ok;
+}
+
+// Every line with a "name" field is one scenario
+bool ReadBenchmarkJson(const char* fileName, std::vector<BenchmarkResult>& results)
+{
+    FILE* file = fopen(fileName, "r");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    results.clear();
+    std::string line;
+    char buffer[1024];
+    while (fgets(buffer, sizeof(buffer), file) != nullptr)
+    {
+        line = buffer;
+        BenchmarkResult result;
+        if (!ReadField(line, "name", result.name))
+        {
+            continue;
+        }
+
+        double value = 0.0;
+        if (ReadField(line, "ticks", value))
+        {
+            result.ticks = (uint32_t)value;
+        }
+        ReadField(line, "total_ms", result.totalMs);
+        ReadField(line, "ticks_per_second", result.ticksPerSecond);
+        ReadField(line, "entities_per_second", result.entitiesPerSecond);
+        ReadField(line, "tick_p50_ms", result.tickP50Ms);
+        ReadField(line, "tick_p95_ms", result.tickP95Ms);
+        ReadField(line, "tick_p99_ms", result.tickP99Ms);
+        ReadField(line, "tick_max_ms", result.tickMaxMs);
+        ReadField(line, "spawn_ms", result.spawnMs);
+        ReadField(line, "update_ms", result.updateMs);
+        ReadField(line, "cull_ms", result.cullMs);
+        if (ReadField(line, "peak_heap_bytes", value))
+        {
+            result.peakHeapBytes = (uint64_t)value;
+        }
+        if (ReadField(line, "allocations", value))
+        {
+            result.allocations = (uint64_t)value;
+        }
+        if (ReadField(line, "pool_capacity_bytes", value))
+        {
+            result.poolCapacityBytes = (uint64_t)value;
+        }
+        if (ReadField(line, "pool_peak_bytes", value))
+        {
+            result.poolPeakBytes = (uint64_t)value;
+        }
+        if (ReadField(line, "pool_overflow_bytes", value))
+        {
+            result.poolOverflowBytes = (uint64_t)value;
+        }
+        results.push_back(result);
+    }
+    fclose(file);
+    return true;
+}
+
+// Scenarios missing from the baseline are reported but never count as regressions
+int CompareBenchmarks(const std::vector<BenchmarkResult>& results, const std::vector<BenchmarkResult>& baseline, double thresholdPercent)
+{
+    int regressions = 0;
+    printf("Comparing against baseline (threshold %.1f%%)\n", thresholdPercent);
+    for (const BenchmarkResult& result : results)
+    {
+        auto match = std::find_if(baseline.begin(), baseline.end(), [&](const BenchmarkResult& base) { return base.name == result.name; });
+        if (match == baseline.end())
+        {
+            printf("  %-20s not in baseline\n", result.name.c_str());
+            continue;
+        }
+        regressions += CompareMetric(result.name.c_str(), "ticks_per_second", result.ticksPerSecond, match->ticksPerSecond, true, thresholdPercent);
+        regressions += CompareMetric(result.name.c_str(), "tick_p95_ms", result.tickP95Ms, match->tickP95Ms, false, thresholdPercent);
+        regressions += CompareMetric(result.name.c_str(), "peak_heap_bytes", (double)result.peakHeapBytes, (double)match->peakHeapBytes, false, thresholdPercent);
+    }
+    return regressions;
+}
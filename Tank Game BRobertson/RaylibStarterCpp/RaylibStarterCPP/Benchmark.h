@@ -0,0 +1,90 @@
+#pragma once
+#include "Pool.h"
+#include "Simulation.h"
+#include "TankInput.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// What one tick of a benchmark world spent in each phase
+struct BenchmarkTick
+{
+    double spawnMs = 0.0;
+    double updateMs = 0.0;
+    double cullMs = 0.0;
+    size_t entities = 0; // Entities stepped this tick
+};
+
+// A workload RunBenchmark builds fresh for each run and steps tick by tick.
+// Scenarios on a Simulation only give setup and tick functions; other worlds, such as an AI arena, implement this
+class BenchmarkWorld
+{
+public:
+    virtual ~BenchmarkWorld() = default;
+
+    // Runs one tick and fills in what each phase cost
+    virtual void Step(uint32_t tick, BenchmarkTick& measured) = 0;
+
+    // Stats of the pool the world's entities are allocated from
+    virtual PoolStats GetPoolStats() const = 0;
+};
+
+// A named, repeatable workload run headless for a fixed number of ticks
+struct BenchmarkScenario
+{
+    const char* name;
+    const char* description;
+    uint32_t defaultTicks;
+
+    // Builds the starting world, not timed
+    void (*setup)(Simulation& simulation);
+
+    // Chooses the tick's input and may add entities to keep the load steady, timed as the "spawn" phase
+    void (*tick)(Simulation& simulation, uint32_t tick, TankInput& input);
+
+    // Builds a world that is not a Simulation, not timed; when set, setup and tick are unused
+    std::unique_ptr<BenchmarkWorld> (*createWorld)();
+};
+
+// Measurements from one scenario run
+struct BenchmarkResult
+{
+    std::string name;
+    uint32_t ticks = 0;
+    double totalMs = 0.0;
+    double ticksPerSecond = 0.0;
+    double entitiesPerSecond = 0.0;  // Entities stepped per second, summed over ticks
+    double tickP50Ms = 0.0;
+    double tickP95Ms = 0.0;
+    double tickP99Ms = 0.0;
+    double tickMaxMs = 0.0;
+    double spawnMs = 0.0;            // Per-phase totals over the whole run
+    double updateMs = 0.0;
+    double cullMs = 0.0;
+    uint64_t peakHeapBytes = 0;      // Highest live heap size during the run, pool blocks included
+    uint64_t allocations = 0;        // Heap allocations made during the timed ticks
+    uint64_t poolCapacityBytes = 0;  // Pool the entities live in: its block, the most of it in use,
+    uint64_t poolPeakBytes = 0;      // and what spilled to the heap because it was full
+    uint64_t poolOverflowBytes = 0;
+};
+
+// Returns every registered scenario
+const std::vector<BenchmarkScenario>& GetBenchmarkScenarios();
+
+// Returns the scenario with the given name, or nullptr
+const BenchmarkScenario* FindBenchmarkScenario(const char* name);
+
+// Runs a scenario for the given number of ticks, or its default when ticks is zero
+BenchmarkResult RunBenchmark(const BenchmarkScenario& scenario, uint32_t ticks);
+
+// Writes results as JSON, one scenario object per line
+bool WriteBenchmarkJson(const std::vector<BenchmarkResult>& results, const char* fileName);
+
+// Reads results written by WriteBenchmarkJson; this is not a general JSON parser
+bool ReadBenchmarkJson(const char* fileName, std::vector<BenchmarkResult>& results);
+
+// Prints a comparison against a baseline and returns the number of metrics that regressed by more
+// than thresholdPercent (lower throughput, or higher p95 tick time or peak heap)
+int CompareBenchmarks(const std::vector<BenchmarkResult>& results, const std::vector<BenchmarkResult>& baseline, double thresholdPercent);
@@ -0,0 +1,666 @@
+#include "BenchmarkCommands.h"
+#include "GameSetup.h"
+#include "AssetLoader.h"
+#include "Benchmark.h"
+#include "Bullet.h"
+#include "GameClient.h"
+#include "GameServer.h"
+#include "ImageCache.h"
+#include "PhysicsWorld.h"
+#include "Pool.h"
+#include "RollbackSession.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace MathClasses;
+
+namespace
+{
+    // List the paths of every PNG in a directory
+    std::vector<std::string> ListImages(const char* imageDirectory)
+    {
+        std::vector<std::string> files;
+        int fileCount = 0;
+        char** names = GetDirectoryFiles(imageDirectory, &fileCount);
+        for (int i = 0; i < fileCount; ++i)
+        {
+            if (IsFileExtension(names[i], ".png"))
+            {
+                files.push_back(std::string(imageDirectory) + "/" + names[i]);
+            }
+        }
+        ClearDirectoryFiles();
+        return files;
+    }
+
+    // Input for tank i on a given tick: always driving, half turning each way, reversing every other two seconds
+    TankInput MakePhysicsBenchmarkInput(int index, int tick)
+    {
+        TankInput input;
+        input.Set((tick / 240) % 2 == 0 ? TankInput::MoveForward : TankInput::MoveBackward, true);
+        input.Set(index % 2 == 0 ? TankInput::RotateLeft : TankInput::RotateRight, true);
+        return input;
+    }
+}
+
+// Run headless benchmark scenarios: --bench [name|all] [--ticks N] [--json out] [--baseline file] [--threshold percent]
+// Returns 1 if any metric regressed past the threshold, so it can gate a build
+int RunBenchmarks(int argc, char** argv, int first)
+{
+    const char* scenarioName = "all";
+    uint32_t ticks = 0;
+    const char* jsonFile = "bench_results.json";
+    const char* baselineFile = nullptr;
+    double threshold = 10.0;
+
+    for (int i = first; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc)
+        {
+            ticks = (uint32_t)atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+        {
+            jsonFile = argv[++i];
+        }
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+        {
+            baselineFile = argv[++i];
+        }
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+        {
+            threshold = atof(argv[++i]);
+        }
+        else if (argv[i][0] != '-')
+        {
+            scenarioName = argv[i];
+        }
+    }
+
+    std::vector<const BenchmarkScenario*> scenarios;
+    for (const BenchmarkScenario& scenario : GetBenchmarkScenarios())
+    {
+        if (strcmp(scenarioName, "all") == 0 || strcmp(scenarioName, scenario.name) == 0)
+        {
+            scenarios.push_back(&scenario);
+        }
+    }
+    if (scenarios.empty())
+    {
+        printf("Unknown scenario %s, available:\n", scenarioName);
+        for (const BenchmarkScenario& scenario : GetBenchmarkScenarios())
+        {
+            printf("  %s - %s\n", scenario.name, scenario.description);
+        }
+        return 1;
+    }
+
+    std::vector<BenchmarkResult> results;
+    for (const BenchmarkScenario* scenario : scenarios)
+    {
+        BenchmarkResult result = RunBenchmark(*scenario, ticks);
+        printf("%-20s %7u ticks %10.1f ticks/s  p50 %.3f  p95 %.3f  p99 %.3f ms  peak heap %llu KB  pool peak %llu/%llu KB, overflow %llu KB\n",
+            result.name.c_str(), result.ticks, result.ticksPerSecond, result.tickP50Ms, result.tickP95Ms, result.tickP99Ms,
+            (unsigned long long)(result.peakHeapBytes / 1024), (unsigned long long)(result.poolPeakBytes / 1024),
+            (unsigned long long)(result.poolCapacityBytes / 1024), (unsigned long long)(result.poolOverflowBytes / 1024));
+        results.push_back(result);
+    }
+
+    if (!WriteBenchmarkJson(results, jsonFile))
+    {
+        printf("Could not write %s\n", jsonFile);
+        return 1;
+    }
+    printf("Wrote %s\n", jsonFile);
+
+    if (baselineFile != nullptr)
+    {
+        std::vector<BenchmarkResult> baseline;
+        if (!ReadBenchmarkJson(baselineFile, baseline))
+        {
+            printf("Could not read baseline %s\n", baselineFile);
+            return 1;
+        }
+        int regressions = CompareBenchmarks(results, baseline, threshold);
+        printf("%d regression(s)\n", regressions);
+        return regressions > 0 ? 1 : 0;
+    }
+    return 0;
+}
+
+// Time loading every PNG in a directory with sequential LoadTexture calls against the AssetLoader
+int BenchmarkAssetLoading(const char* imageDirectory)
+{
+    std::vector<std::string> files = ListImages(imageDirectory);
+    if (files.empty())
+    {
+        printf("No .png files in %s\n", imageDirectory);
+        return 1;
+    }
+
+    // Uploads need a GL context, but nothing has to be shown
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(320, 240, "Tank Game - Asset Benchmark");
+
+    // Read every file once so both runs start from a warm OS file cache
+    for (const std::string& file : files)
+    {
+        unsigned int size = 0;
+        unsigned char* data = LoadFileData(file.c_str(), &size);
+        if (data != nullptr)
+        {
+            RL_FREE(data);
+        }
+    }
+
+    std::vector<Texture2D> textures;
+    textures.reserve(files.size());
+
+    double start = GetTime();
+    for (const std::string& file : files)
+    {
+        textures.push_back(LoadTexture(file.c_str()));
+    }
+    double sequentialMs = (GetTime() - start) * 1000.0;
+
+    for (Texture2D& texture : textures)
+    {
+        UnloadTexture(texture);
+    }
+    textures.clear();
+
+    ThreadPool pool;
+    double parallelMs = 0.0;
+    {
+        AssetLoader loader(pool);
+        start = GetTime();
+        for (const std::string& file : files)
+        {
+            loader.RequestTexture(file.c_str());
+        }
+        loader.FinishAll();
+        parallelMs = (GetTime() - start) * 1000.0;
+
+        for (AssetHandle handle = 0; handle < (AssetHandle)files.size(); ++handle)
+        {
+            UnloadTexture(loader.GetTexture(handle));
+        }
+    }
+
+    CloseWindow();
+
+    printf("%zu images\n", files.size());
+    printf("sequential LoadTexture: %.1f ms\n", sequentialMs);
+    printf("AssetLoader (%u workers): %.1f ms (%.1fx)\n", pool.GetThreadCount(), parallelMs,
+        parallelMs > 0.0 ? sequentialMs / parallelMs : 0.0);
+    return 0;
+}
+
+// Decode every PNG in a directory plainly, then through an empty image cache (cold) and a filled one (warm)
+int BenchmarkImageCache(const char* imageDirectory)
+{
+    std::vector<std::string> files = ListImages(imageDirectory);
+    if (files.empty())
+    {
+        printf("No .png files in %s\n", imageDirectory);
+        return 1;
+    }
+
+    ImageCache cache("image_cache_bench");
+    cache.Clear();
+
+    // Decodes every file one way and returns the time taken in milliseconds
+    auto timeLoads = [&files](auto load) {
+        auto start = std::chrono::steady_clock::now();
+        for (const std::string& file : files)
+        {
+            Image image = load(file.c_str());
+            UnloadImage(image);
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // The untimed first pass only warms the OS file cache
+    timeLoads([](const char* file) { return LoadImage(file); });
+    double decodeMs = timeLoads([](const char* file) {
+        Image image = LoadImage(file);
+        ImageFormat(&image, UNCOMPRESSED_R8G8B8A8);
+        return image;
+    });
+    double coldMs = timeLoads([&cache](const char* file) { return cache.Load(file); });
+    double warmMs = timeLoads([&cache](const char* file) { return cache.Load(file); });
+
+    cache.Clear();
+
+    printf("%zu images\n", files.size());
+    printf("LoadImage + ImageFormat: %.1f ms\n", decodeMs);
+    printf("cold cache (decode + write): %.1f ms\n", coldMs);
+    printf("warm cache (hash + one read): %.1f ms (%.1fx)\n", warmMs, warmMs > 0.0 ? decodeMs / warmMs : 0.0);
+    return 0;
+}
+
+// Keep liveCount objects alive and replace about half of them every round, first through the global heap
+// and then through the pools, to compare allocation cost under heavy spawn/despawn churn
+int BenchmarkPoolChurn(int liveCount, int rounds)
+{
+    if (liveCount <= 0 || rounds <= 0)
+    {
+        printf("--bench-pool needs a positive object count and round count\n");
+        return 1;
+    }
+
+    // The same replacement pattern is used for every allocator, so the runs do identical work
+    std::vector<uint32_t> pattern(liveCount);
+    uint32_t seed = 0x9e3779b9U;
+    for (uint32_t& value : pattern)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        value = seed;
+    }
+
+    // Runs the churn loop with the given create and destroy functions, returns nanoseconds per replacement
+    // inspect is called after the timed rounds, while every object is still alive
+    auto timeChurn = [&](int roundCount, auto create, auto destroy, auto inspect) {
+        std::vector<void*> live(liveCount);
+        for (int i = 0; i < liveCount; ++i)
+        {
+            live[i] = create(pattern[i]);
+        }
+
+        uint64_t replacements = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < roundCount; ++round)
+        {
+            for (int i = 0; i < liveCount; ++i)
+            {
+                if (((pattern[i] >> (round & 15)) & 1) != 0)
+                {
+                    destroy(live[i]);
+                    live[i] = create(pattern[i] + round);
+                    replacements++;
+                }
+            }
+        }
+        double elapsedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        inspect();
+
+        for (void* object : live)
+        {
+            destroy(object);
+        }
+        return replacements > 0 ? elapsedNs / replacements : 0.0;
+    };
+
+    Sprite sprite = Sprite::FromTexture(Texture2D{});
+    MathClasses::Vector3 direction(1.0f, 0.0f, 0.0f);
+
+    // Fixed-size entities: a bullet each
+    double bulletHeapNs = timeChurn(rounds,
+        [&](uint32_t) { return (void*)new Bullet(MathClasses::Vector3(), direction, sprite); },
+        [](void* object) { delete static_cast<Bullet*>(object); }, [] {});
+
+    ObjectPool<Bullet> bulletPool(liveCount);
+    PoolStats bulletStats = {};
+    double bulletPoolNs = timeChurn(rounds,
+        [&](uint32_t) { return (void*)bulletPool.Create(MathClasses::Vector3(), direction, sprite); },
+        [&](void* object) { bulletPool.Destroy(static_cast<Bullet*>(object)); },
+        [&] { bulletStats = bulletPool.GetStats(); });
+
+    // Transient objects of mixed sizes, from 16 to 512 bytes
+    auto transientSize = [](uint32_t value) { return (size_t)16 << (value % 6); };
+    double transientHeapNs = timeChurn(rounds,
+        [&](uint32_t value) { return calloc(1, transientSize(value)); },
+        [](void* object) { free(object); }, [] {});
+
+    SizeClassPool transientPool(liveCount);
+    PoolStats transientStats = {};
+    double transientPoolNs = timeChurn(rounds,
+        [&](uint32_t value) { return transientPool.Allocate(transientSize(value)); },
+        [&](void* object) { transientPool.Free(object); },
+        [&] { transientStats = transientPool.GetStats(); });
+
+    // The same churn through one MemPool, whose free list keeps growing, so it only runs a tenth of the rounds
+    int mixedRounds = std::max(1, rounds / 10);
+    MemoryPool mixedPool((size_t)liveCount * 768);
+    PoolStats mixedStats = {};
+    double mixedPoolNs = timeChurn(mixedRounds,
+        [&](uint32_t value) { return mixedPool.Allocate(transientSize(value)); },
+        [&](void* object) { mixedPool.Free(object); },
+        [&] { mixedStats = mixedPool.GetStats(); });
+
+    printf("%d live objects, %d rounds\n", liveCount, rounds);
+    printf("bullets    new/delete %7.1f ns  ObjectPool %7.1f ns (%.1fx)  peak %zu KB, %llu overflows\n",
+        bulletHeapNs, bulletPoolNs, bulletPoolNs > 0.0 ? bulletHeapNs / bulletPoolNs : 0.0,
+        bulletStats.peakUsedBytes / 1024, (unsigned long long)bulletStats.overflows);
+    printf("transient  calloc/free %6.1f ns  SizeClassPool %4.1f ns (%.1fx)  peak %zu KB, %llu overflows\n",
+        transientHeapNs, transientPoolNs, transientPoolNs > 0.0 ? transientHeapNs / transientPoolNs : 0.0,
+        transientStats.peakUsedBytes / 1024, (unsigned long long)transientStats.overflows);
+    printf("transient  MemoryPool %7.1f ns over %d rounds, then %zu KB free in %zu blocks, largest %zu KB, fragmentation %.0f%%\n",
+        mixedPoolNs, mixedRounds, mixedStats.freeBytes / 1024, mixedStats.freeListLength,
+        mixedStats.largestFreeBlock / 1024, mixedStats.fragmentation * 100.0f);
+    return 0;
+}
+
+// Step growing numbers of tank bodies through physac and through Tank's hand-integrated movement,
+// then measure what handing drives and states across to the physics thread costs the main thread
+int BenchmarkPhysics(int ticks)
+{
+    if (ticks <= 0)
+    {
+        printf("--bench-physics needs a positive tick count\n");
+        return 1;
+    }
+
+    // physac creates a manifold for every pair of moving bodies each step, and finding each one a free id
+    // rescans the live ones, so a step grows roughly with the cube of the count. Past 32 a run takes minutes.
+    const int bodyCounts[] = { 1, 4, 8, 16, 32 };
+    const float deltaTime = 1.0f / 120.0f;
+    const float bodySize = 64.0f;
+
+    Texture2D texture = {};
+    texture.width = (int)bodySize;
+    texture.height = (int)bodySize;
+    Sprite sprite = Sprite::FromTexture(texture);
+
+    // Rows of eight, close enough that neighbours collide once they start turning
+    auto placeBody = [bodySize](int index) {
+        return Vector2{ 100.0f + (index % 8) * (bodySize + 8.0f), 100.0f + (index / 8) * (bodySize + 8.0f) };
+    };
+
+    // Returns microseconds per tick of a loop body
+    auto timeTicks = [ticks](auto tick) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ticks; ++i)
+        {
+            tick(i);
+        }
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / ticks;
+    };
+
+    printf("%d ticks per run\n", ticks);
+    printf("bodies  physac step  Tank::Update  threaded handoff  (thread step)\n");
+    for (int count : bodyCounts)
+    {
+        double physacUs = 0.0;
+        {
+            PhysicsWorld world;
+            for (int i = 0; i < count; ++i)
+            {
+                world.AddDynamicBox(placeBody(i), bodySize, bodySize, -180.0f);
+            }
+            physacUs = timeTicks([&](int tick) {
+                for (int i = 0; i < count; ++i)
+                {
+                    TankInput input = MakePhysicsBenchmarkInput(i, tick);
+                    world.SetDrive(i, TakeTankDrive(input));
+                }
+                world.Step();
+            });
+        }
+
+        double customUs = 0.0;
+        {
+            MemoryPool pool(count * 512 * sizeof(Bullet));
+            std::vector<Tank> tanks;
+            tanks.reserve(count);
+            for (int i = 0; i < count; ++i)
+            {
+                Vector2 position = placeBody(i);
+                tanks.emplace_back(MathClasses::Vector3(position.x, position.y, 0.0f), sprite, sprite, sprite, pool);
+            }
+            customUs = timeTicks([&](int tick) {
+                for (int i = 0; i < count; ++i)
+                {
+                    tanks[i].Update(MakePhysicsBenchmarkInput(i, tick), deltaTime);
+                }
+            });
+        }
+
+        double handoffUs = 0.0;
+        float threadStepMs = 0.0f;
+        {
+            PhysicsWorld world;
+            for (int i = 0; i < count; ++i)
+            {
+                world.AddDynamicBox(placeBody(i), bodySize, bodySize, -180.0f);
+            }
+            std::vector<PhysicsBodyState> states;
+            states.reserve(count);
+            world.Start();
+            handoffUs = timeTicks([&](int tick) {
+                for (int i = 0; i < count; ++i)
+                {
+                    TankInput input = MakePhysicsBenchmarkInput(i, tick);
+                    world.SetDrive(i, TakeTankDrive(input));
+                }
+                world.Read(states);
+            });
+
+            // Let the thread take a few steps even when the handoff loop finished almost at once
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            world.Stop();
+            threadStepMs = world.GetAverageStepMs();
+        }
+
+        printf("%6d  %8.1f us  %9.2f us  %13.2f us  (%.1f us)\n", count, physacUs, customUs, handoffUs, threadStepMs * 1000.0f);
+    }
+    return 0;
+}
+
+// Connect clients to a loopback server and run scripted play, once without loss and once dropping 5% of packets
+// Reports server tick cost and snapshot bytes per client per tick, next to the same world sent in full
+// (quantised, no delta) and as raw floats
+int BenchmarkNetwork(int clientCount, int ticks)
+{
+    if (clientCount <= 0 || clientCount > NET_MAX_PLAYERS || ticks <= 0)
+    {
+        printf("--bench-net needs 1 to %d clients and a positive tick count\n", NET_MAX_PLAYERS);
+        return 1;
+    }
+
+    SimulationConfig config = MakeHeadlessConfig();
+    const float deltaTime = 1.0f / 120.0f;
+    const float lossRates[] = { 0.0f, 0.05f };
+
+    printf("%d clients, %d ticks at 120 Hz\n", clientCount, ticks);
+    printf("loss  server mean   p95     (recv / sim / snapshot)     bytes/client/tick  full    raw     encodes/tick  dropped\n");
+    for (float lossRate : lossRates)
+    {
+        LoopbackTransport transport;
+        transport.SetLossRate(lossRate);
+        GameServer server(transport, config, Sprite::FromSize(config.bodyWidth, config.bodyHeight),
+            Sprite::FromSize(config.turretWidth, config.turretHeight), Sprite::FromSize(config.bulletWidth, config.bulletHeight));
+        server.GetLevel().targets.push_back({ 1000, 100, 140, 140 });
+
+        std::vector<std::unique_ptr<GameClient>> clients;
+        for (int i = 0; i < clientCount; ++i)
+        {
+            clients.push_back(std::make_unique<GameClient>(transport, server.GetEndpoint()));
+        }
+
+        // Connect everyone before measuring, retrying whatever the loss swallowed
+        for (int attempt = 0; attempt < 100 && server.GetPlayerCount() < clientCount; ++attempt)
+        {
+            for (auto& client : clients)
+            {
+                client->ReceivePackets();
+                if (!client->IsConnected())
+                {
+                    client->Connect();
+                }
+            }
+            server.Tick(deltaTime);
+        }
+
+        std::vector<float> tickMs;
+        tickMs.reserve(ticks);
+        double receiveMs = 0.0, simulateMs = 0.0, snapshotMs = 0.0;
+        uint64_t snapshotBytes = 0;
+        uint64_t fullBytes = 0;
+        uint64_t rawBytes = 0;
+        uint64_t encodes = 0;
+        BitWriter fullWriter;
+        for (int tick = 0; tick < ticks; ++tick)
+        {
+            for (int i = 0; i < clientCount; ++i)
+            {
+                clients[i]->ReceivePackets();
+                clients[i]->SendInput(MakeBotInput(i, tick));
+            }
+
+            server.Tick(deltaTime);
+
+            const NetServerStats& stats = server.GetStats();
+            tickMs.push_back(stats.receiveMs + stats.simulateMs + stats.snapshotMs);
+            receiveMs += stats.receiveMs;
+            simulateMs += stats.simulateMs;
+            snapshotMs += stats.snapshotMs;
+            snapshotBytes += stats.bytesSent;
+            encodes += stats.packetsEncoded;
+
+            // What the same world costs without deltas, taken from the last snapshot a client decoded
+            if (clients[0]->HasSnapshot())
+            {
+                const NetSnapshot& snapshot = clients[0]->GetSnapshot();
+                fullWriter.Reset();
+                EncodeSnapshot(snapshot, nullptr, fullWriter);
+                fullBytes += 9 + fullWriter.GetData().size();
+                rawBytes += 9 + snapshot.tanks.size() * (1 + 4 * sizeof(float)) + snapshot.bullets.size() * (2 + 3 * sizeof(float));
+            }
+        }
+
+        uint64_t dropped = 0;
+        for (auto& client : clients)
+        {
+            dropped += client->GetStats().snapshotsDropped;
+        }
+
+        std::sort(tickMs.begin(), tickMs.end());
+        double meanMs = (receiveMs + simulateMs + snapshotMs) / ticks;
+        float p95Ms = tickMs[(size_t)(tickMs.size() * 0.95f)];
+        printf("%3.0f%%  %7.3f ms  %6.3f  (%.3f / %.3f / %.3f ms)  %12.1f B  %5.0f B  %5.0f B  %8.2f  %9llu\n",
+            lossRate * 100.0f, meanMs, p95Ms, receiveMs / ticks, simulateMs / ticks, snapshotMs / ticks,
+            (double)snapshotBytes / ticks / clientCount, (double)fullBytes / ticks, (double)rawBytes / ticks,
+            (double)encodes / ticks, (unsigned long long)dropped);
+    }
+    return 0;
+}
+
+// Run two scripted rollback peers over loopback links of increasing latency, with and without loss
+// A reference world stepped with the true inputs checks every tick each peer has confirmed
+int BenchmarkRollback(int ticks)
+{
+    if (ticks <= 0)
+    {
+        printf("--bench-rollback needs a positive tick count\n");
+        return 1;
+    }
+
+    const float tickSeconds = 1.0f / 120.0f;
+    const int latencies[] = { 0, 50, 100, 150 };
+    const float lossRates[] = { 0.0f, 0.05f };
+    SimulationConfig config = MakeHeadlessConfig();
+    Sprite body = Sprite::FromSize(config.bodyWidth, config.bodyHeight);
+    Sprite turret = Sprite::FromSize(config.turretWidth, config.turretHeight);
+    Sprite bullet = Sprite::FromSize(config.bulletWidth, config.bulletHeight);
+
+    printf("%d ticks per peer at 120 Hz, 2 peers\n", ticks);
+    printf("latency  loss  stalls  rollbacks  avg/max ticks  save us/tick  load us  resim us/tick  frame mean/p99 us  verified  desyncs\n");
+    for (float lossRate : lossRates)
+    {
+        for (int latencyMs : latencies)
+        {
+            LoopbackTransport transport;
+            transport.SetLatency(LatencyToTicks(latencyMs));
+            transport.SetLossRate(lossRate);
+            int endpoints[2] = { transport.CreateEndpoint(), transport.CreateEndpoint() };
+
+            std::vector<std::unique_ptr<RollbackWorld>> worlds;
+            std::vector<std::unique_ptr<RollbackSession>> sessions;
+            for (int peer = 0; peer < 2; ++peer)
+            {
+                worlds.push_back(std::make_unique<RollbackWorld>(config, 2, body, turret, bullet));
+                worlds[peer]->GetLevel().targets.push_back({ 1000, 100, 140, 140 });
+                sessions.push_back(std::make_unique<RollbackSession>(*worlds[peer], transport, endpoints[peer], endpoints[1 - peer], peer, tickSeconds));
+            }
+
+            // Checksums of the world before each tick, from a world that always had the real inputs
+            RollbackWorld reference(config, 2, body, turret, bullet);
+            reference.GetLevel().targets.push_back({ 1000, 100, 140, 140 });
+            std::vector<uint64_t> referenceChecksums;
+            referenceChecksums.reserve(ticks + 1);
+
+            std::vector<float> frameMs;
+            frameMs.reserve(ticks * 4);
+            uint32_t verified[2] = { 0, 0 };
+            uint64_t desyncs = 0;
+
+            for (int frame = 0; frame < ticks * 4 && (worlds[0]->GetTick() < (uint32_t)ticks || worlds[1]->GetTick() < (uint32_t)ticks); ++frame)
+            {
+                for (int peer = 0; peer < 2; ++peer)
+                {
+                    if (worlds[peer]->GetTick() < (uint32_t)ticks)
+                    {
+                        sessions[peer]->AdvanceFrame(MakeBotInput(peer, (int)worlds[peer]->GetTick()));
+                        frameMs.push_back(sessions[peer]->GetStats().lastFrameMs);
+                    }
+                }
+                transport.AdvanceClock();
+
+                for (int peer = 0; peer < 2; ++peer)
+                {
+                    uint32_t confirmed = sessions[peer]->GetConfirmedTick();
+                    while (verified[peer] <= confirmed)
+                    {
+                        while (referenceChecksums.size() <= verified[peer])
+                        {
+                            referenceChecksums.push_back(reference.Checksum());
+                            TankInput inputs[2] = { MakeBotInput(0, (int)reference.GetTick()), MakeBotInput(1, (int)reference.GetTick()) };
+                            reference.Step(inputs, tickSeconds);
+                        }
+                        const WorldState* state = sessions[peer]->GetSavedState(verified[peer]);
+                        if (state != nullptr && ChecksumWorldState(*state) != referenceChecksums[verified[peer]])
+                        {
+                            desyncs++;
+                        }
+                        verified[peer]++;
+                    }
+                }
+            }
+
+            RollbackStats total = {};
+            for (auto& session : sessions)
+            {
+                const RollbackStats& stats = session->GetStats();
+                total.stalls += stats.stalls;
+                total.rollbacks += stats.rollbacks;
+                total.resimulatedTicks += stats.resimulatedTicks;
+                total.maxRollback = stats.maxRollback > total.maxRollback ? stats.maxRollback : total.maxRollback;
+                total.saveMs += stats.saveMs;
+                total.loadMs += stats.loadMs;
+                total.resimulateMs += stats.resimulateMs;
+                total.frameMs += stats.frameMs;
+            }
+
+            std::sort(frameMs.begin(), frameMs.end());
+            uint64_t steppedTicks = worlds[0]->GetTick() + worlds[1]->GetTick() + total.resimulatedTicks;
+            double rollbacks = total.rollbacks > 0 ? (double)total.rollbacks : 1.0;
+            double resimulated = total.resimulatedTicks > 0 ? (double)total.resimulatedTicks : 1.0;
+            printf("%4d ms  %3.0f%%  %6llu  %9llu  %6.1f / %-4u  %12.2f  %7.2f  %13.2f  %8.1f / %-7.1f  %8u  %7llu\n",
+                latencyMs, lossRate * 100.0f, (unsigned long long)total.stalls, (unsigned long long)total.rollbacks,
+                total.resimulatedTicks / rollbacks, total.maxRollback, total.saveMs * 1000.0 / steppedTicks,
+                total.loadMs * 1000.0 / rollbacks, total.resimulateMs * 1000.0 / resimulated,
+                total.frameMs * 1000.0 / frameMs.size(), frameMs[(size_t)(frameMs.size() * 0.99f)] * 1000.0f,
+                verified[0] + verified[1], (unsigned long long)desyncs);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+// Benchmarks run from the command line, each printing a report and returning the process exit code:
+// 0 when the run finished and every check passed, 1 for bad arguments, failed checks or regressions
+
+// Runs the scenarios in Benchmark.h: [name|all] [--ticks N] [--json out] [--baseline file] [--threshold percent]
+// Returns 1 if any metric regressed past the threshold, so it can gate a build
+int RunBenchmarks(int argc, char** argv, int first);
+
+// Asset loading and caching, over every PNG in a directory
+int BenchmarkAssetLoading(const char* imageDirectory);
+int BenchmarkImageCache(const char* imageDirectory);
+
+// Heap against pool allocation under spawn/despawn churn
+int BenchmarkPoolChurn(int liveCount, int rounds);
+
+// Tank bodies through physac against Tank's own movement, and the cost of the hand-off to the physics thread
+int BenchmarkPhysics(int ticks);
+
+// Server tick cost and snapshot sizes for loopback clients, with and without packet loss
+int BenchmarkNetwork(int clientCount, int ticks);
+
+// Rollback peers over growing latency, checked against a world stepped with the true inputs
+int BenchmarkRollback(int ticks);
+
+// AI targeting, lead solving and tank collision
+int BenchmarkAi(int tankCount, int ticks);
+int BenchmarkAim(int shots);
+int BenchmarkCollision(int tankCount, int iterations);
+
+// Broadphases: the dynamic AABB tree and incremental sweep and prune
+int BenchmarkAabbTree(int maxObjects);
+int BenchmarkSweepAndPrune(int objects, int ticks);
+
+// Queries: pixel-mask hits, ray casts, splash damage and flow fields
+int BenchmarkMasks(int tests);
+int BenchmarkRays(int rayCount);
+int BenchmarkSplash(int explosionCount);
+int BenchmarkFlowField(int repeats);
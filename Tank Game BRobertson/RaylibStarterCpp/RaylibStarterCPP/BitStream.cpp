@@ -0,0 +1,123 @@
+#include "BitStream.h"
+
+// Constructor starting with an empty buffer
+BitWriter::BitWriter()
+    : scratch(0), scratchBits(0), bitCount(0)
+{
+}
+
+// Drop everything written, keeping the buffer's capacity
+void BitWriter::Reset()
+{
+    data.clear();
+    scratch = 0;
+    scratchBits = 0;
+    bitCount = 0;
+}
+
+// Gather bits in a 64-bit scratch word and flush whole bytes as they fill
+void BitWriter::WriteBits(uint32_t value, int count)
+{
+    if (count < 32)
+    {
+        value &= (1u << count) - 1u;
+    }
+    scratch |= static_cast<uint64_t>(value) << scratchBits;
+    scratchBits += count;
+    bitCount += count;
+    while (scratchBits >= 8)
+    {
+        data.push_back(static_cast<uint8_t>(scratch));
+        scratch >>= 8;
+        scratchBits -= 8;
+    }
+}
+
+// Write a single flag bit
+void BitWriter::WriteBool(bool value)
+{
+    WriteBits(value ? 1u : 0u, 1);
+}
+
+// The reader sign-extends from the top written bit
+void BitWriter::WriteSigned(int32_t value, int count)
+{
+    WriteBits(static_cast<uint32_t>(value), count);
+}
+
+// Flush the partial byte, later writes carry on after the padding
+const std::vector<uint8_t>& BitWriter::GetData()
+{
+    if (scratchBits > 0)
+    {
+        data.push_back(static_cast<uint8_t>(scratch));
+        bitCount += 8 - scratchBits;
+        scratch = 0;
+        scratchBits = 0;
+    }
+    return data;
+}
+
+// Get the number of bits written, including padding added by GetData
+size_t BitWriter::GetBitCount() const
+{
+    return bitCount;
+}
+
+// Constructor reading from a buffer the caller keeps alive
+BitReader::BitReader(const uint8_t* data, size_t size)
+    : data(data), size(size), bitPosition(0), overflowed(false)
+{
+}
+
+// Read up to a byte at a time, in the order WriteBits packed them
+uint32_t BitReader::ReadBits(int count)
+{
+    if (bitPosition + count > size * 8)
+    {
+        overflowed = true;
+        bitPosition = size * 8;
+        return 0;
+    }
+
+    uint32_t value = 0;
+    int written = 0;
+    while (written < count)
+    {
+        size_t byteIndex = bitPosition / 8;
+        int bitOffset = static_cast<int>(bitPosition % 8);
+        int take = 8 - bitOffset;
+        if (take > count - written)
+        {
+            take = count - written;
+        }
+        uint32_t bits = (data[byteIndex] >> bitOffset) & ((1u << take) - 1u);
+        value |= bits << written;
+        written += take;
+        bitPosition += take;
+    }
+    return value;
+}
+
+// Read a single flag bit
+bool BitReader::ReadBool()
+{
+    return ReadBits(1) != 0;
+}
+
+// Sign-extend from the top bit that was written
+int32_t BitReader::ReadSigned(int count)
+{
+    uint32_t value = ReadBits(count);
+    if (count < 32 && (value & (1u << (count - 1))) != 0)
+    {
+        value |= ~((1u << count) - 1u);
+    }
+    return static_cast<int32_t>(value);
+}
+
+// Check if a read ran past the end of the data
+bool BitReader::HasOverflowed() const
+{
+    return overflowed;
+}
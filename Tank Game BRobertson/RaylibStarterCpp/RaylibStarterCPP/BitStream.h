@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Packs values into a byte buffer using only as many bits as each one needs, lowest bit first
+// The buffer is cleared by Reset but keeps its capacity, so a writer reused every tick stops allocating.
+class BitWriter
+{
+public:
+    BitWriter();
+
+    // Empties the buffer for the next packet
+    void Reset();
+
+    // Writes the low bitCount bits of value, bitCount is at most 32
+    void WriteBits(uint32_t value, int bitCount);
+
+    void WriteBool(bool value);
+
+    // Writes a two's complement value that fits in bitCount bits
+    void WriteSigned(int32_t value, int bitCount);
+
+    // Pads to a whole byte, the returned data ends on the last byte written
+    const std::vector<uint8_t>& GetData();
+
+    size_t GetBitCount() const;
+
+private:
+    std::vector<uint8_t> data;
+    uint64_t scratch;  // Bits waiting to be flushed to data
+    int scratchBits;
+    size_t bitCount;
+};
+
+// Reads values back in the order a BitWriter wrote them
+// Reading past the end returns zeros and sets the overflow flag, so a truncated packet can be rejected after decoding.
+class BitReader
+{
+public:
+    BitReader(const uint8_t* data, size_t size);
+
+    uint32_t ReadBits(int bitCount);
+
+    bool ReadBool();
+
+    int32_t ReadSigned(int bitCount);
+
+    // Checks if a read ran past the end of the data
+    bool HasOverflowed() const;
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t bitPosition;
+    bool overflowed;
+};
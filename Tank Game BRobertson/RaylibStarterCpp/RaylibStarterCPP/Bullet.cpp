@@ -3,14 +3,22 @@
 #include "Vector3.h"
 using namespace MathClasses;
 
+const float Bullet::launchSpeed = 450.0f;
+
 // Constructor initialising bullet properties
-Bullet::Bullet(MathClasses::Vector3 position, MathClasses::Vector3 direction, Texture2D texture)
-    : position(position), direction(direction.Normalised()), texture(texture), speed(450.0f)
+Bullet::Bullet(MathClasses::Vector3 position, MathClasses::Vector3 direction, Sprite sprite)
+    : position(position), direction(direction.Normalised()), sprite(sprite), speed(launchSpeed)
 {
     // Adjusting the rotation to correct the bullet's orientation
     rotation = atan2f(direction.y, direction.x) * RAD2DEG + 90.0f;
 }
 
+// Constructor restoring a bullet exactly as it was saved
+Bullet::Bullet(MathClasses::Vector3 position, MathClasses::Vector3 direction, float speed, float rotation, Sprite sprite)
+    : position(position), direction(direction), speed(speed), rotation(rotation), sprite(sprite)
+{
+}
+
 // Update the bullet's position based on its speed and direction
 void Bullet::Update(float deltaTime)
 {
@@ -20,15 +28,15 @@ void Bullet::Update(float deltaTime)
 // Draw the bullet with the correct rotation
 void Bullet::Draw() const
 {
-    DrawTexturePro(texture, {0, 0, (float)texture.width, (float)texture.height},
-                  {position.x, position.y, (float)texture.width, (float)texture.height},
-                  {texture.width / 2.0f, texture.height / 2.0f}, rotation, WHITE);
+    DrawTexturePro(sprite.texture, sprite.source,
+                  {position.x, position.y, sprite.Width(), sprite.Height()},
+                  {sprite.Width() / 2.0f, sprite.Height() / 2.0f}, rotation, WHITE);
 }
 
-// Check if the bullet has hit the edge of the screen
-bool Bullet::IsOutOfBounds() const
+// Check if the bullet has hit the edge of the arena
+bool Bullet::IsOutOfBounds(float arenaWidth, float arenaHeight) const
 {
-    return position.x < 0 || position.x > GetScreenWidth() || position.y < 0 || position.y > GetScreenHeight();
+    return position.x < 0 || position.x > arenaWidth || position.y < 0 || position.y > arenaHeight;
 }
 
 // Check for bullet collision with the box
@@ -38,8 +46,39 @@ bool Bullet::BoxCollision(const Vector2& boxPos, const Vector2& boxSize) const
         position.y > boxPos.y && position.y < (boxPos.y + boxSize.y));
 }
 
+// Check the bullet against every box in a list
+bool Bullet::HitsAny(const std::vector<Rectangle>& boxes) const
+{
+    for (const Rectangle& box : boxes)
+    {
+        if (BoxCollision({ box.x, box.y }, { box.width, box.height }))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 // Get the current position of the bullet
 MathClasses::Vector3 Bullet::GetPosition() const
 {
     return position;
+}
+
+// Get the direction the bullet is travelling in
+MathClasses::Vector3 Bullet::GetDirection() const
+{
+    return direction;
+}
+
+// Get the speed of the bullet
+float Bullet::GetSpeed() const
+{
+    return speed;
+}
+
+// Get the rendering angle of the bullet
+float Bullet::GetRotation() const
+{
+    return rotation;
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 #include "raylib.h"
+#include "Sprite.h"
 #include "Vector3.h"
+#include <vector>
 
 using namespace MathClasses;
 
@@ -8,8 +10,14 @@ using namespace MathClasses;
 class Bullet
 {
 public:
-    // Constructs a bullet with a given position, direction, and texture
-    Bullet(MathClasses::Vector3 position, MathClasses::Vector3 direction, Texture2D texture);
+    // Speed every newly fired bullet travels at, in pixels per second
+    static const float launchSpeed;
+
+    // Constructs a bullet with a given position, direction, and sprite
+    Bullet(MathClasses::Vector3 position, MathClasses::Vector3 direction, Sprite sprite);
+
+    // Constructs a bullet from exact saved state, without renormalising the direction
+    Bullet(MathClasses::Vector3 position, MathClasses::Vector3 direction, float speed, float rotation, Sprite sprite);
 
     // Updates the bullet's position based on its speed and direction
     void Update(float deltaTime);
@@ -17,19 +25,31 @@ public:
     // Draws the bullet on the screen with the correct rotation
     void Draw() const;
 
-    // Checks if the bullet has moved outside the screen bounds
-    bool IsOutOfBounds() const;
+    // Checks if the bullet has moved outside the arena bounds
+    bool IsOutOfBounds(float arenaWidth, float arenaHeight) const;
 
     // Checks if the bullet collides with a given box (AABB)
     bool BoxCollision(const Vector2& boxPos, const Vector2& boxSize) const;
 
+    // Checks if the bullet is inside any box in a list
+    bool HitsAny(const std::vector<Rectangle>& boxes) const;
+
     // Returns the current position of the bullet
     MathClasses::Vector3 GetPosition() const;
 
+    // Returns the normalised direction of travel
+    MathClasses::Vector3 GetDirection() const;
+
+    // Returns the movement speed in pixels per second
+    float GetSpeed() const;
+
+    // Returns the rendering angle in degrees
+    float GetRotation() const;
+
 private:
     MathClasses::Vector3 position;   // Current position of the bullet
     MathClasses::Vector3 direction;  // Normalized direction vector
     float speed;                     // Movement speed of the bullet
     float rotation;                  // Rotation angle for rendering
-    Texture2D texture;               // Texture used to draw the bullet
+    Sprite sprite;                   // Sprite used to draw the bullet
 };
\ No newline at end of file
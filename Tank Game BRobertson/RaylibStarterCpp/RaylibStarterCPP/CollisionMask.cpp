@@ -0,0 +1,211 @@
+#include "CollisionMask.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+const int CollisionMask::rotationSteps;
+
+namespace
+{
+    // Frame offset between two frames placed by their centres, in a's pixels
+    void FrameOffset(const MaskFrame& a, Vector2 centreA, const MaskFrame& b, Vector2 centreB, int& offsetX, int& offsetY)
+    {
+        offsetX = (int)floorf((centreB.x - b.size * 0.5f) - (centreA.x - a.size * 0.5f) + 0.5f);
+        offsetY = (int)floorf((centreB.y - b.size * 0.5f) - (centreA.y - a.size * 0.5f) + 0.5f);
+    }
+
+    // The 64 bits of a row starting at bit start, which may run off either end of the row
+    uint64_t ReadBits(const uint64_t* row, int words, int start)
+    {
+        if (start < 0)
+        {
+            return start > -64 ? row[0] << -start : 0;
+        }
+        int word = start >> 6;
+        int shift = start & 63;
+        uint64_t low = word < words ? row[word] >> shift : 0;
+        uint64_t high = shift != 0 && word + 1 < words ? row[word + 1] << (64 - shift) : 0;
+        return low | high;
+    }
+
+    // Intersect a's set-bit bounds with b's shifted into a's pixels; false when they miss
+    bool SharedBounds(const MaskFrame& a, const MaskFrame& b, int offsetX, int offsetY, int& x0, int& y0, int& x1, int& y1)
+    {
+        if (a.IsEmpty() || b.IsEmpty())
+        {
+            return false;
+        }
+        x0 = std::max(a.minX, b.minX + offsetX);
+        y0 = std::max(a.minY, b.minY + offsetY);
+        x1 = std::min(a.maxX, b.maxX + offsetX);
+        y1 = std::min(a.maxY, b.maxY + offsetY);
+        return x0 <= x1 && y0 <= y1;
+    }
+}
+
+// Constructor for an empty mask, to be built once the sprite is loaded
+CollisionMask::CollisionMask()
+    : width(0), height(0), solidCount(0)
+{
+}
+
+// Threshold the alpha byte of every pixel
+void CollisionMask::Build(const Image& image, unsigned char alphaThreshold)
+{
+    PROFILE_SCOPE("CollisionMask::Build");
+    width = image.width;
+    height = image.height;
+    const unsigned char* pixels = static_cast<const unsigned char*>(image.data);
+    std::vector<uint8_t> solid((size_t)width * height);
+    for (size_t i = 0; i < solid.size(); ++i)
+    {
+        solid[i] = pixels[i * 4 + 3] >= alphaThreshold ? 1 : 0;
+    }
+    BuildFrames(solid);
+}
+
+// Read the texture back once, crop out the sprite in case it lives in an atlas, and build from that
+bool CollisionMask::BuildFromSprite(Sprite sprite, unsigned char alphaThreshold)
+{
+    if (sprite.texture.id == 0)
+    {
+        return false;
+    }
+    Image image = GetTextureData(sprite.texture);
+    if (image.data == nullptr)
+    {
+        return false;
+    }
+    ImageCrop(&image, sprite.source);
+    ImageFormat(&image, UNCOMPRESSED_R8G8B8A8);
+    Build(image, alphaThreshold);
+    UnloadImage(image);
+    return true;
+}
+
+// Every pixel solid
+void CollisionMask::BuildSolid(int solidWidth, int solidHeight)
+{
+    width = solidWidth;
+    height = solidHeight;
+    BuildFrames(std::vector<uint8_t>((size_t)width * height, 1));
+}
+
+// Count the solid pixels, then rotate them into each frame
+void CollisionMask::BuildFrames(const std::vector<uint8_t>& solid)
+{
+    solidCount = (size_t)std::count(solid.begin(), solid.end(), (uint8_t)1);
+    frames.resize(rotationSteps);
+    for (int step = 0; step < rotationSteps; ++step)
+    {
+        BuildFrame(solid, step * 360.0f / rotationSteps, frames[step]);
+    }
+}
+
+// Each frame pixel's centre is turned back by the rotation into the sprite and takes the pixel it lands in
+// The frame is as wide as the sprite's diagonal, so no rotation cuts a corner off
+void CollisionMask::BuildFrame(const std::vector<uint8_t>& solid, float rotation, MaskFrame& frame) const
+{
+    frame.size = (int)ceilf(sqrtf((float)(width * width + height * height))) + 2;
+    frame.wordsPerRow = (frame.size + 63) / 64;
+    frame.bits.assign((size_t)frame.size * frame.wordsPerRow, 0);
+    frame.minX = frame.minY = frame.size;
+    frame.maxX = frame.maxY = -1;
+
+    float cosine = cosf(rotation * DEG2RAD);
+    float sine = sinf(rotation * DEG2RAD);
+    float half = frame.size * 0.5f;
+    for (int y = 0; y < frame.size; ++y)
+    {
+        float dy = y + 0.5f - half;
+        for (int x = 0; x < frame.size; ++x)
+        {
+            float dx = x + 0.5f - half;
+            int sourceX = (int)floorf(dx * cosine + dy * sine + width * 0.5f);
+            int sourceY = (int)floorf(-dx * sine + dy * cosine + height * 0.5f);
+            if (sourceX < 0 || sourceY < 0 || sourceX >= width || sourceY >= height || !solid[(size_t)sourceY * width + sourceX])
+            {
+                continue;
+            }
+            frame.bits[(size_t)y * frame.wordsPerRow + (x >> 6)] |= 1ull << (x & 63);
+            frame.minX = std::min(frame.minX, x);
+            frame.minY = std::min(frame.minY, y);
+            frame.maxX = std::max(frame.maxX, x);
+            frame.maxY = std::max(frame.maxY, y);
+        }
+    }
+}
+
+// Pick the nearest step, wrapping negative and large angles
+const MaskFrame& CollisionMask::GetFrame(float rotation) const
+{
+    int step = (int)floorf(rotation * (rotationSteps / 360.0f) + 0.5f) % rotationSteps;
+    return frames[step < 0 ? step + rotationSteps : step];
+}
+
+// Get the width of the source sprite
+int CollisionMask::GetWidth() const
+{
+    return width;
+}
+
+// Get the height of the source sprite
+int CollisionMask::GetHeight() const
+{
+    return height;
+}
+
+// Get the number of solid source pixels
+size_t CollisionMask::GetSolidCount() const
+{
+    return solidCount;
+}
+
+// Only the rows and words inside both frames' set-bit bounds are read. Bits of a outside b's
+// bounds meet zeros in b, so the words need no masking at the edges of the shared range.
+bool CollisionMask::Overlaps(const MaskFrame& a, Vector2 centreA, const MaskFrame& b, Vector2 centreB)
+{
+    int offsetX, offsetY, x0, y0, x1, y1;
+    FrameOffset(a, centreA, b, centreB, offsetX, offsetY);
+    if (!SharedBounds(a, b, offsetX, offsetY, x0, y0, x1, y1))
+    {
+        return false;
+    }
+
+    for (int y = y0; y <= y1; ++y)
+    {
+        const uint64_t* rowA = &a.bits[(size_t)y * a.wordsPerRow];
+        const uint64_t* rowB = &b.bits[(size_t)(y - offsetY) * b.wordsPerRow];
+        for (int word = x0 >> 6; word <= x1 >> 6; ++word)
+        {
+            if (rowA[word] & ReadBits(rowB, b.wordsPerRow, word * 64 - offsetX))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Check every pixel in the shared bounds of both frames
+bool CollisionMask::OverlapsPerPixel(const MaskFrame& a, Vector2 centreA, const MaskFrame& b, Vector2 centreB)
+{
+    int offsetX, offsetY, x0, y0, x1, y1;
+    FrameOffset(a, centreA, b, centreB, offsetX, offsetY);
+    if (!SharedBounds(a, b, offsetX, offsetY, x0, y0, x1, y1))
+    {
+        return false;
+    }
+
+    for (int y = y0; y <= y1; ++y)
+    {
+        for (int x = x0; x <= x1; ++x)
+        {
+            if (a.Get(x, y) && b.Get(x - offsetX, y - offsetY))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
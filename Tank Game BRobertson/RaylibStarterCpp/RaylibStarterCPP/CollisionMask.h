@@ -0,0 +1,76 @@
+#pragma once
+#include "raylib.h"
+#include "Sprite.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One rotation of a collision mask: a square grid of bits centred on the sprite's centre
+// Rows are packed 64 pixels to a word, bit x % 64 of word x / 64, so two masks can be compared a
+// word at a time. The bounds of the set bits are kept for a quick box test before any words are read.
+struct MaskFrame
+{
+    int size;        // Width and height in pixels
+    int wordsPerRow;
+    int minX, minY;  // Inclusive bounds of the set bits, min greater than max when nothing is set
+    int maxX, maxY;
+    std::vector<uint64_t> bits;
+
+    bool Get(int x, int y) const
+    {
+        return x >= 0 && y >= 0 && x < size && y < size && ((bits[(size_t)y * wordsPerRow + (x >> 6)] >> (x & 63)) & 1u) != 0;
+    }
+
+    bool IsEmpty() const
+    {
+        return minX > maxX;
+    }
+};
+
+// Pixel-accurate collision shape of a sprite, built once from its alpha channel
+// The sprite is rotated into a frame at each of rotationSteps angles up front, sampling the nearest
+// source pixel, so a test only picks the frame nearest the draw rotation and never rotates anything.
+// Frames are placed by their centres, matching DrawTexturePro with the origin at the sprite's centre.
+class CollisionMask
+{
+public:
+    static const int rotationSteps = 64;
+
+    CollisionMask();
+
+    // Builds every rotation from an R8G8B8A8 image, counting pixels with at least alphaThreshold alpha as solid
+    void Build(const Image& image, unsigned char alphaThreshold);
+
+    // Reads the sprite's pixels back from its texture and builds from them
+    // Returns false, leaving the mask unchanged, when the texture was never uploaded or has no pixels to read
+    bool BuildFromSprite(Sprite sprite, unsigned char alphaThreshold);
+
+    // Builds a mask that is solid across the whole sprite, for sprites without readable pixels
+    void BuildSolid(int width, int height);
+
+    // Frame for the rotation step nearest an angle in degrees
+    const MaskFrame& GetFrame(float rotation) const;
+
+    int GetWidth() const;
+    int GetHeight() const;
+
+    // Solid pixels in the unrotated sprite
+    size_t GetSolidCount() const;
+
+    // Places both frames by their centres and ANDs their rows a word at a time
+    static bool Overlaps(const MaskFrame& a, Vector2 centreA, const MaskFrame& b, Vector2 centreB);
+
+    // The same test one pixel at a time, kept to check Overlaps against
+    static bool OverlapsPerPixel(const MaskFrame& a, Vector2 centreA, const MaskFrame& b, Vector2 centreB);
+
+private:
+    // Rotates the solid pixels into one frame
+    void BuildFrame(const std::vector<uint8_t>& solid, float rotation, MaskFrame& frame) const;
+
+    // Builds every frame from one solid flag per source pixel
+    void BuildFrames(const std::vector<uint8_t>& solid);
+
+    int width, height;
+    size_t solidCount;
+    std::vector<MaskFrame> frames;
+};
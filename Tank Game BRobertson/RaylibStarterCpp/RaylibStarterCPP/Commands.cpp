@@ -0,0 +1,79 @@
+#include "Commands.h"
+#include "BenchmarkCommands.h"
+#include "NetSnapshot.h"
+#include "Tools.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    // A flag that runs a tool or benchmark and exits instead of starting the game
+    struct Command
+    {
+        const char* flag;
+        const char* arguments;                        // Shown after the flag when the required ones are missing
+        int requiredArgs;                             // Arguments that must follow the flag
+        int (*run)(int argc, char** argv, int first); // first indexes the argument after the flag
+    };
+
+    // The argument at index as a number, or fallback when the command line ends before it
+    int IntArg(int argc, char** argv, int index, int fallback)
+    {
+        return index < argc ? atoi(argv[index]) : fallback;
+    }
+
+    // Every command, with the defaults used for arguments left off the end
+    const Command commands[] = {
+        { "--verify", "<file>", 1, [](int, char** argv, int first) { return VerifyReplay(argv[first]); } },
+        { "--compile-level", "<in> <out>", 2, [](int, char** argv, int first) { return CompileLevelFile(argv[first], argv[first + 1]); } },
+        { "--build-atlas", "<dir> <png> <table>", 3, [](int, char** argv, int first) {
+            return BuildAtlasFiles(argv[first], argv[first + 1], argv[first + 2]); } },
+        { "--build-archive", "<dir> <out>", 2, [](int, char** argv, int first) { return BuildArchiveFile(argv[first], argv[first + 1]); } },
+        { "--bench", "[name|all] [--ticks N] [--json file] [--baseline file] [--threshold percent]", 0,
+            [](int argc, char** argv, int first) { return RunBenchmarks(argc, argv, first); } },
+        { "--bench-load", "<dir>", 1, [](int, char** argv, int first) { return BenchmarkAssetLoading(argv[first]); } },
+        { "--bench-cache", "<dir>", 1, [](int, char** argv, int first) { return BenchmarkImageCache(argv[first]); } },
+        { "--bench-pool", "[objects] [rounds]", 0, [](int argc, char** argv, int first) {
+            return BenchmarkPoolChurn(IntArg(argc, argv, first, 10000), IntArg(argc, argv, first + 1, 200)); } },
+        { "--bench-physics", "[ticks]", 0, [](int argc, char** argv, int first) { return BenchmarkPhysics(IntArg(argc, argv, first, 240)); } },
+        { "--bench-net", "[clients] [ticks]", 0, [](int argc, char** argv, int first) {
+            return BenchmarkNetwork(IntArg(argc, argv, first, NET_MAX_PLAYERS), IntArg(argc, argv, first + 1, 1200)); } },
+        { "--bench-rollback", "[ticks]", 0, [](int argc, char** argv, int first) { return BenchmarkRollback(IntArg(argc, argv, first, 3600)); } },
+        { "--bench-ai", "[tanks] [ticks]", 0, [](int argc, char** argv, int first) {
+            return BenchmarkAi(IntArg(argc, argv, first, 10000), IntArg(argc, argv, first + 1, 600)); } },
+        { "--bench-aim", "[shots]", 0, [](int argc, char** argv, int first) { return BenchmarkAim(IntArg(argc, argv, first, 100000)); } },
+        { "--bench-collide", "[tanks] [rounds]", 0, [](int argc, char** argv, int first) {
+            return BenchmarkCollision(IntArg(argc, argv, first, 4000), IntArg(argc, argv, first + 1, 16)); } },
+        { "--bench-tree", "[objects]", 0, [](int argc, char** argv, int first) { return BenchmarkAabbTree(IntArg(argc, argv, first, 100000)); } },
+        { "--bench-sap", "[objects] [ticks]", 0, [](int argc, char** argv, int first) {
+            return BenchmarkSweepAndPrune(IntArg(argc, argv, first, 10000), IntArg(argc, argv, first + 1, 600)); } },
+        { "--bench-masks", "[tests]", 0, [](int argc, char** argv, int first) { return BenchmarkMasks(IntArg(argc, argv, first, 200000)); } },
+        { "--bench-rays", "[rays]", 0, [](int argc, char** argv, int first) { return BenchmarkRays(IntArg(argc, argv, first, 200000)); } },
+        { "--bench-splash", "[explosions]", 0, [](int argc, char** argv, int first) { return BenchmarkSplash(IntArg(argc, argv, first, 2000)); } },
+        { "--bench-flow", "[repeats]", 0, [](int argc, char** argv, int first) { return BenchmarkFlowField(IntArg(argc, argv, first, 10)); } },
+    };
+}
+
+// Linear search over the table, a command missing its arguments prints its usage rather than starting the game
+bool RunCommand(int argc, char** argv, int index, int& exitCode)
+{
+    for (const Command& command : commands)
+    {
+        if (strcmp(argv[index], command.flag) != 0)
+        {
+            continue;
+        }
+        if (index + command.requiredArgs >= argc)
+        {
+            printf("Usage: %s %s\n", command.flag, command.arguments);
+            exitCode = 1;
+        }
+        else
+        {
+            exitCode = command.run(argc, argv, index + 1);
+        }
+        return true;
+    }
+    return false;
+}
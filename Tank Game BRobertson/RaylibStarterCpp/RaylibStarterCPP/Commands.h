@@ -0,0 +1,6 @@
+#pragma once
+
+// Runs the tool or benchmark whose flag is argv[index], reading its arguments from the ones after it
+// A command flag without its required arguments prints the command's usage and sets exitCode to 1
+// Returns true when argv[index] was a command flag, false otherwise, leaving exitCode alone
+bool RunCommand(int argc, char** argv, int index, int& exitCode);
@@ -0,0 +1,121 @@
+#include "EntityInspector.h"
+#include "raygui.h"
+#include <cstdio>
+
+namespace
+{
+    // Formats a rectangle row for the target and wall lists
+    void FormatRectangle(const char* kind, int index, const Rectangle& rectangle, char* text, int textSize)
+    {
+        snprintf(text, textSize, "%s %d  (%.0f, %.0f)  %.0f x %.0f", kind, index, rectangle.x, rectangle.y, rectangle.width, rectangle.height);
+    }
+}
+
+// Each list asks the simulation for its row text only when a visible row needs formatting
+EntityInspector::EntityInspector()
+    : bulletList([this](int index, char* text, int textSize) {
+        const Bullet& bullet = simulation->GetTank().GetBullets()[index];
+        MathClasses::Vector3 position = bullet.GetPosition();
+        MathClasses::Vector3 direction = bullet.GetDirection();
+        snprintf(text, textSize, "Bullet %d  (%.0f, %.0f)  dir (%.2f, %.2f)  %.0f px/s",
+            index, position.x, position.y, direction.x, direction.y, bullet.GetSpeed());
+    }),
+    targetList([this](int index, char* text, int textSize) {
+        FormatRectangle("Target", index, simulation->GetLevel().targets[index], text, textSize);
+    }),
+    wallList([this](int index, char* text, int textSize) {
+        FormatRectangle("Wall", index, simulation->GetLevel().walls[index], text, textSize);
+    })
+{
+    // Targets and walls never move, so their text can be kept much longer than the bullets'
+    targetList.SetRefreshFrames(600);
+    wallList.SetRefreshFrames(600);
+}
+
+// Flip visibility
+void EntityInspector::Toggle()
+{
+    visible = !visible;
+}
+
+// Check if the panel is shown
+bool EntityInspector::IsVisible() const
+{
+    return visible;
+}
+
+// Tabs along the top, a summary line and then the list of the active tab
+void EntityInspector::Draw(const Simulation& world, Rectangle bounds)
+{
+    if (!visible)
+    {
+        return;
+    }
+    simulation = &world;
+
+    VirtualListView* lists[TAB_COUNT] = { &bulletList, &targetList, &wallList };
+    for (int i = 0; i < TAB_COUNT; ++i)
+    {
+        // A bullet culled and another fired in the same tick keeps the count but shifts every row after it
+        int count = GetCount(i);
+        uint32_t generation = GetGeneration(i);
+        if (count != lastCounts[i] || generation != lastGenerations[i])
+        {
+            lists[i]->Invalidate();
+            lastCounts[i] = count;
+            lastGenerations[i] = generation;
+        }
+    }
+
+    GuiPanel(bounds);
+    float tabWidth = (bounds.width - 20.0f - 2.0f * GuiGetStyle(TOGGLE, GROUP_PADDING)) / TAB_COUNT;
+    tab = GuiToggleGroup({ bounds.x + 10.0f, bounds.y + 10.0f, tabWidth, 24.0f }, "Bullets;Targets;Walls", tab);
+
+    VirtualListView& list = *lists[tab];
+    Rectangle listBounds = { bounds.x + 10.0f, bounds.y + 64.0f, bounds.width - 20.0f, bounds.height - 74.0f };
+    list.Draw(listBounds, GetCount(tab));
+
+    GuiLabel({ bounds.x + 10.0f, bounds.y + 38.0f, bounds.width - 20.0f, 20.0f },
+        TextFormat("%d rows, %d formatted this frame", GetCount(tab), list.GetRowsFormatted()));
+
+    DrawSelection();
+    simulation = nullptr;
+}
+
+// Get the number of rows a tab lists
+int EntityInspector::GetCount(int tabIndex) const
+{
+    switch (tabIndex)
+    {
+    case TAB_BULLETS:
+        return (int)simulation->GetTank().GetBullets().size();
+    case TAB_TARGETS:
+        return (int)simulation->GetLevel().targets.size();
+    default:
+        return (int)simulation->GetLevel().walls.size();
+    }
+}
+
+// Get the generation of the entities a tab lists
+uint32_t EntityInspector::GetGeneration(int tabIndex) const
+{
+    return tabIndex == TAB_BULLETS ? simulation->GetBulletGeneration() : simulation->GetLevelGeneration();
+}
+
+// Draw a highlight around whichever entity is selected on the active tab
+void EntityInspector::DrawSelection() const
+{
+    if (tab == TAB_BULLETS && bulletList.GetSelected() >= 0)
+    {
+        MathClasses::Vector3 position = simulation->GetTank().GetBullets()[bulletList.GetSelected()].GetPosition();
+        DrawCircleLines((int)position.x, (int)position.y, 16.0f, MAGENTA);
+    }
+    else if (tab == TAB_TARGETS && targetList.GetSelected() >= 0)
+    {
+        DrawRectangleLinesEx(simulation->GetLevel().targets[targetList.GetSelected()], 3, MAGENTA);
+    }
+    else if (tab == TAB_WALLS && wallList.GetSelected() >= 0)
+    {
+        DrawRectangleLinesEx(simulation->GetLevel().walls[wallList.GetSelected()], 3, MAGENTA);
+    }
+}
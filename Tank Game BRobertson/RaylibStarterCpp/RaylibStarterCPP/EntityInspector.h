@@ -0,0 +1,46 @@
+#pragma once
+#include "raylib.h"
+#include "Simulation.h"
+#include "VirtualListView.h"
+
+// Toggleable panel listing every bullet, target or wall, with the selected one outlined in the world
+// Lists use VirtualListView, so inspecting 100k entities costs no more per frame than inspecting ten.
+class EntityInspector
+{
+public:
+    EntityInspector();
+
+    // Shows or hides the panel
+    void Toggle();
+    bool IsVisible() const;
+
+    // Draws the panel inside bounds and outlines the selected entity, call between BeginDrawing and EndDrawing
+    void Draw(const Simulation& simulation, Rectangle bounds);
+
+private:
+    enum Tab
+    {
+        TAB_BULLETS,
+        TAB_TARGETS,
+        TAB_WALLS,
+        TAB_COUNT
+    };
+
+    // Returns the number of entities shown on a tab
+    int GetCount(int tabIndex) const;
+
+    // Returns the simulation counter that moves when a tab's rows start meaning different entities
+    uint32_t GetGeneration(int tabIndex) const;
+
+    // Outlines the selected entity of the active tab
+    void DrawSelection() const;
+
+    bool visible = false;
+    int tab = TAB_BULLETS;
+    const Simulation* simulation = nullptr; // Only valid during Draw, read by the row callbacks
+    VirtualListView bulletList;
+    VirtualListView targetList;
+    VirtualListView wallList;
+    int lastCounts[TAB_COUNT] = {};           // Row counts seen last frame, a change means indices have shifted
+    uint32_t lastGenerations[TAB_COUNT] = {}; // Generations seen last frame, a change means entities came or went
+};
@@ -0,0 +1,600 @@
+#include "FlowField.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+
+namespace
+{
+    // The eight step directions, straight ones on even indices
+    const int stepX[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+    const int stepY[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+    const uint32_t stepCost[8] = { 10, 14, 10, 14, 10, 14, 10, 14 };
+    const uint8_t noDirection = 8;
+
+    // Unit vectors for each direction, with a zero vector for noDirection
+    const float diagonal = 0.70710678f;
+    const Vector2 stepVectors[9] = {
+        { 1.0f, 0.0f }, { diagonal, diagonal }, { 0.0f, 1.0f }, { -diagonal, diagonal },
+        { -1.0f, 0.0f }, { -diagonal, -diagonal }, { 0.0f, -1.0f }, { diagonal, -diagonal }, { 0.0f, 0.0f }
+    };
+
+    // Enough chunks per thread that an uneven tile does not leave the other threads idle
+    const size_t chunksPerThread = 4;
+}
+
+const int FlowField::tileSize;
+const uint32_t FlowField::unreachable;
+
+// Constructor sizing the cell and tile tables, nothing is solved until the first Build or Update
+FlowField::FlowField(float width, float height, float cellSize)
+    : cellSize(cellSize), inverseCellSize(1.0f / cellSize), goal(0), goalChanged(true), stats()
+{
+    columns = std::max(1, (int)std::ceil(width * inverseCellSize));
+    rows = std::max(1, (int)std::ceil(height * inverseCellSize));
+    tileColumns = (columns + tileSize - 1) / tileSize;
+    tileRows = (rows + tileSize - 1) / tileSize;
+
+    size_t cellCount = (size_t)columns * rows;
+    blocked.assign(cellCount, 0);
+    costs.assign(cellCount, unreachable);
+    directions.assign(cellCount, noDirection);
+
+    size_t tileCount = (size_t)tileColumns * tileRows;
+    dirty.assign(tileCount, 0);
+    edgeChanged.assign(tileCount, 0);
+    unsettled.assign(tileCount, 0);
+    touched.assign(tileCount, 0);
+}
+
+// Flip the overlapped cells, remembering each one that actually changed
+void FlowField::SetBlocked(Rectangle area, bool block)
+{
+    int left = std::max(0, (int)(area.x * inverseCellSize));
+    int top = std::max(0, (int)(area.y * inverseCellSize));
+    int right = std::min(columns - 1, (int)std::ceil((area.x + area.width) * inverseCellSize) - 1);
+    int bottom = std::min(rows - 1, (int)std::ceil((area.y + area.height) * inverseCellSize) - 1);
+    for (int y = top; y <= bottom; ++y)
+    {
+        for (int x = left; x <= right; ++x)
+        {
+            int cell = y * columns + x;
+            if ((blocked[cell] != 0) != block)
+            {
+                blocked[cell] = block ? 1 : 0;
+                changedCells.push_back(cell);
+            }
+        }
+    }
+}
+
+// Move the goal, clamped onto the grid
+void FlowField::SetGoal(Vector2 position)
+{
+    int x = std::min(columns - 1, std::max(0, (int)(position.x * inverseCellSize)));
+    int y = std::min(rows - 1, std::max(0, (int)(position.y * inverseCellSize)));
+    goal = y * columns + x;
+    goalChanged = true;
+}
+
+// Throw every cost away and solve all tiles
+void FlowField::Build(ThreadPool* pool)
+{
+    PROFILE_SCOPE("FlowField::Build");
+    stats = FlowFieldStats();
+    changedCells.clear();
+    goalChanged = false;
+
+    {
+        ScopedTimer timer(stats.integrateMs);
+        std::fill(costs.begin(), costs.end(), unreachable);
+        if (!blocked[goal])
+        {
+            costs[goal] = 0;
+        }
+        std::fill(dirty.begin(), dirty.end(), 1);
+        std::fill(unsettled.begin(), unsettled.end(), 1);
+        std::fill(touched.begin(), touched.end(), 1);
+        RelaxDirtyTiles(pool);
+    }
+
+    ScopedTimer timer(stats.directionMs);
+    UpdateDirections(pool);
+}
+
+// Reset the paths the changes cut, then solve only the tiles that reset cells or newly opened cells live in
+void FlowField::Update(ThreadPool* pool)
+{
+    if (goalChanged)
+    {
+        Build(pool);
+        return;
+    }
+
+    PROFILE_SCOPE("FlowField::Update");
+    stats = FlowFieldStats();
+    if (changedCells.empty())
+    {
+        return;
+    }
+
+    {
+        ScopedTimer timer(stats.integrateMs);
+        for (int cell : changedCells)
+        {
+            if (blocked[cell])
+            {
+                // Cells next to a new obstacle may have stepped diagonally past it, which is no longer allowed
+                ResetPathsThrough(cell);
+                int x = cell % columns;
+                int y = cell / columns;
+                for (int direction = 0; direction < 8; ++direction)
+                {
+                    int nx = x + stepX[direction];
+                    int ny = y + stepY[direction];
+                    if (nx < 0 || ny < 0 || nx >= columns || ny >= rows)
+                    {
+                        continue;
+                    }
+                    int neighbour = ny * columns + nx;
+                    uint8_t step = directions[neighbour];
+                    if (costs[neighbour] != unreachable && step != noDirection && !CanStep(nx, ny, step))
+                    {
+                        ResetPathsThrough(neighbour);
+                    }
+                }
+            }
+            else
+            {
+                // A cell that opened can only make paths shorter, solving its tile lets that spread outwards
+                costs[cell] = cell == goal ? 0 : unreachable;
+                unsettled[TileOf(cell)] = 1;
+                MarkAround(TileOf(cell));
+            }
+        }
+        changedCells.clear();
+        RelaxDirtyTiles(pool);
+    }
+
+    ScopedTimer timer(stats.directionMs);
+    UpdateDirections(pool);
+}
+
+// Dijkstra from the goal with a binary heap, stepping by the same rules as the tile sweeps
+void FlowField::BuildSerial()
+{
+    PROFILE_SCOPE("FlowField::BuildSerial");
+    stats = FlowFieldStats();
+    changedCells.clear();
+    goalChanged = false;
+
+    {
+        ScopedTimer timer(stats.integrateMs);
+        std::fill(costs.begin(), costs.end(), unreachable);
+        typedef std::pair<uint32_t, int> Entry;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+        if (!blocked[goal])
+        {
+            costs[goal] = 0;
+            open.push(Entry(0, goal));
+        }
+        while (!open.empty())
+        {
+            Entry entry = open.top();
+            open.pop();
+            if (entry.first != costs[entry.second])
+            {
+                continue;
+            }
+            int x = entry.second % columns;
+            int y = entry.second / columns;
+            for (int direction = 0; direction < 8; ++direction)
+            {
+                // Steps are symmetric, so a neighbour that can step here can be reached from here
+                if (!CanStep(x, y, direction))
+                {
+                    continue;
+                }
+                int neighbour = (y + stepY[direction]) * columns + x + stepX[direction];
+                uint32_t cost = entry.first + stepCost[direction];
+                if (cost < costs[neighbour])
+                {
+                    costs[neighbour] = cost;
+                    open.push(Entry(cost, neighbour));
+                }
+            }
+        }
+    }
+
+    ScopedTimer timer(stats.directionMs);
+    std::fill(touched.begin(), touched.end(), 1);
+    UpdateDirections(nullptr);
+}
+
+// Look up the stored direction for the cell under a position
+Vector2 FlowField::Sample(Vector2 position) const
+{
+    int x = (int)(position.x * inverseCellSize);
+    int y = (int)(position.y * inverseCellSize);
+    if (x < 0 || y < 0 || x >= columns || y >= rows)
+    {
+        return stepVectors[noDirection];
+    }
+    return stepVectors[directions[y * columns + x]];
+}
+
+// Diagonal steps need both cells they pass between to be open
+bool FlowField::CanStep(int x, int y, int direction) const
+{
+    int nx = x + stepX[direction];
+    int ny = y + stepY[direction];
+    if (nx < 0 || ny < 0 || nx >= columns || ny >= rows || blocked[ny * columns + nx])
+    {
+        return false;
+    }
+    return (direction % 2) == 0 || (!blocked[y * columns + nx] && !blocked[ny * columns + x]);
+}
+
+// Dijkstra confined to one tile: edge cells first take the best step in from a neighbouring tile, then
+// only steps inside the tile are relaxed. A settled tile already agrees with itself, so only the edge
+// cells that improved start the search; an unsettled one starts from every cell with a cost.
+// Neighbours in other tiles are only read, and belong to tiles of other colours that are not running
+uint8_t FlowField::SolveTile(int tile, std::vector<uint64_t>& heap)
+{
+    int left = (tile % tileColumns) * tileSize;
+    int top = (tile / tileColumns) * tileSize;
+    int right = std::min(left + tileSize, columns) - 1;
+    int bottom = std::min(top + tileSize, rows) - 1;
+
+    // Bit d is set when a changed cell sits on the side facing step direction d
+    uint8_t edges = 0;
+    auto noteChange = [&](int x, int y) {
+        if (x != left && x != right && y != top && y != bottom)
+        {
+            return;
+        }
+        for (int direction = 0; direction < 8; ++direction)
+        {
+            if ((stepX[direction] < 0 && x == left) || (stepX[direction] > 0 && x == right) || stepX[direction] == 0)
+            {
+                if ((stepY[direction] < 0 && y == top) || (stepY[direction] > 0 && y == bottom) || stepY[direction] == 0)
+                {
+                    edges |= (uint8_t)(1 << direction);
+                }
+            }
+        }
+    };
+
+    // Entries pack the cost above the cell index, so the smallest entry is the cheapest cell
+    bool seedAll = unsettled[tile] != 0;
+    unsettled[tile] = 0;
+    heap.clear();
+    for (int y = top; y <= bottom; ++y)
+    {
+        for (int x = left; x <= right; ++x)
+        {
+            int cell = y * columns + x;
+            if (blocked[cell])
+            {
+                continue;
+            }
+            uint32_t best = costs[cell];
+            if (x == left || x == right || y == top || y == bottom)
+            {
+                for (int direction = 0; direction < 8; ++direction)
+                {
+                    int nx = x + stepX[direction];
+                    int ny = y + stepY[direction];
+                    if ((nx < left || nx > right || ny < top || ny > bottom) && CanStep(x, y, direction))
+                    {
+                        uint32_t neighbourCost = costs[ny * columns + nx];
+                        if (neighbourCost != unreachable && neighbourCost + stepCost[direction] < best)
+                        {
+                            best = neighbourCost + stepCost[direction];
+                        }
+                    }
+                }
+                if (best < costs[cell])
+                {
+                    costs[cell] = best;
+                    noteChange(x, y);
+                    heap.push_back(((uint64_t)best << 32) | (uint32_t)cell);
+                    continue;
+                }
+            }
+            if (seedAll && best != unreachable)
+            {
+                heap.push_back(((uint64_t)best << 32) | (uint32_t)cell);
+            }
+        }
+    }
+    std::make_heap(heap.begin(), heap.end(), std::greater<uint64_t>());
+
+    while (!heap.empty())
+    {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<uint64_t>());
+        uint64_t entry = heap.back();
+        heap.pop_back();
+        uint32_t cost = (uint32_t)(entry >> 32);
+        int cell = (int)(entry & 0xFFFFFFFFu);
+        if (cost != costs[cell])
+        {
+            continue;
+        }
+        int x = cell % columns;
+        int y = cell / columns;
+        for (int direction = 0; direction < 8; ++direction)
+        {
+            int nx = x + stepX[direction];
+            int ny = y + stepY[direction];
+            if (nx < left || nx > right || ny < top || ny > bottom || !CanStep(x, y, direction))
+            {
+                continue;
+            }
+            int neighbour = ny * columns + nx;
+            uint32_t neighbourCost = cost + stepCost[direction];
+            if (neighbourCost < costs[neighbour])
+            {
+                costs[neighbour] = neighbourCost;
+                noteChange(nx, ny);
+                heap.push_back(((uint64_t)neighbourCost << 32) | (uint32_t)neighbour);
+                std::push_heap(heap.begin(), heap.end(), std::greater<uint64_t>());
+            }
+        }
+    }
+    return edges;
+}
+
+// One pass runs the four colours in turn, each colour's dirty tiles in parallel. A tile whose edge
+// changed dirties the neighbours on that side, which the later colours of the same pass already pick up.
+void FlowField::RelaxDirtyTiles(ThreadPool* pool)
+{
+    bool anyDirty = true;
+    while (anyDirty)
+    {
+        anyDirty = false;
+        stats.passes++;
+        for (int colour = 0; colour < 4; ++colour)
+        {
+            tileList.clear();
+            for (int ty = colour / 2; ty < tileRows; ty += 2)
+            {
+                for (int tx = colour % 2; tx < tileColumns; tx += 2)
+                {
+                    int tile = ty * tileColumns + tx;
+                    if (dirty[tile])
+                    {
+                        dirty[tile] = 0;
+                        touched[tile] = 1;
+                        tileList.push_back(tile);
+                    }
+                }
+            }
+            if (tileList.empty())
+            {
+                continue;
+            }
+
+            RunChunked(pool, tileList.size(), [this](size_t first, size_t last) {
+                std::vector<uint64_t> heap;
+                heap.reserve(tileSize * tileSize * 2);
+                for (size_t i = first; i < last; ++i)
+                {
+                    edgeChanged[tileList[i]] = SolveTile(tileList[i], heap);
+                }
+            });
+            stats.tilesSolved += (uint32_t)tileList.size();
+
+            // Only the tiles across a changed side can improve from it
+            for (int tile : tileList)
+            {
+                int tx = tile % tileColumns;
+                int ty = tile / tileColumns;
+                for (int direction = 0; direction < 8; ++direction)
+                {
+                    int nx = tx + stepX[direction];
+                    int ny = ty + stepY[direction];
+                    if ((edgeChanged[tile] & (1 << direction)) && nx >= 0 && ny >= 0 && nx < tileColumns && ny < tileRows)
+                    {
+                        dirty[ny * tileColumns + nx] = 1;
+                    }
+                }
+            }
+        }
+        for (uint8_t flag : dirty)
+        {
+            if (flag)
+            {
+                anyDirty = true;
+                break;
+            }
+        }
+    }
+}
+
+// A cell's direction reads its neighbours' costs, so tiles next to a solved one are redone too
+void FlowField::UpdateDirections(ThreadPool* pool)
+{
+    tileList.clear();
+    for (int ty = 0; ty < tileRows; ++ty)
+    {
+        for (int tx = 0; tx < tileColumns; ++tx)
+        {
+            bool near = false;
+            for (int y = std::max(0, ty - 1); y <= std::min(tileRows - 1, ty + 1) && !near; ++y)
+            {
+                for (int x = std::max(0, tx - 1); x <= std::min(tileColumns - 1, tx + 1) && !near; ++x)
+                {
+                    near = touched[y * tileColumns + x] != 0;
+                }
+            }
+            if (near)
+            {
+                tileList.push_back(ty * tileColumns + tx);
+            }
+        }
+    }
+
+    RunChunked(pool, tileList.size(), [this](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i)
+        {
+            int tile = tileList[i];
+            int left = (tile % tileColumns) * tileSize;
+            int top = (tile / tileColumns) * tileSize;
+            int right = std::min(left + tileSize, columns);
+            int bottom = std::min(top + tileSize, rows);
+            for (int y = top; y < bottom; ++y)
+            {
+                for (int x = left; x < right; ++x)
+                {
+                    int cell = y * columns + x;
+                    // Pick the step that gives this cell its cost, so following directions walks the shortest path
+                    uint8_t best = noDirection;
+                    uint32_t bestCost = unreachable;
+                    if (!blocked[cell] && costs[cell] != unreachable && costs[cell] > 0)
+                    {
+                        for (int direction = 0; direction < 8; ++direction)
+                        {
+                            if (CanStep(x, y, direction))
+                            {
+                                uint32_t neighbourCost = costs[(y + stepY[direction]) * columns + x + stepX[direction]];
+                                if (neighbourCost != unreachable && neighbourCost + stepCost[direction] < bestCost)
+                                {
+                                    bestCost = neighbourCost + stepCost[direction];
+                                    best = (uint8_t)direction;
+                                }
+                            }
+                        }
+                    }
+                    directions[cell] = best;
+                }
+            }
+        }
+    });
+    std::fill(touched.begin(), touched.end(), 0);
+}
+
+// Walk the direction field backwards from a cell: any open neighbour stepping into a reset cell is reset too
+void FlowField::ResetPathsThrough(int cell)
+{
+    if (costs[cell] == unreachable)
+    {
+        return;
+    }
+    resetQueue.clear();
+    resetQueue.push_back(cell);
+    costs[cell] = unreachable;
+    for (size_t i = 0; i < resetQueue.size(); ++i)
+    {
+        int current = resetQueue[i];
+        int x = current % columns;
+        int y = current / columns;
+        dirty[TileOf(current)] = 1;
+        unsettled[TileOf(current)] = 1;
+        stats.cellsReset++;
+        for (int direction = 0; direction < 8; ++direction)
+        {
+            int nx = x + stepX[direction];
+            int ny = y + stepY[direction];
+            if (nx < 0 || ny < 0 || nx >= columns || ny >= rows)
+            {
+                continue;
+            }
+            int neighbour = ny * columns + nx;
+            // The neighbour steps back the opposite way, (direction + 4) % 8, if its path runs through here
+            if (costs[neighbour] != unreachable && directions[neighbour] == (direction + 4) % 8)
+            {
+                costs[neighbour] = unreachable;
+                resetQueue.push_back(neighbour);
+            }
+        }
+    }
+}
+
+// Dirty a tile and the tiles around it, clamped to the grid
+void FlowField::MarkAround(int tile)
+{
+    int tx = tile % tileColumns;
+    int ty = tile / tileColumns;
+    for (int y = std::max(0, ty - 1); y <= std::min(tileRows - 1, ty + 1); ++y)
+    {
+        for (int x = std::max(0, tx - 1); x <= std::min(tileColumns - 1, tx + 1); ++x)
+        {
+            dirty[y * tileColumns + x] = 1;
+        }
+    }
+}
+
+// Find the tile a cell belongs to
+int FlowField::TileOf(int cell) const
+{
+    return (cell / columns / tileSize) * tileColumns + (cell % columns) / tileSize;
+}
+
+// Split a range into a few chunks per worker and wait for all of them
+template <typename Job>
+void FlowField::RunChunked(ThreadPool* pool, size_t count, const Job& job)
+{
+    if (pool == nullptr || count < 2)
+    {
+        job(0, count);
+        return;
+    }
+    size_t chunks = std::min(count, (size_t)pool->GetThreadCount() * chunksPerThread);
+    size_t chunkSize = (count + chunks - 1) / chunks;
+    for (size_t first = 0; first < count; first += chunkSize)
+    {
+        size_t last = std::min(count, first + chunkSize);
+        pool->Submit([&job, first, last] { job(first, last); });
+    }
+    pool->WaitIdle();
+}
+
+// Check if a cell is blocked
+bool FlowField::IsBlocked(int x, int y) const
+{
+    return blocked[y * columns + x] != 0;
+}
+
+// Get a cell's path cost to the goal, or unreachable
+uint32_t FlowField::GetCost(int x, int y) const
+{
+    return costs[y * columns + x];
+}
+
+// Get the whole integration field, row by row
+const std::vector<uint32_t>& FlowField::GetCosts() const
+{
+    return costs;
+}
+
+// Get the whole direction field, row by row
+const std::vector<uint8_t>& FlowField::GetDirections() const
+{
+    return directions;
+}
+
+// Get the number of cell columns
+int FlowField::GetColumns() const
+{
+    return columns;
+}
+
+// Get the number of cell rows
+int FlowField::GetRows() const
+{
+    return rows;
+}
+
+// Get the width of one cell in pixels
+float FlowField::GetCellSize() const
+{
+    return cellSize;
+}
+
+// Get the counters for the last Build or Update
+const FlowFieldStats& FlowField::GetStats() const
+{
+    return stats;
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include "raylib.h"
+#include "ThreadPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Work done by the most recent Build or Update
+struct FlowFieldStats
+{
+    uint32_t passes;       // Rounds over the four tile colours until no tile changed
+    uint32_t tilesSolved;  // Tile relaxations run, a tile can be solved once per pass
+    uint32_t cellsReset;   // Cells whose cost was thrown away because an obstacle cut their path
+    float integrateMs;     // Resetting costs and relaxing tiles
+    float directionMs;     // Recomputing directions around the solved tiles
+};
+
+// Grid flow field leading every open cell to one goal, for moving many tanks to the same place
+// The integration field holds each cell's path cost to the goal, 10 per straight step and 14 per
+// diagonal one, with no corner cutting past blocked cells. The direction field stores the step
+// towards the cheapest neighbour, so following it from any cell walks a shortest path and a tank
+// samples it with a single lookup.
+// Costs are solved in square tiles. Tiles are coloured by the parity of their column and row, so
+// two tiles of one colour never touch and every tile of a colour can be solved on its own thread.
+// A tile runs Dijkstra inside itself, seeded from the costs along its neighbours' edges, and the
+// tiles across any side whose costs changed are solved again. Obstacle changes only reset the cells
+// whose path ran through them, found by walking the direction field backwards, so an Update touches
+// the affected tiles only.
+class FlowField
+{
+public:
+    static const int tileSize = 32;
+    static const uint32_t unreachable = UINT32_MAX;
+
+    // Covers width x height with square cells, all open, and the goal in the first cell
+    FlowField(float width, float height, float cellSize);
+
+    // Opens or blocks every cell a rectangle overlaps, taking effect on the next Update
+    void SetBlocked(Rectangle area, bool blocked);
+
+    // Moves the goal to the cell containing a position, so the next Update rebuilds everything
+    void SetGoal(Vector2 position);
+
+    // Solves every tile from scratch, in parallel on the pool or on the calling thread when it is null
+    void Build(ThreadPool* pool);
+
+    // Applies the obstacle changes since the last Build or Update, or rebuilds if the goal moved
+    void Update(ThreadPool* pool);
+
+    // Single-threaded Dijkstra over the whole grid, the reference the tiled solver is checked against
+    void BuildSerial();
+
+    // Unit direction to move in from a position, or zero at the goal, in a blocked cell or where the goal cannot be reached
+    Vector2 Sample(Vector2 position) const;
+
+    bool IsBlocked(int x, int y) const;
+    uint32_t GetCost(int x, int y) const;
+    const std::vector<uint32_t>& GetCosts() const;
+    const std::vector<uint8_t>& GetDirections() const;
+    int GetColumns() const;
+    int GetRows() const;
+    float GetCellSize() const;
+    const FlowFieldStats& GetStats() const;
+
+private:
+    // Checks a step from a cell in one of the eight directions stays on open cells without cutting a corner
+    bool CanStep(int x, int y, int direction) const;
+
+    // Lowers costs in one tile from its neighbours' edges, using heap as scratch
+    // Returns a mask of the step directions whose side of the tile had a cost change
+    uint8_t SolveTile(int tile, std::vector<uint64_t>& heap);
+
+    // Solves every dirty tile, colour by colour, until none are left
+    void RelaxDirtyTiles(ThreadPool* pool);
+
+    // Recomputes directions for every tile marked in touched and the tiles around them
+    void UpdateDirections(ThreadPool* pool);
+
+    // Resets a cell and every cell whose direction chain leads through it
+    void ResetPathsThrough(int cell);
+
+    // Marks a tile and its eight neighbours as needing a solve
+    void MarkAround(int tile);
+
+    int TileOf(int cell) const;
+
+    // Runs job(first, last) over [0, count) in chunks on the pool, or in one go without it
+    template <typename Job>
+    void RunChunked(ThreadPool* pool, size_t count, const Job& job);
+
+    float cellSize;
+    float inverseCellSize;
+    int columns, rows;
+    int tileColumns, tileRows;
+    int goal;
+    bool goalChanged;
+    std::vector<uint8_t> blocked;
+    std::vector<uint32_t> costs;
+    std::vector<uint8_t> directions;    // Index into the eight step directions, or noDirection
+    std::vector<uint8_t> dirty;         // Per tile, needs solving on the current pass
+    std::vector<uint8_t> edgeChanged;   // Per tile SolveTile mask, written only by the job solving it
+    std::vector<uint8_t> unsettled;     // Per tile, holds cells reset or opened since it was last solved
+    std::vector<uint8_t> touched;       // Per tile, solved since the directions were last updated
+    std::vector<int> changedCells;      // Cells SetBlocked flipped since the last Update
+    std::vector<int> tileList;          // Scratch list of tiles for one colour or the direction pass
+    std::vector<int> resetQueue;        // Scratch for ResetPathsThrough
+    FlowFieldStats stats;
+};
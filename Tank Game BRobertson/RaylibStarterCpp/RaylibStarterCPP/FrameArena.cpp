@@ -0,0 +1,99 @@
+#include "FrameArena.h"
+#include "AllocationCounter.h"
+
+// Constructor allocating the main block once, an arena whose block could not be allocated starts empty
+// and serves the first tick from overflow blocks
+FrameArena::FrameArena(size_t capacity)
+    : block(static_cast<unsigned char*>(AllocationCounter::Allocate(capacity))), capacity(capacity), offset(0), overflowBytes(0), peak(0), overflows(0)
+{
+    if (block == nullptr)
+    {
+        this->capacity = 0;
+    }
+    overflowBlocks.reserve(16);
+}
+
+// Free the main block and any overflow blocks
+FrameArena::~FrameArena()
+{
+    Reset();
+    AllocationCounter::Free(block);
+}
+
+// Bump allocate from the main block, falling back to a heap block when it is full
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+    size_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+    if (aligned + size <= capacity)
+    {
+        offset = aligned + size;
+        return block + aligned;
+    }
+
+    // Over-allocate so the pointer can be aligned inside the block
+    void* overflow = AllocationCounter::Allocate(size + alignment);
+    if (overflow == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    overflowBlocks.push_back(overflow);
+    overflowBytes += size + alignment;
+    uintptr_t address = (reinterpret_cast<uintptr_t>(overflow) + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+    return reinterpret_cast<void*>(address);
+}
+
+// Drop every allocation, growing the main block if the tick spilled into overflow blocks
+void FrameArena::Reset()
+{
+    size_t used = GetUsed();
+    if (used > peak)
+    {
+        peak = used;
+    }
+
+    if (!overflowBlocks.empty())
+    {
+        for (void* overflow : overflowBlocks)
+        {
+            AllocationCounter::Free(overflow);
+        }
+        overflowBlocks.clear();
+        overflows++;
+
+        // Without room for the larger block the arena runs empty and tries again after the next spill
+        AllocationCounter::Free(block);
+        capacity = peak + peak / 2;
+        block = static_cast<unsigned char*>(AllocationCounter::Allocate(capacity));
+        if (block == nullptr)
+        {
+            capacity = 0;
+        }
+    }
+
+    offset = 0;
+    overflowBytes = 0;
+}
+
+// Get the bytes used this tick, including overflow blocks
+size_t FrameArena::GetUsed() const
+{
+    return offset + overflowBytes;
+}
+
+// Get the size of the main block
+size_t FrameArena::GetCapacity() const
+{
+    return capacity;
+}
+
+// Get the largest number of bytes any tick has used
+size_t FrameArena::GetPeak() const
+{
+    return peak;
+}
+
+// Get how many ticks needed overflow blocks
+size_t FrameArena::GetOverflows() const
+{
+    return overflows;
+}
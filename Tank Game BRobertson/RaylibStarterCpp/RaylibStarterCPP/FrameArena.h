@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// Linear allocator for data that only lives for one tick, such as collision pair lists and draw lists
+// Allocation bumps a pointer and Reset releases everything at once. If a tick needs more than the
+// capacity, overflow blocks come from the heap and the main block grows to the peak on the next Reset,
+// so steady-state ticks never touch the heap. Every block comes from AllocationCounter, so spills and
+// regrows show up in the same counters as operator new.
+class FrameArena
+{
+public:
+    explicit FrameArena(size_t capacity);
+    ~FrameArena();
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Returns uninitialised memory that stays valid until the next Reset, throws std::bad_alloc when the heap is exhausted
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    // Allocates uninitialised storage for count objects of type T
+    template <typename T>
+    T* AllocateArray(size_t count)
+    {
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // Releases every allocation made since the last reset
+    void Reset();
+
+    size_t GetUsed() const;        // Bytes handed out since the last reset
+    size_t GetCapacity() const;    // Size of the main block
+    size_t GetPeak() const;        // Most bytes used by any tick so far
+    size_t GetOverflows() const;   // Number of times a tick ran past the main block
+
+private:
+    unsigned char* block;
+    size_t capacity;
+    size_t offset;
+    size_t overflowBytes;
+    size_t peak;
+    size_t overflows;
+    std::vector<void*> overflowBlocks;
+};
+
+// Standard allocator adapter so containers can live in a FrameArena
+// Deallocation is a no-op, memory comes back when the arena is reset
+template <typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(FrameArena& arena) : arena(&arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t count)
+    {
+        return arena->AllocateArray<T>(count);
+    }
+
+    void deallocate(T*, size_t)
+    {
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+
+private:
+    template <typename U> friend class ArenaAllocator;
+    FrameArena* arena;
+};
+
+// A vector whose storage lives in a FrameArena, it must not outlive the arena's next Reset
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
@@ -0,0 +1,174 @@
+#include "GameClient.h"
+#include "Matrix3.h"
+#include <cmath>
+
+namespace
+{
+    // Room for every player's bullets when drawing, the view is rebuilt each frame so this never grows
+    const size_t viewPoolBytes = 2 * 1024 * 1024;
+}
+
+// Constructor opening the client's endpoint on the transport
+GameClient::GameClient(LoopbackTransport& transport, int serverEndpoint)
+    : transport(transport), endpoint(transport.CreateEndpoint()), serverEndpoint(serverEndpoint), playerId(-1), rejected(false), stats()
+{
+    decoded.tick = 0;
+}
+
+// Send a connect request, the server answers with a welcome or a reject
+void GameClient::Connect()
+{
+    writer.Reset();
+    writer.WriteBits(NET_CONNECT, 8);
+    const std::vector<uint8_t>& data = writer.GetData();
+    transport.Send(endpoint, serverEndpoint, data.data(), data.size());
+}
+
+// Input goes out every tick, so the acknowledgement rides along instead of having its own packet
+void GameClient::SendInput(const TankInput& input)
+{
+    writer.Reset();
+    writer.WriteBits(NET_INPUT, 8);
+    writer.WriteBits(received.IsEmpty() ? 0 : received.Latest().tick, 32);
+    writer.WriteBits(input.buttons, 8);
+    const std::vector<uint8_t>& data = writer.GetData();
+    transport.Send(endpoint, serverEndpoint, data.data(), data.size());
+}
+
+// Handle welcomes, rejects and snapshots
+void GameClient::ReceivePackets()
+{
+    while (transport.Receive(endpoint, packet))
+    {
+        BitReader reader(packet.data.data(), packet.data.size());
+        uint32_t type = reader.ReadBits(8);
+        if (type == NET_WELCOME)
+        {
+            playerId = static_cast<int>(reader.ReadBits(8));
+        }
+        else if (type == NET_REJECT)
+        {
+            rejected = true;
+        }
+        else if (type == NET_SNAPSHOT)
+        {
+            uint32_t tick = reader.ReadBits(32);
+            uint32_t baselineTick = reader.ReadBits(32);
+            const NetSnapshot* baseline = baselineTick != 0 ? FindSnapshot(baselineTick) : nullptr;
+            bool stale = !received.IsEmpty() && tick <= received.Latest().tick;
+            if (stale || (baselineTick != 0 && baseline == nullptr) || !DecodeSnapshot(reader, baseline, decoded))
+            {
+                stats.snapshotsDropped++;
+            }
+            else
+            {
+                decoded.tick = tick;
+                received.Push(decoded);
+                stats.snapshotsReceived++;
+                stats.snapshotBytes += packet.data.size();
+            }
+        }
+        transport.Recycle(packet);
+    }
+}
+
+// Check if the server has given this client a tank
+bool GameClient::IsConnected() const
+{
+    return playerId >= 0;
+}
+
+// Check if the server was full
+bool GameClient::IsRejected() const
+{
+    return rejected;
+}
+
+// Get the player index the server assigned
+int GameClient::GetPlayerId() const
+{
+    return playerId;
+}
+
+// Check if any snapshot has been decoded yet
+bool GameClient::HasSnapshot() const
+{
+    return !received.IsEmpty();
+}
+
+// Get the newest decoded snapshot
+const NetSnapshot& GameClient::GetSnapshot() const
+{
+    return received.Latest();
+}
+
+// Get the traffic received so far
+const NetClientStats& GameClient::GetStats() const
+{
+    return stats;
+}
+
+// Rebuild a Tank for each player from the snapshot and let Tank draw itself and its bullets
+// Tanks start facing -180 degrees with identity transforms, so the transforms are the rotation since then
+void GameClient::Draw(Sprite bodySprite, Sprite turretSprite, Sprite bulletSprite)
+{
+    if (received.IsEmpty())
+    {
+        return;
+    }
+    if (viewPool == nullptr)
+    {
+        viewPool = std::make_unique<MemoryPool>(viewPoolBytes);
+        view.reserve(NET_MAX_PLAYERS);
+    }
+
+    const NetSnapshot& snapshot = received.Latest();
+    while (view.size() < snapshot.tanks.size())
+    {
+        view.emplace_back(MathClasses::Vector3(0.0f, 0.0f, 0.0f), bodySprite, turretSprite, bulletSprite, *viewPool);
+    }
+
+    size_t bulletStart = 0;
+    for (size_t t = 0; t < snapshot.tanks.size(); ++t)
+    {
+        const NetTank& netTank = snapshot.tanks[t];
+        Tank& tank = view[t];
+
+        TankState state;
+        state.position = MathClasses::Vector3(DequantisePosition(netTank.x), DequantisePosition(netTank.y), 0.0f);
+        state.bodyRotation = DequantiseAngle(netTank.bodyAngle);
+        state.turretRotation = DequantiseAngle(netTank.turretAngle);
+        state.bodyTransform = Matrix3::MakeRotateZ((state.bodyRotation + 180.0f) * DEG2RAD);
+        state.turretTransform = Matrix3::MakeRotateZ(state.turretRotation * DEG2RAD);
+        tank.SetState(state);
+
+        // Bullet rotation is the direction of travel plus 90 degrees
+        BulletList& bullets = tank.GetBullets();
+        bullets.clear();
+        for (size_t i = 0; i < netTank.bulletCount; ++i)
+        {
+            const NetBullet& netBullet = snapshot.bullets[bulletStart + i];
+            float rotation = DequantiseAngle(netBullet.angle);
+            float heading = (rotation - 90.0f) * DEG2RAD;
+            bullets.emplace_back(MathClasses::Vector3(DequantisePosition(netBullet.x), DequantisePosition(netBullet.y), 0.0f),
+                MathClasses::Vector3(cosf(heading), sinf(heading), 0.0f), 0.0f, rotation, bulletSprite);
+        }
+        bulletStart += netTank.bulletCount;
+
+        tank.Draw();
+    }
+}
+
+// Search the received snapshots, newest first
+const NetSnapshot* GameClient::FindSnapshot(uint32_t snapshotTick) const
+{
+    for (int i = received.GetCount() - 1; i >= 0; --i)
+    {
+        const NetSnapshot& snapshot = received.Get(i);
+        if (snapshot.tick == snapshotTick)
+        {
+            return &snapshot;
+        }
+    }
+    return nullptr;
+}
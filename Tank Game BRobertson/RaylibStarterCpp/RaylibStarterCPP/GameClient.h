@@ -0,0 +1,77 @@
+#pragma once
+#include "BitStream.h"
+#include "GameServer.h"
+#include "LoopbackTransport.h"
+#include "NetSnapshot.h"
+#include "Pool.h"
+#include "RingBuffer.h"
+#include "Sprite.h"
+#include "Tank.h"
+#include "TankInput.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Traffic a client has received so far
+struct NetClientStats
+{
+    uint64_t snapshotsReceived;
+    uint64_t snapshotBytes;
+    uint64_t snapshotsDropped; // Out of date, or delta encoded against a baseline this client no longer holds
+};
+
+// Client side of the loopback game: sends input and acknowledgements, decodes snapshots
+// Decoded snapshots are kept for as long as the server keeps them, so any snapshot the client
+// acknowledged is still here when the server uses it as a baseline.
+class GameClient
+{
+public:
+    GameClient(LoopbackTransport& transport, int serverEndpoint);
+
+    // Asks the server for a tank, safe to repeat until IsConnected
+    void Connect();
+
+    // Sends this tick's input along with the newest snapshot tick received
+    void SendInput(const TankInput& input);
+
+    // Handles every packet waiting for this client
+    void ReceivePackets();
+
+    bool IsConnected() const;
+
+    // True once the server turned the client away
+    bool IsRejected() const;
+
+    // Player index the server assigned, -1 before the welcome arrives
+    int GetPlayerId() const;
+
+    bool HasSnapshot() const;
+
+    // Newest decoded world state, with positions and angles still quantised
+    const NetSnapshot& GetSnapshot() const;
+
+    const NetClientStats& GetStats() const;
+
+    // Draws every tank and bullet in the newest snapshot, the caller is responsible for BeginDrawing/EndDrawing
+    void Draw(Sprite bodySprite, Sprite turretSprite, Sprite bulletSprite);
+
+private:
+    // Finds a decoded snapshot by tick, or nullptr
+    const NetSnapshot* FindSnapshot(uint32_t snapshotTick) const;
+
+    LoopbackTransport& transport;
+    int endpoint;
+    int serverEndpoint;
+    int playerId;
+    bool rejected;
+
+    RingBuffer<NetSnapshot, GameServer::historyLength> received;
+    NetSnapshot decoded;
+    BitWriter writer;
+    NetPacket packet;
+    NetClientStats stats;
+
+    // Tanks rebuilt from the newest snapshot for drawing, only created once Draw is first called
+    std::unique_ptr<MemoryPool> viewPool;
+    std::vector<Tank> view;
+};
@@ -0,0 +1,537 @@
+#include "GameModes.h"
+#include "GameSetup.h"
+#include "AiArena.h"
+#include "AllocationCounter.h"
+#include "EntityInspector.h"
+#include "FlowField.h"
+#include "GameClient.h"
+#include "GameServer.h"
+#include "ImageCache.h"
+#include "Level.h"
+#include "PerfHud.h"
+#include "PhysicsWorld.h"
+#include "Profiler.h"
+#include "Replay.h"
+#include "RollbackSession.h"
+#include "ThreadPool.h"
+#include "WorldSnapshot.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace MathClasses;
+
+// Play the game with the keyboard, recording every tick so the session can be replayed
+// F5 saves the world to quicksave.tkws and F9 loads it back, restarting the recording from there
+// With usePhysics the tank body moves on the physics thread instead, and nothing is recorded
+int RunGame(const char* recordFile, const char* snapshotFile, const char* levelFile, bool usePhysics)
+{
+    InitWindow(screenWidth, screenHeight, "Tank Game - Bradley Robertson");
+
+    // Images decode on worker threads while the window keeps drawing, only the upload happens here
+    // Loose images are decoded once and then read back from the pixel cache on later launches
+    ThreadPool pool;
+    ImageCache imageCache("image_cache");
+    AssetLoader loader(pool, &imageCache);
+    GameSprites sprites;
+    double loadStart = GetTime();
+    RequestGameSprites(sprites, loader);
+
+    bool loaded = false;
+    while (!loaded)
+    {
+        loader.Update(4);
+        if (loader.IsFinished())
+        {
+            loaded = ResolveGameSprites(sprites, loader);
+        }
+
+        BeginDrawing();
+        ClearBackground(RAYWHITE);
+        DrawText(TextFormat("Loading assets %d%%", (int)(loader.GetProgress() * 100.0f)), 10, 10, 20, DARKGRAY);
+        EndDrawing();
+    }
+    printf("Assets loaded in %.1f ms\n", (GetTime() - loadStart) * 1000.0);
+
+    SimulationConfig config = MakeDefaultConfig(sprites);
+
+    // A compiled level only has its header read here, the rest streams in a few chunks per frame
+    LevelStream levelStream;
+    if (levelFile != nullptr)
+    {
+        if (levelStream.Open(levelFile))
+        {
+            const LevelFileHeader& header = levelStream.GetHeader();
+            config.arenaWidth = header.arenaWidth;
+            config.arenaHeight = header.arenaHeight;
+            config.tankStartX = header.spawnX;
+            config.tankStartY = header.spawnY;
+        }
+        else
+        {
+            printf("Could not load level %s\n", levelFile);
+        }
+    }
+
+    Simulation simulation(config, sprites.body, sprites.turret, sprites.bullet);
+    if (levelFile == nullptr)
+    {
+        // Box position and size
+        simulation.GetLevel().targets.push_back({ 1000, 100, 140, 140 });
+    }
+
+    // Warm start from a saved world instead of the default arena
+    if (snapshotFile != nullptr)
+    {
+        SnapshotView snapshot;
+        if (!snapshot.Open(snapshotFile) || !simulation.Restore(snapshot))
+        {
+            printf("Could not load snapshot %s\n", snapshotFile);
+        }
+    }
+
+    ReplayRecorder recorder(simulation);
+    PerfHud perfHud(targetFps);
+
+    // Started once the level has finished streaming, so every obstacle exists when bodies are made
+    // Replays cannot reproduce the physics thread's timing, so physics sessions are not recorded
+    std::unique_ptr<PhysicsWorld> physics;
+    std::vector<PhysicsBodyState> physicsStates;
+    if (usePhysics)
+    {
+        physics = std::make_unique<PhysicsWorld>();
+        physicsStates.reserve(PHYSAC_MAX_BODIES);
+        printf("Physics mode: this session will not be recorded\n");
+    }
+    EntityInspector inspector;
+
+    // Frames after warm-up that still allocated from the heap
+    int frameCount = 0;
+    int allocatingFrames = 0;
+
+    SetTargetFPS(targetFps);
+
+    while (!WindowShouldClose())
+    {
+        PROFILE_FRAME();
+        PROFILE_SCOPE("Frame");
+
+        uint64_t allocationsBefore = AllocationCounter::GetAllocations();
+
+        if (IsKeyPressed(KEY_F3))
+        {
+            perfHud.Toggle();
+        }
+        if (IsKeyPressed(KEY_F4))
+        {
+            inspector.Toggle();
+        }
+        if (IsKeyPressed(KEY_F5))
+        {
+            SaveSnapshot(simulation, "quicksave.tkws");
+        }
+        if (IsKeyPressed(KEY_F9))
+        {
+            SnapshotView snapshot;
+            if (snapshot.Open("quicksave.tkws") && simulation.Restore(snapshot))
+            {
+                recorder.Restart(simulation);
+                if (physics != nullptr && physics->IsRunning())
+                {
+                    const Tank& tank = simulation.GetTank();
+                    physics->SetPose(0, { tank.GetPosition().x, tank.GetPosition().y }, tank.GetBodyRotation());
+                }
+            }
+        }
+
+        if (!levelStream.IsFinished())
+        {
+            PROFILE_SCOPE("Level::Stream");
+            if (!levelStream.Pump(simulation.GetLevel(), 256 * 1024))
+            {
+                // Play on with the chunks that did load rather than waiting on a file that cannot finish
+                printf("Level %s is truncated or corrupt, keeping the part that loaded\n", levelFile);
+                levelStream.Close();
+            }
+
+            // The recording starts once the whole level is part of the world
+            if (levelStream.IsFinished())
+            {
+                recorder.Restart(simulation);
+            }
+        }
+
+        float deltaTime = GetFrameTime();
+        TankInput input = TankInput::FromKeyboard();
+
+        if (physics != nullptr)
+        {
+            if (!physics->IsRunning() && levelStream.IsFinished())
+            {
+                StartTankPhysics(*physics, simulation);
+            }
+            PhysicsDrive drive = TakeTankDrive(input);
+            if (physics->IsRunning())
+            {
+                physics->SetDrive(0, drive);
+            }
+        }
+
+        simulation.Step(input, deltaTime);
+
+        if (physics != nullptr && physics->IsRunning())
+        {
+            physics->Read(physicsStates);
+            ApplyTankPhysics(simulation.GetTank(), physicsStates[0]);
+        }
+        if (physics == nullptr)
+        {
+            recorder.Record(input, deltaTime, simulation.Checksum());
+        }
+
+        BeginDrawing();
+
+        ClearBackground(RAYWHITE);
+
+        simulation.Draw();
+
+        if (!levelStream.IsFinished())
+        {
+            DrawText(TextFormat("Loading level %d%%", (int)(levelStream.GetProgress() * 100.0f)), 10, 10, 20, DARKGRAY);
+        }
+
+        const Level& level = simulation.GetLevel();
+        PerfCounts counts = { 1, (int)simulation.GetTank().GetBullets().size(), (int)level.targets.size(), (int)level.walls.size() };
+        perfHud.RecordFrame(deltaTime * 1000.0f, simulation.GetTimings(), counts, AllocationCounter::GetAllocations(),
+            simulation.GetEntityPool().GetStats());
+        perfHud.Draw(screenWidth - 310.0f, 10.0f);
+        inspector.Draw(simulation, { 10.0f, 40.0f, 380.0f, 420.0f });
+
+        {
+            PROFILE_SCOPE("EndDrawing");
+            EndDrawing();
+        }
+
+        if (++frameCount > 120 && AllocationCounter::GetAllocations() != allocationsBefore)
+        {
+            allocatingFrames++;
+        }
+    }
+
+    printf("%d of %d frames allocated from the heap after warm-up\n", allocatingFrames, frameCount);
+
+#if defined(TANK_PROFILER)
+    // Open in chrome://tracing or ui.perfetto.dev to inspect frame spikes
+    Profiler::ExportChromeTrace("frame_trace.json");
+#endif
+
+    if (physics == nullptr && !recorder.Save(recordFile))
+    {
+        printf("Failed to save replay to %s\n", recordFile);
+    }
+
+    // Unloading the textures
+    UnloadGameSprites(sprites);
+
+    CloseWindow();
+
+    system("pause");
+
+    return 0;
+}
+
+// Watch a recording: Right arrow fast-forwards, Left arrow seeks back five seconds, Home restarts, P pauses
+int RunReplay(const char* replayFile)
+{
+    ReplayPlayer player;
+    if (!player.Load(replayFile))
+    {
+        printf("Could not load replay %s\n", replayFile);
+        return 1;
+    }
+
+    const SimulationConfig& config = player.GetConfig();
+    InitWindow((int)config.arenaWidth, (int)config.arenaHeight, "Tank Game - Replay");
+
+    ThreadPool pool;
+    ImageCache imageCache("image_cache");
+    AssetLoader loader(pool, &imageCache);
+    GameSprites sprites;
+    LoadGameSprites(sprites, loader);
+
+    Simulation simulation(config, sprites.body, sprites.turret, sprites.bullet);
+    player.Rewind(simulation);
+    bool paused = false;
+
+    SetTargetFPS(targetFps);
+
+    while (!WindowShouldClose())
+    {
+        if (IsKeyPressed(KEY_P))
+        {
+            paused = !paused;
+        }
+        if (IsKeyPressed(KEY_HOME))
+        {
+            player.Seek(simulation, 0);
+        }
+        if (IsKeyPressed(KEY_LEFT))
+        {
+            uint32_t cursor = player.GetCursor();
+            player.Seek(simulation, cursor > 600 ? cursor - 600 : 0);
+        }
+
+        if (IsKeyDown(KEY_RIGHT))
+        {
+            player.FastForward(simulation, 16);
+        }
+        else if (!paused)
+        {
+            player.Step(simulation);
+        }
+
+        BeginDrawing();
+
+        ClearBackground(RAYWHITE);
+
+        simulation.Draw();
+
+        DrawText(TextFormat("Tick %u / %u", player.GetCursor(), player.GetTickCount()), 10, 10, 20, DARKGRAY);
+        if (player.GetFirstMismatch() >= 0)
+        {
+            DrawText(TextFormat("Desync at tick %lld", (long long)player.GetFirstMismatch()), 10, 35, 20, RED);
+        }
+
+        EndDrawing();
+    }
+
+    UnloadGameSprites(sprites);
+
+    CloseWindow();
+
+    return 0;
+}
+
+// Play through an in-process server: keyboard input goes out as packets, and what is drawn is
+// decoded from the server's snapshots. Bots connect alongside and drive scripted inputs.
+// The server steps at a fixed 120 Hz tick, as in --bench-net, whatever the frame rate.
+int RunLoopbackGame(int botCount)
+{
+    InitWindow(screenWidth, screenHeight, "Tank Game - Loopback");
+
+    ThreadPool pool;
+    ImageCache imageCache("image_cache");
+    AssetLoader loader(pool, &imageCache);
+    GameSprites sprites;
+    LoadGameSprites(sprites, loader);
+
+    LoopbackTransport transport;
+    GameServer server(transport, MakeDefaultConfig(sprites), sprites.body, sprites.turret, sprites.bullet);
+    server.GetLevel().targets.push_back({ 1000, 100, 140, 140 });
+
+    GameClient client(transport, server.GetEndpoint());
+    std::vector<std::unique_ptr<GameClient>> bots;
+    for (int i = 0; i < botCount && i + 1 < NET_MAX_PLAYERS; ++i)
+    {
+        bots.push_back(std::make_unique<GameClient>(transport, server.GetEndpoint()));
+    }
+
+    // The server runs whole 120 Hz ticks however long frames take, catching up on a slow frame but
+    // dropping time past a few ticks so a long stall does not turn into a burst of catch-up ticks
+    const float tickSeconds = 1.0f / 120.0f;
+    const int maxTicksPerFrame = 4;
+    float unsimulated = 0.0f;
+
+    SetTargetFPS(targetFps);
+
+    while (!WindowShouldClose())
+    {
+        unsimulated = std::min(unsimulated + GetFrameTime(), tickSeconds * maxTicksPerFrame);
+
+        client.ReceivePackets();
+        if (client.IsConnected())
+        {
+            client.SendInput(TankInput::FromKeyboard());
+        }
+        else
+        {
+            client.Connect();
+        }
+        for (size_t i = 0; i < bots.size(); ++i)
+        {
+            bots[i]->ReceivePackets();
+            if (bots[i]->IsConnected())
+            {
+                bots[i]->SendInput(MakeBotInput((int)i + 1, (int)server.GetTick()));
+            }
+            else if (!bots[i]->IsRejected())
+            {
+                bots[i]->Connect();
+            }
+        }
+
+        while (unsimulated >= tickSeconds)
+        {
+            server.Tick(tickSeconds);
+            unsimulated -= tickSeconds;
+        }
+
+        BeginDrawing();
+
+        ClearBackground(RAYWHITE);
+
+        for (const Rectangle& target : server.GetLevel().targets)
+        {
+            DrawRectangleRec(target, GREEN);
+        }
+        client.Draw(sprites.body, sprites.turret, sprites.bullet);
+
+        const NetServerStats& stats = server.GetStats();
+        const NetClientStats& received = client.GetStats();
+        DrawText(TextFormat("Players %d  tick %u  snapshot %u B  server %.2f ms", server.GetPlayerCount(), server.GetTick(),
+            server.GetPlayerCount() > 0 ? stats.bytesSent / server.GetPlayerCount() : 0u, stats.receiveMs + stats.simulateMs + stats.snapshotMs), 10, 10, 20, DARKGRAY);
+        DrawText(TextFormat("Received %llu snapshots, %llu dropped", (unsigned long long)received.snapshotsReceived,
+            (unsigned long long)received.snapshotsDropped), 10, 35, 20, DARKGRAY);
+
+        EndDrawing();
+    }
+
+    UnloadGameSprites(sprites);
+
+    CloseWindow();
+
+    return 0;
+}
+
+// Play against a scripted peer over a loopback link with the given one-way latency, rolling back on late input
+int RunRollbackGame(int latencyMs)
+{
+    InitWindow(screenWidth, screenHeight, "Tank Game - Rollback");
+
+    ThreadPool pool;
+    ImageCache imageCache("image_cache");
+    AssetLoader loader(pool, &imageCache);
+    GameSprites sprites;
+    LoadGameSprites(sprites, loader);
+
+    const float tickSeconds = 1.0f / 120.0f;
+    SimulationConfig config = MakeDefaultConfig(sprites);
+    LoopbackTransport transport;
+    transport.SetLatency(LatencyToTicks(latencyMs));
+    int localEndpoint = transport.CreateEndpoint();
+    int remoteEndpoint = transport.CreateEndpoint();
+
+    RollbackWorld localWorld(config, 2, sprites.body, sprites.turret, sprites.bullet);
+    RollbackWorld remoteWorld(config, 2, sprites.body, sprites.turret, sprites.bullet);
+    localWorld.GetLevel().targets.push_back({ 1000, 100, 140, 140 });
+    remoteWorld.GetLevel().targets.push_back({ 1000, 100, 140, 140 });
+    RollbackSession local(localWorld, transport, localEndpoint, remoteEndpoint, 0, tickSeconds);
+    RollbackSession remote(remoteWorld, transport, remoteEndpoint, localEndpoint, 1, tickSeconds);
+
+    SetTargetFPS(targetFps);
+
+    while (!WindowShouldClose())
+    {
+        local.AdvanceFrame(TankInput::FromKeyboard());
+        remote.AdvanceFrame(MakeBotInput(1, (int)remoteWorld.GetTick()));
+        transport.AdvanceClock();
+
+        BeginDrawing();
+
+        ClearBackground(RAYWHITE);
+
+        localWorld.Draw();
+
+        const RollbackStats& stats = local.GetStats();
+        DrawText(TextFormat("Latency %d ms  tick %u  confirmed %u", latencyMs, localWorld.GetTick(), local.GetConfirmedTick()), 10, 10, 20, DARKGRAY);
+        DrawText(TextFormat("Rollbacks %llu (max %u ticks)  stalls %llu  frame %.3f ms", (unsigned long long)stats.rollbacks, stats.maxRollback,
+            (unsigned long long)stats.stalls, stats.lastFrameMs), 10, 35, 20, DARKGRAY);
+
+        EndDrawing();
+    }
+
+    UnloadGameSprites(sprites);
+
+    CloseWindow();
+
+    return 0;
+}
+
+// Watch two teams of AI tanks fight it out, T switches between grid and brute-force targeting
+// Tanks with nothing in range follow a flow field around the walls to the centre, clicking moves a wall
+int RunAiGame(int tankCount)
+{
+    InitWindow(screenWidth, screenHeight, "Tank Game - AI");
+
+    ThreadPool pool;
+    ImageCache imageCache("image_cache");
+    AssetLoader loader(pool, &imageCache);
+    GameSprites sprites;
+    LoadGameSprites(sprites, loader);
+
+    const float tickSeconds = 1.0f / 120.0f;
+    AiArena arena((float)screenWidth, (float)screenHeight, sprites.body, sprites.turret, sprites.bullet, tankCount);
+    arena.SpawnLattice(tankCount);
+
+    std::vector<Rectangle> walls = { { 300, 200, 40, 320 }, { 940, 200, 40, 320 }, { 500, 140, 280, 40 }, { 500, 540, 280, 40 } };
+    FlowField flowField((float)screenWidth, (float)screenHeight, 16.0f);
+    for (const Rectangle& wall : walls)
+    {
+        flowField.SetBlocked(wall, true);
+    }
+    flowField.SetGoal({ screenWidth / 2.0f, screenHeight / 2.0f });
+    flowField.Update(&pool);
+    arena.SetFlowField(&flowField);
+
+    SetTargetFPS(targetFps);
+
+    while (!WindowShouldClose())
+    {
+        if (IsKeyPressed(KEY_T))
+        {
+            arena.SetTargeting(arena.GetTargeting() == AiTargeting::Grid ? AiTargeting::BruteForce : AiTargeting::Grid);
+        }
+        if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+        {
+            Vector2 mouse = GetMousePosition();
+            flowField.SetBlocked(walls[0], false);
+            walls[0].x = mouse.x - walls[0].width / 2.0f;
+            walls[0].y = mouse.y - walls[0].height / 2.0f;
+            for (const Rectangle& wall : walls)
+            {
+                flowField.SetBlocked(wall, true);
+            }
+        }
+        flowField.Update(&pool);
+
+        arena.Step(tickSeconds);
+
+        BeginDrawing();
+
+        ClearBackground(RAYWHITE);
+
+        for (const Rectangle& wall : walls)
+        {
+            DrawRectangleRec(wall, DARKGRAY);
+        }
+        arena.Draw();
+
+        const AiTimings& timings = arena.GetTimings();
+        DrawText(TextFormat("%d tanks  %d bullets  %d hits  %d splashed  targeting: %s (T to switch)", (int)arena.GetTankCount(), (int)arena.GetBulletCount(),
+            (int)arena.GetHitCount(), (int)arena.GetSplashCount(),
+            arena.GetTargeting() == AiTargeting::Grid ? "grid" : "brute force"), 10, 10, 20, DARKGRAY);
+        DrawText(TextFormat("gather %.3f  target %.3f  aim %.3f  steer %.3f  collide %.3f  cull %.3f ms", timings.gatherMs, timings.targetMs,
+            timings.aimMs, timings.steerMs, timings.collideMs, timings.cullMs), 10, 35, 20, DARKGRAY);
+        const FlowFieldStats& flowStats = flowField.GetStats();
+        DrawText(TextFormat("flow field update %.3f ms, %u tiles", flowStats.integrateMs + flowStats.directionMs, flowStats.tilesSolved), 10, 60, 20, DARKGRAY);
+
+        EndDrawing();
+    }
+
+    UnloadGameSprites(sprites);
+
+    CloseWindow();
+
+    return 0;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+// Windowed ways to run the game, each returning the process exit code
+
+// Plays the game with the keyboard, recording every tick so the session can be replayed
+// snapshotFile and levelFile may be null; with usePhysics the tank body moves on the physics thread
+int RunGame(const char* recordFile, const char* snapshotFile, const char* levelFile, bool usePhysics);
+
+// Watches a recording with seeking and pausing
+int RunReplay(const char* replayFile);
+
+// Plays through an in-process server alongside botCount scripted bots
+int RunLoopbackGame(int botCount);
+
+// Plays against a scripted peer over a loopback link with the given one-way latency
+int RunRollbackGame(int latencyMs);
+
+// Watches two teams of AI tanks fight it out
+int RunAiGame(int tankCount);
@@ -0,0 +1,284 @@
+#include "GameServer.h"
+#include "Profiler.h"
+
+namespace
+{
+    // Sized for every player holding a few hundred bullets in flight
+    const size_t bulletPoolBytes = 8 * 1024 * 1024;
+}
+
+// Constructor for a connected player's state
+GameServer::Player::Player(int endpoint, uint8_t id, Tank tank)
+    : endpoint(endpoint), id(id), tank(std::move(tank)), nextBulletId(1), ackedTick(0)
+{
+    bulletIds.reserve(256);
+}
+
+// Constructor opening the server's endpoint on the transport
+GameServer::GameServer(LoopbackTransport& transport, const SimulationConfig& config, Sprite bodySprite, Sprite turretSprite, Sprite bulletSprite)
+    : transport(transport), endpoint(transport.CreateEndpoint()), config(config),
+    bodySprite(bodySprite), turretSprite(turretSprite), bulletSprite(bulletSprite),
+    bulletPool(bulletPoolBytes), tick(0), encodedCount(0), stats()
+{
+    // Reserved so a client connecting mid-game never reallocates the player list
+    players.reserve(NET_MAX_PLAYERS);
+    current.tick = 0;
+}
+
+// Receive, simulate, then snapshot, so every client sees the effect of the inputs it sent before this tick
+void GameServer::Tick(float deltaTime)
+{
+    PROFILE_SCOPE("Server::Tick");
+    stats = NetServerStats{};
+    {
+        ScopedTimer timer(stats.receiveMs);
+        ReceivePackets();
+    }
+    {
+        ScopedTimer timer(stats.simulateMs);
+        Simulate(deltaTime);
+    }
+    tick++;
+    {
+        ScopedTimer timer(stats.snapshotMs);
+        CaptureSnapshot();
+        SendSnapshots();
+    }
+}
+
+// Handle connects and inputs, anything malformed is ignored
+void GameServer::ReceivePackets()
+{
+    while (transport.Receive(endpoint, packet))
+    {
+        BitReader reader(packet.data.data(), packet.data.size());
+        uint32_t type = reader.ReadBits(8);
+        if (type == NET_CONNECT)
+        {
+            AddPlayer(packet.from);
+        }
+        else if (type == NET_INPUT)
+        {
+            uint32_t ack = reader.ReadBits(32);
+            uint8_t buttons = static_cast<uint8_t>(reader.ReadBits(8));
+            if (!reader.HasOverflowed())
+            {
+                for (Player& player : players)
+                {
+                    if (player.endpoint == packet.from)
+                    {
+                        player.input.buttons = buttons;
+                        // Inputs can arrive after a newer one was lost, so the acknowledgement only moves forward
+                        if (ack > player.ackedTick && ack <= tick)
+                        {
+                            player.ackedTick = ack;
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+        transport.Recycle(packet);
+    }
+}
+
+// Give a new client a tank at the next spawn point, or welcome it again if its first welcome was lost
+void GameServer::AddPlayer(int client)
+{
+    for (const Player& player : players)
+    {
+        if (player.endpoint == client)
+        {
+            replyWriter.Reset();
+            replyWriter.WriteBits(NET_WELCOME, 8);
+            replyWriter.WriteBits(player.id, 8);
+            const std::vector<uint8_t>& reply = replyWriter.GetData();
+            transport.Send(endpoint, client, reply.data(), reply.size());
+            return;
+        }
+    }
+
+    replyWriter.Reset();
+    if (players.size() >= NET_MAX_PLAYERS)
+    {
+        replyWriter.WriteBits(NET_REJECT, 8);
+        const std::vector<uint8_t>& reply = replyWriter.GetData();
+        transport.Send(endpoint, client, reply.data(), reply.size());
+        return;
+    }
+
+    // Spawn points first, then a grid across the arena once they run out
+    uint8_t id = static_cast<uint8_t>(players.size());
+    MathClasses::Vector3 position(config.tankStartX, config.tankStartY, 0.0f);
+    if (id < level.spawnPoints.size())
+    {
+        position = MathClasses::Vector3(level.spawnPoints[id].x, level.spawnPoints[id].y, 0.0f);
+    }
+    else if (id > 0)
+    {
+        const int columns = 8;
+        float cellWidth = config.arenaWidth / columns;
+        float cellHeight = config.arenaHeight / (NET_MAX_PLAYERS / columns);
+        position = MathClasses::Vector3((id % columns + 0.5f) * cellWidth, (id / columns + 0.5f) * cellHeight, 0.0f);
+    }
+
+    players.emplace_back(client, id, Tank(position, bodySprite, turretSprite, bulletSprite, bulletPool));
+
+    replyWriter.WriteBits(NET_WELCOME, 8);
+    replyWriter.WriteBits(id, 8);
+    const std::vector<uint8_t>& reply = replyWriter.GetData();
+    transport.Send(endpoint, client, reply.data(), reply.size());
+}
+
+// Step every tank, number the bullets it fired, then cull bullets the same way Simulation does
+// The id list is compacted alongside the bullet list so each surviving bullet keeps its id
+void GameServer::Simulate(float deltaTime)
+{
+    for (Player& player : players)
+    {
+        BulletList& bullets = player.tank.GetBullets();
+        size_t before = bullets.size();
+        player.tank.Update(player.input, deltaTime);
+        for (size_t i = before; i < bullets.size(); ++i)
+        {
+            player.bulletIds.push_back(player.nextBulletId++);
+        }
+
+        size_t kept = 0;
+        for (size_t i = 0; i < bullets.size(); ++i)
+        {
+            const Bullet& bullet = bullets[i];
+            if (bullet.IsOutOfBounds(config.arenaWidth, config.arenaHeight) || bullet.HitsAny(level.targets) || bullet.HitsAny(level.walls))
+            {
+                continue;
+            }
+            if (kept != i)
+            {
+                bullets[kept] = bullets[i];
+                player.bulletIds[kept] = player.bulletIds[i];
+            }
+            kept++;
+        }
+        bullets.erase(bullets.begin() + kept, bullets.end());
+        player.bulletIds.resize(kept);
+    }
+}
+
+// Quantise the world into the current snapshot and keep a copy for future baselines
+void GameServer::CaptureSnapshot()
+{
+    current.tick = tick;
+    current.tanks.clear();
+    current.bullets.clear();
+    for (const Player& player : players)
+    {
+        const Tank& tank = player.tank;
+        const BulletList& bullets = tank.GetBullets();
+
+        NetTank netTank;
+        netTank.player = player.id;
+        netTank.x = QuantisePosition(tank.GetPosition().x);
+        netTank.y = QuantisePosition(tank.GetPosition().y);
+        netTank.bodyAngle = QuantiseAngle(tank.GetBodyRotation());
+        netTank.turretAngle = QuantiseAngle(tank.GetTurretRotation());
+        netTank.bulletCount = static_cast<uint16_t>(bullets.size());
+        current.tanks.push_back(netTank);
+
+        for (size_t i = 0; i < bullets.size(); ++i)
+        {
+            NetBullet netBullet;
+            netBullet.id = player.bulletIds[i];
+            netBullet.x = QuantisePosition(bullets[i].GetPosition().x);
+            netBullet.y = QuantisePosition(bullets[i].GetPosition().y);
+            netBullet.angle = QuantiseAngle(bullets[i].GetRotation());
+            current.bullets.push_back(netBullet);
+        }
+    }
+    history.Push(current);
+}
+
+// Encode once per distinct baseline, with no loss every client acknowledges the same tick and shares one packet
+void GameServer::SendSnapshots()
+{
+    encodedCount = 0;
+    for (const Player& player : players)
+    {
+        const NetSnapshot* baseline = player.ackedTick != 0 ? FindSnapshot(player.ackedTick) : nullptr;
+        uint32_t baselineTick = baseline != nullptr ? baseline->tick : 0;
+
+        EncodedSnapshot* packetToSend = nullptr;
+        for (int i = 0; i < encodedCount; ++i)
+        {
+            if (encoded[i].baselineTick == baselineTick)
+            {
+                packetToSend = &encoded[i];
+                break;
+            }
+        }
+
+        if (packetToSend == nullptr)
+        {
+            if (encodedCount == static_cast<int>(encoded.size()))
+            {
+                encoded.emplace_back();
+            }
+            packetToSend = &encoded[encodedCount++];
+            packetToSend->baselineTick = baselineTick;
+            BitWriter& writer = packetToSend->writer;
+            writer.Reset();
+            writer.WriteBits(NET_SNAPSHOT, 8);
+            writer.WriteBits(tick, 32);
+            writer.WriteBits(baselineTick, 32);
+            EncodeSnapshot(current, baseline, writer);
+        }
+
+        const std::vector<uint8_t>& data = packetToSend->writer.GetData();
+        transport.Send(endpoint, player.endpoint, data.data(), data.size());
+        stats.bytesSent += static_cast<uint32_t>(data.size());
+    }
+    stats.packetsEncoded = encodedCount;
+}
+
+// Search the history, newest first since that is what clients usually acknowledge
+const NetSnapshot* GameServer::FindSnapshot(uint32_t snapshotTick) const
+{
+    for (int i = history.GetCount() - 1; i >= 0; --i)
+    {
+        const NetSnapshot& snapshot = history.Get(i);
+        if (snapshot.tick == snapshotTick)
+        {
+            return &snapshot;
+        }
+    }
+    return nullptr;
+}
+
+// Get the level bullets are culled against
+Level& GameServer::GetLevel()
+{
+    return level;
+}
+
+// Get the address clients send to
+int GameServer::GetEndpoint() const
+{
+    return endpoint;
+}
+
+// Get the number of connected players
+int GameServer::GetPlayerCount() const
+{
+    return static_cast<int>(players.size());
+}
+
+// Get the number of ticks simulated
+uint32_t GameServer::GetTick() const
+{
+    return tick;
+}
+
+// Get the timings and traffic of the last tick
+const NetServerStats& GameServer::GetStats() const
+{
+    return stats;
+}
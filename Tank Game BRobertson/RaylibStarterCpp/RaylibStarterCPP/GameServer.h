@@ -0,0 +1,93 @@
+#pragma once
+#include "BitStream.h"
+#include "Level.h"
+#include "LoopbackTransport.h"
+#include "NetSnapshot.h"
+#include "Pool.h"
+#include "RingBuffer.h"
+#include "Simulation.h"
+#include "Tank.h"
+#include "TankInput.h"
+#include <cstdint>
+#include <vector>
+
+// Cost of the most recent server tick
+struct NetServerStats
+{
+    float receiveMs;       // Reading connects and inputs
+    float simulateMs;      // Moving tanks and bullets and culling bullets
+    float snapshotMs;      // Quantising the world, delta encoding and sending
+    uint32_t bytesSent;    // Snapshot bytes sent to all clients together
+    int packetsEncoded;    // Distinct snapshot packets built, clients with the same baseline share one
+};
+
+// Authoritative game server: one tank per connected client, simulated at a fixed tick
+// Every tick it applies each client's latest input, steps the world, then sends each client a snapshot
+// delta encoded against the newest snapshot that client acknowledged. Snapshots are kept for
+// historyLength ticks, and a client whose acknowledgement is older than that gets a full snapshot.
+class GameServer
+{
+public:
+    static const int historyLength = 32;
+
+    GameServer(LoopbackTransport& transport, const SimulationConfig& config, Sprite bodySprite, Sprite turretSprite, Sprite bulletSprite);
+
+    // Reads packets, advances the world one tick and sends snapshots
+    void Tick(float deltaTime);
+
+    // Targets and walls that stop bullets, set up before clients connect
+    Level& GetLevel();
+
+    int GetEndpoint() const;
+    int GetPlayerCount() const;
+    uint32_t GetTick() const;
+    const NetServerStats& GetStats() const;
+
+private:
+    // A connected client and the tank it drives
+    struct Player
+    {
+        Player(int endpoint, uint8_t id, Tank tank);
+
+        int endpoint;
+        uint8_t id;
+        Tank tank;
+        std::vector<uint16_t> bulletIds; // Network id of each bullet, kept in step with the tank's bullet list
+        uint16_t nextBulletId;
+        TankInput input;                 // Latest input received, held until the next one arrives
+        uint32_t ackedTick;              // Newest snapshot the client has received, 0 before the first
+    };
+
+    // A snapshot packet built this tick, reused by every client acknowledging the same baseline
+    struct EncodedSnapshot
+    {
+        uint32_t baselineTick;
+        BitWriter writer;
+    };
+
+    void ReceivePackets();
+    void AddPlayer(int endpoint);
+    void Simulate(float deltaTime);
+    void CaptureSnapshot();
+    void SendSnapshots();
+
+    // Finds a snapshot still held in the history, or nullptr
+    const NetSnapshot* FindSnapshot(uint32_t snapshotTick) const;
+
+    LoopbackTransport& transport;
+    int endpoint;
+    SimulationConfig config;
+    Sprite bodySprite, turretSprite, bulletSprite;
+    MemoryPool bulletPool; // Declared before the players, whose bullet lists allocate from it
+    Level level;
+    std::vector<Player> players;
+    uint32_t tick;
+
+    NetSnapshot current;
+    RingBuffer<NetSnapshot, historyLength> history;
+    std::vector<EncodedSnapshot> encoded;
+    int encodedCount;
+    BitWriter replyWriter;
+    NetPacket packet;
+    NetServerStats stats;
+};
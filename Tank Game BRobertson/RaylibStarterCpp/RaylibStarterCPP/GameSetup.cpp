@@ -0,0 +1,246 @@
+#include "GameSetup.h"
+#include "AssetArchive.h"
+#include <cstdio>
+#include <string>
+
+using namespace MathClasses;
+
+namespace
+{
+    // Packed assets, when an archive was found; anything missing from it is read from ../assets instead
+    AssetArchive assetArchive;
+
+    // Queue an image by its name inside the assets directory, from the archive when it has the entry
+    AssetHandle RequestAssetTexture(AssetLoader& loader, const char* name)
+    {
+        if (assetArchive.Find(name) != nullptr)
+        {
+            return loader.RequestTexture(assetArchive, name);
+        }
+        return loader.RequestTexture((std::string("../assets/") + name).c_str());
+    }
+
+    // Read the atlas rectangle table from the archive or the assets directory
+    bool LoadAtlasTable(SpriteAtlas& atlas)
+    {
+        const ArchiveEntry* entry = assetArchive.Find("atlas/sprites.atlas");
+        if (entry != nullptr)
+        {
+            return atlas.LoadTable(reinterpret_cast<const char*>(assetArchive.GetPayload(*entry)), (size_t)entry->size);
+        }
+        return atlas.LoadTable("../assets/atlas/sprites.atlas");
+    }
+
+    // Queue the loose images for the tank body, turret, and bullet
+    void RequestLooseSprites(GameSprites& sprites, AssetLoader& loader)
+    {
+        sprites.fromAtlas = false;
+        sprites.handles[0] = RequestAssetTexture(loader, "images/body.png");
+        sprites.handles[1] = RequestAssetTexture(loader, "images/turret.png");
+        sprites.handles[2] = RequestAssetTexture(loader, "images/bullet.png");
+    }
+}
+
+// Open the asset archive: the one given on the command line, otherwise assets.tkpa next to the executable
+// and then ../assets/assets.tkpa, so the game does not depend on the working directory once packed
+void OpenAssetArchive(const char* archiveFile, const char* executablePath)
+{
+    if (archiveFile != nullptr)
+    {
+        if (!assetArchive.Open(archiveFile))
+        {
+            printf("Could not open asset archive %s\n", archiveFile);
+        }
+        return;
+    }
+
+    std::string besideExecutable = "assets.tkpa";
+    std::string directory = executablePath;
+    size_t separator = directory.find_last_of("/\\");
+    if (separator != std::string::npos)
+    {
+        besideExecutable = directory.substr(0, separator + 1) + besideExecutable;
+    }
+    if (!assetArchive.Open(besideExecutable.c_str()))
+    {
+        assetArchive.Open("../assets/assets.tkpa");
+    }
+}
+
+// Queue the atlas texture when its table names every sprite, otherwise the loose images
+void RequestGameSprites(GameSprites& sprites, AssetLoader& loader)
+{
+    Sprite unused;
+    if (LoadAtlasTable(sprites.atlas) && sprites.atlas.Find("body", unused)
+        && sprites.atlas.Find("turret", unused) && sprites.atlas.Find("bullet", unused))
+    {
+        sprites.fromAtlas = true;
+        sprites.handles[0] = RequestAssetTexture(loader, "atlas/sprites.png");
+        return;
+    }
+    RequestLooseSprites(sprites, loader);
+}
+
+// Build the sprites from the finished loader
+// Returns false if the atlas texture failed and the loose images were queued in its place
+bool ResolveGameSprites(GameSprites& sprites, AssetLoader& loader)
+{
+    if (sprites.fromAtlas)
+    {
+        if (loader.GetState(sprites.handles[0]) != AssetState::Ready)
+        {
+            printf("Could not load the sprite atlas, using loose images\n");
+            RequestLooseSprites(sprites, loader);
+            return false;
+        }
+        sprites.atlas.SetTexture(loader.GetTexture(sprites.handles[0]));
+        sprites.atlas.Find("body", sprites.body);
+        sprites.atlas.Find("turret", sprites.turret);
+        sprites.atlas.Find("bullet", sprites.bullet);
+        return true;
+    }
+
+    sprites.body = Sprite::FromTexture(loader.GetTexture(sprites.handles[0]));
+    sprites.turret = Sprite::FromTexture(loader.GetTexture(sprites.handles[1]));
+    sprites.bullet = Sprite::FromTexture(loader.GetTexture(sprites.handles[2]));
+    return true;
+}
+
+// Load the sprites, blocking until they are on the GPU
+void LoadGameSprites(GameSprites& sprites, AssetLoader& loader)
+{
+    RequestGameSprites(sprites, loader);
+    do
+    {
+        loader.FinishAll();
+    } while (!ResolveGameSprites(sprites, loader));
+}
+
+// Unload whichever textures the sprites were built from
+void UnloadGameSprites(GameSprites& sprites)
+{
+    if (sprites.fromAtlas)
+    {
+        sprites.atlas.Unload();
+        return;
+    }
+    UnloadTexture(sprites.body.texture);
+    UnloadTexture(sprites.turret.texture);
+    UnloadTexture(sprites.bullet.texture);
+}
+
+// Builds the default arena around the loaded sprites
+SimulationConfig MakeDefaultConfig(const GameSprites& sprites)
+{
+    SimulationConfig config = {};
+    config.arenaWidth = (float)screenWidth;
+    config.arenaHeight = (float)screenHeight;
+
+    // Initialise the starting location of the tank
+    config.tankStartX = screenWidth / 2.0f;
+    config.tankStartY = screenHeight / 2.0f;
+
+    config.bodyWidth = (int)sprites.body.Width();
+    config.bodyHeight = (int)sprites.body.Height();
+    config.turretWidth = (int)sprites.turret.Width();
+    config.turretHeight = (int)sprites.turret.Height();
+    config.bulletWidth = (int)sprites.bullet.Width();
+    config.bulletHeight = (int)sprites.bullet.Height();
+    return config;
+}
+
+// The default arena with the sprite sizes of the shipped art, for benchmarks that run without a window
+SimulationConfig MakeHeadlessConfig()
+{
+    SimulationConfig config = {};
+    config.arenaWidth = (float)screenWidth;
+    config.arenaHeight = (float)screenHeight;
+    config.tankStartX = screenWidth / 2.0f;
+    config.tankStartY = screenHeight / 2.0f;
+    SetShippedSpriteSizes(config);
+    return config;
+}
+
+// Physics mode: the tank becomes a physac body driven against the walls and targets as static boxes
+// physac holds at most PHYSAC_MAX_BODIES bodies, so obstacles past that are left out
+void StartTankPhysics(PhysicsWorld& physics, const Simulation& simulation)
+{
+    const Tank& tank = simulation.GetTank();
+    const SimulationConfig& config = simulation.GetConfig();
+    MathClasses::Vector3 position = tank.GetPosition();
+    physics.AddDynamicBox({ position.x, position.y }, (float)config.bodyWidth, (float)config.bodyHeight, tank.GetBodyRotation());
+
+    const Level& level = simulation.GetLevel();
+    size_t obstacles = level.walls.size() + level.targets.size();
+    size_t added = 0;
+    bool full = false;
+    for (const std::vector<Rectangle>* boxes : { &level.walls, &level.targets })
+    {
+        for (size_t i = 0; i < boxes->size() && !full; ++i)
+        {
+            full = !physics.AddStaticBox((*boxes)[i]);
+            added += full ? 0 : 1;
+        }
+    }
+    if (added < obstacles)
+    {
+        printf("Physics mode: only %zu of %zu walls and targets fit in physac\n", added, obstacles);
+    }
+    physics.Start();
+}
+
+// Turn the movement keys into a drive at the tank's usual speeds, leaving the turret and fire keys
+PhysicsDrive TakeTankDrive(TankInput& input)
+{
+    PhysicsDrive drive = { 0.0f, 0.0f };
+    if (input.IsDown(TankInput::MoveForward))
+    {
+        drive.forwardSpeed += 100.0f;
+    }
+    if (input.IsDown(TankInput::MoveBackward))
+    {
+        drive.forwardSpeed -= 100.0f;
+    }
+    if (input.IsDown(TankInput::RotateLeft))
+    {
+        drive.turnRate -= 60.0f;
+    }
+    if (input.IsDown(TankInput::RotateRight))
+    {
+        drive.turnRate += 60.0f;
+    }
+    input.Set(TankInput::MoveForward, false);
+    input.Set(TankInput::MoveBackward, false);
+    input.Set(TankInput::RotateLeft, false);
+    input.Set(TankInput::RotateRight, false);
+    return drive;
+}
+
+// Put the tank's body where the physics thread last left it, the turret keeps its own rotation
+void ApplyTankPhysics(Tank& tank, const PhysicsBodyState& body)
+{
+    TankState state = tank.GetState();
+    state.position = MathClasses::Vector3(body.position.x, body.position.y, 0.0f);
+    state.bodyRotation = body.rotation;
+
+    // The body transform starts as the identity while the rotation starts at -180 degrees
+    state.bodyTransform = Matrix3::MakeRotateZ((body.rotation + 180.0f) * DEG2RAD);
+    tank.SetState(state);
+}
+
+// Scripted controls for loopback bots and benchmark clients: drive in loops, sweep the turret and fire in bursts
+TankInput MakeBotInput(int index, int tick)
+{
+    TankInput input;
+    input.Set((tick / 240 + index) % 3 == 0 ? TankInput::MoveBackward : TankInput::MoveForward, true);
+    input.Set(index % 2 == 0 ? TankInput::RotateLeft : TankInput::RotateRight, (tick / 60 + index) % 2 == 0);
+    input.Set(index % 3 == 0 ? TankInput::TurretRight : TankInput::TurretLeft, true);
+    input.Set(TankInput::Fire, (tick + index * 7) % 30 == 0);
+    return input;
+}
+
+// Converts a one-way delay to whole 120 Hz ticks
+uint32_t LatencyToTicks(int latencyMs)
+{
+    return (uint32_t)((latencyMs * 120 + 500) / 1000);
+}
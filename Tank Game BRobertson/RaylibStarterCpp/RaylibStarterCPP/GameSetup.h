@@ -0,0 +1,62 @@
+#pragma once
+#include "AssetLoader.h"
+#include "PhysicsWorld.h"
+#include "Simulation.h"
+#include "Sprite.h"
+#include "SpriteAtlas.h"
+#include "Tank.h"
+#include "TankInput.h"
+#include <cstdint>
+
+// Window size shared by every windowed mode
+const int screenWidth = 1280;
+const int screenHeight = 720;
+
+// Frame rate every windowed mode runs at, and the budget the performance HUD measures frames against
+const int targetFps = 120;
+
+// Sprites for the tank body, turret, and bullet, taken from the atlas when one has been built
+struct GameSprites
+{
+    SpriteAtlas atlas;
+    bool fromAtlas = false;
+    AssetHandle handles[3] = { -1, -1, -1 };
+    Sprite body, turret, bullet;
+};
+
+// Opens the asset archive named on the command line, or finds the packed one when archiveFile is null
+void OpenAssetArchive(const char* archiveFile, const char* executablePath);
+
+// Queues the atlas texture when its table names every sprite, otherwise the loose images
+void RequestGameSprites(GameSprites& sprites, AssetLoader& loader);
+
+// Builds the sprites from the finished loader
+// Returns false if the atlas texture failed and the loose images were queued in its place
+bool ResolveGameSprites(GameSprites& sprites, AssetLoader& loader);
+
+// Loads the sprites, blocking until they are on the GPU
+void LoadGameSprites(GameSprites& sprites, AssetLoader& loader);
+
+// Unloads whichever textures the sprites were built from
+void UnloadGameSprites(GameSprites& sprites);
+
+// The default arena around the loaded sprites
+SimulationConfig MakeDefaultConfig(const GameSprites& sprites);
+
+// The default arena with the sprite sizes of the shipped art, for modes that run without a window
+SimulationConfig MakeHeadlessConfig();
+
+// Makes the tank a physac body among the level's walls and targets as static boxes
+void StartTankPhysics(PhysicsWorld& physics, const Simulation& simulation);
+
+// Takes the movement keys out of the input as a drive, leaving the turret and fire keys
+PhysicsDrive TakeTankDrive(TankInput& input);
+
+// Moves the tank's body to where the physics thread last left it
+void ApplyTankPhysics(Tank& tank, const PhysicsBodyState& body);
+
+// Scripted controls for loopback bots and benchmark clients
+TankInput MakeBotInput(int index, int tick);
+
+// Converts a one-way delay to whole 120 Hz ticks
+uint32_t LatencyToTicks(int latencyMs);
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// 64-bit FNV-1a, used for state checksums and content keys
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+const uint64_t FNV_PRIME = 1099511628211ull;
+
+// Hashes a block of bytes, continuing from a previous hash if one is given
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t hash = FNV_OFFSET_BASIS)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+// Hashes the raw bytes of a trivially copyable value
+template <typename T>
+inline uint64_t HashValue(const T& value, uint64_t hash = FNV_OFFSET_BASIS)
+{
+    return HashBytes(&value, sizeof(T), hash);
+}
@@ -0,0 +1,170 @@
+#include "ImageCache.h"
+#include "Hash.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+    const char IMAGE_CACHE_MAGIC[4] = { 'T', 'K', 'I', 'C' };
+    const char* const IMAGE_CACHE_EXTENSION = ".rgba";
+
+    // Create a single directory level, ignoring the error if it already exists
+    void MakeDirectory(const char* path)
+    {
+#if defined(_WIN32)
+        _mkdir(path);
+#else
+        mkdir(path, 0755);
+#endif
+    }
+}
+
+ImageCache::ImageCache(const char* directory) : directory(directory)
+{
+    MakeDirectory(directory);
+}
+
+// Hash the source bytes, then try the cache before falling back to a full decode
+Image ImageCache::Load(const char* sourceFile) const
+{
+    Image image = {};
+    unsigned int sourceSize = 0;
+    unsigned char* source = LoadFileData(sourceFile, &sourceSize);
+    if (source == nullptr)
+    {
+        return image;
+    }
+    uint64_t sourceHash = HashBytes(source, sourceSize);
+    RL_FREE(source);
+
+    std::string path = PathFor(sourceHash);
+    if (ReadEntry(path, sourceHash, sourceSize, image))
+    {
+        return image;
+    }
+
+    // raylib 3.0 cannot decode from memory, so the miss path reads the file a second time
+    image = LoadImage(sourceFile);
+    if (image.data == nullptr)
+    {
+        return image;
+    }
+    ImageFormat(&image, UNCOMPRESSED_R8G8B8A8);
+    // Entries are read back as width * height * 4 bytes, so anything else must never be written
+    if (image.format == UNCOMPRESSED_R8G8B8A8)
+    {
+        WriteEntry(path, sourceHash, sourceSize, image);
+    }
+    return image;
+}
+
+// Remove every cache file, leaving anything else in the directory alone
+void ImageCache::Clear() const
+{
+    int count = 0;
+    char** names = GetDirectoryFiles(directory.c_str(), &count);
+    for (int i = 0; i < count; ++i)
+    {
+        if (IsFileExtension(names[i], IMAGE_CACHE_EXTENSION))
+        {
+            std::remove((directory + "/" + names[i]).c_str());
+        }
+    }
+    ClearDirectoryFiles();
+}
+
+// Get the cache directory
+const std::string& ImageCache::GetDirectory() const
+{
+    return directory;
+}
+
+// The content hash in hex is the file name
+std::string ImageCache::PathFor(uint64_t sourceHash) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)sourceHash);
+    return directory + "/" + name + IMAGE_CACHE_EXTENSION;
+}
+
+// The buffer read from disk becomes the image's pixel data, the trailer at its end is simply ignored
+bool ImageCache::ReadEntry(const std::string& path, uint64_t sourceHash, uint64_t sourceSize, Image& image) const
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (length < (long)sizeof(ImageCacheTrailer))
+    {
+        fclose(file);
+        return false;
+    }
+
+    unsigned char* buffer = static_cast<unsigned char*>(RL_MALLOC(length));
+    bool ok = fread(buffer, 1, length, file) == (size_t)length;
+    fclose(file);
+
+    ImageCacheTrailer trailer;
+    memcpy(&trailer, buffer + length - sizeof(ImageCacheTrailer), sizeof(ImageCacheTrailer));
+    ok = ok && memcmp(trailer.magic, IMAGE_CACHE_MAGIC, sizeof(IMAGE_CACHE_MAGIC)) == 0 &&
+        trailer.version == IMAGE_CACHE_VERSION && trailer.sourceHash == sourceHash && trailer.sourceSize == sourceSize &&
+        trailer.format == UNCOMPRESSED_R8G8B8A8 && (uint64_t)trailer.width * trailer.height * 4 == trailer.pixelBytes &&
+        (uint64_t)trailer.pixelBytes + sizeof(ImageCacheTrailer) == (uint64_t)length;
+    if (!ok)
+    {
+        RL_FREE(buffer);
+        return false;
+    }
+
+    image.data = buffer;
+    image.width = (int)trailer.width;
+    image.height = (int)trailer.height;
+    image.mipmaps = 1;
+    image.format = UNCOMPRESSED_R8G8B8A8;
+    return true;
+}
+
+// Another thread may be writing the same entry, so each writer uses its own temporary file
+void ImageCache::WriteEntry(const std::string& path, uint64_t sourceHash, uint64_t sourceSize, const Image& image) const
+{
+    ImageCacheTrailer trailer = {};
+    memcpy(trailer.magic, IMAGE_CACHE_MAGIC, sizeof(IMAGE_CACHE_MAGIC));
+    trailer.version = IMAGE_CACHE_VERSION;
+    trailer.sourceHash = sourceHash;
+    trailer.sourceSize = sourceSize;
+    trailer.width = (uint32_t)image.width;
+    trailer.height = (uint32_t)image.height;
+    trailer.format = UNCOMPRESSED_R8G8B8A8;
+    trailer.pixelBytes = (uint32_t)image.width * image.height * 4;
+
+    std::string temporary = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return;
+    }
+    fwrite(image.data, 1, trailer.pixelBytes, file);
+    fwrite(&trailer, sizeof(trailer), 1, file);
+    bool ok = ferror(file) == 0;
+    ok = fclose(file) == 0 && ok;
+
+    // A failed rename means another thread already cached the same content
+    if (!ok || std::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporary.c_str());
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "raylib.h"
+#include <cstdint>
+#include <string>
+
+// Cache file layout: width x height RGBA pixels followed by an ImageCacheTrailer
+// The trailer goes last so one read fills a buffer whose start is already the Image's pixel data.
+const uint32_t IMAGE_CACHE_VERSION = 1;
+
+struct ImageCacheTrailer
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceHash;  // FNV-1a of the source file's bytes, also the cache file name
+    uint64_t sourceSize;  // Source file length, a cheap second check against hash collisions
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;      // Always UNCOMPRESSED_R8G8B8A8
+    uint32_t pixelBytes;  // Length of the pixel data before the trailer
+};
+
+// On-disk cache of decoded RGBA pixels, keyed by a hash of each source file's contents
+// Editing a source image changes its key, so stale entries are never read and need no invalidation step.
+// Safe to use from several threads at once.
+class ImageCache
+{
+public:
+    // Uses the given directory for cache files, creating it if needed
+    explicit ImageCache(const char* directory);
+
+    // Loads an image as RGBA, from the cache when the source is unchanged, otherwise decoding and caching it
+    // Returns an image with null data if the source cannot be read or decoded
+    // An image that does not convert to RGBA is returned in its decoded format and not cached
+    Image Load(const char* sourceFile) const;
+
+    // Deletes every cache file in the directory
+    void Clear() const;
+
+    const std::string& GetDirectory() const;
+
+private:
+    // Returns the cache file path for a content hash
+    std::string PathFor(uint64_t sourceHash) const;
+
+    // Reads a cache file with a single read, returns false if it is missing or does not match
+    bool ReadEntry(const std::string& path, uint64_t sourceHash, uint64_t sourceSize, Image& image) const;
+
+    // Writes a cache file under a temporary name and renames it into place
+    void WriteEntry(const std::string& path, uint64_t sourceHash, uint64_t sourceSize, const Image& image) const;
+
+    std::string directory;
+};
@@ -0,0 +1,240 @@
+#include "InterceptSolver.h"
+#include "Profiler.h"
+#include <cfloat>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define INTERCEPT_SOLVER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    // Solves |r + v t| = muzzle + speed t for the earliest t >= 0, with r the offset from shooter to target
+    // Uses the half-b quadratic a t^2 + 2 h t + c = 0 and the stable root pair q / a and c / q, which
+    // also copes with a = 0 when the target is exactly as fast as the bullet. Every step is mirrored
+    // operation for operation in the SSE2 path so both give identical results.
+    bool SolveShot(float rx, float ry, float vx, float vy, float speed, float muzzle, float& time, float& dx, float& dy)
+    {
+        float a = (vx * vx + vy * vy) - speed * speed;
+        float h = (rx * vx + ry * vy) - muzzle * speed;
+        float c = (rx * rx + ry * ry) - muzzle * muzzle;
+        float discriminant = h * h - a * c;
+        if (discriminant < 0.0f)
+        {
+            return false;
+        }
+
+        float q = -(h + copysignf(sqrtf(discriminant), h));
+        float first = q / a;
+        float second = c / q;
+        float best = first >= 0.0f && first <= FLT_MAX ? first : INFINITY;
+        if (second >= 0.0f && second <= FLT_MAX && second < best)
+        {
+            best = second;
+        }
+
+        float distance = muzzle + speed * best;
+        if (!(best <= FLT_MAX) || !(distance > 0.0f))
+        {
+            return false;
+        }
+
+        float inverseDistance = 1.0f / distance;
+        time = best;
+        dx = (rx + vx * best) * inverseDistance;
+        dy = (ry + vy * best) * inverseDistance;
+        return true;
+    }
+}
+
+// Constructor for an empty batch
+InterceptSolver::InterceptSolver(float bulletSpeed, float muzzleLength)
+    : bulletSpeed(bulletSpeed), muzzleLength(muzzleLength)
+{
+}
+
+// Solve one shot straight away, outside the batch
+bool InterceptSolver::Solve(Vector2 origin, Vector2 target, Vector2 targetVelocity, float& time, Vector2& direction) const
+{
+    return SolveShot(target.x - origin.x, target.y - origin.y, targetVelocity.x, targetVelocity.y, bulletSpeed, muzzleLength,
+        time, direction.x, direction.y);
+}
+
+// Drop every shot in the batch
+void InterceptSolver::Clear()
+{
+    originsX.clear();
+    originsY.clear();
+    targetsX.clear();
+    targetsY.clear();
+    velocitiesX.clear();
+    velocitiesY.clear();
+}
+
+// Append a shot to each input array
+size_t InterceptSolver::Add(Vector2 origin, Vector2 target, Vector2 targetVelocity)
+{
+    originsX.push_back(origin.x);
+    originsY.push_back(origin.y);
+    targetsX.push_back(target.x);
+    targetsY.push_back(target.y);
+    velocitiesX.push_back(targetVelocity.x);
+    velocitiesY.push_back(targetVelocity.y);
+    return originsX.size() - 1;
+}
+
+// Four shots per step, one per lane. Lanes without a root come out as NaN or infinity and are
+// masked to a time of -1 and a zero direction at the end. Leftover shots go through SolveRange.
+void InterceptSolver::SolveAll()
+{
+    PROFILE_SCOPE("InterceptSolver::SolveAll");
+    size_t count = originsX.size();
+    times.resize(count);
+    directionsX.resize(count);
+    directionsY.resize(count);
+    size_t first = 0;
+
+#if defined(INTERCEPT_SOLVER_SSE2)
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 largest = _mm_set1_ps(FLT_MAX);
+    const __m128 infinity = _mm_set1_ps(INFINITY);
+    const __m128 missed = _mm_set1_ps(-1.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 speed = _mm_set1_ps(bulletSpeed);
+    const __m128 muzzle = _mm_set1_ps(muzzleLength);
+    const __m128 speedSq = _mm_set1_ps(bulletSpeed * bulletSpeed);
+    const __m128 muzzleSpeed = _mm_set1_ps(muzzleLength * bulletSpeed);
+    const __m128 muzzleSq = _mm_set1_ps(muzzleLength * muzzleLength);
+    for (; first + 4 <= count; first += 4)
+    {
+        __m128 rx = _mm_sub_ps(_mm_loadu_ps(&targetsX[first]), _mm_loadu_ps(&originsX[first]));
+        __m128 ry = _mm_sub_ps(_mm_loadu_ps(&targetsY[first]), _mm_loadu_ps(&originsY[first]));
+        __m128 vx = _mm_loadu_ps(&velocitiesX[first]);
+        __m128 vy = _mm_loadu_ps(&velocitiesY[first]);
+
+        __m128 a = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), speedSq);
+        __m128 h = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(rx, vx), _mm_mul_ps(ry, vy)), muzzleSpeed);
+        __m128 c = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)), muzzleSq);
+        __m128 discriminant = _mm_sub_ps(_mm_mul_ps(h, h), _mm_mul_ps(a, c));
+        __m128 hasRoots = _mm_cmpge_ps(discriminant, zero);
+
+        // copysign(sqrt(discriminant), h), then negate
+        __m128 root = _mm_or_ps(_mm_sqrt_ps(discriminant), _mm_and_ps(h, signMask));
+        __m128 q = _mm_xor_ps(_mm_add_ps(h, root), signMask);
+        __m128 firstRoot = _mm_div_ps(q, a);
+        __m128 secondRoot = _mm_div_ps(c, q);
+
+        __m128 firstValid = _mm_and_ps(_mm_cmpge_ps(firstRoot, zero), _mm_cmple_ps(firstRoot, largest));
+        __m128 best = _mm_or_ps(_mm_and_ps(firstValid, firstRoot), _mm_andnot_ps(firstValid, infinity));
+        __m128 secondBetter = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(secondRoot, zero), _mm_cmple_ps(secondRoot, largest)),
+            _mm_cmplt_ps(secondRoot, best));
+        best = _mm_or_ps(_mm_and_ps(secondBetter, secondRoot), _mm_andnot_ps(secondBetter, best));
+
+        __m128 distance = _mm_add_ps(muzzle, _mm_mul_ps(speed, best));
+        __m128 hit = _mm_and_ps(_mm_and_ps(hasRoots, _mm_cmple_ps(best, largest)), _mm_cmpgt_ps(distance, zero));
+        __m128 inverseDistance = _mm_div_ps(one, distance);
+        __m128 dx = _mm_mul_ps(_mm_add_ps(rx, _mm_mul_ps(vx, best)), inverseDistance);
+        __m128 dy = _mm_mul_ps(_mm_add_ps(ry, _mm_mul_ps(vy, best)), inverseDistance);
+
+        _mm_storeu_ps(&times[first], _mm_or_ps(_mm_and_ps(hit, best), _mm_andnot_ps(hit, missed)));
+        _mm_storeu_ps(&directionsX[first], _mm_and_ps(hit, dx));
+        _mm_storeu_ps(&directionsY[first], _mm_and_ps(hit, dy));
+    }
+#endif
+
+    SolveRange(first, count);
+}
+
+// Solve the whole batch without SIMD
+void InterceptSolver::SolveAllScalar()
+{
+    PROFILE_SCOPE("InterceptSolver::SolveAllScalar");
+    size_t count = originsX.size();
+    times.resize(count);
+    directionsX.resize(count);
+    directionsY.resize(count);
+    SolveRange(0, count);
+}
+
+// Solve batch shots one by one, writing the miss values where there is no intercept
+void InterceptSolver::SolveRange(size_t first, size_t last)
+{
+    for (size_t i = first; i < last; ++i)
+    {
+        float time, dx, dy;
+        if (SolveShot(targetsX[i] - originsX[i], targetsY[i] - originsY[i], velocitiesX[i], velocitiesY[i], bulletSpeed, muzzleLength,
+            time, dx, dy))
+        {
+            times[i] = time;
+            directionsX[i] = dx;
+            directionsY[i] = dy;
+        }
+        else
+        {
+            times[i] = -1.0f;
+            directionsX[i] = 0.0f;
+            directionsY[i] = 0.0f;
+        }
+    }
+}
+
+// Get the number of shots in the batch
+size_t InterceptSolver::GetCount() const
+{
+    return originsX.size();
+}
+
+// Get one shot's flight time from the last solve
+float InterceptSolver::GetTime(size_t slot) const
+{
+    return times[slot];
+}
+
+// Get one shot's firing direction from the last solve
+Vector2 InterceptSolver::GetDirection(size_t slot) const
+{
+    return { directionsX[slot], directionsY[slot] };
+}
+
+// Get every flight time from the last solve
+const std::vector<float>& InterceptSolver::GetTimes() const
+{
+    return times;
+}
+
+// Get the x component of every firing direction from the last solve
+const std::vector<float>& InterceptSolver::GetDirectionsX() const
+{
+    return directionsX;
+}
+
+// Get the y component of every firing direction from the last solve
+const std::vector<float>& InterceptSolver::GetDirectionsY() const
+{
+    return directionsY;
+}
+
+// Get the speed bullets are assumed to fly at
+float InterceptSolver::GetBulletSpeed() const
+{
+    return bulletSpeed;
+}
+
+// Get how far from the tank bullets appear
+float InterceptSolver::GetMuzzleLength() const
+{
+    return muzzleLength;
+}
+
+// Turn a firing direction into the turret angle, undoing the body rotation and the 90 degree sprite offset
+float InterceptSolver::TurretRotationFor(Vector2 direction, float bodyRotation)
+{
+    float angle = fmodf(atan2f(direction.y, direction.x) * RAD2DEG - 90.0f - bodyRotation + 180.0f, 360.0f);
+    if (angle < 0.0f)
+    {
+        angle += 360.0f;
+    }
+    return angle - 180.0f;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "raylib.h"
+#include <cstddef>
+#include <vector>
+
+// Lead aiming for straight-flying bullets against targets moving at a constant velocity
+// A bullet fired along unit direction d from origin O is at O + d * (muzzleLength + bulletSpeed * t),
+// since it appears muzzleLength out from the tank. It meets a target at P + V * t when
+// |P + V * t - O| = muzzleLength + bulletSpeed * t, a quadratic in t. The earliest non-negative root
+// is the flight time, and the direction is the offset to the meeting point divided by the distance
+// the bullet covers, so no square root is needed beyond the discriminant's.
+// Shots can be solved one at a time, or added to a batch that is solved four at a time with SSE2.
+class InterceptSolver
+{
+public:
+    InterceptSolver(float bulletSpeed, float muzzleLength);
+
+    // Solves one shot, returning false when the bullet can never catch the target
+    bool Solve(Vector2 origin, Vector2 target, Vector2 targetVelocity, float& time, Vector2& direction) const;
+
+    // Empties the batch, keeping its storage
+    void Clear();
+
+    // Adds a shot to the batch and returns its slot
+    size_t Add(Vector2 origin, Vector2 target, Vector2 targetVelocity);
+
+    // Solves every shot in the batch, vectorised when SSE2 is available
+    void SolveAll();
+
+    // The same solve one shot at a time, used where SSE2 is missing and to check the vector version
+    void SolveAllScalar();
+
+    size_t GetCount() const;
+
+    // Flight time of a batch shot, negative when it cannot hit
+    float GetTime(size_t slot) const;
+
+    // Unit firing direction of a batch shot, zero when it cannot hit
+    Vector2 GetDirection(size_t slot) const;
+
+    const std::vector<float>& GetTimes() const;
+    const std::vector<float>& GetDirectionsX() const;
+    const std::vector<float>& GetDirectionsY() const;
+
+    float GetBulletSpeed() const;
+    float GetMuzzleLength() const;
+
+    // Turret angle relative to the body that fires along a direction, as Tank::FireBullet uses
+    // body + turret + 90 degrees. Wrapped into [-180, 180).
+    static float TurretRotationFor(Vector2 direction, float bodyRotation);
+
+private:
+    // Solves batch shots [first, last) one at a time
+    void SolveRange(size_t first, size_t last);
+
+    float bulletSpeed;
+    float muzzleLength;
+    std::vector<float> originsX, originsY;
+    std::vector<float> targetsX, targetsY;
+    std::vector<float> velocitiesX, velocitiesY;
+    std::vector<float> times;
+    std::vector<float> directionsX, directionsY;
+};
@@ -0,0 +1,284 @@
+#include "Level.h"
+#include <cstring>
+#include <sstream>
+
+namespace
+{
+    const char LEVEL_MAGIC[4] = { 'T', 'K', 'L', 'V' };
+
+    // Write records of one type as a run of chunks
+    template <typename T>
+    void WriteChunks(FILE* file, LevelChunkType type, const std::vector<T>& records, uint32_t& chunkCount)
+    {
+        for (size_t first = 0; first < records.size(); first += LEVEL_CHUNK_RECORDS)
+        {
+            size_t count = records.size() - first;
+            if (count > LEVEL_CHUNK_RECORDS)
+            {
+                count = LEVEL_CHUNK_RECORDS;
+            }
+            LevelChunkHeader chunk = { type, static_cast<uint32_t>(count) };
+            fwrite(&chunk, sizeof(chunk), 1, file);
+            fwrite(&records[first], sizeof(T), count, file);
+            chunkCount++;
+        }
+    }
+
+    // Append the records held in a staging buffer to the level
+    template <typename T>
+    void AppendRecords(std::vector<T>& destination, const unsigned char* data, uint32_t count)
+    {
+        const T* records = reinterpret_cast<const T*>(data);
+        destination.insert(destination.end(), records, records + count);
+    }
+}
+
+// Parse the text description line by line, then write it out grouped into chunks
+bool CompileLevel(const char* sourceFile, const char* outputFile, std::string& error)
+{
+    FILE* source = fopen(sourceFile, "r");
+    if (source == nullptr)
+    {
+        error = std::string("cannot open ") + sourceFile;
+        return false;
+    }
+
+    LevelFileHeader header = {};
+    memcpy(header.magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC));
+    header.version = LEVEL_VERSION;
+    header.arenaWidth = 1280.0f;
+    header.arenaHeight = 720.0f;
+
+    Level level;
+    char line[256];
+    int lineNumber = 0;
+    while (fgets(line, sizeof(line), source) != nullptr)
+    {
+        lineNumber++;
+        char* comment = strchr(line, '#');
+        if (comment != nullptr)
+        {
+            *comment = '\0';
+        }
+
+        std::istringstream tokens(line);
+        std::string keyword;
+        if (!(tokens >> keyword))
+        {
+            continue;
+        }
+
+        Rectangle box = {};
+        Vector2 point = {};
+        bool ok = true;
+        if (keyword == "arena")
+        {
+            ok = static_cast<bool>(tokens >> header.arenaWidth >> header.arenaHeight);
+        }
+        else if (keyword == "spawn")
+        {
+            ok = static_cast<bool>(tokens >> point.x >> point.y);
+            level.spawnPoints.push_back(point);
+        }
+        else if (keyword == "target" || keyword == "wall")
+        {
+            ok = static_cast<bool>(tokens >> box.x >> box.y >> box.width >> box.height);
+            (keyword == "target" ? level.targets : level.walls).push_back(box);
+        }
+        else
+        {
+            ok = false;
+        }
+
+        if (!ok)
+        {
+            fclose(source);
+            error = std::string(sourceFile) + ":" + std::to_string(lineNumber) + ": cannot parse '" + keyword + "'";
+            return false;
+        }
+    }
+    fclose(source);
+
+    if (level.spawnPoints.empty())
+    {
+        level.spawnPoints.push_back({ header.arenaWidth / 2.0f, header.arenaHeight / 2.0f });
+    }
+    header.spawnX = level.spawnPoints[0].x;
+    header.spawnY = level.spawnPoints[0].y;
+    header.targetCount = static_cast<uint32_t>(level.targets.size());
+    header.wallCount = static_cast<uint32_t>(level.walls.size());
+    header.spawnCount = static_cast<uint32_t>(level.spawnPoints.size());
+
+    FILE* output = fopen(outputFile, "wb");
+    if (output == nullptr)
+    {
+        error = std::string("cannot write ") + outputFile;
+        return false;
+    }
+
+    // Header is rewritten once the chunk count is known
+    fwrite(&header, sizeof(header), 1, output);
+    WriteChunks(output, LEVEL_CHUNK_SPAWNS, level.spawnPoints, header.chunkCount);
+    WriteChunks(output, LEVEL_CHUNK_WALLS, level.walls, header.chunkCount);
+    WriteChunks(output, LEVEL_CHUNK_TARGETS, level.targets, header.chunkCount);
+    fseek(output, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, output);
+
+    bool ok = ferror(output) == 0;
+    ok = fclose(output) == 0 && ok;
+    if (!ok)
+    {
+        error = std::string("failed writing ") + outputFile;
+    }
+    return ok;
+}
+
+// Constructor for a stream with no file open
+LevelStream::LevelStream()
+    : file(nullptr), header(), chunksRead(0), chunkBytes(0), stopped(false)
+{
+}
+
+// Close the file if streaming did not finish
+LevelStream::~LevelStream()
+{
+    if (file != nullptr)
+    {
+        fclose(file);
+    }
+}
+
+// Close the file early, the level keeps the records already appended
+void LevelStream::Close()
+{
+    if (file != nullptr)
+    {
+        fclose(file);
+        file = nullptr;
+    }
+    stopped = true;
+}
+
+// Read the header, leaving the chunks for Pump
+bool LevelStream::Open(const char* fileName)
+{
+    if (file != nullptr)
+    {
+        fclose(file);
+    }
+    chunksRead = 0;
+    stopped = false;
+
+    file = fopen(fileName, "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC)) != 0 || header.version != LEVEL_VERSION)
+    {
+        fclose(file);
+        file = nullptr;
+        header = {};
+        return false;
+    }
+
+    // The header's totals are only trusted once Pump has checked them against this
+    long headerEnd = ftell(file);
+    chunkBytes = 0;
+    if (fseek(file, 0, SEEK_END) == 0)
+    {
+        long end = ftell(file);
+        chunkBytes = end > headerEnd ? (uint64_t)(end - headerEnd) : 0;
+    }
+    fseek(file, headerEnd, SEEK_SET);
+
+    staging.reserve(LEVEL_CHUNK_RECORDS * sizeof(Rectangle));
+    return true;
+}
+
+// Read chunks until the budget is spent, always finishing the chunk in progress
+bool LevelStream::Pump(Level& level, size_t byteBudget)
+{
+    if (file == nullptr)
+    {
+        return IsFinished();
+    }
+
+    if (chunksRead == 0)
+    {
+        // Every record and chunk header takes space in the file, so larger totals mean a corrupt header
+        // and reserving them could ask for gigabytes
+        uint64_t needed = ((uint64_t)header.targetCount + header.wallCount) * sizeof(Rectangle) +
+            (uint64_t)header.spawnCount * sizeof(Vector2) + (uint64_t)header.chunkCount * sizeof(LevelChunkHeader);
+        if (needed > chunkBytes)
+        {
+            Close();
+            return false;
+        }
+        level.targets.reserve(level.targets.size() + header.targetCount);
+        level.walls.reserve(level.walls.size() + header.wallCount);
+        level.spawnPoints.reserve(level.spawnPoints.size() + header.spawnCount);
+    }
+
+    size_t bytesRead = 0;
+    while (!IsFinished() && bytesRead < byteBudget)
+    {
+        LevelChunkHeader chunk;
+        if (fread(&chunk, sizeof(chunk), 1, file) != 1 || chunk.count > LEVEL_CHUNK_RECORDS)
+        {
+            return false;
+        }
+
+        size_t recordSize = chunk.type == LEVEL_CHUNK_SPAWNS ? sizeof(Vector2) : sizeof(Rectangle);
+        staging.resize(chunk.count * recordSize);
+        if (fread(staging.data(), 1, staging.size(), file) != staging.size())
+        {
+            return false;
+        }
+
+        switch (chunk.type)
+        {
+        case LEVEL_CHUNK_TARGETS:
+            AppendRecords(level.targets, staging.data(), chunk.count);
+            break;
+        case LEVEL_CHUNK_WALLS:
+            AppendRecords(level.walls, staging.data(), chunk.count);
+            break;
+        case LEVEL_CHUNK_SPAWNS:
+            AppendRecords(level.spawnPoints, staging.data(), chunk.count);
+            break;
+        default:
+            return false;
+        }
+
+        bytesRead += sizeof(chunk) + staging.size();
+        chunksRead++;
+    }
+
+    if (IsFinished() && file != nullptr)
+    {
+        fclose(file);
+        file = nullptr;
+    }
+    return true;
+}
+
+// Get the level header
+const LevelFileHeader& LevelStream::GetHeader() const
+{
+    return header;
+}
+
+// Check if every chunk has been read, or streaming was stopped early
+bool LevelStream::IsFinished() const
+{
+    return stopped || chunksRead >= header.chunkCount;
+}
+
+// Get how much of the level has been read
+float LevelStream::GetProgress() const
+{
+    return header.chunkCount == 0 ? 1.0f : (float)chunksRead / header.chunkCount;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "raylib.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Static arena geometry: targets bullets are aimed at, walls that stop bullets and tank spawn points
+struct Level
+{
+    std::vector<Rectangle> targets;
+    std::vector<Rectangle> walls;
+    std::vector<Vector2> spawnPoints;
+};
+
+// Compiled level layout (little endian):
+//   LevelFileHeader
+//   chunkCount x { LevelChunkHeader, count records }
+// Records are Rectangle (targets, walls) or Vector2 (spawn points), at most LEVEL_CHUNK_RECORDS per chunk.
+const uint32_t LEVEL_VERSION = 1;
+const uint32_t LEVEL_CHUNK_RECORDS = 4096;
+
+enum LevelChunkType : uint32_t
+{
+    LEVEL_CHUNK_TARGETS = 1,
+    LEVEL_CHUNK_WALLS = 2,
+    LEVEL_CHUNK_SPAWNS = 3
+};
+
+struct LevelFileHeader
+{
+    char magic[4];
+    uint32_t version;
+    float arenaWidth, arenaHeight;
+    float spawnX, spawnY;       // First spawn point, so the tank can be placed before any chunk is read
+    uint32_t chunkCount;
+    uint32_t targetCount;       // Totals across all chunks, used to reserve storage up front
+    uint32_t wallCount;
+    uint32_t spawnCount;
+};
+
+struct LevelChunkHeader
+{
+    uint32_t type;  // LevelChunkType
+    uint32_t count; // Number of records that follow
+};
+
+// Compiles a text arena description into the binary chunked format
+// Text lines are "arena w h", "spawn x y", "target x y w h" or "wall x y w h", with # starting a comment
+bool CompileLevel(const char* sourceFile, const char* outputFile, std::string& error);
+
+// Reads a compiled level a few chunks at a time, so play can start before a large map is resident
+class LevelStream
+{
+public:
+    LevelStream();
+    ~LevelStream();
+    LevelStream(const LevelStream&) = delete;
+    LevelStream& operator=(const LevelStream&) = delete;
+
+    // Reads only the header
+    bool Open(const char* fileName);
+
+    // Reads whole chunks into the level until at least byteBudget bytes were read, returns false on error
+    // The first call reserves storage for every record so the level never regrows while streaming,
+    // after checking the header's totals fit in the file; when they do not it closes the stream and returns false
+    bool Pump(Level& level, size_t byteBudget);
+
+    // Closes the file and stops streaming, keeping whatever chunks were read, after which IsFinished is true
+    void Close();
+
+    const LevelFileHeader& GetHeader() const;
+    bool IsFinished() const;
+
+    // Fraction of chunks read so far, from 0 to 1
+    float GetProgress() const;
+
+private:
+    FILE* file;
+    LevelFileHeader header;
+    uint32_t chunksRead;
+    uint64_t chunkBytes; // Bytes after the header, which must hold every chunk the header counts
+    bool stopped; // Closed before the last chunk, usually after a bad chunk
+    std::vector<unsigned char> staging; // Reused for every chunk, never larger than one full chunk
+};
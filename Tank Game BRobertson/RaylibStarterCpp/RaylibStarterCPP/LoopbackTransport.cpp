@@ -0,0 +1,93 @@
+#include "LoopbackTransport.h"
+
+// Constructor with no endpoints and no loss
+LoopbackTransport::LoopbackTransport()
+    : lossRate(0.0f), lossState(0x9E3779B9u), latency(0), clock(0)
+{
+}
+
+// Add an endpoint with an empty queue
+int LoopbackTransport::CreateEndpoint()
+{
+    queues.emplace_back();
+    traffic.push_back(NetTraffic{});
+    return static_cast<int>(queues.size()) - 1;
+}
+
+// Copy the data into a recycled buffer and queue it for the receiver
+void LoopbackTransport::Send(int from, int to, const uint8_t* data, size_t size)
+{
+    NetTraffic& sender = traffic[from];
+    sender.packetsSent++;
+    sender.bytesSent += size;
+
+    if (lossRate > 0.0f)
+    {
+        // xorshift32, so a lossy run drops the same packets every time
+        lossState ^= lossState << 13;
+        lossState ^= lossState >> 17;
+        lossState ^= lossState << 5;
+        if ((lossState & 0xFFFFFFu) < static_cast<uint32_t>(lossRate * 0x1000000))
+        {
+            sender.packetsDropped++;
+            return;
+        }
+    }
+
+    NetPacket packet;
+    packet.from = from;
+    packet.deliverAt = clock + latency;
+    if (!spareBuffers.empty())
+    {
+        packet.data.swap(spareBuffers.back());
+        spareBuffers.pop_back();
+    }
+    packet.data.assign(data, data + size);
+    queues[to].push_back(std::move(packet));
+}
+
+// Move the oldest queued packet out to the caller, once its latency has passed
+bool LoopbackTransport::Receive(int endpoint, NetPacket& packet)
+{
+    std::deque<NetPacket>& queue = queues[endpoint];
+    if (queue.empty() || queue.front().deliverAt > clock)
+    {
+        return false;
+    }
+    packet.from = queue.front().from;
+    packet.deliverAt = queue.front().deliverAt;
+    packet.data.swap(queue.front().data);
+    queue.pop_front();
+    return true;
+}
+
+// Keep the buffer for the next Send
+void LoopbackTransport::Recycle(NetPacket& packet)
+{
+    spareBuffers.push_back(std::move(packet.data));
+    packet.data = std::vector<uint8_t>();
+}
+
+// Set the fraction of packets to drop
+void LoopbackTransport::SetLossRate(float rate)
+{
+    lossRate = rate;
+}
+
+// Set the one-way delay in clock ticks
+void LoopbackTransport::SetLatency(uint32_t ticks)
+{
+    latency = ticks;
+}
+
+// Advance the clock packets are delayed against
+void LoopbackTransport::AdvanceClock()
+{
+    clock++;
+}
+
+// Get the counters for packets an endpoint has sent
+const NetTraffic& LoopbackTransport::GetTraffic(int endpoint) const
+{
+    return traffic[endpoint];
+}
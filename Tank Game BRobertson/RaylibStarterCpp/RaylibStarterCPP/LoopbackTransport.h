@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+// A datagram waiting to be received
+struct NetPacket
+{
+    int from;                   // Endpoint that sent it
+    uint32_t deliverAt;         // Transport clock tick the packet becomes receivable
+    std::vector<uint8_t> data;
+};
+
+// Traffic counters for one endpoint
+struct NetTraffic
+{
+    uint64_t packetsSent;
+    uint64_t bytesSent;
+    uint64_t packetsDropped; // Sent but thrown away by the simulated loss
+};
+
+// In-process stand-in for a UDP socket per endpoint, used to run a server and its clients in one program
+// Packets are delivered in order after the configured latency. Like UDP, a dropped packet is never resent.
+// Received packets hand their buffers back through Recycle so steady traffic stops allocating.
+// Not thread safe: the server and every client are expected to run on the same thread.
+class LoopbackTransport
+{
+public:
+    LoopbackTransport();
+
+    // Adds an endpoint and returns its address
+    int CreateEndpoint();
+
+    // Queues a copy of the data for another endpoint
+    void Send(int from, int to, const uint8_t* data, size_t size);
+
+    // Takes the oldest packet queued for an endpoint, returns false when there is none
+    bool Receive(int endpoint, NetPacket& packet);
+
+    // Returns a received packet's buffer to the free list
+    void Recycle(NetPacket& packet);
+
+    // Drops each packet with the given probability, from a fixed seed so runs repeat exactly
+    void SetLossRate(float rate);
+
+    // Holds every packet back for this many AdvanceClock calls, 0 delivers straight away
+    void SetLatency(uint32_t ticks);
+
+    // Moves the transport clock on one tick, called once per simulated frame
+    void AdvanceClock();
+
+    const NetTraffic& GetTraffic(int endpoint) const;
+
+private:
+    std::vector<std::deque<NetPacket>> queues;
+    std::vector<NetTraffic> traffic;
+    std::vector<std::vector<uint8_t>> spareBuffers;
+    float lossRate;
+    uint32_t lossState;
+    uint32_t latency;
+    uint32_t clock;
+};
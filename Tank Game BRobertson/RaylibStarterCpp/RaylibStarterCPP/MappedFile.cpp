@@ -0,0 +1,164 @@
+#include "MappedFile.h"
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Constructor for an empty mapping
+MappedFile::MappedFile()
+    : data(nullptr), size(0), mappingHandle(nullptr)
+{
+}
+
+// Release the mapping when going out of scope
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+// Take over another mapping
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data(other.data), size(other.size), mappingHandle(other.mappingHandle)
+{
+    other.data = nullptr;
+    other.size = 0;
+    other.mappingHandle = nullptr;
+}
+
+// Release our mapping and take over another
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+        std::swap(mappingHandle, other.mappingHandle);
+    }
+    return *this;
+}
+
+#if defined(_WIN32)
+
+// Map the file with CreateFileMapping, the file handle can be closed once the view exists
+bool MappedFile::Open(const char* fileName)
+{
+    Close();
+
+    HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr)
+    {
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    data = static_cast<const unsigned char*>(view);
+    size = static_cast<size_t>(fileSize.QuadPart);
+    mappingHandle = mapping;
+    return true;
+}
+
+// Unmap the view and close the mapping object
+void MappedFile::Close()
+{
+    if (data != nullptr)
+    {
+        UnmapViewOfFile(data);
+        CloseHandle(static_cast<HANDLE>(mappingHandle));
+    }
+    data = nullptr;
+    size = 0;
+    mappingHandle = nullptr;
+}
+
+#else
+
+// Map the file with mmap, the descriptor can be closed once the mapping exists
+bool MappedFile::Open(const char* fileName)
+{
+    Close();
+
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+    {
+        return false;
+    }
+
+    data = static_cast<const unsigned char*>(view);
+    size = static_cast<size_t>(info.st_size);
+    return true;
+}
+
+// Unmap the file
+void MappedFile::Close()
+{
+    if (data != nullptr)
+    {
+        munmap(const_cast<unsigned char*>(data), size);
+    }
+    data = nullptr;
+    size = 0;
+    mappingHandle = nullptr;
+}
+
+#endif
+
+// Check if a file is currently mapped
+bool MappedFile::IsOpen() const
+{
+    return data != nullptr;
+}
+
+// Get the start of the mapped bytes
+const unsigned char* MappedFile::GetData() const
+{
+    return data;
+}
+
+// Get the number of mapped bytes
+size_t MappedFile::GetSize() const
+{
+    return size;
+}
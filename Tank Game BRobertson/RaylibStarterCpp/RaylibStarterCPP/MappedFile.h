@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+
+// Read-only memory mapping of a whole file, so data can be used in place without copying or parsing
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Maps the file, replacing any previous mapping
+    bool Open(const char* fileName);
+
+    // Unmaps the file
+    void Close();
+
+    bool IsOpen() const;
+    const unsigned char* GetData() const;
+    size_t GetSize() const;
+
+private:
+    const unsigned char* data; // Start of the mapped view
+    size_t size;               // Length of the file in bytes
+    void* mappingHandle;       // Windows file mapping object, unused elsewhere
+};
@@ -0,0 +1,281 @@
+#include "NetSnapshot.h"
+#include <cmath>
+
+namespace
+{
+    // Deltas small enough for these fields are sent in place of the full value
+    // A tank moves under 1 pixel and a bullet under 4 pixels per tick, so both fit for a dozen ticks of lag
+    const int tankDeltaBits = 8;
+    const int bulletDeltaBits = 10;
+    const int angleDeltaBits = 8;
+
+    const int playerBits = 7;
+    const int countBits = 16;
+    const int idGapBits = 4;
+
+    // Checks if a value fits in a signed field of the given width
+    bool FitsSigned(int32_t value, int bits)
+    {
+        int32_t limit = 1 << (bits - 1);
+        return value >= -limit && value < limit;
+    }
+
+    // Unchanged costs one bit, a small change a delta, anything else the full value
+    void WritePosition(BitWriter& writer, int32_t value, int32_t base, int deltaBits)
+    {
+        int32_t delta = value - base;
+        writer.WriteBool(delta != 0);
+        if (delta == 0)
+        {
+            return;
+        }
+        bool small = FitsSigned(delta, deltaBits);
+        writer.WriteBool(small);
+        writer.WriteSigned(small ? delta : value, small ? deltaBits : NET_POSITION_BITS);
+    }
+
+    // Read a field written by WritePosition
+    int32_t ReadPosition(BitReader& reader, int32_t base, int deltaBits)
+    {
+        if (!reader.ReadBool())
+        {
+            return base;
+        }
+        if (reader.ReadBool())
+        {
+            return base + reader.ReadSigned(deltaBits);
+        }
+        return reader.ReadSigned(NET_POSITION_BITS);
+    }
+
+    // Angles wrap, so the delta is taken the short way round the circle
+    void WriteAngle(BitWriter& writer, uint16_t value, uint16_t base)
+    {
+        int32_t delta = static_cast<int16_t>(static_cast<uint16_t>(value - base));
+        writer.WriteBool(delta != 0);
+        if (delta == 0)
+        {
+            return;
+        }
+        bool small = FitsSigned(delta, angleDeltaBits);
+        writer.WriteBool(small);
+        if (small)
+        {
+            writer.WriteSigned(delta, angleDeltaBits);
+        }
+        else
+        {
+            writer.WriteBits(value, NET_ANGLE_BITS);
+        }
+    }
+
+    // Read a field written by WriteAngle
+    uint16_t ReadAngle(BitReader& reader, uint16_t base)
+    {
+        if (!reader.ReadBool())
+        {
+            return base;
+        }
+        if (reader.ReadBool())
+        {
+            return static_cast<uint16_t>(base + reader.ReadSigned(angleDeltaBits));
+        }
+        return static_cast<uint16_t>(reader.ReadBits(NET_ANGLE_BITS));
+    }
+
+    // Orders wrapping bullet ids, treating anything less than half the id space ahead as newer
+    bool IdBefore(uint16_t a, uint16_t b)
+    {
+        return static_cast<int16_t>(static_cast<uint16_t>(a - b)) < 0;
+    }
+
+    // Find the baseline tank for a player, moving a cursor forward through the sorted baseline tanks
+    // bulletCursor follows along so it points at that tank's first bullet
+    const NetTank* MatchTank(const NetSnapshot* baseline, uint8_t player, size_t& tankCursor, size_t& bulletCursor)
+    {
+        if (baseline == nullptr)
+        {
+            return nullptr;
+        }
+        while (tankCursor < baseline->tanks.size() && baseline->tanks[tankCursor].player < player)
+        {
+            bulletCursor += baseline->tanks[tankCursor].bulletCount;
+            tankCursor++;
+        }
+        if (tankCursor < baseline->tanks.size() && baseline->tanks[tankCursor].player == player)
+        {
+            return &baseline->tanks[tankCursor];
+        }
+        return nullptr;
+    }
+
+    // Find the baseline bullet with an id, moving a cursor forward through one tank's sorted bullets
+    const NetBullet* MatchBullet(const NetBullet* bullets, size_t count, uint16_t id, size_t& cursor)
+    {
+        while (cursor < count && IdBefore(bullets[cursor].id, id))
+        {
+            cursor++;
+        }
+        if (cursor < count && bullets[cursor].id == id)
+        {
+            return &bullets[cursor];
+        }
+        return nullptr;
+    }
+}
+
+// Round to the nearest eighth of a pixel
+int32_t QuantisePosition(float position)
+{
+    return static_cast<int32_t>(lroundf(position * NET_POSITION_SCALE));
+}
+
+// Convert back to pixels
+float DequantisePosition(int32_t position)
+{
+    return position / NET_POSITION_SCALE;
+}
+
+// Round to the nearest 65536th of a turn, wrapping negative angles
+uint16_t QuantiseAngle(float degrees)
+{
+    float turns = degrees / 360.0f;
+    turns -= floorf(turns);
+    return static_cast<uint16_t>(static_cast<uint32_t>(lroundf(turns * 65536.0f)) & 0xFFFFu);
+}
+
+// Convert back to degrees in [0, 360)
+float DequantiseAngle(uint16_t angle)
+{
+    return angle * (360.0f / 65536.0f);
+}
+
+// Tanks and bullets that exist in the baseline send per-field deltas, new ones send full values
+// Removed entities are simply left out. Bullet ids go out as gaps from the previous id, which are
+// almost always small because ids are handed out in firing order and only hits open gaps between them.
+void EncodeSnapshot(const NetSnapshot& snapshot, const NetSnapshot* baseline, BitWriter& writer)
+{
+    writer.WriteBits(static_cast<uint32_t>(snapshot.tanks.size()), playerBits);
+
+    size_t baseTankCursor = 0;
+    size_t baseBulletStart = 0;
+    size_t bulletStart = 0;
+    for (const NetTank& tank : snapshot.tanks)
+    {
+        writer.WriteBits(tank.player, playerBits);
+        const NetTank* baseTank = MatchTank(baseline, tank.player, baseTankCursor, baseBulletStart);
+        if (baseTank != nullptr)
+        {
+            WritePosition(writer, tank.x, baseTank->x, tankDeltaBits);
+            WritePosition(writer, tank.y, baseTank->y, tankDeltaBits);
+            WriteAngle(writer, tank.bodyAngle, baseTank->bodyAngle);
+            WriteAngle(writer, tank.turretAngle, baseTank->turretAngle);
+        }
+        else
+        {
+            writer.WriteSigned(tank.x, NET_POSITION_BITS);
+            writer.WriteSigned(tank.y, NET_POSITION_BITS);
+            writer.WriteBits(tank.bodyAngle, NET_ANGLE_BITS);
+            writer.WriteBits(tank.turretAngle, NET_ANGLE_BITS);
+        }
+
+        writer.WriteBits(tank.bulletCount, countBits);
+        const NetBullet* baseBullets = baseTank != nullptr ? baseline->bullets.data() + baseBulletStart : nullptr;
+        size_t baseBulletCount = baseTank != nullptr ? baseTank->bulletCount : 0;
+        size_t baseBulletCursor = 0;
+        for (size_t i = 0; i < tank.bulletCount; ++i)
+        {
+            const NetBullet& bullet = snapshot.bullets[bulletStart + i];
+            uint16_t gap = static_cast<uint16_t>(bullet.id - (i > 0 ? snapshot.bullets[bulletStart + i - 1].id : 0));
+            bool smallGap = i > 0 && gap < (1u << idGapBits);
+            if (i > 0)
+            {
+                writer.WriteBool(smallGap);
+            }
+            writer.WriteBits(smallGap ? gap : bullet.id, smallGap ? idGapBits : 16);
+
+            const NetBullet* baseBullet = MatchBullet(baseBullets, baseBulletCount, bullet.id, baseBulletCursor);
+            if (baseBullet != nullptr)
+            {
+                WritePosition(writer, bullet.x, baseBullet->x, bulletDeltaBits);
+                WritePosition(writer, bullet.y, baseBullet->y, bulletDeltaBits);
+                WriteAngle(writer, bullet.angle, baseBullet->angle);
+            }
+            else
+            {
+                writer.WriteSigned(bullet.x, NET_POSITION_BITS);
+                writer.WriteSigned(bullet.y, NET_POSITION_BITS);
+                writer.WriteBits(bullet.angle, NET_ANGLE_BITS);
+            }
+        }
+        bulletStart += tank.bulletCount;
+    }
+}
+
+// Mirror of EncodeSnapshot, matching baseline entities the same way the encoder did
+bool DecodeSnapshot(BitReader& reader, const NetSnapshot* baseline, NetSnapshot& snapshot)
+{
+    snapshot.tanks.clear();
+    snapshot.bullets.clear();
+
+    uint32_t tankCount = reader.ReadBits(playerBits);
+    size_t baseTankCursor = 0;
+    size_t baseBulletStart = 0;
+    for (uint32_t t = 0; t < tankCount && !reader.HasOverflowed(); ++t)
+    {
+        NetTank tank;
+        tank.player = static_cast<uint8_t>(reader.ReadBits(playerBits));
+        const NetTank* baseTank = MatchTank(baseline, tank.player, baseTankCursor, baseBulletStart);
+        if (baseTank != nullptr)
+        {
+            tank.x = ReadPosition(reader, baseTank->x, tankDeltaBits);
+            tank.y = ReadPosition(reader, baseTank->y, tankDeltaBits);
+            tank.bodyAngle = ReadAngle(reader, baseTank->bodyAngle);
+            tank.turretAngle = ReadAngle(reader, baseTank->turretAngle);
+        }
+        else
+        {
+            tank.x = reader.ReadSigned(NET_POSITION_BITS);
+            tank.y = reader.ReadSigned(NET_POSITION_BITS);
+            tank.bodyAngle = static_cast<uint16_t>(reader.ReadBits(NET_ANGLE_BITS));
+            tank.turretAngle = static_cast<uint16_t>(reader.ReadBits(NET_ANGLE_BITS));
+        }
+
+        tank.bulletCount = static_cast<uint16_t>(reader.ReadBits(countBits));
+        const NetBullet* baseBullets = baseTank != nullptr ? baseline->bullets.data() + baseBulletStart : nullptr;
+        size_t baseBulletCount = baseTank != nullptr ? baseTank->bulletCount : 0;
+        size_t baseBulletCursor = 0;
+        uint16_t previousId = 0;
+        for (size_t i = 0; i < tank.bulletCount && !reader.HasOverflowed(); ++i)
+        {
+            NetBullet bullet;
+            bool smallGap = i > 0 && reader.ReadBool();
+            if (smallGap)
+            {
+                bullet.id = static_cast<uint16_t>(previousId + reader.ReadBits(idGapBits));
+            }
+            else
+            {
+                bullet.id = static_cast<uint16_t>(reader.ReadBits(16));
+            }
+            previousId = bullet.id;
+
+            const NetBullet* baseBullet = MatchBullet(baseBullets, baseBulletCount, bullet.id, baseBulletCursor);
+            if (baseBullet != nullptr)
+            {
+                bullet.x = ReadPosition(reader, baseBullet->x, bulletDeltaBits);
+                bullet.y = ReadPosition(reader, baseBullet->y, bulletDeltaBits);
+                bullet.angle = ReadAngle(reader, baseBullet->angle);
+            }
+            else
+            {
+                bullet.x = reader.ReadSigned(NET_POSITION_BITS);
+                bullet.y = reader.ReadSigned(NET_POSITION_BITS);
+                bullet.angle = static_cast<uint16_t>(reader.ReadBits(NET_ANGLE_BITS));
+            }
+            snapshot.bullets.push_back(bullet);
+        }
+        snapshot.tanks.push_back(tank);
+    }
+    return !reader.HasOverflowed();
+}
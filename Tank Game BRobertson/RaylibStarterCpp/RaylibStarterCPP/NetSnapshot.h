@@ -0,0 +1,72 @@
+#pragma once
+#include "BitStream.h"
+#include <cstdint>
+#include <vector>
+
+// Positions travel in eighths of a pixel and angles in 65536ths of a turn
+// 20 bits of position covers +-65536 pixels, far past any arena, and is only sent when a delta does not fit
+const float NET_POSITION_SCALE = 8.0f;
+const int NET_POSITION_BITS = 20;
+const int NET_ANGLE_BITS = 16;
+
+// Most players a server accepts, limited by the 7-bit player and tank count fields
+const int NET_MAX_PLAYERS = 64;
+
+// Packet layouts, every packet starts with an 8-bit NetMessage:
+//   Connect   client to server, asks for a tank
+//   Welcome   server to client: uint8 player
+//   Reject    server to client, the server is full
+//   Input     client to server: uint32 newest snapshot tick received, uint8 TankInput buttons
+//   Snapshot  server to client: uint32 tick, uint32 baseline tick (0 for none), EncodeSnapshot body
+//   RollbackInput  peer to peer: uint32 newest remote tick received + 1 (0 for none), uint32 first tick,
+//                  uint8 count, count x uint8 TankInput buttons
+enum NetMessage : uint8_t
+{
+    NET_CONNECT = 1,
+    NET_WELCOME = 2,
+    NET_REJECT = 3,
+    NET_INPUT = 4,
+    NET_SNAPSHOT = 5,
+    NET_ROLLBACK_INPUT = 6
+};
+
+// One player's tank as sent over the network
+struct NetTank
+{
+    uint8_t player;        // Player index assigned by the server
+    int32_t x, y;          // Quantised centre
+    uint16_t bodyAngle;    // Quantised body rotation
+    uint16_t turretAngle;  // Quantised turret rotation, relative to the body
+    uint16_t bulletCount;  // Number of this tank's bullets that follow the previous tank's in NetSnapshot::bullets
+};
+
+// One bullet as sent over the network
+struct NetBullet
+{
+    uint16_t id;     // Per-tank id in firing order, wrapping at 65536
+    int32_t x, y;    // Quantised centre
+    uint16_t angle;  // Quantised rendering rotation, which also gives the direction of travel
+};
+
+// Quantised world state at the end of a server tick, the tick itself travels in the packet header
+// Tanks are sorted by player, and each tank's bullets are sorted by id, so snapshots can be merged in one pass.
+struct NetSnapshot
+{
+    uint32_t tick;
+    std::vector<NetTank> tanks;
+    std::vector<NetBullet> bullets;
+};
+
+int32_t QuantisePosition(float position);
+float DequantisePosition(int32_t position);
+
+// Wraps any angle in degrees onto a full turn
+uint16_t QuantiseAngle(float degrees);
+float DequantiseAngle(uint16_t angle);
+
+// Writes a snapshot, sending only what changed since the baseline when there is one
+// The receiver must decode against the same baseline, so the sender only uses snapshots the receiver acknowledged.
+void EncodeSnapshot(const NetSnapshot& snapshot, const NetSnapshot* baseline, BitWriter& writer);
+
+// Reads a snapshot written by EncodeSnapshot against the same baseline, returns false if the data is truncated
+bool DecodeSnapshot(BitReader& reader, const NetSnapshot* baseline, NetSnapshot& snapshot);
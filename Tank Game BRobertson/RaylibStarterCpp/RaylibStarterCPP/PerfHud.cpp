@@ -0,0 +1,143 @@
+#include "PerfHud.h"
+#include "raygui.h"
+#include <algorithm>
+
+namespace
+{
+    const float hudWidth = 300.0f;
+    const float hudHeight = 210.0f;
+    const float lineHeight = 20.0f;
+}
+
+// Constructor converting the frame rate into a per-frame budget
+PerfHud::PerfHud(int targetFps)
+    : targetFrameMs(1000.0f / targetFps)
+{
+}
+
+// Flip visibility
+void PerfHud::Toggle()
+{
+    visible = !visible;
+}
+
+// Check if the overlay is shown
+bool PerfHud::IsVisible() const
+{
+    return visible;
+}
+
+// Push the frame into every history and refresh the percentiles
+void PerfHud::RecordFrame(float frameMs, const PhaseTimings& timings, const PerfCounts& frameCounts, uint64_t totalAllocations, const PoolStats& poolStats)
+{
+    frameTimes.Push(frameMs);
+    updateTimes.Push(timings.updateMs);
+    cullTimes.Push(timings.cullMs);
+    drawTimes.Push(timings.drawMs);
+
+    // The first frame has no previous total to compare against
+    uint64_t allocations = lastAllocations != 0 ? totalAllocations - lastAllocations : 0;
+    lastAllocations = totalAllocations;
+    allocationTotal = totalAllocations;
+    frameAllocations.Push(static_cast<uint32_t>(allocations));
+
+    counts = frameCounts;
+    pool = poolStats;
+    p50 = GetFramePercentile(50.0f);
+    p95 = GetFramePercentile(95.0f);
+    p99 = GetFramePercentile(99.0f);
+}
+
+// Sorts a copy of the history on the stack, 240 floats is cheap enough to do every frame
+float PerfHud::GetFramePercentile(float percentile) const
+{
+    int count = frameTimes.GetCount();
+    if (count == 0)
+    {
+        return 0.0f;
+    }
+
+    float sorted[PERF_HUD_HISTORY];
+    for (int i = 0; i < count; ++i)
+    {
+        sorted[i] = frameTimes.Get(i);
+    }
+    int rank = std::min(count - 1, static_cast<int>(percentile / 100.0f * count));
+    std::nth_element(sorted, sorted + rank, sorted + count);
+    return sorted[rank];
+}
+
+// Panel with the graph on top and one label per stat line below it
+void PerfHud::Draw(float x, float y) const
+{
+    if (!visible)
+    {
+        return;
+    }
+
+    GuiPanel({ x, y, hudWidth, hudHeight });
+    DrawGraph({ x + 10.0f, y + 10.0f, hudWidth - 20.0f, 60.0f });
+
+    uint32_t peakAllocations = 0;
+    for (int i = 0; i < frameAllocations.GetCount(); ++i)
+    {
+        peakAllocations = std::max(peakAllocations, frameAllocations.Get(i));
+    }
+
+    float line = y + 75.0f;
+    float frameMs = frameTimes.IsEmpty() ? 0.0f : frameTimes.Latest();
+    GuiLabel({ x + 10.0f, line, hudWidth - 20.0f, lineHeight }, TextFormat("Frame %.2f ms (%d fps)", frameMs, GetFPS()));
+    line += lineHeight;
+    GuiLabel({ x + 10.0f, line, hudWidth - 20.0f, lineHeight }, TextFormat("p50 %.2f  p95 %.2f  p99 %.2f ms", p50, p95, p99));
+    line += lineHeight;
+    GuiLabel({ x + 10.0f, line, hudWidth - 20.0f, lineHeight }, TextFormat("Update %.3f  Cull %.3f  Draw %.3f ms",
+        Average(updateTimes), Average(cullTimes), Average(drawTimes)));
+    line += lineHeight;
+    GuiLabel({ x + 10.0f, line, hudWidth - 20.0f, lineHeight }, TextFormat("Tanks %d  Bullets %d  Targets %d  Walls %d",
+        counts.tanks, counts.bullets, counts.targets, counts.walls));
+    line += lineHeight;
+    GuiLabel({ x + 10.0f, line, hudWidth - 20.0f, lineHeight }, TextFormat("Allocs %u this frame, peak %u, total %llu",
+        frameAllocations.IsEmpty() ? 0u : frameAllocations.Latest(), peakAllocations, (unsigned long long)allocationTotal));
+    line += lineHeight;
+    GuiLabel({ x + 10.0f, line, hudWidth - 20.0f, lineHeight }, TextFormat("Pool %u/%u KB  frag %d%%  overflows %llu",
+        (unsigned)(pool.usedBytes / 1024), (unsigned)(pool.capacityBytes / 1024), (int)(pool.fragmentation * 100.0f),
+        (unsigned long long)pool.overflows));
+}
+
+// One bar per frame, oldest on the left, coloured by how far over the frame budget it ran
+void PerfHud::DrawGraph(Rectangle bounds) const
+{
+    DrawRectangleRec(bounds, Fade(BLACK, 0.6f));
+
+    float scaleMs = targetFrameMs * 2.0f;
+    for (int i = 0; i < frameTimes.GetCount(); ++i)
+    {
+        scaleMs = std::max(scaleMs, frameTimes.Get(i));
+    }
+
+    float barWidth = bounds.width / PERF_HUD_HISTORY;
+    float budgetY = bounds.y + bounds.height - bounds.height * (targetFrameMs / scaleMs);
+    for (int i = 0; i < frameTimes.GetCount(); ++i)
+    {
+        float frameMs = frameTimes.Get(i);
+        float height = bounds.height * (frameMs / scaleMs);
+        Color color = frameMs <= targetFrameMs ? GREEN : (frameMs <= targetFrameMs * 2.0f ? ORANGE : RED);
+        DrawRectangleRec({ bounds.x + i * barWidth, bounds.y + bounds.height - height, barWidth, height }, color);
+    }
+    DrawLineV({ bounds.x, budgetY }, { bounds.x + bounds.width, budgetY }, WHITE);
+}
+
+// Mean of every value in a history
+float PerfHud::Average(const RingBuffer<float, PERF_HUD_HISTORY>& history)
+{
+    if (history.IsEmpty())
+    {
+        return 0.0f;
+    }
+    float total = 0.0f;
+    for (int i = 0; i < history.GetCount(); ++i)
+    {
+        total += history.Get(i);
+    }
+    return total / history.GetCount();
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "raylib.h"
+#include "Pool.h"
+#include "RingBuffer.h"
+#include "Simulation.h"
+#include <cstdint>
+
+const int PERF_HUD_HISTORY = 240;
+
+// Entity totals shown by the HUD
+struct PerfCounts
+{
+    int tanks;
+    int bullets;
+    int targets;
+    int walls;
+};
+
+// Toggleable overlay with a frame-time graph, percentiles, phase timings, entity counts, allocations and pool usage
+// All history is kept in fixed ring buffers, so recording and drawing never touch the heap.
+class PerfHud
+{
+public:
+    // Frame bars are coloured against the budget of one frame at targetFps, the rate passed to SetTargetFPS
+    explicit PerfHud(int targetFps);
+
+    // Shows or hides the overlay, recording continues either way so the graph is full when it opens
+    void Toggle();
+    bool IsVisible() const;
+
+    // Adds one frame to the history
+    // totalAllocations is the running AllocationCounter total, the per-frame count is derived from it
+    void RecordFrame(float frameMs, const PhaseTimings& timings, const PerfCounts& counts, uint64_t totalAllocations, const PoolStats& poolStats);
+
+    // Draws the overlay with its top-left corner at x, y
+    void Draw(float x, float y) const;
+
+    // Returns the frame time at a percentile (0 to 100) of the recorded history
+    float GetFramePercentile(float percentile) const;
+
+private:
+    // Draws the frame-time history as a bar graph inside bounds
+    void DrawGraph(Rectangle bounds) const;
+
+    // Averages a phase over the history
+    static float Average(const RingBuffer<float, PERF_HUD_HISTORY>& history);
+
+    float targetFrameMs;
+    bool visible = false;
+    RingBuffer<float, PERF_HUD_HISTORY> frameTimes;
+    RingBuffer<float, PERF_HUD_HISTORY> updateTimes;
+    RingBuffer<float, PERF_HUD_HISTORY> cullTimes;
+    RingBuffer<float, PERF_HUD_HISTORY> drawTimes;
+    RingBuffer<uint32_t, PERF_HUD_HISTORY> frameAllocations;
+    PerfCounts counts = {};
+    PoolStats pool = {};
+    uint64_t lastAllocations = 0;
+    uint64_t allocationTotal = 0;
+    float p50 = 0.0f, p95 = 0.0f, p99 = 0.0f; // Updated once per recorded frame
+};
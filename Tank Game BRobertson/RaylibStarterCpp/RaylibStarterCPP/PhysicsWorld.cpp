@@ -0,0 +1,230 @@
+#include "PhysicsWorld.h"
+#include "Profiler.h"
+#include <chrono>
+#include <cmath>
+
+// Helpers built alongside physac in physac.c, where the body struct is visible
+extern "C"
+{
+    void StepPhysicsFixed(void);
+    void MakePhysicsBodyStatic(PhysicsBody body);
+    void GetPhysicsBodyMotion(PhysicsBody body, Vector2* position, float* orient, Vector2* velocity);
+    void SetPhysicsBodyVelocity(PhysicsBody body, Vector2 velocity, float angularVelocity);
+    void SetPhysicsBodyPosition(PhysicsBody body, Vector2 position);
+}
+
+namespace
+{
+    // physac integrates in milliseconds, the game works in seconds
+    const float millisecondsPerSecond = 1000.0f;
+
+    // How many steps the thread may fall behind before it drops the backlog instead of catching up
+    const int maxCatchUpSteps = 4;
+}
+
+// Constructor configuring physac for a top-down arena with no gravity
+PhysicsWorld::PhysicsWorld(float stepsPerSecond)
+    : stepMs(millisecondsPerSecond / stepsPerSecond), stepCount(0), front(0), running(false), stepNanoseconds(0), timedSteps(0)
+{
+    InitPhysics();
+    SetPhysicsGravity(0.0f, 0.0f);
+    SetPhysicsTimeStep(stepMs);
+    dynamicBodies.reserve(PHYSAC_MAX_BODIES);
+    frames[0].step = 0;
+    frames[1].step = 0;
+}
+
+// Join the thread before physac's bodies are freed underneath it
+PhysicsWorld::~PhysicsWorld()
+{
+    Stop();
+    ClosePhysics();
+}
+
+// The body starts at rest, facing the given heading
+int PhysicsWorld::AddDynamicBox(Vector2 centre, float width, float height, float rotation)
+{
+    if (running || GetPhysicsBodiesCount() >= PHYSAC_MAX_BODIES)
+    {
+        return -1;
+    }
+
+    PhysicsBody body = CreatePhysicsBodyRectangle(centre, width, height, 1.0f);
+    SetPhysicsBodyRotation(body, rotation * DEG2RAD);
+    dynamicBodies.push_back(body);
+
+    Command command = {};
+    pending.push_back(command);
+    active.push_back(command);
+
+    PhysicsBodyState state = { centre, rotation, { 0.0f, 0.0f } };
+    frames[0].states.push_back(state);
+    frames[1].states.push_back(state);
+    return static_cast<int>(dynamicBodies.size()) - 1;
+}
+
+// Obstacles never move, so they are not part of the published frames
+bool PhysicsWorld::AddStaticBox(const Rectangle& box)
+{
+    if (running || GetPhysicsBodiesCount() >= PHYSAC_MAX_BODIES)
+    {
+        return false;
+    }
+
+    Vector2 centre = { box.x + box.width / 2.0f, box.y + box.height / 2.0f };
+    MakePhysicsBodyStatic(CreatePhysicsBodyRectangle(centre, box.width, box.height, 1.0f));
+    return true;
+}
+
+// Launch the fixed-rate loop
+void PhysicsWorld::Start()
+{
+    if (running)
+    {
+        return;
+    }
+    running = true;
+    thread = std::thread(&PhysicsWorld::ThreadLoop, this);
+}
+
+// Ask the loop to finish its current step, then wait for it
+void PhysicsWorld::Stop()
+{
+    running = false;
+    if (thread.joinable())
+    {
+        thread.join();
+    }
+}
+
+// Check if the physics thread is stepping
+bool PhysicsWorld::IsRunning() const
+{
+    return running;
+}
+
+// Step synchronously, for benchmarks and tools that have no thread running
+void PhysicsWorld::Step()
+{
+    if (!running)
+    {
+        RunStep();
+    }
+}
+
+// Replace a body's drive, the physics thread picks it up at its next step
+void PhysicsWorld::SetDrive(int body, const PhysicsDrive& drive)
+{
+    std::lock_guard<std::mutex> lock(commandMutex);
+    pending[body].drive = drive;
+}
+
+// Queue a teleport for the next step
+void PhysicsWorld::SetPose(int body, Vector2 position, float rotation)
+{
+    std::lock_guard<std::mutex> lock(commandMutex);
+    pending[body].teleport = true;
+    pending[body].position = position;
+    pending[body].rotation = rotation;
+}
+
+// Copy the front frame, the thread only ever writes the back one
+uint32_t PhysicsWorld::Read(std::vector<PhysicsBodyState>& states) const
+{
+    std::lock_guard<std::mutex> lock(frameMutex);
+    const Frame& frame = frames[front];
+    states.assign(frame.states.begin(), frame.states.end());
+    return frame.step;
+}
+
+// Get the number of bodies that have published states
+int PhysicsWorld::GetDynamicCount() const
+{
+    return static_cast<int>(dynamicBodies.size());
+}
+
+// Get the mean time spent inside a step
+float PhysicsWorld::GetAverageStepMs() const
+{
+    uint32_t steps = timedSteps;
+    return steps > 0 ? static_cast<float>(stepNanoseconds / steps) / 1000000.0f : 0.0f;
+}
+
+// Step on a fixed schedule, sleeping between steps rather than spinning like physac's own loop
+void PhysicsWorld::ThreadLoop()
+{
+    auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(stepMs));
+    auto next = std::chrono::steady_clock::now();
+    while (running)
+    {
+        RunStep();
+
+        next += period;
+        auto now = std::chrono::steady_clock::now();
+        if (now > next + period * maxCatchUpSteps)
+        {
+            // Stalled (a breakpoint, or a step far over budget), so resume from now rather than bursting
+            next = now;
+        }
+        std::this_thread::sleep_until(next);
+    }
+}
+
+// Apply drives, advance physac by one step, then fill the back frame and swap it to the front
+void PhysicsWorld::RunStep()
+{
+    PROFILE_SCOPE("Physics::Step");
+    uint64_t startNs = Profiler::NowNs();
+
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        active.assign(pending.begin(), pending.end());
+        for (Command& command : pending)
+        {
+            command.teleport = false;
+        }
+    }
+
+    for (size_t i = 0; i < dynamicBodies.size(); ++i)
+    {
+        PhysicsBody body = dynamicBodies[i];
+        const Command& command = active[i];
+        if (command.teleport)
+        {
+            SetPhysicsBodyPosition(body, command.position);
+            SetPhysicsBodyRotation(body, command.rotation * DEG2RAD);
+        }
+
+        // Forward is the way the tank drives when W is held, (-sin, cos) of its heading
+        Vector2 position;
+        float orient;
+        Vector2 velocity;
+        GetPhysicsBodyMotion(body, &position, &orient, &velocity);
+        float speed = command.drive.forwardSpeed / millisecondsPerSecond;
+        Vector2 forward = { -sinf(orient) * speed, cosf(orient) * speed };
+        SetPhysicsBodyVelocity(body, forward, command.drive.turnRate * DEG2RAD / millisecondsPerSecond);
+    }
+
+    StepPhysicsFixed();
+    stepCount++;
+
+    Frame& back = frames[1 - front];
+    back.step = stepCount;
+    for (size_t i = 0; i < dynamicBodies.size(); ++i)
+    {
+        PhysicsBodyState& state = back.states[i];
+        float orient;
+        GetPhysicsBodyMotion(dynamicBodies[i], &state.position, &orient, &state.velocity);
+        state.rotation = orient * RAD2DEG;
+        state.velocity.x *= millisecondsPerSecond;
+        state.velocity.y *= millisecondsPerSecond;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        front = 1 - front;
+    }
+
+    stepNanoseconds += Profiler::NowNs() - startNs;
+    timedSteps++;
+}
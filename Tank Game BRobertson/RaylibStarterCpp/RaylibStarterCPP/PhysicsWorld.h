@@ -0,0 +1,111 @@
+#pragma once
+#include "raylib.h"
+#include "physac.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Where a dynamic body ended up after a physics step
+struct PhysicsBodyState
+{
+    Vector2 position;  // Centre of the body
+    float rotation;    // Heading in degrees, the same convention as Tank's body rotation
+    Vector2 velocity;  // Pixels per second
+};
+
+// Movement requested for a dynamic body, applied at the start of every step until it is changed
+struct PhysicsDrive
+{
+    float forwardSpeed; // Pixels per second along the body's forward axis, negative to reverse
+    float turnRate;     // Degrees per second, negative to turn left
+};
+
+// Rigid bodies for tanks and obstacles, simulated by physac at a fixed rate on a dedicated thread
+// physac keeps its bodies in globals, so only one world can exist at a time and it holds at most
+// PHYSAC_MAX_BODIES bodies. Bodies are added before Start, after which only the physics thread calls
+// into physac. Drives go in through a locked command list, and results come back through two frames:
+// the thread fills the back frame and swaps it to the front, and readers copy the front frame.
+class PhysicsWorld
+{
+public:
+    explicit PhysicsWorld(float stepsPerSecond = 120.0f);
+
+    // Stops the thread and destroys every physac body
+    ~PhysicsWorld();
+
+    PhysicsWorld(const PhysicsWorld&) = delete;
+    PhysicsWorld& operator=(const PhysicsWorld&) = delete;
+
+    // Adds a body that moves, returns its index in the published states or -1 when physac is full
+    int AddDynamicBox(Vector2 centre, float width, float height, float rotation);
+
+    // Adds an immovable axis-aligned box, returns false when physac is full
+    bool AddStaticBox(const Rectangle& box);
+
+    // Starts stepping on the physics thread
+    void Start();
+
+    // Stops the physics thread, the last published frame stays readable
+    void Stop();
+
+    bool IsRunning() const;
+
+    // Runs one step on the calling thread and publishes it, only valid while the thread is stopped
+    void Step();
+
+    // Sets the movement a dynamic body keeps applying from the next step on
+    void SetDrive(int body, const PhysicsDrive& drive);
+
+    // Moves a dynamic body without simulating the path in between, such as after loading a snapshot
+    void SetPose(int body, Vector2 position, float rotation);
+
+    // Copies the latest published states, one per dynamic body, and returns the step they are from
+    uint32_t Read(std::vector<PhysicsBodyState>& states) const;
+
+    int GetDynamicCount() const;
+
+    // Average time the physics thread spent inside a step, excluding the time it slept
+    float GetAverageStepMs() const;
+
+private:
+    // Drive and pending teleport for one dynamic body
+    struct Command
+    {
+        PhysicsDrive drive;
+        bool teleport;
+        Vector2 position;
+        float rotation;
+    };
+
+    // States published after one step
+    struct Frame
+    {
+        uint32_t step;
+        std::vector<PhysicsBodyState> states;
+    };
+
+    // Fixed-rate loop run on the physics thread
+    void ThreadLoop();
+
+    // Takes the latest commands, steps physac once and publishes the result
+    void RunStep();
+
+    float stepMs;
+    std::vector<PhysicsBody> dynamicBodies;
+    uint32_t stepCount;
+
+    std::vector<Command> pending;  // Written by the main thread under commandMutex
+    std::vector<Command> active;   // The physics thread's copy for the current step
+    mutable std::mutex commandMutex;
+
+    Frame frames[2];
+    int front;                     // Index of the frame readers copy, swapped under frameMutex
+    mutable std::mutex frameMutex;
+
+    std::thread thread;
+    std::atomic<bool> running;
+    std::atomic<uint64_t> stepNanoseconds;
+    std::atomic<uint32_t> timedSteps;
+};
@@ -0,0 +1,225 @@
+#include "Pool.h"
+#include "AllocationCounter.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    // rmem keeps a MemNode header directly in front of every block it hands out
+    const MemNode* GetNode(const void* pointer)
+    {
+        return reinterpret_cast<const MemNode*>(static_cast<const uint8_t*>(pointer) - sizeof(MemNode));
+    }
+
+    // Zeroed heap memory for an allocation that did not fit, counted like any other
+    void* AllocateOverflow(size_t size)
+    {
+        void* memory = AllocationCounter::Allocate(size);
+        if (memory != nullptr)
+        {
+            memset(memory, 0, size);
+        }
+        return memory;
+    }
+}
+
+// rmem only takes a buffer whose slot size is already a multiple of size_t, and each free slot holds a size_t
+ObjPool CreateCountedObjPool(size_t objectSize, size_t count)
+{
+    size_t slotSize = (std::max(objectSize, sizeof(size_t)) + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1);
+    return CreateObjPoolFromBuffer(AllocationCounter::Allocate(slotSize * count), slotSize, count);
+}
+
+// rmem's DestroyObjPool would free the block behind the counter's back
+void DestroyCountedObjPool(ObjPool& pool)
+{
+    AllocationCounter::Free(pool.stack.mem);
+    pool = ObjPool();
+}
+
+// Constructor reserving the whole pool up front
+MemoryPool::MemoryPool(size_t capacity)
+    : pool(CreateMemPoolFromBuffer(AllocationCounter::Allocate(capacity), capacity)), used(0), peak(0), allocations(0), overflows(0), overflowBytes(0)
+{
+}
+
+// Release the pool's block, anything still allocated from it becomes invalid
+MemoryPool::~MemoryPool()
+{
+    AllocationCounter::Free(pool.stack.mem);
+}
+
+// Allocate from the pool, falling back to the heap when nothing fits
+void* MemoryPool::Allocate(size_t size)
+{
+    allocations++;
+    void* memory = MemPoolAlloc(&pool, size);
+    if (memory == nullptr)
+    {
+        overflows++;
+        overflowBytes += size;
+        return AllocateOverflow(size);
+    }
+
+    used += GetNode(memory)->size;
+    if (used > peak)
+    {
+        peak = used;
+    }
+    return memory;
+}
+
+// Hand a block back to whichever allocator it came from
+void MemoryPool::Free(void* pointer)
+{
+    if (pointer == nullptr)
+    {
+        return;
+    }
+    if (!Owns(pointer))
+    {
+        AllocationCounter::Free(pointer);
+        return;
+    }
+    used -= GetNode(pointer)->size;
+    MemPoolFree(&pool, pointer);
+}
+
+// Check if a pointer lies inside the pool's block
+bool MemoryPool::Owns(const void* pointer) const
+{
+    const uint8_t* address = static_cast<const uint8_t*>(pointer);
+    return pool.stack.mem != nullptr && address >= pool.stack.mem && address < pool.stack.mem + pool.stack.size;
+}
+
+// Everything below the stack base has never been handed out, the rest of the free space sits in
+// the free list and the small-size buckets
+PoolStats MemoryPool::GetStats() const
+{
+    PoolStats stats = {};
+    stats.capacityBytes = pool.stack.size;
+    stats.usedBytes = used;
+    stats.peakUsedBytes = peak;
+    stats.allocations = allocations;
+    stats.overflows = overflows;
+    stats.overflowBytes = overflowBytes;
+
+    size_t untouched = static_cast<size_t>(pool.stack.base - pool.stack.mem);
+    stats.freeBytes = untouched;
+    stats.largestFreeBlock = untouched;
+    for (const MemNode* node = pool.freeList.head; node != nullptr; node = node->next)
+    {
+        stats.freeBytes += node->size;
+        stats.freeListLength++;
+        if (node->size > stats.largestFreeBlock)
+        {
+            stats.largestFreeBlock = node->size;
+        }
+    }
+    for (int i = 0; i < MEMPOOL_BUCKET_SIZE; ++i)
+    {
+        for (const MemNode* node = pool.buckets[i]; node != nullptr; node = node->next)
+        {
+            stats.freeBytes += node->size;
+            stats.freeListLength++;
+            if (node->size > stats.largestFreeBlock)
+            {
+                stats.largestFreeBlock = node->size;
+            }
+        }
+    }
+
+    if (stats.freeBytes > 0)
+    {
+        stats.fragmentation = 1.0f - static_cast<float>(stats.largestFreeBlock) / static_cast<float>(stats.freeBytes);
+    }
+    return stats;
+}
+
+// Constructor reserving every class up front
+SizeClassPool::SizeClassPool(size_t blocksPerClass)
+    : used(0), peak(0), allocations(0), overflows(0), overflowBytes(0)
+{
+    for (int i = 0; i < classCount; ++i)
+    {
+        pools[i] = CreateCountedObjPool(smallestClass << i, blocksPerClass);
+    }
+}
+
+// Release every class, anything still allocated from them becomes invalid
+SizeClassPool::~SizeClassPool()
+{
+    for (ObjPool& pool : pools)
+    {
+        DestroyCountedObjPool(pool);
+    }
+}
+
+// Take a slot from the smallest class that fits, falling back to the heap
+void* SizeClassPool::Allocate(size_t size)
+{
+    allocations++;
+    int index = 0;
+    while (index < classCount && (smallestClass << index) < size)
+    {
+        index++;
+    }
+
+    void* memory = index < classCount ? ObjPoolAlloc(&pools[index]) : nullptr;
+    if (memory == nullptr)
+    {
+        overflows++;
+        overflowBytes += size;
+        return AllocateOverflow(size);
+    }
+
+    used += pools[index].objSize;
+    if (used > peak)
+    {
+        peak = used;
+    }
+    return memory;
+}
+
+// Find the class that owns the block by address, anything else came from the heap
+void SizeClassPool::Free(void* pointer)
+{
+    if (pointer == nullptr)
+    {
+        return;
+    }
+    const uint8_t* address = static_cast<const uint8_t*>(pointer);
+    for (ObjPool& pool : pools)
+    {
+        if (pool.stack.mem != nullptr && address >= pool.stack.mem && address < pool.stack.mem + pool.stack.size * pool.objSize)
+        {
+            used -= pool.objSize;
+            ObjPoolFree(&pool, pointer);
+            return;
+        }
+    }
+    AllocationCounter::Free(pointer);
+}
+
+// Sum the classes, the largest free block is the biggest class with a slot left
+PoolStats SizeClassPool::GetStats() const
+{
+    PoolStats stats = {};
+    stats.usedBytes = used;
+    stats.peakUsedBytes = peak;
+    stats.allocations = allocations;
+    stats.overflows = overflows;
+    stats.overflowBytes = overflowBytes;
+    for (const ObjPool& pool : pools)
+    {
+        stats.capacityBytes += pool.stack.size * pool.objSize;
+        stats.freeBytes += pool.freeBlocks * pool.objSize;
+        stats.freeListLength += pool.freeBlocks;
+        if (pool.freeBlocks > 0)
+        {
+            stats.largestFreeBlock = pool.objSize;
+        }
+    }
+    stats.fragmentation = 0.0f;
+    return stats;
+}
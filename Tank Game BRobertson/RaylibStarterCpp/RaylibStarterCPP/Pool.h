@@ -0,0 +1,237 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+#include "rmem.h"
+
+// Pooled allocation for entities, built on raylib's rmem MemPool and ObjPool
+// Every pool reserves its memory up front. Allocations that do not fit fall back to the global heap
+// and are counted as overflows, so an undersized pool shows up in the stats instead of failing.
+// Backing blocks and overflows both come from AllocationCounter, so pooled memory shows up in the
+// heap counters that the HUD and benchmarks read.
+// None of the pools are thread safe, each one belongs to a single simulation.
+
+// Usage counters for a pool, gathered on demand by GetStats
+struct PoolStats
+{
+    size_t capacityBytes;     // Size of the pool's backing block
+    size_t usedBytes;         // Bytes handed out, including per-block headers
+    size_t peakUsedBytes;     // Highest usedBytes so far
+    size_t freeBytes;         // Bytes still available inside the pool
+    size_t largestFreeBlock;  // Biggest single block that could still be handed out
+    size_t freeListLength;    // Freed blocks waiting to be reused
+    float fragmentation;      // 0 when the free bytes are one block, approaching 1 as they scatter
+    uint64_t allocations;     // Allocate calls since the pool was created
+    uint64_t overflows;       // Allocations that did not fit and went to the global heap
+    uint64_t overflowBytes;   // Bytes those allocations asked for
+};
+
+// ObjPool of count slots of at least objectSize bytes over a block from AllocationCounter
+// Returns an empty pool, which hands out nothing, when the block cannot be allocated
+ObjPool CreateCountedObjPool(size_t objectSize, size_t count);
+
+// Releases a pool from CreateCountedObjPool
+void DestroyCountedObjPool(ObjPool& pool);
+
+// Variable-size allocator over an rmem MemPool, for container storage that grows a few times and then stays
+// Freed blocks go to size buckets or a first-fit free list, and every free scans that list for double
+// frees, so heavy churn of many small blocks belongs in a SizeClassPool instead. The lists are never
+// merged because MemPoolDefrag in this rmem version drops blocks while merging.
+class MemoryPool
+{
+public:
+    explicit MemoryPool(size_t capacity);
+    ~MemoryPool();
+    MemoryPool(const MemoryPool&) = delete;
+    MemoryPool& operator=(const MemoryPool&) = delete;
+
+    // Returns zeroed memory aligned to 8 bytes, from the heap if the pool is full
+    void* Allocate(size_t size);
+
+    // Returns memory from Allocate to the pool or the heap, whichever it came from
+    void Free(void* pointer);
+
+    // Checks if a pointer lies inside the pool's block
+    bool Owns(const void* pointer) const;
+
+    // Walks the free lists to measure free space and fragmentation
+    PoolStats GetStats() const;
+
+private:
+    MemPool pool;
+    size_t used;
+    size_t peak;
+    uint64_t allocations;
+    uint64_t overflows;
+    uint64_t overflowBytes;
+};
+
+// Fixed-size pool of T over an rmem ObjPool, for entities created and destroyed one at a time
+// Free slots form an index list threaded through the slots themselves, so Create and Destroy are O(1).
+template <typename T>
+class ObjectPool
+{
+public:
+    static_assert(alignof(T) <= sizeof(size_t), "rmem only aligns pool slots to size_t");
+
+    explicit ObjectPool(size_t capacity)
+        : pool(CreateCountedObjPool(sizeof(T), capacity)), live(0), peak(0), allocations(0), overflows(0)
+    {
+    }
+
+    ~ObjectPool()
+    {
+        DestroyCountedObjPool(pool);
+    }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    // Constructs a T in a free slot, or on the heap when every slot is taken
+    template <typename... Args>
+    T* Create(Args&&... args)
+    {
+        void* memory = ObjPoolAlloc(&pool);
+        if (memory == nullptr)
+        {
+            memory = ::operator new(sizeof(T));
+            overflows++;
+        }
+        allocations++;
+        live++;
+        if (live > peak)
+        {
+            peak = live;
+        }
+        return new (memory) T(std::forward<Args>(args)...);
+    }
+
+    // Destroys an object from Create and frees its slot
+    void Destroy(T* object)
+    {
+        if (object == nullptr)
+        {
+            return;
+        }
+        object->~T();
+        if (Owns(object))
+        {
+            ObjPoolFree(&pool, object);
+        }
+        else
+        {
+            ::operator delete(object);
+        }
+        live--;
+    }
+
+    // Checks if a pointer lies inside the pool's slots
+    bool Owns(const void* pointer) const
+    {
+        const uint8_t* address = static_cast<const uint8_t*>(pointer);
+        return pool.stack.mem != nullptr && address >= pool.stack.mem && address < pool.stack.mem + pool.stack.size * pool.objSize;
+    }
+
+    // Number of objects currently alive, including any that overflowed to the heap
+    size_t GetLiveCount() const
+    {
+        return live;
+    }
+
+    // Slots are all the same size, so free space never fragments
+    PoolStats GetStats() const
+    {
+        PoolStats stats = {};
+        stats.capacityBytes = pool.stack.size * pool.objSize;
+        stats.freeBytes = pool.freeBlocks * pool.objSize;
+        stats.usedBytes = stats.capacityBytes - stats.freeBytes;
+        stats.peakUsedBytes = (peak < pool.stack.size ? peak : pool.stack.size) * pool.objSize;
+        stats.largestFreeBlock = pool.freeBlocks > 0 ? pool.objSize : 0;
+        stats.freeListLength = pool.freeBlocks;
+        stats.fragmentation = 0.0f;
+        stats.allocations = allocations;
+        stats.overflows = overflows;
+        stats.overflowBytes = overflows * sizeof(T);
+        return stats;
+    }
+
+private:
+    ObjPool pool;
+    size_t live;
+    size_t peak;
+    uint64_t allocations;
+    uint64_t overflows;
+};
+
+// Mixed-size transient objects, rounded up to power-of-two classes from 16 to 512 bytes
+// Each class is its own ObjPool, so allocation and free stay O(1) however long the churn runs.
+// Larger requests, and requests for a class that is full, go to the heap.
+class SizeClassPool
+{
+public:
+    static const int classCount = 6;
+    static const size_t smallestClass = 16;
+
+    explicit SizeClassPool(size_t blocksPerClass);
+    ~SizeClassPool();
+    SizeClassPool(const SizeClassPool&) = delete;
+    SizeClassPool& operator=(const SizeClassPool&) = delete;
+
+    // Returns zeroed memory aligned to 8 bytes
+    void* Allocate(size_t size);
+
+    // Returns memory from Allocate to its class, or to the heap
+    void Free(void* pointer);
+
+    // Totals over every class; slots in a class are all one size, so free space never fragments
+    PoolStats GetStats() const;
+
+private:
+    ObjPool pools[classCount];
+    size_t used;
+    size_t peak;
+    uint64_t allocations;
+    uint64_t overflows;
+    uint64_t overflowBytes;
+};
+
+// Standard allocator adapter so containers can keep their storage in a MemoryPool
+template <typename T>
+class PoolAllocator
+{
+public:
+    using value_type = T;
+
+    static_assert(alignof(T) <= sizeof(intptr_t), "MemPool only aligns blocks to intptr_t");
+
+    explicit PoolAllocator(MemoryPool& pool) : pool(&pool) {}
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& other) : pool(other.pool) {}
+
+    T* allocate(size_t count)
+    {
+        return static_cast<T*>(pool->Allocate(sizeof(T) * count));
+    }
+
+    void deallocate(T* pointer, size_t)
+    {
+        pool->Free(pointer);
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>& other) const { return pool == other.pool; }
+
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>& other) const { return pool != other.pool; }
+
+private:
+    template <typename U> friend class PoolAllocator;
+    MemoryPool* pool;
+};
+
+// A vector whose storage lives in a MemoryPool, which must outlive it
+template <typename T>
+using PoolVector = std::vector<T, PoolAllocator<T>>;
@@ -0,0 +1,123 @@
+#include "Profiler.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    // Events recorded by one thread, only ever written by that thread
+    struct ThreadBuffer
+    {
+        uint32_t threadIndex;
+        std::vector<ProfileEvent> events;
+        uint64_t dropped;
+    };
+
+    const size_t initialEventCapacity = 1 << 14;
+    const size_t maxEventsPerThread = 1 << 20;
+
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    std::atomic<uint32_t> frameIndex{ 0 };
+
+    // Every buffer ever created, kept alive so a thread can exit before export
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> registry;
+
+    thread_local ThreadBuffer* localBuffer = nullptr;
+
+    // Returns the calling thread's buffer, registering it on first use
+    ThreadBuffer& GetLocalBuffer()
+    {
+        if (localBuffer == nullptr)
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            registry.push_back(std::make_unique<ThreadBuffer>());
+            localBuffer = registry.back().get();
+            localBuffer->threadIndex = static_cast<uint32_t>(registry.size());
+            localBuffer->events.reserve(initialEventCapacity);
+            localBuffer->dropped = 0;
+        }
+        return *localBuffer;
+    }
+}
+
+// Nanoseconds since the profiler was first loaded
+uint64_t Profiler::NowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+// Advance the frame counter used to tag new events
+void Profiler::BeginFrame()
+{
+    frameIndex.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Get the frame counter
+uint32_t Profiler::GetFrameIndex()
+{
+    return frameIndex.load(std::memory_order_relaxed);
+}
+
+// Append a finished scope to this thread's buffer, dropping it once the buffer is full
+void Profiler::Record(const char* name, uint64_t startNs, uint64_t endNs)
+{
+    ThreadBuffer& buffer = GetLocalBuffer();
+    if (buffer.events.size() >= maxEventsPerThread)
+    {
+        buffer.dropped++;
+        return;
+    }
+    buffer.events.push_back({ name, startNs, endNs - startNs, GetFrameIndex() });
+}
+
+// Empty every thread's buffer while keeping their capacity
+void Profiler::Clear()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto& buffer : registry)
+    {
+        buffer->events.clear();
+        buffer->dropped = 0;
+    }
+}
+
+// Write complete ("X") events that chrome://tracing and ui.perfetto.dev can open
+bool Profiler::ExportChromeTrace(const char* fileName)
+{
+    FILE* file = fopen(fileName, "w");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (auto& buffer : registry)
+    {
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"Thread %u\"}}",
+            first ? "" : ",\n", buffer->threadIndex, buffer->threadIndex);
+        first = false;
+
+        for (const ProfileEvent& event : buffer->events)
+        {
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u}}",
+                event.name, buffer->threadIndex, event.startNs / 1000.0, event.durationNs / 1000.0, event.frame);
+        }
+
+        if (buffer->dropped > 0)
+        {
+            fprintf(stderr, "Profiler: thread %u dropped %llu events\n", buffer->threadIndex, (unsigned long long)buffer->dropped);
+        }
+    }
+    fprintf(file, "\n]}\n");
+
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    return ok;
+}
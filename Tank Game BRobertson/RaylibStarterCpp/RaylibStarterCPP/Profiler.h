@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+
+// Scoped frame profiler. Timing markers only exist when TANK_PROFILER is defined
+// (Debug configurations), otherwise PROFILE_SCOPE and PROFILE_FRAME compile to nothing.
+
+// A single timed scope recorded by one thread
+struct ProfileEvent
+{
+    const char* name;     // Static string naming the scope
+    uint64_t startNs;     // Start time in nanoseconds since the profiler epoch
+    uint64_t durationNs;  // Length of the scope in nanoseconds
+    uint32_t frame;       // Frame index the scope was recorded in
+};
+
+// Collects scope timings into per-thread buffers and exports them as a Chrome trace
+class Profiler
+{
+public:
+    // Returns nanoseconds elapsed since the profiler epoch
+    static uint64_t NowNs();
+
+    // Marks the start of a new frame
+    static void BeginFrame();
+
+    // Returns the index of the current frame
+    static uint32_t GetFrameIndex();
+
+    // Stores a finished scope in the calling thread's buffer
+    static void Record(const char* name, uint64_t startNs, uint64_t endNs);
+
+    // Discards every recorded event on every thread
+    static void Clear();
+
+    // Writes all recorded events in Chrome/Perfetto trace JSON format
+    // Must not be called while other threads are still recording
+    static bool ExportChromeTrace(const char* fileName);
+};
+
+// Records the lifetime of the enclosing scope
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name) : name(name), startNs(Profiler::NowNs()) {}
+    ~ProfileScope() { Profiler::Record(name, startNs, Profiler::NowNs()); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;  // Scope name, must outlive the profiler
+    uint64_t startNs;  // Time the scope was entered
+};
+
+// Adds the lifetime of the enclosing scope to a running total in milliseconds
+// Unlike PROFILE_SCOPE this is always compiled in, for stats shown in release builds
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(float& totalMs) : totalMs(totalMs), startNs(Profiler::NowNs()) {}
+    ~ScopedTimer() { totalMs += (Profiler::NowNs() - startNs) / 1000000.0f; }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    float& totalMs;    // Total the elapsed time is added to
+    uint64_t startNs;  // Time the scope was entered
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if defined(TANK_PROFILER)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FRAME() Profiler::BeginFrame()
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#endif
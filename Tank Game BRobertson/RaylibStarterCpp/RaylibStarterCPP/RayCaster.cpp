@@ -0,0 +1,478 @@
+#include "RayCaster.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RAY_CASTER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+const uint8_t RayCaster::hitTargets;
+const uint8_t RayCaster::hitWalls;
+const uint8_t RayCaster::hitTanks;
+const uint8_t RayCaster::hitAll;
+
+namespace
+{
+    // Refits loosen the tank hierarchy as tanks wander off from the neighbours they were built with
+    const int tankRebuildInterval = 60;
+
+    // Chunks per pool thread, a few so a chunk of slow rays does not leave the other threads idle
+    const size_t chunksPerThread = 4;
+
+    // Each level splits its items at least in half twice and leaves three siblings waiting, so even
+    // 2^32 items stay well inside this
+    const int traversalStackSize = 64;
+
+    // Nearer wins, then the lower shape kind, then the lower index. A miss loses to any hit within the ray.
+    bool Wins(float distance, RayShape shape, int32_t index, const RayHit& best)
+    {
+        if (best.shape == RayShape::None)
+        {
+            return distance <= best.distance;
+        }
+        if (distance != best.distance)
+        {
+            return distance < best.distance;
+        }
+        return shape != best.shape ? shape < best.shape : index < best.index;
+    }
+
+    RayHit Miss(const Ray2D& ray)
+    {
+        return { ray.maxDistance, -1, RayShape::None };
+    }
+
+    AabbBounds Union(const AabbBounds& a, const AabbBounds& b)
+    {
+        return { std::min(a.minX, b.minX), std::min(a.minY, b.minY), std::max(a.maxX, b.maxX), std::max(a.maxY, b.maxY) };
+    }
+
+    // Box around every slot of a node
+    template <typename Node>
+    AabbBounds NodeBounds(const Node& node)
+    {
+        AabbBounds bounds = { node.minX[0], node.minY[0], node.maxX[0], node.maxY[0] };
+        for (int slot = 1; slot < node.count; ++slot)
+        {
+            bounds = Union(bounds, { node.minX[slot], node.minY[slot], node.maxX[slot], node.maxY[slot] });
+        }
+        return bounds;
+    }
+
+    template <typename Node>
+    void SetSlot(Node& node, int slot, const AabbBounds& box)
+    {
+        node.minX[slot] = box.minX;
+        node.minY[slot] = box.minY;
+        node.maxX[slot] = box.maxX;
+        node.maxY[slot] = box.maxY;
+    }
+
+    // Slab test against every slot of a node, writing the entry distances and returning a bit per slot hit
+    // The SSE2 path picks minimums and maximums with the same operand order as AabbBounds::IntersectRay,
+    // so its entry distances match the scalar test bit for bit
+    template <typename Node>
+    int IntersectSlots(const Node& node, Vector2 origin, Vector2 inverseDirection, float maxDistance, float* entries)
+    {
+#if defined(RAY_CASTER_SSE2)
+        __m128 originX = _mm_set1_ps(origin.x);
+        __m128 originY = _mm_set1_ps(origin.y);
+        __m128 inverseX = _mm_set1_ps(inverseDirection.x);
+        __m128 inverseY = _mm_set1_ps(inverseDirection.y);
+        __m128 x1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minX), originX), inverseX);
+        __m128 x2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxX), originX), inverseX);
+        __m128 y1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minY), originY), inverseY);
+        __m128 y2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxY), originY), inverseY);
+        __m128 entry = _mm_max_ps(_mm_min_ps(y1, y2), _mm_min_ps(x1, x2));
+        __m128 exit = _mm_min_ps(_mm_max_ps(y2, y1), _mm_max_ps(x2, x1));
+        entry = _mm_max_ps(entry, _mm_setzero_ps());
+        __m128 hit = _mm_and_ps(_mm_cmple_ps(entry, exit), _mm_cmple_ps(entry, _mm_set1_ps(maxDistance)));
+        _mm_storeu_ps(entries, entry);
+        return _mm_movemask_ps(hit) & ((1 << node.count) - 1);
+#else
+        int hits = 0;
+        for (int slot = 0; slot < node.count; ++slot)
+        {
+            AabbBounds box = { node.minX[slot], node.minY[slot], node.maxX[slot], node.maxY[slot] };
+            hits |= box.IntersectRay(origin, inverseDirection, maxDistance, entries[slot]) ? 1 << slot : 0;
+        }
+        return hits;
+#endif
+    }
+}
+
+// Sort the items into a tree of nodes, each written before the nodes below it
+void RayCaster::WideBvh::Build(const std::vector<AabbBounds>& boxes)
+{
+    nodes.clear();
+    items.resize(boxes.size());
+    centres.resize(boxes.size());
+    for (size_t i = 0; i < boxes.size(); ++i)
+    {
+        items[i] = (int32_t)i;
+        centres[i] = { (boxes[i].minX + boxes[i].maxX) * 0.5f, (boxes[i].minY + boxes[i].maxY) * 0.5f };
+    }
+    if (!boxes.empty())
+    {
+        BuildRange(boxes, 0, boxes.size());
+    }
+}
+
+// Four items or fewer become the node's slots, more are split in half and each half in half again
+int32_t RayCaster::WideBvh::BuildRange(const std::vector<AabbBounds>& boxes, size_t first, size_t last)
+{
+    int32_t index = (int32_t)nodes.size();
+    nodes.emplace_back();
+
+    size_t splits[5];
+    int count;
+    if (last - first <= 4)
+    {
+        count = (int)(last - first);
+        for (int slot = 0; slot <= count; ++slot)
+        {
+            splits[slot] = first + slot;
+        }
+    }
+    else
+    {
+        count = 4;
+        splits[0] = first;
+        splits[2] = SplitRange(first, last);
+        splits[1] = SplitRange(first, splits[2]);
+        splits[3] = SplitRange(splits[2], last);
+        splits[4] = last;
+    }
+
+    // Children are built first, which can grow the node array, so the node is filled in afterwards
+    int32_t children[4];
+    AabbBounds bounds[4];
+    for (int slot = 0; slot < count; ++slot)
+    {
+        if (splits[slot + 1] - splits[slot] == 1)
+        {
+            int32_t item = items[splits[slot]];
+            children[slot] = -1 - item;
+            bounds[slot] = boxes[item];
+        }
+        else
+        {
+            children[slot] = BuildRange(boxes, splits[slot], splits[slot + 1]);
+            bounds[slot] = NodeBounds(nodes[children[slot]]);
+        }
+    }
+
+    Node& node = nodes[index];
+    node.count = count;
+    for (int slot = 0; slot < 4; ++slot)
+    {
+        node.children[slot] = slot < count ? children[slot] : 0;
+        SetSlot(node, slot, slot < count ? bounds[slot] : AabbBounds{ 0.0f, 0.0f, 0.0f, 0.0f });
+    }
+    return index;
+}
+
+// nth_element puts the median in place with smaller centres before it and larger after
+size_t RayCaster::WideBvh::SplitRange(size_t first, size_t last)
+{
+    float minX = centres[items[first]].x, maxX = minX;
+    float minY = centres[items[first]].y, maxY = minY;
+    for (size_t i = first + 1; i < last; ++i)
+    {
+        Vector2 centre = centres[items[i]];
+        minX = std::min(minX, centre.x);
+        maxX = std::max(maxX, centre.x);
+        minY = std::min(minY, centre.y);
+        maxY = std::max(maxY, centre.y);
+    }
+
+    size_t middle = first + (last - first) / 2;
+    bool alongX = maxX - minX >= maxY - minY;
+    std::nth_element(items.begin() + first, items.begin() + middle, items.begin() + last, [this, alongX](int32_t a, int32_t b) {
+        return alongX ? centres[a].x < centres[b].x : centres[a].y < centres[b].y;
+        });
+    return middle;
+}
+
+// Nodes are stored parents first, so walking backwards refits every child before its parent reads it
+void RayCaster::WideBvh::Refit(const std::vector<AabbBounds>& boxes)
+{
+    for (size_t i = nodes.size(); i-- > 0;)
+    {
+        Node& node = nodes[i];
+        for (int slot = 0; slot < node.count; ++slot)
+        {
+            int32_t child = node.children[slot];
+            SetSlot(node, slot, child < 0 ? boxes[-1 - child] : NodeBounds(nodes[child]));
+        }
+    }
+}
+
+// Items in a node are visited as soon as the node is, so their hits clip the ray before any child
+// node is pushed. Child nodes go on the stack farthest first with their entry distance, and are
+// skipped when popped if a hit has since clipped the ray short of them.
+template <typename Visit>
+void RayCaster::WideBvh::RayCast(Vector2 origin, Vector2 direction, float maxDistance, Visit visit) const
+{
+    if (nodes.empty())
+    {
+        return;
+    }
+
+    struct Pending
+    {
+        int32_t node;
+        float entry;
+    };
+    Pending stack[traversalStackSize];
+    int depth = 0;
+    stack[depth++] = { 0, 0.0f };
+    Vector2 inverseDirection = { 1.0f / direction.x, 1.0f / direction.y };
+    while (depth > 0)
+    {
+        Pending top = stack[--depth];
+        if (top.entry > maxDistance)
+        {
+            continue;
+        }
+
+        const Node& node = nodes[top.node];
+        float entries[4];
+        int hits = IntersectSlots(node, origin, inverseDirection, maxDistance, entries);
+        Pending children[4];
+        int childCount = 0;
+        for (int slot = 0; slot < node.count; ++slot)
+        {
+            if ((hits & (1 << slot)) == 0)
+            {
+                continue;
+            }
+            int32_t child = node.children[slot];
+            if (child < 0)
+            {
+                maxDistance = visit(-1 - child, entries[slot], maxDistance);
+            }
+            else
+            {
+                // Insertion sort, farthest first
+                int position = childCount++;
+                while (position > 0 && children[position - 1].entry < entries[slot])
+                {
+                    children[position] = children[position - 1];
+                    --position;
+                }
+                children[position] = { child, entries[slot] };
+            }
+        }
+        for (int i = 0; i < childCount; ++i)
+        {
+            if (children[i].entry <= maxDistance)
+            {
+                stack[depth++] = children[i];
+            }
+        }
+    }
+}
+
+// Constructor for a caster with nothing to hit
+RayCaster::RayCaster()
+    : targetCount(0), updatesSinceBuild(0)
+{
+}
+
+// Targets and walls share one hierarchy, items below targetCount being targets
+void RayCaster::SetBoxes(const std::vector<Rectangle>& targets, const std::vector<Rectangle>& walls)
+{
+    PROFILE_SCOPE("RayCaster::SetBoxes");
+    targetCount = targets.size();
+    boxes.clear();
+    for (const Rectangle& target : targets)
+    {
+        boxes.push_back(AabbBounds::FromRectangle(target));
+    }
+    for (const Rectangle& wall : walls)
+    {
+        boxes.push_back(AabbBounds::FromRectangle(wall));
+    }
+    boxTree.Build(boxes);
+}
+
+// Each body's hierarchy box is the axis-aligned box around its turned sprite rectangle
+void RayCaster::UpdateTanks(const std::vector<Tank>& tankList)
+{
+    PROFILE_SCOPE("RayCaster::UpdateTanks");
+    bool countChanged = tankList.size() != tanks.size();
+    tanks.resize(tankList.size());
+    tankBounds.resize(tankList.size());
+    for (size_t i = 0; i < tankList.size(); ++i)
+    {
+        const Tank& tank = tankList[i];
+        MathClasses::Vector3 position = tank.GetPosition();
+        Matrix3 transform = tank.GetBodyTransform();
+        MathClasses::Vector3 axisX = transform.axis[0].Normalised();
+        MathClasses::Vector3 axisY = transform.axis[1].Normalised();
+        Vector2 size = tank.GetBodySize();
+
+        TankBox& box = tanks[i];
+        box.centre = { position.x, position.y };
+        box.axisX = { axisX.x, axisX.y };
+        box.axisY = { axisY.x, axisY.y };
+        box.halfWidth = size.x * 0.5f;
+        box.halfHeight = size.y * 0.5f;
+
+        float extentX = fabsf(box.axisX.x) * box.halfWidth + fabsf(box.axisY.x) * box.halfHeight;
+        float extentY = fabsf(box.axisX.y) * box.halfWidth + fabsf(box.axisY.y) * box.halfHeight;
+        tankBounds[i] = { box.centre.x - extentX, box.centre.y - extentY, box.centre.x + extentX, box.centre.y + extentY };
+    }
+
+    if (countChanged || ++updatesSinceBuild >= tankRebuildInterval)
+    {
+        tankTree.Build(tankBounds);
+        updatesSinceBuild = 0;
+    }
+    else
+    {
+        tankTree.Refit(tankBounds);
+    }
+}
+
+// Slab test against one box, for tanks in their own frame and for the brute-force check
+void RayCaster::TestBox(Vector2 origin, Vector2 inverseDirection, const AabbBounds& box, RayShape shape, int32_t index, RayHit& best) const
+{
+    float distance;
+    if (box.IntersectRay(origin, inverseDirection, best.distance, distance) && Wins(distance, shape, index, best))
+    {
+        best = { distance, index, shape };
+    }
+}
+
+// Turn the ray into the tank's frame, where the body is an axis-aligned box about the origin
+void RayCaster::TestTank(const Ray2D& ray, int32_t index, RayHit& best) const
+{
+    const TankBox& box = tanks[index];
+    float offsetX = ray.origin.x - box.centre.x;
+    float offsetY = ray.origin.y - box.centre.y;
+    Vector2 origin = { offsetX * box.axisX.x + offsetY * box.axisX.y, offsetX * box.axisY.x + offsetY * box.axisY.y };
+    Vector2 direction = { ray.direction.x * box.axisX.x + ray.direction.y * box.axisX.y, ray.direction.x * box.axisY.x + ray.direction.y * box.axisY.y };
+    AabbBounds local = { -box.halfWidth, -box.halfHeight, box.halfWidth, box.halfHeight };
+    TestBox(origin, { 1.0f / direction.x, 1.0f / direction.y }, local, RayShape::Tank, index, best);
+}
+
+// A target or wall item's slot box is the shape itself, so the hierarchy's entry distance is the hit
+RayHit RayCaster::Cast(const Ray2D& ray) const
+{
+    RayHit best = Miss(ray);
+    if ((ray.shapes & (hitTargets | hitWalls)) != 0)
+    {
+        boxTree.RayCast(ray.origin, ray.direction, best.distance, [&](int32_t item, float entry, float) {
+            bool wall = (size_t)item >= targetCount;
+            if ((ray.shapes & (wall ? hitWalls : hitTargets)) != 0)
+            {
+                RayShape shape = wall ? RayShape::Wall : RayShape::Target;
+                int32_t index = wall ? item - (int32_t)targetCount : item;
+                if (Wins(entry, shape, index, best))
+                {
+                    best = { entry, index, shape };
+                }
+            }
+            return best.distance;
+            });
+    }
+    if ((ray.shapes & hitTanks) != 0)
+    {
+        tankTree.RayCast(ray.origin, ray.direction, best.distance, [&](int32_t item, float, float) {
+            if (item != ray.ignoreTank)
+            {
+                TestTank(ray, item, best);
+            }
+            return best.distance;
+            });
+    }
+    return best;
+}
+
+// Rays are independent, so chunks share nothing but the hierarchies they read
+void RayCaster::CastAll(const Ray2D* rays, size_t count, RayHit* hits, ThreadPool* pool) const
+{
+    PROFILE_SCOPE("RayCaster::CastAll");
+    auto castRange = [this, rays, hits](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i)
+        {
+            hits[i] = Cast(rays[i]);
+        }
+    };
+    if (pool == nullptr || count < 2)
+    {
+        castRange(0, count);
+        return;
+    }
+    size_t chunks = std::min(count, (size_t)pool->GetThreadCount() * chunksPerThread);
+    size_t chunkSize = (count + chunks - 1) / chunks;
+    for (size_t first = 0; first < count; first += chunkSize)
+    {
+        size_t last = std::min(count, first + chunkSize);
+        pool->Submit([&castRange, first, last] { castRange(first, last); });
+    }
+    pool->WaitIdle();
+}
+
+// Every target, wall and tank against every ray
+void RayCaster::CastAllBruteForce(const Ray2D* rays, size_t count, RayHit* hits) const
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Ray2D& ray = rays[i];
+        RayHit best = Miss(ray);
+        Vector2 inverseDirection = { 1.0f / ray.direction.x, 1.0f / ray.direction.y };
+        for (size_t j = 0; j < boxes.size(); ++j)
+        {
+            bool wall = j >= targetCount;
+            if ((ray.shapes & (wall ? hitWalls : hitTargets)) != 0)
+            {
+                TestBox(ray.origin, inverseDirection, boxes[j], wall ? RayShape::Wall : RayShape::Target, (int32_t)(wall ? j - targetCount : j), best);
+            }
+        }
+        if ((ray.shapes & hitTanks) != 0)
+        {
+            for (size_t j = 0; j < tanks.size(); ++j)
+            {
+                if ((int32_t)j != ray.ignoreTank)
+                {
+                    TestTank(ray, (int32_t)j, best);
+                }
+            }
+        }
+        hits[i] = best;
+    }
+}
+
+// Cast along the segment with its own length as the unit, so any wall hit short of 1 blocks the view
+bool RayCaster::HasLineOfSight(Vector2 from, Vector2 to) const
+{
+    if (from.x == to.x && from.y == to.y)
+    {
+        return true;
+    }
+    Ray2D ray = { from, { to.x - from.x, to.y - from.y }, 1.0f, hitWalls, -1 };
+    return Cast(ray).shape == RayShape::None;
+}
+
+// Get the number of target boxes
+size_t RayCaster::GetTargetCount() const
+{
+    return targetCount;
+}
+
+// Get the number of wall boxes
+size_t RayCaster::GetWallCount() const
+{
+    return boxes.size() - targetCount;
+}
+
+// Get the number of tank bodies
+size_t RayCaster::GetTankCount() const
+{
+    return tanks.size();
+}
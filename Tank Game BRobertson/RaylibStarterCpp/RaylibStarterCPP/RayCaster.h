@@ -0,0 +1,134 @@
+#pragma once
+#include "raylib.h"
+#include "AabbTree.h"
+#include "Tank.h"
+#include "ThreadPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Kind of shape a ray stopped at
+enum class RayShape : uint8_t
+{
+    None,   // Nothing within the ray's length
+    Target,
+    Wall,
+    Tank
+};
+
+// One ray to cast. Distances are in multiples of direction, so a unit direction measures them in pixels.
+struct Ray2D
+{
+    Vector2 origin;
+    Vector2 direction;
+    float maxDistance;
+    uint8_t shapes;     // RayCaster::hitTargets, hitWalls and hitTanks or-ed together
+    int32_t ignoreTank; // Tank the ray starts from, so it does not stop inside its own body, or -1
+};
+
+// First shape along a ray
+struct RayHit
+{
+    float distance;  // Where the ray enters the shape, 0 when it starts inside; maxDistance on a miss
+    int32_t index;   // Index in the target, wall or tank list the shape came from, -1 on a miss
+    RayShape shape;
+};
+
+// Ray casts against every collidable shape in the arena: target and wall boxes, and tank bodies as
+// oriented boxes the size of their sprite, for hitscan shots, line of sight and sensors.
+// Shapes live in flattened bounding-volume hierarchies with four children per node, one for the boxes
+// and one for the tanks. A node holds its children's boxes side by side, so one SSE2 slab test checks
+// all four, and a child that is a single target or wall is tested exactly by that same slab test.
+// Each ray walks the box hierarchy first and then the tank one clipped to its nearest hit, nearer
+// children first. Tanks are tested in their own frame with the usual slab test. The tank hierarchy
+// is refitted to the tanks' new boxes each update and rebuilt every so often, or when tanks come or go.
+// Hits at equal distances go to the lowest shape kind and then the lowest index, so every cast of the
+// same ray gives the same answer whatever order the hierarchies are walked in.
+class RayCaster
+{
+public:
+    static const uint8_t hitTargets = 1;
+    static const uint8_t hitWalls = 2;
+    static const uint8_t hitTanks = 4;
+    static const uint8_t hitAll = hitTargets | hitWalls | hitTanks;
+
+    RayCaster();
+
+    // Replaces the static boxes and builds their hierarchy
+    void SetBoxes(const std::vector<Rectangle>& targets, const std::vector<Rectangle>& walls);
+
+    // Copies each tank's body box, refitting the tank hierarchy or rebuilding it when due
+    void UpdateTanks(const std::vector<Tank>& tanks);
+
+    // First hit along one ray
+    RayHit Cast(const Ray2D& ray) const;
+
+    // Casts count rays into hits, split into chunks across the pool when there is one
+    void CastAll(const Ray2D* rays, size_t count, RayHit* hits, ThreadPool* pool = nullptr) const;
+
+    // Tests every shape for every ray, kept to check the hierarchies against
+    void CastAllBruteForce(const Ray2D* rays, size_t count, RayHit* hits) const;
+
+    // True when no wall lies between the two points
+    bool HasLineOfSight(Vector2 from, Vector2 to) const;
+
+    size_t GetTargetCount() const;
+    size_t GetWallCount() const;
+    size_t GetTankCount() const;
+
+private:
+    // Body box of one tank in its own frame
+    struct TankBox
+    {
+        Vector2 centre;
+        Vector2 axisX, axisY; // Unit axes along the sprite's width and height
+        float halfWidth, halfHeight;
+    };
+
+    // Bounding-volume hierarchy stored as an array of four-wide nodes, each before its children
+    class WideBvh
+    {
+    public:
+        // Up to four child boxes as separate coordinate arrays, ready to load into SSE2 registers
+        struct Node
+        {
+            float minX[4], minY[4], maxX[4], maxY[4];
+            int32_t children[4]; // Node index, or -1 - item for a single item
+            int32_t count;       // Slots in use, from the front
+        };
+
+        // Builds top-down, splitting each range at the median of its longer axis twice per node
+        void Build(const std::vector<AabbBounds>& boxes);
+
+        // Keeps the tree and updates every box from the items' new boxes, children before parents
+        void Refit(const std::vector<AabbBounds>& boxes);
+
+        // Calls visit(item, entry, maxDistance) for each item whose box the ray enters within maxDistance,
+        // nearer nodes first. visit returns the new maxDistance.
+        template <typename Visit>
+        void RayCast(Vector2 origin, Vector2 direction, float maxDistance, Visit visit) const;
+
+    private:
+        // Builds the node over items [first, last) and its subtree, returning its index
+        int32_t BuildRange(const std::vector<AabbBounds>& boxes, size_t first, size_t last);
+
+        // Reorders items [first, last) about their median along the longer axis of their centres
+        size_t SplitRange(size_t first, size_t last);
+
+        std::vector<Node> nodes;
+        std::vector<int32_t> items;   // Scratch for Build, item indices being split
+        std::vector<Vector2> centres; // Scratch for Build, box centres by item
+    };
+
+    // Tests the ray against one shape, keeping it in best when it is nearer or wins the tie
+    void TestBox(Vector2 origin, Vector2 inverseDirection, const AabbBounds& box, RayShape shape, int32_t index, RayHit& best) const;
+    void TestTank(const Ray2D& ray, int32_t index, RayHit& best) const;
+
+    WideBvh boxTree;
+    WideBvh tankTree;
+    std::vector<AabbBounds> boxes; // Targets, then walls
+    size_t targetCount;
+    std::vector<TankBox> tanks;
+    std::vector<AabbBounds> tankBounds;
+    int updatesSinceBuild;
+};
@@ -0,0 +1,247 @@
+#include "Replay.h"
+#include "WorldSnapshot.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    // Fixed size header at the start of every replay file
+    struct ReplayHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t tickCount;
+        uint32_t snapshotSize;
+        SimulationConfig config;
+    };
+
+    const char REPLAY_MAGIC[4] = { 'T', 'K', 'R', 'P' };
+    const size_t REPLAY_TICK_SIZE = sizeof(uint8_t) + sizeof(float) + sizeof(uint32_t);
+}
+
+// Constructor remembering the starting state
+ReplayRecorder::ReplayRecorder(const Simulation& simulation)
+{
+    // Roughly ten minutes at 120 ticks per second before the vector has to grow
+    ticks.reserve(120 * 60 * 10);
+    Restart(simulation);
+}
+
+// Snapshot the world so playback can start from exactly this state
+void ReplayRecorder::Restart(const Simulation& simulation)
+{
+    config = simulation.GetConfig();
+    WriteSnapshot(simulation, initialSnapshot);
+    ticks.clear();
+}
+
+// Append one tick
+void ReplayRecorder::Record(const TankInput& input, float deltaTime, uint64_t checksum)
+{
+    ticks.push_back({ input, deltaTime, FoldChecksum(checksum) });
+}
+
+// Write the header followed by tightly packed ticks
+bool ReplayRecorder::Save(const char* fileName) const
+{
+    FILE* file = fopen(fileName, "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    ReplayHeader header = {};
+    memcpy(header.magic, REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+    header.version = REPLAY_VERSION;
+    header.tickCount = static_cast<uint32_t>(ticks.size());
+    header.snapshotSize = static_cast<uint32_t>(initialSnapshot.size());
+    header.config = config;
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(initialSnapshot.data(), 1, initialSnapshot.size(), file);
+
+    std::vector<unsigned char> packed(ticks.size() * REPLAY_TICK_SIZE);
+    unsigned char* out = packed.data();
+    for (const ReplayTick& tick : ticks)
+    {
+        out[0] = tick.input.buttons;
+        memcpy(out + 1, &tick.deltaTime, sizeof(float));
+        memcpy(out + 5, &tick.checksum, sizeof(uint32_t));
+        out += REPLAY_TICK_SIZE;
+    }
+    fwrite(packed.data(), 1, packed.size(), file);
+
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    return ok;
+}
+
+// Get the number of recorded ticks
+uint32_t ReplayRecorder::GetTickCount() const
+{
+    return static_cast<uint32_t>(ticks.size());
+}
+
+// Read and validate a recording
+bool ReplayPlayer::Load(const char* fileName)
+{
+    FILE* file = fopen(fileName, "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    ReplayHeader header = {};
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) != 0 || header.version != REPLAY_VERSION)
+    {
+        fclose(file);
+        return false;
+    }
+
+    std::vector<unsigned char> snapshot(header.snapshotSize);
+    std::vector<unsigned char> packed(static_cast<size_t>(header.tickCount) * REPLAY_TICK_SIZE);
+    bool ok = fread(snapshot.data(), 1, snapshot.size(), file) == snapshot.size() &&
+        fread(packed.data(), 1, packed.size(), file) == packed.size();
+    fclose(file);
+
+    SnapshotView view;
+    if (!ok || !view.Attach(snapshot.data(), snapshot.size()))
+    {
+        return false;
+    }
+
+    config = header.config;
+    initialSnapshot.swap(snapshot);
+    checkpoints.clear();
+    ticks.resize(header.tickCount);
+    const unsigned char* in = packed.data();
+    for (ReplayTick& tick : ticks)
+    {
+        tick.input.buttons = in[0];
+        memcpy(&tick.deltaTime, in + 1, sizeof(float));
+        memcpy(&tick.checksum, in + 5, sizeof(uint32_t));
+        in += REPLAY_TICK_SIZE;
+    }
+    cursor = 0;
+    firstMismatch = -1;
+    return true;
+}
+
+// Get the recorded simulation settings
+const SimulationConfig& ReplayPlayer::GetConfig() const
+{
+    return config;
+}
+
+// Get the number of recorded ticks
+uint32_t ReplayPlayer::GetTickCount() const
+{
+    return static_cast<uint32_t>(ticks.size());
+}
+
+// Get the next tick to play
+uint32_t ReplayPlayer::GetCursor() const
+{
+    return cursor;
+}
+
+// Check if every tick has been played
+bool ReplayPlayer::IsFinished() const
+{
+    return cursor >= ticks.size();
+}
+
+// Get the first tick whose checksum did not match
+int64_t ReplayPlayer::GetFirstMismatch() const
+{
+    return firstMismatch;
+}
+
+// Simulate the next recorded tick and compare the result with the recording
+bool ReplayPlayer::Step(Simulation& simulation)
+{
+    if (IsFinished())
+    {
+        return false;
+    }
+
+    const ReplayTick& tick = ticks[cursor];
+    simulation.Step(tick.input, tick.deltaTime);
+    if (firstMismatch < 0 && FoldChecksum(simulation.Checksum()) != tick.checksum)
+    {
+        firstMismatch = cursor;
+    }
+    cursor++;
+
+    if (cursor % REPLAY_CHECKPOINT_INTERVAL == 0 && cursor / REPLAY_CHECKPOINT_INTERVAL == checkpoints.size() + 1)
+    {
+        checkpoints.emplace_back();
+        WriteSnapshot(simulation, checkpoints.back());
+    }
+    return true;
+}
+
+// Simulate several ticks back to back
+uint32_t ReplayPlayer::FastForward(Simulation& simulation, uint32_t count)
+{
+    uint32_t played = 0;
+    while (played < count && Step(simulation))
+    {
+        played++;
+    }
+    return played;
+}
+
+// Replays are deterministic, so seeking jumps to the latest checkpoint at or before the target and fast-forwards
+void ReplayPlayer::Seek(Simulation& simulation, uint32_t tick)
+{
+    tick = std::min(tick, GetTickCount());
+    size_t checkpoint = std::min<size_t>(tick / REPLAY_CHECKPOINT_INTERVAL, checkpoints.size());
+    uint32_t checkpointTick = static_cast<uint32_t>(checkpoint * REPLAY_CHECKPOINT_INTERVAL);
+
+    if (tick < cursor || checkpointTick > cursor)
+    {
+        if (checkpoint > 0)
+        {
+            RestoreBuffer(simulation, checkpoints[checkpoint - 1]);
+            cursor = checkpointTick;
+        }
+        else
+        {
+            Rewind(simulation);
+        }
+
+        if (firstMismatch >= cursor)
+        {
+            firstMismatch = -1;
+        }
+    }
+    FastForward(simulation, tick - cursor);
+}
+
+// Restore the state the recording starts from
+void ReplayPlayer::Rewind(Simulation& simulation)
+{
+    RestoreBuffer(simulation, initialSnapshot);
+    cursor = 0;
+}
+
+// Play the full recording from the start
+int64_t ReplayPlayer::Verify(Simulation& simulation)
+{
+    Rewind(simulation);
+    firstMismatch = -1;
+    FastForward(simulation, GetTickCount());
+    return firstMismatch;
+}
+
+// View a snapshot buffer in place and copy it into the simulation
+void ReplayPlayer::RestoreBuffer(Simulation& simulation, const std::vector<unsigned char>& buffer)
+{
+    SnapshotView view;
+    if (view.Attach(buffer.data(), buffer.size()))
+    {
+        simulation.Restore(view);
+    }
+}
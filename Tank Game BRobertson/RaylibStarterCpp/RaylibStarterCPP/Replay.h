@@ -0,0 +1,99 @@
+#pragma once
+#include "Simulation.h"
+#include "TankInput.h"
+#include <cstdint>
+#include <vector>
+
+// Replay file layout (little endian):
+//   ReplayHeader
+//   snapshotSize bytes of world snapshot the recording starts from
+//   tickCount x { uint8 buttons, float deltaTime, uint32 checksum }  (9 bytes per tick)
+const uint32_t REPLAY_VERSION = 3;
+
+// Seeking restores the nearest checkpoint captured during playback, taken every this many ticks
+const uint32_t REPLAY_CHECKPOINT_INTERVAL = 1200;
+
+// Everything recorded for a single tick
+struct ReplayTick
+{
+    TankInput input;   // Controls applied this tick
+    float deltaTime;   // Frame time the tick was simulated with
+    uint32_t checksum; // Folded world checksum after the tick
+};
+
+// Records live input so a session can be reproduced exactly
+class ReplayRecorder
+{
+public:
+    // Starts recording from the simulation's current state
+    explicit ReplayRecorder(const Simulation& simulation);
+
+    // Drops every recorded tick and starts again from the simulation's current state
+    void Restart(const Simulation& simulation);
+
+    // Stores one tick along with the world checksum after it was simulated
+    void Record(const TankInput& input, float deltaTime, uint64_t checksum);
+
+    // Writes the recording to disk
+    bool Save(const char* fileName) const;
+
+    uint32_t GetTickCount() const;
+
+private:
+    SimulationConfig config;
+    std::vector<unsigned char> initialSnapshot;
+    std::vector<ReplayTick> ticks;
+};
+
+// Plays a recording back into a simulation, checking every tick against the recorded checksum
+class ReplayPlayer
+{
+public:
+    // Reads a recording from disk
+    bool Load(const char* fileName);
+
+    // Simulation settings the recording was made with
+    const SimulationConfig& GetConfig() const;
+
+    uint32_t GetTickCount() const;
+
+    // Index of the next tick to play
+    uint32_t GetCursor() const;
+
+    bool IsFinished() const;
+
+    // Tick of the first checksum mismatch, or -1 if playback has matched so far
+    int64_t GetFirstMismatch() const;
+
+    // Plays the next tick, returns false once the recording has ended
+    bool Step(Simulation& simulation);
+
+    // Plays up to count ticks without rendering, returns how many were played
+    uint32_t FastForward(Simulation& simulation, uint32_t count);
+
+    // Moves playback to the given tick, restoring the nearest checkpoint and re-simulating from there
+    void Seek(Simulation& simulation, uint32_t tick);
+
+    // Puts the simulation back into the state the recording starts from
+    void Rewind(Simulation& simulation);
+
+    // Rewinds the simulation and plays the whole recording, returns the first mismatching tick or -1
+    int64_t Verify(Simulation& simulation);
+
+private:
+    // Restores a snapshot buffer into the simulation
+    static void RestoreBuffer(Simulation& simulation, const std::vector<unsigned char>& buffer);
+
+    SimulationConfig config = {};
+    std::vector<unsigned char> initialSnapshot;
+    std::vector<std::vector<unsigned char>> checkpoints; // checkpoints[i] is the world after (i + 1) * interval ticks
+    std::vector<ReplayTick> ticks;
+    uint32_t cursor = 0;
+    int64_t firstMismatch = -1;
+};
+
+// Folds a 64-bit world checksum into the 32 bits stored per tick
+inline uint32_t FoldChecksum(uint64_t checksum)
+{
+    return static_cast<uint32_t>(checksum ^ (checksum >> 32));
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+// Fixed-capacity history that overwrites its oldest value, storage lives inline so pushing never allocates
+template <typename T, int Capacity>
+class RingBuffer
+{
+public:
+    // Adds a value, replacing the oldest once the buffer is full
+    void Push(const T& value)
+    {
+        values[head] = value;
+        head = (head + 1) % Capacity;
+        if (count < Capacity)
+        {
+            count++;
+        }
+    }
+
+    // Returns the value at index, where 0 is the oldest value still held
+    const T& Get(int index) const
+    {
+        return values[(head - count + index + Capacity) % Capacity];
+    }
+
+    // Returns the most recently pushed value
+    const T& Latest() const
+    {
+        return values[(head - 1 + Capacity) % Capacity];
+    }
+
+    int GetCount() const { return count; }
+    bool IsEmpty() const { return count == 0; }
+    static constexpr int GetCapacity() { return Capacity; }
+
+private:
+    T values[Capacity] = {};
+    int head = 0;   // Slot the next value is written to
+    int count = 0;  // Number of values held, at most Capacity
+};
@@ -0,0 +1,212 @@
+#include "RollbackSession.h"
+#include "NetSnapshot.h"
+#include "Profiler.h"
+
+namespace
+{
+    // Most inputs one packet can carry, limited by its 8-bit count
+    const int maxInputsPerPacket = 255;
+
+    // Milliseconds since a Profiler::NowNs reading
+    double ElapsedMs(uint64_t startNs)
+    {
+        return (Profiler::NowNs() - startNs) / 1000000.0;
+    }
+}
+
+// Constructor for a session that has not stepped yet, the world must be at tick 0
+RollbackSession::RollbackSession(RollbackWorld& world, LoopbackTransport& transport, int localEndpoint, int remoteEndpoint, int localPlayer, float tickSeconds)
+    : world(world), transport(transport), localEndpoint(localEndpoint), remoteEndpoint(remoteEndpoint), localPlayer(localPlayer),
+    tickSeconds(tickSeconds), remoteTick(-1), remoteAckedTick(-1), rollbackTick(-1), stats()
+{
+    for (WorldState& state : states)
+    {
+        state.tick = UINT32_MAX;
+    }
+}
+
+// Receive and roll back first, so this frame's step already uses everything that has arrived
+bool RollbackSession::AdvanceFrame(const TankInput& localInput)
+{
+    PROFILE_SCOPE("Rollback::Frame");
+    uint64_t startNs = Profiler::NowNs();
+    stats.frames++;
+
+    ReceiveInputs();
+    if (rollbackTick >= 0)
+    {
+        Rollback();
+    }
+
+    bool advanced = false;
+    int64_t tick = world.GetTick();
+    if (tick - (remoteTick + 1) >= maxPrediction)
+    {
+        stats.stalls++;
+    }
+    else
+    {
+        localInputs[tick % historyLength] = localInput;
+        SaveAndStep();
+        advanced = true;
+    }
+
+    SendInputs();
+
+    stats.lastFrameMs = static_cast<float>(ElapsedMs(startNs));
+    stats.frameMs += stats.lastFrameMs;
+    return advanced;
+}
+
+// Store newly confirmed remote inputs, and note the earliest one that contradicts what was simulated
+void RollbackSession::ReceiveInputs()
+{
+    while (transport.Receive(localEndpoint, packet))
+    {
+        BitReader reader(packet.data.data(), packet.data.size());
+        uint32_t type = reader.ReadBits(8);
+        int64_t ack = static_cast<int64_t>(reader.ReadBits(32)) - 1;
+        int64_t first = reader.ReadBits(32);
+        uint32_t count = reader.ReadBits(8);
+        if (type != NET_ROLLBACK_INPUT || reader.HasOverflowed())
+        {
+            transport.Recycle(packet);
+            continue;
+        }
+
+        if (ack > remoteAckedTick)
+        {
+            remoteAckedTick = ack;
+        }
+
+        int64_t simulatedTick = world.GetTick();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            TankInput input;
+            input.buttons = static_cast<uint8_t>(reader.ReadBits(8));
+            int64_t tick = first + i;
+
+            // Only the next tick in sequence is taken, anything older is a repeat of an input already held
+            if (tick != remoteTick + 1 || reader.HasOverflowed())
+            {
+                continue;
+            }
+
+            TankInput& stored = remoteInputs[tick % historyLength];
+            if (tick < simulatedTick && stored.buttons != input.buttons && (rollbackTick < 0 || tick < rollbackTick))
+            {
+                rollbackTick = tick;
+            }
+            stored = input;
+            remoteTick = tick;
+        }
+        transport.Recycle(packet);
+    }
+}
+
+// Repeat every local input the remote peer has not confirmed, oldest first
+void RollbackSession::SendInputs()
+{
+    int64_t tick = world.GetTick();
+    int64_t first = remoteAckedTick + 1;
+    if (first < tick - historyLength + 1)
+    {
+        first = tick - historyLength + 1;
+    }
+    int64_t count = tick - first;
+    if (count > maxInputsPerPacket)
+    {
+        count = maxInputsPerPacket;
+    }
+    if (count < 0)
+    {
+        count = 0;
+    }
+
+    writer.Reset();
+    writer.WriteBits(NET_ROLLBACK_INPUT, 8);
+    writer.WriteBits(static_cast<uint32_t>(remoteTick + 1), 32);
+    writer.WriteBits(static_cast<uint32_t>(first), 32);
+    writer.WriteBits(static_cast<uint32_t>(count), 8);
+    for (int64_t i = 0; i < count; ++i)
+    {
+        writer.WriteBits(localInputs[(first + i) % historyLength].buttons, 8);
+    }
+    const std::vector<uint8_t>& data = writer.GetData();
+    transport.Send(localEndpoint, remoteEndpoint, data.data(), data.size());
+}
+
+// Load the world from before the first wrong prediction and step it back to the present
+// Ticks past the newest confirmed remote input are predicted again from that input
+void RollbackSession::Rollback()
+{
+    PROFILE_SCOPE("Rollback::Resimulate");
+    uint32_t presentTick = world.GetTick();
+    uint32_t ticks = presentTick - static_cast<uint32_t>(rollbackTick);
+
+    uint64_t loadStartNs = Profiler::NowNs();
+    world.Load(states[rollbackTick % historyLength]);
+    stats.loadMs += ElapsedMs(loadStartNs);
+
+    for (int64_t tick = remoteTick + 1; tick < presentTick; ++tick)
+    {
+        remoteInputs[tick % historyLength] = remoteInputs[remoteTick % historyLength];
+    }
+
+    uint64_t resimulateStartNs = Profiler::NowNs();
+    while (world.GetTick() < presentTick)
+    {
+        SaveAndStep();
+    }
+    stats.resimulateMs += ElapsedMs(resimulateStartNs);
+
+    stats.rollbacks++;
+    stats.resimulatedTicks += ticks;
+    if (ticks > stats.maxRollback)
+    {
+        stats.maxRollback = ticks;
+    }
+    rollbackTick = -1;
+}
+
+// Save first so this tick can be rolled back to, then step with local and remote input in player order
+void RollbackSession::SaveAndStep()
+{
+    uint32_t tick = world.GetTick();
+
+    uint64_t saveStartNs = Profiler::NowNs();
+    world.Save(states[tick % historyLength]);
+    stats.saveMs += ElapsedMs(saveStartNs);
+
+    if (static_cast<int64_t>(tick) > remoteTick)
+    {
+        remoteInputs[tick % historyLength] = remoteTick >= 0 ? remoteInputs[remoteTick % historyLength] : TankInput();
+    }
+
+    TankInput inputs[2];
+    inputs[localPlayer] = localInputs[tick % historyLength];
+    inputs[1 - localPlayer] = remoteInputs[tick % historyLength];
+    world.Step(inputs, tickSeconds);
+}
+
+// States up to the tick after the newest confirmed remote input are final, if they have been saved
+uint32_t RollbackSession::GetConfirmedTick() const
+{
+    int64_t confirmed = remoteTick + 1;
+    int64_t newestSaved = static_cast<int64_t>(world.GetTick()) - 1;
+    int64_t tick = confirmed < newestSaved ? confirmed : newestSaved;
+    return tick > 0 ? static_cast<uint32_t>(tick) : 0;
+}
+
+// Look up a saved world, checking the slot has not been reused for a later tick
+const WorldState* RollbackSession::GetSavedState(uint32_t tick) const
+{
+    const WorldState& state = states[tick % historyLength];
+    return state.tick == tick && tick < world.GetTick() ? &state : nullptr;
+}
+
+// Get the session's counters
+const RollbackStats& RollbackSession::GetStats() const
+{
+    return stats;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "BitStream.h"
+#include "LoopbackTransport.h"
+#include "RollbackWorld.h"
+#include "TankInput.h"
+#include <cstdint>
+
+// Per-session rollback counters, times are summed over the whole session
+struct RollbackStats
+{
+    uint64_t frames;           // AdvanceFrame calls
+    uint64_t stalls;           // Frames that did not advance because the remote peer was too far behind
+    uint64_t rollbacks;        // Frames that loaded an earlier tick because a prediction was wrong
+    uint64_t resimulatedTicks; // Ticks stepped again after a load
+    uint32_t maxRollback;      // Most ticks re-simulated in one frame
+    double saveMs;             // Copying the world out every tick
+    double loadMs;             // Restoring the world before a re-simulation
+    double resimulateMs;       // Stepping the re-simulated ticks, saves included
+    double frameMs;            // Whole AdvanceFrame calls
+    float lastFrameMs;         // The most recent AdvanceFrame call
+};
+
+// GGPO-style rollback between two peers that each simulate the whole world
+// Every tick the world is saved before it is stepped. Remote input that has not arrived yet is
+// predicted by repeating the last input received. When the real input arrives and differs from
+// the prediction, the world is loaded from the tick it was first needed and re-simulated to the
+// present within the same frame, without drawing. Every packet repeats all local inputs the remote
+// peer has not acknowledged, so a lost packet is covered by the next one.
+class RollbackSession
+{
+public:
+    // Furthest a peer runs ahead of the last confirmed remote input before it stalls
+    static const int maxPrediction = 16;
+
+    // Ticks of saved worlds and inputs kept: enough to roll back maxPrediction ticks, and to resend
+    // every input a peer stalled maxPrediction ticks behind has not acknowledged yet
+    static const int historyLength = 64;
+
+    // Both peers must use the same tickSeconds, frame times never reach the simulation
+    RollbackSession(RollbackWorld& world, LoopbackTransport& transport, int localEndpoint, int remoteEndpoint, int localPlayer, float tickSeconds);
+
+    // Handles incoming input, rolls back if needed, then steps one tick with this frame's local input
+    // Returns false if the frame stalled waiting for the remote peer, in which case the input is dropped
+    bool AdvanceFrame(const TankInput& localInput);
+
+    // Newest tick whose saved world no longer depends on any prediction
+    uint32_t GetConfirmedTick() const;
+
+    // Saved world at a tick still in the history, or nullptr
+    const WorldState* GetSavedState(uint32_t tick) const;
+
+    const RollbackStats& GetStats() const;
+
+private:
+    void ReceiveInputs();
+    void SendInputs();
+
+    // Loads the saved world at rollbackTick and steps it back up to the present
+    void Rollback();
+
+    // Saves the world, then steps it with the best inputs known for its tick
+    void SaveAndStep();
+
+    RollbackWorld& world;
+    LoopbackTransport& transport;
+    int localEndpoint;
+    int remoteEndpoint;
+    int localPlayer;
+    float tickSeconds;
+
+    TankInput localInputs[historyLength];
+    TankInput remoteInputs[historyLength];   // Confirmed inputs, then predictions past remoteTick
+    int64_t remoteTick;                      // Newest tick whose remote input has arrived, -1 before any
+    int64_t remoteAckedTick;                 // Newest local input tick the remote peer has confirmed
+    int64_t rollbackTick;                    // Earliest tick simulated with a wrong prediction, -1 for none
+    WorldState states[historyLength];        // World saved before stepping each tick
+
+    BitWriter writer;
+    NetPacket packet;
+    RollbackStats stats;
+};
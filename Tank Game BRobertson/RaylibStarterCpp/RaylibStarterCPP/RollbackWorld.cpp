@@ -0,0 +1,147 @@
+#include "RollbackWorld.h"
+#include "Hash.h"
+#include "Profiler.h"
+#include <algorithm>
+
+namespace
+{
+    // A few hundred bullets per tank, with room for the lists to grow
+    const size_t bulletPoolBytes = 1024 * 1024;
+
+    // Fold one tank and its bullets into a hash
+    uint64_t HashTank(const TankState& tank, const Bullet* bullets, uint32_t bulletCount, uint64_t hash)
+    {
+        hash = HashValue(tank.position.x, hash);
+        hash = HashValue(tank.position.y, hash);
+        hash = HashValue(tank.bodyRotation, hash);
+        hash = HashValue(tank.turretRotation, hash);
+        hash = HashValue(bulletCount, hash);
+        for (uint32_t i = 0; i < bulletCount; ++i)
+        {
+            MathClasses::Vector3 position = bullets[i].GetPosition();
+            hash = HashValue(position.x, hash);
+            hash = HashValue(position.y, hash);
+        }
+        return hash;
+    }
+}
+
+// Hash a saved world tank by tank
+uint64_t ChecksumWorldState(const WorldState& state)
+{
+    uint64_t hash = HashValue(state.tick);
+    size_t bulletStart = 0;
+    for (size_t i = 0; i < state.tanks.size(); ++i)
+    {
+        hash = HashTank(state.tanks[i], state.bullets.data() + bulletStart, state.bulletCounts[i], hash);
+        bulletStart += state.bulletCounts[i];
+    }
+    return hash;
+}
+
+// Constructor spreading the players evenly across the middle of the arena
+RollbackWorld::RollbackWorld(const SimulationConfig& config, int playerCount, Sprite bodySprite, Sprite turretSprite, Sprite bulletSprite)
+    : config(config), bulletPool(bulletPoolBytes), tick(0)
+{
+    tanks.reserve(playerCount);
+    for (int i = 0; i < playerCount; ++i)
+    {
+        float x = config.arenaWidth * (i + 1) / (playerCount + 1);
+        tanks.emplace_back(MathClasses::Vector3(x, config.tankStartY, 0.0f), bodySprite, turretSprite, bulletSprite, bulletPool);
+    }
+}
+
+// Move every tank, then cull bullets the same way Simulation does
+void RollbackWorld::Step(const TankInput* inputs, float deltaTime)
+{
+    PROFILE_SCOPE("Rollback::Step");
+    for (size_t i = 0; i < tanks.size(); ++i)
+    {
+        tanks[i].Update(inputs[i], deltaTime);
+
+        BulletList& bullets = tanks[i].GetBullets();
+        bullets.erase(std::remove_if(bullets.begin(), bullets.end(), [&](const Bullet& bullet) {
+            return bullet.IsOutOfBounds(config.arenaWidth, config.arenaHeight) || bullet.HitsAny(level.targets) || bullet.HitsAny(level.walls);
+            }), bullets.end());
+    }
+    tick++;
+}
+
+// Copy tank states and every bullet list end to end
+void RollbackWorld::Save(WorldState& state) const
+{
+    PROFILE_SCOPE("Rollback::Save");
+    state.tick = tick;
+    state.tanks.clear();
+    state.bulletCounts.clear();
+    state.bullets.clear();
+    for (const Tank& tank : tanks)
+    {
+        const BulletList& bullets = tank.GetBullets();
+        state.tanks.push_back(tank.GetState());
+        state.bulletCounts.push_back(static_cast<uint32_t>(bullets.size()));
+        state.bullets.insert(state.bullets.end(), bullets.begin(), bullets.end());
+    }
+}
+
+// Copy every tank and bullet list back, the lists keep their pooled storage
+void RollbackWorld::Load(const WorldState& state)
+{
+    PROFILE_SCOPE("Rollback::Load");
+    tick = state.tick;
+    size_t bulletStart = 0;
+    for (size_t i = 0; i < tanks.size(); ++i)
+    {
+        tanks[i].SetState(state.tanks[i]);
+        const Bullet* first = state.bullets.data() + bulletStart;
+        tanks[i].GetBullets().assign(first, first + state.bulletCounts[i]);
+        bulletStart += state.bulletCounts[i];
+    }
+}
+
+// Hash the live world tank by tank, matching ChecksumWorldState
+uint64_t RollbackWorld::Checksum() const
+{
+    uint64_t hash = HashValue(tick);
+    for (const Tank& tank : tanks)
+    {
+        const BulletList& bullets = tank.GetBullets();
+        hash = HashTank(tank.GetState(), bullets.data(), static_cast<uint32_t>(bullets.size()), hash);
+    }
+    return hash;
+}
+
+// Draw the level under the tanks
+void RollbackWorld::Draw()
+{
+    for (const Rectangle& wall : level.walls)
+    {
+        DrawRectangleRec(wall, DARKGRAY);
+    }
+    for (Tank& tank : tanks)
+    {
+        tank.Draw();
+    }
+    for (const Rectangle& target : level.targets)
+    {
+        DrawRectangleRec(target, GREEN);
+    }
+}
+
+// Get the number of ticks simulated
+uint32_t RollbackWorld::GetTick() const
+{
+    return tick;
+}
+
+// Get the number of tanks
+int RollbackWorld::GetPlayerCount() const
+{
+    return static_cast<int>(tanks.size());
+}
+
+// Get the level bullets are culled against
+Level& RollbackWorld::GetLevel()
+{
+    return level;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "Bullet.h"
+#include "Level.h"
+#include "Pool.h"
+#include "Simulation.h"
+#include "Tank.h"
+#include "TankInput.h"
+#include <cstdint>
+#include <vector>
+
+// Everything that changes while a RollbackWorld is stepped, copied out by Save and back in by Load
+// Tanks and bullets are plain copies, so after the first few saves the vectors stop growing and a
+// save or load is a handful of memcpys.
+struct WorldState
+{
+    uint32_t tick;
+    std::vector<TankState> tanks;
+    std::vector<uint32_t> bulletCounts; // Bullets belonging to each tank, in tank order
+    std::vector<Bullet> bullets;
+};
+
+// Hashes a saved world the same way RollbackWorld::Checksum hashes the live one
+uint64_t ChecksumWorldState(const WorldState& state);
+
+// A deterministic arena with one tank per player, stepped from every player's input at once
+// Nothing here draws or reads the clock, so the same inputs always give the same world and any
+// saved tick can be loaded and re-simulated.
+class RollbackWorld
+{
+public:
+    RollbackWorld(const SimulationConfig& config, int playerCount, Sprite bodySprite, Sprite turretSprite, Sprite bulletSprite);
+
+    // Advances the world by one tick, inputs holds one entry per player
+    void Step(const TankInput* inputs, float deltaTime);
+
+    // Copies the world into a state, reusing its storage
+    void Save(WorldState& state) const;
+
+    // Replaces the world with a state from Save
+    void Load(const WorldState& state);
+
+    // Hash of every value that affects future ticks
+    uint64_t Checksum() const;
+
+    // Draws every tank and its bullets, the caller is responsible for BeginDrawing/EndDrawing
+    void Draw();
+
+    uint32_t GetTick() const;
+    int GetPlayerCount() const;
+    Level& GetLevel();
+
+private:
+    SimulationConfig config;
+    MemoryPool bulletPool; // Declared before the tanks, whose bullet lists allocate from it
+    std::vector<Tank> tanks;
+    Level level;
+    uint32_t tick;
+};
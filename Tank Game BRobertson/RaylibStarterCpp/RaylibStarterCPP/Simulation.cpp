@@ -0,0 +1,275 @@
+#include "Simulation.h"
+#include "Hash.h"
+#include "Profiler.h"
+#include "WorldSnapshot.h"
+#include <algorithm>
+
+using namespace MathClasses;
+
+namespace
+{
+    // Enough for the bullet list to grow past 10k bullets without spilling to the heap
+    const size_t entityPoolBytes = 4 * 1024 * 1024;
+
+    // Append every box that overlaps the screen to a draw list
+    void CollectVisible(const std::vector<Rectangle>& boxes, const Rectangle& screen, ArenaVector<Rectangle>& visible)
+    {
+        visible.reserve(boxes.size());
+        for (const Rectangle& box : boxes)
+        {
+            if (CheckCollisionRecs(box, screen))
+            {
+                visible.push_back(box);
+            }
+        }
+    }
+
+    // Start of the hash Checksum returns; each bullet's position is then folded in with HashBulletPosition
+    uint64_t HashWorld(uint32_t tick, float x, float y, float bodyRotation, float turretRotation, uint32_t targetCount, uint32_t bulletCount)
+    {
+        uint64_t hash = HashValue(tick);
+        hash = HashValue(x, hash);
+        hash = HashValue(y, hash);
+        hash = HashValue(bodyRotation, hash);
+        hash = HashValue(turretRotation, hash);
+        hash = HashValue(targetCount, hash);
+        return HashValue(bulletCount, hash);
+    }
+
+    uint64_t HashBulletPosition(float x, float y, uint64_t hash)
+    {
+        hash = HashValue(x, hash);
+        return HashValue(y, hash);
+    }
+}
+
+// Keep in step with body.png, turret.png and bullet.png
+void SetShippedSpriteSizes(SimulationConfig& config)
+{
+    config.bodyWidth = 84;
+    config.bodyHeight = 84;
+    config.turretWidth = 32;
+    config.turretHeight = 60;
+    config.bulletWidth = 20;
+    config.bulletHeight = 34;
+}
+
+// Constructor placing the tank at its spawn point in an empty arena
+Simulation::Simulation(const SimulationConfig& config, Sprite bodySprite, Sprite turretSprite, Sprite bulletSprite)
+    : config(config), bodySprite(bodySprite), turretSprite(turretSprite), bulletSprite(bulletSprite),
+    entityPool(entityPoolBytes),
+    tank(MathClasses::Vector3(config.tankStartX, config.tankStartY, 0.0f), bodySprite, turretSprite, bulletSprite, entityPool),
+    frameArena(64 * 1024), drawArena(64 * 1024), tick(0), bulletGeneration(0), levelGeneration(0), timings()
+{
+}
+
+// Constructor for headless runs such as replay verification
+Simulation::Simulation(const SimulationConfig& config)
+    : Simulation(config, Sprite::FromSize(config.bodyWidth, config.bodyHeight),
+        Sprite::FromSize(config.turretWidth, config.turretHeight), Sprite::FromSize(config.bulletWidth, config.bulletHeight))
+{
+}
+
+// Copy the world out of a snapshot, reading the records in place
+bool Simulation::Restore(const SnapshotView& snapshot)
+{
+    const SnapshotHeader& header = snapshot.GetHeader();
+    if (header.tankCount != 1)
+    {
+        return false;
+    }
+
+    // The records restore exactly, so the world they make hashes the same as the one that was saved;
+    // check that before touching anything, so a stale or corrupted snapshot leaves the world as it was
+    const TankRecord& record = snapshot.GetTanks()[0];
+    const BulletRecord* records = snapshot.GetBullets() + record.firstBullet;
+    uint64_t hash = HashWorld(header.tick, record.position[0], record.position[1], record.bodyRotation, record.turretRotation,
+        header.targetCount, record.bulletCount);
+    for (uint32_t i = 0; i < record.bulletCount; ++i)
+    {
+        hash = HashBulletPosition(records[i].position[0], records[i].position[1], hash);
+    }
+    if (hash != header.worldChecksum)
+    {
+        return false;
+    }
+
+    config = header.config;
+    tick = header.tick;
+
+    TankState state;
+    state.position = MathClasses::Vector3(record.position[0], record.position[1], 0.0f);
+    state.bodyRotation = record.bodyRotation;
+    state.turretRotation = record.turretRotation;
+    state.bodyTransform = Matrix3(record.bodyTransform);
+    state.turretTransform = Matrix3(record.turretTransform);
+    tank.SetState(state);
+
+    level.targets.assign(snapshot.GetTargets(), snapshot.GetTargets() + header.targetCount);
+    level.walls.assign(snapshot.GetWalls(), snapshot.GetWalls() + header.wallCount);
+    level.spawnPoints.assign(snapshot.GetSpawnPoints(), snapshot.GetSpawnPoints() + header.spawnCount);
+
+    bulletGeneration++;
+    levelGeneration++;
+
+    BulletList& bullets = tank.GetBullets();
+    bullets.clear();
+    for (uint32_t i = 0; i < record.bulletCount; ++i)
+    {
+        const BulletRecord& bullet = records[i];
+        bullets.emplace_back(MathClasses::Vector3(bullet.position[0], bullet.position[1], 0.0f),
+            MathClasses::Vector3(bullet.direction[0], bullet.direction[1], 0.0f), bullet.speed, bullet.rotation, bulletSprite);
+    }
+    return true;
+}
+
+// Apply input, move everything, then destroy bullets that are out of bounds or have hit a target or wall
+void Simulation::Step(const TankInput& input, float deltaTime)
+{
+    frameArena.Reset();
+    timings.updateMs = 0.0f;
+    timings.cullMs = 0.0f;
+
+    // Firing only appends and culling only removes, so a bullet count that moved in either phase means new entities
+    BulletList& bullets = tank.GetBullets();
+    size_t bulletCount = bullets.size();
+    {
+        ScopedTimer timer(timings.updateMs);
+        tank.Update(input, deltaTime);
+    }
+    bool bulletsChanged = bullets.size() != bulletCount;
+
+    {
+        PROFILE_SCOPE("Bullets::Cull");
+        ScopedTimer timer(timings.cullMs);
+        bulletCount = bullets.size();
+        bullets.erase(std::remove_if(bullets.begin(), bullets.end(), [&](const Bullet& bullet) {
+            return bullet.IsOutOfBounds(config.arenaWidth, config.arenaHeight) || bullet.HitsAny(level.targets) || bullet.HitsAny(level.walls);
+            }), bullets.end());
+        bulletsChanged = bulletsChanged || bullets.size() != bulletCount;
+    }
+    if (bulletsChanged)
+    {
+        bulletGeneration++;
+    }
+
+    tick++;
+}
+
+// Spawned bullets live alongside the tank's own, so they are culled and hashed the same way
+void Simulation::SpawnBullet(MathClasses::Vector3 position, MathClasses::Vector3 direction)
+{
+    tank.GetBullets().emplace_back(position, direction, bulletSprite);
+    bulletGeneration++;
+}
+
+// Draw the world, the caller is responsible for BeginDrawing/EndDrawing
+// Walls and targets are culled to the screen into draw lists in the draw arena, which is reset here
+// rather than in Step, because a paused or finished replay keeps drawing without stepping
+void Simulation::Draw()
+{
+    timings.drawMs = 0.0f;
+    ScopedTimer timer(timings.drawMs);
+    drawArena.Reset();
+
+    Rectangle screen = { 0.0f, 0.0f, (float)GetScreenWidth(), (float)GetScreenHeight() };
+
+    ArenaVector<Rectangle> visibleWalls{ ArenaAllocator<Rectangle>(drawArena) };
+    CollectVisible(level.walls, screen, visibleWalls);
+    ArenaVector<Rectangle> visibleTargets{ ArenaAllocator<Rectangle>(drawArena) };
+    CollectVisible(level.targets, screen, visibleTargets);
+
+    for (const Rectangle& wall : visibleWalls)
+    {
+        DrawRectangleRec(wall, DARKGRAY);
+    }
+
+    tank.Draw();
+
+    // Draw the boxes for testing collision
+    for (const Rectangle& target : visibleTargets)
+    {
+        DrawRectangleRec(target, GREEN);
+    }
+}
+
+// Hash every value that affects future ticks
+uint64_t Simulation::Checksum() const
+{
+    MathClasses::Vector3 position = tank.GetPosition();
+    const BulletList& bullets = tank.GetBullets();
+    uint64_t hash = HashWorld(tick, position.x, position.y, tank.GetBodyRotation(), tank.GetTurretRotation(),
+        static_cast<uint32_t>(level.targets.size()), static_cast<uint32_t>(bullets.size()));
+    for (const Bullet& bullet : bullets)
+    {
+        MathClasses::Vector3 bulletPosition = bullet.GetPosition();
+        hash = HashBulletPosition(bulletPosition.x, bulletPosition.y, hash);
+    }
+    return hash;
+}
+
+// Get the number of ticks simulated since the last reset
+uint32_t Simulation::GetTick() const
+{
+    return tick;
+}
+
+// Get the counter that moves whenever the bullet list gains or loses bullets
+uint32_t Simulation::GetBulletGeneration() const
+{
+    return bulletGeneration;
+}
+
+// Get the counter that moves whenever a snapshot replaces the level
+uint32_t Simulation::GetLevelGeneration() const
+{
+    return levelGeneration;
+}
+
+// Get the phase timings of the last Step and Draw
+const PhaseTimings& Simulation::GetTimings() const
+{
+    return timings;
+}
+
+// Get the simulated tank
+Tank& Simulation::GetTank()
+{
+    return tank;
+}
+
+// Get the simulated tank (read-only)
+const Tank& Simulation::GetTank() const
+{
+    return tank;
+}
+
+// Get the per-tick scratch allocator
+FrameArena& Simulation::GetFrameArena()
+{
+    return frameArena;
+}
+
+// Get the pool entity storage is allocated from
+const MemoryPool& Simulation::GetEntityPool() const
+{
+    return entityPool;
+}
+
+// Get the level geometry
+Level& Simulation::GetLevel()
+{
+    return level;
+}
+
+// Get the level geometry (read-only)
+const Level& Simulation::GetLevel() const
+{
+    return level;
+}
+
+// Get the configuration the simulation was built from
+const SimulationConfig& Simulation::GetConfig() const
+{
+    return config;
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include "raylib.h"
+#include "FrameArena.h"
+#include "Level.h"
+#include "Pool.h"
+#include "Tank.h"
+#include "TankInput.h"
+#include <cstdint>
+
+class SnapshotView;
+
+// Everything needed to rebuild the starting state of a simulation
+// Kept as plain data so it can be written straight into replay files
+struct SimulationConfig
+{
+    float arenaWidth, arenaHeight; // Bullets are culled outside this area
+    float tankStartX, tankStartY;  // Spawn position of the tank
+    int bodyWidth, bodyHeight;     // Sprite sizes, which drive turret and muzzle offsets
+    int turretWidth, turretHeight;
+    int bulletWidth, bulletHeight;
+};
+
+// Sets the sprite sizes to those of the shipped body, turret and bullet art in assets/images,
+// so runs without a window collide and fire the way the game does
+void SetShippedSpriteSizes(SimulationConfig& config);
+
+// Time spent in each phase of the most recent Step and Draw
+struct PhaseTimings
+{
+    float updateMs; // Tank and bullet movement
+    float cullMs;   // Bullet bounds and hit tests
+    float drawMs;   // Screen culling and draw calls
+};
+
+// Owns the game world and advances it one fixed tick at a time from recorded or live input
+class Simulation
+{
+public:
+    // Builds a simulation using the given sprites for drawing
+    Simulation(const SimulationConfig& config, Sprite bodySprite, Sprite turretSprite, Sprite bulletSprite);
+
+    // Builds a simulation that never draws, using placeholder sprites of the configured sizes
+    explicit Simulation(const SimulationConfig& config);
+
+    // Replaces the world with a snapshot taken by WriteSnapshot
+    // Returns false, leaving the world untouched, if it does not fit or does not hash to the checksum it was saved with
+    bool Restore(const SnapshotView& snapshot);
+
+    // Advances the world by one tick
+    void Step(const TankInput& input, float deltaTime);
+
+    // Adds a bullet that is not fired by the tank, used to load up benchmark scenarios
+    void SpawnBullet(MathClasses::Vector3 position, MathClasses::Vector3 direction);
+
+    // Draws the tank, its bullets, the walls and the targets
+    void Draw();
+
+    // Returns a hash of the full world state, used to detect replay desyncs
+    uint64_t Checksum() const;
+
+    // Returns the number of ticks simulated since the last reset
+    uint32_t GetTick() const;
+
+    // Counters that change whenever bullets are fired, culled, spawned or restored, and whenever a snapshot
+    // replaces the level, so a view keyed by index can tell its rows now mean different entities even when
+    // the count is unchanged. Neither is part of the checksum.
+    uint32_t GetBulletGeneration() const;
+    uint32_t GetLevelGeneration() const;
+
+    // Returns how long the last Step and Draw took, phase by phase
+    const PhaseTimings& GetTimings() const;
+
+    Tank& GetTank();
+    const Tank& GetTank() const;
+
+    // Scratch memory for data that only lives until the next Step
+    FrameArena& GetFrameArena();
+
+    // Pool that entity storage such as the bullet list is allocated from
+    const MemoryPool& GetEntityPool() const;
+
+    // Targets and walls, which may keep growing while a level streams in
+    Level& GetLevel();
+    const Level& GetLevel() const;
+    const SimulationConfig& GetConfig() const;
+
+private:
+    SimulationConfig config;
+    Sprite bodySprite, turretSprite, bulletSprite;
+    MemoryPool entityPool; // Declared before the tank, which allocates from it
+    Tank tank;
+    Level level;
+    FrameArena frameArena;
+    FrameArena drawArena; // Draw lists, reset by Draw itself so frames drawn without a Step do not pile up
+    uint32_t tick;
+    uint32_t bulletGeneration;
+    uint32_t levelGeneration;
+    PhaseTimings timings;
+};
@@ -0,0 +1,1154 @@
+#include "BenchmarkCommands.h"
+#include "GameSetup.h"
+#include "AabbTree.h"
+#include "AiArena.h"
+#include "Bullet.h"
+#include "CollisionMask.h"
+#include "FlowField.h"
+#include "InterceptSolver.h"
+#include "Pool.h"
+#include "Profiler.h"
+#include "RayCaster.h"
+#include "SplashDamage.h"
+#include "SweepAndPrune.h"
+#include "TankCollider.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace MathClasses;
+
+namespace
+{
+    // Load a sprite image for the mask benchmark, or a rounded box of the headless size when the file is
+    // missing or has no opaque pixels. The rounded corners leave empty pixels inside the box as real art does.
+    Image LoadMaskImage(const char* file, int fallbackWidth, int fallbackHeight, bool& synthetic)
+    {
+        Image image = LoadImage(file);
+        if (image.data != nullptr)
+        {
+            ImageFormat(&image, UNCOMPRESSED_R8G8B8A8);
+            const unsigned char* pixels = static_cast<const unsigned char*>(image.data);
+            for (int i = 0; i < image.width * image.height; ++i)
+            {
+                if (pixels[i * 4 + 3] >= 128)
+                {
+                    return image;
+                }
+            }
+            UnloadImage(image);
+        }
+
+        synthetic = true;
+        image = GenImageColor(fallbackWidth, fallbackHeight, BLANK);
+        ImageFormat(&image, UNCOMPRESSED_R8G8B8A8);
+        unsigned char* pixels = static_cast<unsigned char*>(image.data);
+        float radius = std::min(fallbackWidth, fallbackHeight) * 0.35f;
+        for (int y = 0; y < fallbackHeight; ++y)
+        {
+            for (int x = 0; x < fallbackWidth; ++x)
+            {
+                float dx = std::max(std::max(radius - (x + 0.5f), x + 0.5f - (fallbackWidth - radius)), 0.0f);
+                float dy = std::max(std::max(radius - (y + 0.5f), y + 0.5f - (fallbackHeight - radius)), 0.0f);
+                pixels[(y * fallbackWidth + x) * 4 + 3] = dx * dx + dy * dy <= radius * radius ? 255 : 0;
+            }
+        }
+        return image;
+    }
+}
+
+// Run AI arenas of growing size with grid targeting, then a shorter brute-force run of each
+// The brute-force run steps a grid arena alongside it and counts the tanks whose targets differ
+int BenchmarkAi(int tankCount, int ticks)
+{
+    if (tankCount < 2 || ticks <= 0)
+    {
+        printf("--bench-ai needs at least 2 tanks and a positive tick count\n");
+        return 1;
+    }
+
+    const float tickSeconds = 1.0f / 120.0f;
+    const float tickBudgetMs = 1000.0f / 120.0f;
+    const int bruteForceTicks = ticks < 30 ? ticks : 30;
+    SimulationConfig config = MakeHeadlessConfig();
+    Sprite body = Sprite::FromSize(config.bodyWidth, config.bodyHeight);
+    Sprite turret = Sprite::FromSize(config.turretWidth, config.turretHeight);
+    Sprite bullet = Sprite::FromSize(config.bulletWidth, config.bulletHeight);
+
+    std::vector<int> counts;
+    for (int count : { tankCount / 100, tankCount / 10, tankCount })
+    {
+        if (count >= 2 && (counts.empty() || counts.back() != count))
+        {
+            counts.push_back(count);
+        }
+    }
+
+    printf("AI tanks at 120 Hz, 160 px apart, grid runs %d ticks and brute force %d\n", ticks, bruteForceTicks);
+    printf(" tanks  targeting    ticks/s   mean ms  p99 ms   gather  target  aim     steer   collide  cull    target/tick  engaged  bullets   hits  mismatches\n");
+    for (int count : counts)
+    {
+        float side = ceilf(sqrtf((float)count)) * 160.0f;
+        for (AiTargeting mode : { AiTargeting::Grid, AiTargeting::BruteForce })
+        {
+            AiArena arena(side, side, body, turret, bullet, count);
+            arena.SpawnLattice(count);
+            arena.SetTargeting(mode);
+
+            std::unique_ptr<AiArena> check;
+            if (mode == AiTargeting::BruteForce)
+            {
+                check = std::make_unique<AiArena>(side, side, body, turret, bullet, count);
+                check->SpawnLattice(count);
+            }
+
+            int runTicks = mode == AiTargeting::Grid ? ticks : bruteForceTicks;
+            std::vector<float> tickMs;
+            tickMs.reserve(runTicks);
+            AiTimings total = {};
+            uint64_t mismatches = 0;
+            for (int tick = 0; tick < runTicks; ++tick)
+            {
+                arena.Step(tickSeconds);
+                const AiTimings& timings = arena.GetTimings();
+                tickMs.push_back(timings.gatherMs + timings.targetMs + timings.aimMs + timings.steerMs + timings.collideMs + timings.cullMs);
+                total.gatherMs += timings.gatherMs;
+                total.targetMs += timings.targetMs;
+                total.aimMs += timings.aimMs;
+                total.steerMs += timings.steerMs;
+                total.collideMs += timings.collideMs;
+                total.cullMs += timings.cullMs;
+
+                if (check)
+                {
+                    check->Step(tickSeconds);
+                    for (size_t i = 0; i < arena.GetTankCount(); ++i)
+                    {
+                        mismatches += arena.GetTargets()[i] != check->GetTargets()[i] ? 1 : 0;
+                    }
+                }
+            }
+
+            int engaged = 0;
+            for (int32_t target : arena.GetTargets())
+            {
+                engaged += target >= 0 ? 1 : 0;
+            }
+
+            double meanMs = (double)(total.gatherMs + total.targetMs + total.aimMs + total.steerMs + total.collideMs + total.cullMs) / runTicks;
+            std::sort(tickMs.begin(), tickMs.end());
+            printf("%6d  %-11s  %8.0f  %8.3f  %6.3f  %7.3f  %6.3f  %6.3f  %6.3f  %7.3f  %6.3f  %10.1f%%  %7d  %7d  %5d  %10s\n",
+                count, mode == AiTargeting::Grid ? "grid" : "brute force", 1000.0 / meanMs, meanMs, tickMs[(size_t)(tickMs.size() * 0.99f)],
+                total.gatherMs / runTicks, total.targetMs / runTicks, total.aimMs / runTicks, total.steerMs / runTicks, total.collideMs / runTicks, total.cullMs / runTicks,
+                total.targetMs / runTicks / tickBudgetMs * 100.0f, engaged, (int)arena.GetBulletCount(), (int)arena.GetHitCount(),
+                check ? std::to_string(mismatches).c_str() : "-");
+        }
+    }
+    return 0;
+}
+
+// Solve lead shots for random shooters and moving targets with the scalar and SSE2 batches, then fire
+// real bullets along a sample of the answers, and straight at the targets, to see which ones connect
+int BenchmarkAim(int shots)
+{
+    if (shots <= 0)
+    {
+        printf("--bench-aim needs a positive shot count\n");
+        return 1;
+    }
+
+    const int repeats = 5;
+    const int hitChecks = 2000;
+    const float hitRadius = 8.0f;
+    const float tickSeconds = 1.0f / 120.0f;
+    SimulationConfig config = MakeHeadlessConfig();
+    Sprite body = Sprite::FromSize(config.bodyWidth, config.bodyHeight);
+    Sprite turret = Sprite::FromSize(config.turretWidth, config.turretHeight);
+    Sprite bullet = Sprite::FromSize(config.bulletWidth, config.bulletHeight);
+
+    uint32_t seed = 0x2545F491u;
+    auto random = [&seed]() {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return (seed >> 8) * (1.0f / 16777216.0f);
+    };
+
+    // Targets 100 to 700 px away, most moving at up to tank speed and one in ten up to well past bullet speed
+    InterceptSolver solver(Bullet::launchSpeed, (float)config.turretHeight);
+    std::vector<Vector2> origins, targets, velocities;
+    origins.reserve(shots);
+    targets.reserve(shots);
+    velocities.reserve(shots);
+    for (int i = 0; i < shots; ++i)
+    {
+        Vector2 origin = { random() * 2000.0f, random() * 2000.0f };
+        float range = 100.0f + random() * 600.0f;
+        float bearing = random() * 2.0f * PI;
+        float heading = random() * 2.0f * PI;
+        float speed = random() * (i % 10 == 9 ? 600.0f : 100.0f);
+        origins.push_back(origin);
+        targets.push_back({ origin.x + cosf(bearing) * range, origin.y + sinf(bearing) * range });
+        velocities.push_back({ cosf(heading) * speed, sinf(heading) * speed });
+        solver.Add(origins.back(), targets.back(), velocities.back());
+    }
+
+    double scalarMs = 1e9, vectorMs = 1e9;
+    for (int repeat = 0; repeat < repeats; ++repeat)
+    {
+        uint64_t startNs = Profiler::NowNs();
+        solver.SolveAllScalar();
+        scalarMs = std::min(scalarMs, (Profiler::NowNs() - startNs) / 1000000.0);
+    }
+    std::vector<float> scalarTimes = solver.GetTimes();
+    std::vector<float> scalarX = solver.GetDirectionsX();
+    std::vector<float> scalarY = solver.GetDirectionsY();
+    for (int repeat = 0; repeat < repeats; ++repeat)
+    {
+        uint64_t startNs = Profiler::NowNs();
+        solver.SolveAll();
+        vectorMs = std::min(vectorMs, (Profiler::NowNs() - startNs) / 1000000.0);
+    }
+
+    int reachable = 0, mismatches = 0;
+    for (int i = 0; i < shots; ++i)
+    {
+        reachable += solver.GetTime(i) >= 0.0f ? 1 : 0;
+        Vector2 direction = solver.GetDirection(i);
+        if (solver.GetTime(i) != scalarTimes[i] || direction.x != scalarX[i] || direction.y != scalarY[i])
+        {
+            mismatches++;
+        }
+    }
+
+    printf("%d shots at %.0f px/s from a %d px muzzle, best of %d runs\n", shots, Bullet::launchSpeed, config.turretHeight, repeats);
+    printf("solver  total ms  ns/shot  speedup\n");
+    printf("scalar  %8.3f  %7.2f\n", scalarMs, scalarMs * 1000000.0 / shots);
+    printf("sse2    %8.3f  %7.2f  %6.2fx\n", vectorMs, vectorMs * 1000000.0 / shots, scalarMs / vectorMs);
+    printf("reachable %d of %d, %d mismatches against scalar\n", reachable, shots, mismatches);
+
+    // Fire from a real tank, whose body starts at -180 degrees, and step bullet and target at 120 Hz
+    MemoryPool bulletPool(1024 * 1024);
+    int checked = 0, leadHits = 0, directHits = 0;
+    double leadClosest = 0.0, directClosest = 0.0;
+    for (int i = 0; i < shots && checked < hitChecks; ++i)
+    {
+        float flightTime = solver.GetTime(i);
+        if (flightTime < 0.0f)
+        {
+            continue;
+        }
+        checked++;
+
+        Vector2 aims[2] = { solver.GetDirection(i), { targets[i].x - origins[i].x, targets[i].y - origins[i].y } };
+        for (int mode = 0; mode < 2; ++mode)
+        {
+            Tank tank(MathClasses::Vector3(origins[i].x, origins[i].y, 0.0f), body, turret, bullet, bulletPool, 1);
+            tank.RotateTurret(InterceptSolver::TurretRotationFor(aims[mode], tank.GetBodyRotation()));
+            tank.FireBullet();
+            Bullet& shot = tank.GetBullets().back();
+
+            Vector2 position = targets[i];
+            float closest = FLT_MAX;
+            for (float elapsed = 0.0f; elapsed < flightTime + 0.5f; elapsed += tickSeconds)
+            {
+                MathClasses::Vector3 bulletPosition = shot.GetPosition();
+                float dx = bulletPosition.x - position.x;
+                float dy = bulletPosition.y - position.y;
+                closest = std::min(closest, sqrtf(dx * dx + dy * dy));
+                shot.Update(tickSeconds);
+                position.x += velocities[i].x * tickSeconds;
+                position.y += velocities[i].y * tickSeconds;
+            }
+            (mode == 0 ? leadHits : directHits) += closest < hitRadius ? 1 : 0;
+            (mode == 0 ? leadClosest : directClosest) += closest;
+        }
+    }
+    if (checked > 0)
+    {
+        printf("fired %d reachable shots from tanks, hit within %.0f px: lead %.1f%% (closest %.2f px on average), straight at the target %.1f%% (%.2f px)\n",
+            checked, hitRadius, leadHits * 100.0 / checked, leadClosest / checked, directHits * 100.0 / checked, directClosest / checked);
+    }
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Scatter tanks at random angles so tightly that most bodies overlap, then push them apart round by round
+// Each round times the scalar and SSE2 separating-axis tests on the same pairs and checks they agree
+int BenchmarkCollision(int tankCount, int iterations)
+{
+    if (tankCount < 2 || iterations <= 0)
+    {
+        printf("--bench-collide needs at least 2 tanks and a positive iteration count\n");
+        return 1;
+    }
+
+    const int repeats = 5;
+    SimulationConfig config = MakeHeadlessConfig();
+    Sprite body = Sprite::FromSize(config.bodyWidth, config.bodyHeight);
+    Sprite turret = Sprite::FromSize(config.turretWidth, config.turretHeight);
+    Sprite bullet = Sprite::FromSize(config.bulletWidth, config.bulletHeight);
+
+    // About one and a half bodies of room per tank: scattered at random most start out overlapping, but there is space to separate
+    float side = ceilf(sqrtf((float)tankCount)) * 80.0f;
+    uint32_t seed = 0x9E3779B9u;
+    auto random = [&seed]() {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return (seed >> 8) * (1.0f / 16777216.0f);
+    };
+    MemoryPool bulletPool(64 * 1024);
+    std::vector<Tank> tanks;
+    tanks.reserve(tankCount);
+    for (int i = 0; i < tankCount; ++i)
+    {
+        tanks.emplace_back(MathClasses::Vector3(random() * side, random() * side, 0.0f), body, turret, bullet, bulletPool, 0);
+        tanks.back().RotateBody(random() * 360.0f);
+    }
+
+    TankCollider collider(side, side);
+    std::vector<TankContact> scalarContacts;
+    printf("%d tanks of %dx%d px in %.0f px square, best of %d runs per test\n", tankCount, config.bodyWidth, config.bodyHeight, side, repeats);
+    printf("round   pairs  contacts  total depth  broadphase ms  scalar ms  sse2 ms  speedup  resolve ms  mismatches\n");
+    for (int round = 0; round < iterations; ++round)
+    {
+        uint64_t startNs = Profiler::NowNs();
+        collider.Gather(tanks);
+        collider.FindPairs();
+        double broadphaseMs = (Profiler::NowNs() - startNs) / 1000000.0;
+
+        double scalarMs = 1e9, vectorMs = 1e9;
+        for (int repeat = 0; repeat < repeats; ++repeat)
+        {
+            startNs = Profiler::NowNs();
+            collider.TestPairsScalar();
+            scalarMs = std::min(scalarMs, (Profiler::NowNs() - startNs) / 1000000.0);
+        }
+        scalarContacts = collider.GetContacts();
+        for (int repeat = 0; repeat < repeats; ++repeat)
+        {
+            startNs = Profiler::NowNs();
+            collider.TestPairs();
+            vectorMs = std::min(vectorMs, (Profiler::NowNs() - startNs) / 1000000.0);
+        }
+
+        // Both versions walk the pairs in the same order, so their contacts line up one for one
+        const std::vector<TankContact>& contacts = collider.GetContacts();
+        size_t mismatches = contacts.size() > scalarContacts.size() ? contacts.size() - scalarContacts.size() : scalarContacts.size() - contacts.size();
+        for (size_t i = 0; i < contacts.size() && i < scalarContacts.size(); ++i)
+        {
+            const TankContact& a = contacts[i];
+            const TankContact& b = scalarContacts[i];
+            if (a.a != b.a || a.b != b.b || a.depth != b.depth || a.normalX != b.normalX || a.normalY != b.normalY)
+            {
+                mismatches++;
+            }
+        }
+
+        startNs = Profiler::NowNs();
+        collider.Resolve(tanks);
+        double resolveMs = (Profiler::NowNs() - startNs) / 1000000.0;
+
+        printf("%5d  %6zu  %8zu  %11.0f  %13.3f  %9.3f  %7.3f  %6.2fx  %10.3f  %10zu\n", round + 1, collider.GetPairCount(), contacts.size(),
+            collider.GetTotalDepth(), broadphaseMs, scalarMs, vectorMs, scalarMs / vectorMs, resolveMs, mismatches);
+    }
+    return 0;
+}
+
+// Time the dynamic AABB tree against checking every box with Bullet::BoxCollision, over growing
+// object counts and three size mixes: small targets only, small targets among long walls, and large
+// overlapping boxes. Each run inserts every box, drifts a tenth of them at tank speed for a second,
+// rebuilds, then runs bullet point queries and ray casts both ways and compares the answers.
+int BenchmarkAabbTree(int maxObjects)
+{
+    if (maxObjects < 100)
+    {
+        printf("--bench-tree needs at least 100 objects\n");
+        return 1;
+    }
+
+    const int queryCount = 2000;
+    const int moveTicks = 120;
+    const float tickSeconds = 1.0f / 120.0f;
+    const float rayLength = 1000.0f;
+    const char* mixNames[] = { "small", "mixed", "large" };
+    SimulationConfig config = MakeHeadlessConfig();
+    Sprite bulletSprite = Sprite::FromSize(config.bulletWidth, config.bulletHeight);
+    uint32_t seed = 0x9E3779B9u;
+    auto random = [&seed]() {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return (seed >> 8) * (1.0f / 16777216.0f);
+    };
+
+    printf("%d point queries and %d rays of %.0f px per run, a tenth of the boxes drifting for %d ticks\n", queryCount, queryCount, rayLength, moveTicks);
+    printf("objects  mix     insert ms  move ms/tick  reinserts/tick  ratio new/moved/rebuilt  balance  height  "
+        "points tree ms  brute ms  speedup  rays tree ms  brute ms  speedup  valid  mismatches\n");
+    bool allValid = true;
+    int totalMismatches = 0;
+    const int counts[] = { maxObjects / 100, maxObjects / 10, maxObjects };
+    for (int count : counts)
+    {
+        for (int mix = 0; mix < 3; ++mix)
+        {
+            // Keep the density the same as the count grows
+            float side = sqrtf((float)count) * 64.0f;
+            std::vector<Rectangle> boxes(count);
+            for (int i = 0; i < count; ++i)
+            {
+                float width, height;
+                if (mix == 0 || (mix == 1 && i % 50 != 0))
+                {
+                    width = 4.0f + random() * 20.0f;
+                    height = 4.0f + random() * 20.0f;
+                }
+                else if (mix == 1)
+                {
+                    float length = 200.0f + random() * (side * 0.25f - 200.0f);
+                    float thickness = 8.0f + random() * 32.0f;
+                    bool horizontal = random() < 0.5f;
+                    width = horizontal ? length : thickness;
+                    height = horizontal ? thickness : length;
+                }
+                else
+                {
+                    width = 100.0f + random() * 300.0f;
+                    height = 100.0f + random() * 300.0f;
+                }
+                boxes[i] = { random() * (side - width), random() * (side - height), width, height };
+            }
+
+            AabbTree tree(4.0f);
+            std::vector<int32_t> proxies(count);
+            uint64_t startNs = Profiler::NowNs();
+            for (int i = 0; i < count; ++i)
+            {
+                proxies[i] = tree.Insert(boxes[i], i);
+            }
+            double insertMs = (Profiler::NowNs() - startNs) / 1000000.0;
+            float insertedRatio = tree.GetAreaRatio();
+
+            // Every tenth box wanders at up to tank speed
+            std::vector<Vector2> velocities(count, { 0.0f, 0.0f });
+            for (int i = 0; i < count; i += 10)
+            {
+                float heading = random() * 2.0f * PI;
+                float speed = random() * 100.0f;
+                velocities[i] = { cosf(heading) * speed, sinf(heading) * speed };
+            }
+            int reinserts = 0;
+            startNs = Profiler::NowNs();
+            for (int tick = 0; tick < moveTicks; ++tick)
+            {
+                for (int i = 0; i < count; i += 10)
+                {
+                    Vector2 step = { velocities[i].x * tickSeconds, velocities[i].y * tickSeconds };
+                    boxes[i].x += step.x;
+                    boxes[i].y += step.y;
+                    reinserts += tree.Move(proxies[i], boxes[i], step) ? 1 : 0;
+                }
+            }
+            double moveMs = (Profiler::NowNs() - startNs) / 1000000.0 / moveTicks;
+            float movedRatio = tree.GetAreaRatio();
+            bool valid = tree.Validate();
+            int maxBalance = tree.GetMaxBalance();
+            tree.Rebuild();
+            valid = valid && tree.Validate();
+            float rebuiltRatio = tree.GetAreaRatio();
+
+            // Bullets parked at random points, counting the boxes each one is inside
+            std::vector<Bullet> bullets;
+            bullets.reserve(queryCount);
+            for (int i = 0; i < queryCount; ++i)
+            {
+                bullets.emplace_back(MathClasses::Vector3(random() * side, random() * side, 0.0f), MathClasses::Vector3(1.0f, 0.0f, 0.0f), bulletSprite);
+            }
+            std::vector<int> treeHits(queryCount, 0), bruteHits(queryCount, 0);
+            startNs = Profiler::NowNs();
+            for (int i = 0; i < queryCount; ++i)
+            {
+                const Bullet& bullet = bullets[i];
+                MathClasses::Vector3 position = bullet.GetPosition();
+                tree.Query({ position.x, position.y, position.x, position.y }, [&](int32_t proxy) {
+                    const Rectangle& box = boxes[tree.GetUserData(proxy)];
+                    treeHits[i] += bullet.BoxCollision({ box.x, box.y }, { box.width, box.height }) ? 1 : 0;
+                    return true;
+                    });
+            }
+            double pointTreeMs = (Profiler::NowNs() - startNs) / 1000000.0;
+            startNs = Profiler::NowNs();
+            for (int i = 0; i < queryCount; ++i)
+            {
+                for (const Rectangle& box : boxes)
+                {
+                    bruteHits[i] += bullets[i].BoxCollision({ box.x, box.y }, { box.width, box.height }) ? 1 : 0;
+                }
+            }
+            double pointBruteMs = (Profiler::NowNs() - startNs) / 1000000.0;
+
+            // Rays from random points in random directions, keeping the nearest box each one enters
+            std::vector<Vector2> origins(queryCount), directions(queryCount);
+            for (int i = 0; i < queryCount; ++i)
+            {
+                float heading = random() * 2.0f * PI;
+                origins[i] = { random() * side, random() * side };
+                directions[i] = { cosf(heading), sinf(heading) };
+            }
+            std::vector<float> treeNearest(queryCount, rayLength), bruteNearest(queryCount, rayLength);
+            startNs = Profiler::NowNs();
+            for (int i = 0; i < queryCount; ++i)
+            {
+                Vector2 inverseDirection = { 1.0f / directions[i].x, 1.0f / directions[i].y };
+                float& nearest = treeNearest[i];
+                tree.RayCast(origins[i], directions[i], rayLength, [&](int32_t proxy, float maxDistance) {
+                    float distance;
+                    if (AabbBounds::FromRectangle(boxes[tree.GetUserData(proxy)]).IntersectRay(origins[i], inverseDirection, maxDistance, distance) &&
+                        distance < nearest)
+                    {
+                        nearest = distance;
+                        return distance;
+                    }
+                    return maxDistance;
+                    });
+            }
+            double rayTreeMs = (Profiler::NowNs() - startNs) / 1000000.0;
+            startNs = Profiler::NowNs();
+            for (int i = 0; i < queryCount; ++i)
+            {
+                Vector2 inverseDirection = { 1.0f / directions[i].x, 1.0f / directions[i].y };
+                float& nearest = bruteNearest[i];
+                for (const Rectangle& box : boxes)
+                {
+                    float distance;
+                    if (AabbBounds::FromRectangle(box).IntersectRay(origins[i], inverseDirection, nearest, distance) && distance < nearest)
+                    {
+                        nearest = distance;
+                    }
+                }
+            }
+            double rayBruteMs = (Profiler::NowNs() - startNs) / 1000000.0;
+
+            int mismatches = 0;
+            for (int i = 0; i < queryCount; ++i)
+            {
+                mismatches += treeHits[i] != bruteHits[i] ? 1 : 0;
+                mismatches += treeNearest[i] != bruteNearest[i] ? 1 : 0;
+            }
+            allValid = allValid && valid;
+            totalMismatches += mismatches;
+
+            printf("%7d  %-6s  %9.3f  %12.4f  %14.1f  %7.1f / %5.1f / %5.1f  %7d  %6d  %14.3f  %8.3f  %6.1fx  %12.3f  %8.3f  %6.1fx  %5s  %10d\n",
+                count, mixNames[mix], insertMs, moveMs, (double)reinserts / moveTicks, insertedRatio, movedRatio, rebuiltRatio, maxBalance, tree.GetHeight(),
+                pointTreeMs, pointBruteMs, pointBruteMs / pointTreeMs, rayTreeMs, rayBruteMs, rayBruteMs / rayTreeMs, valid ? "yes" : "NO", mismatches);
+        }
+    }
+    return allValid && totalMismatches == 0 ? 0 : 1;
+}
+
+// Drive tank-sized boxes around at tank speed and keep two sweep-and-prune broadphases in step: one
+// updated incrementally, one rebuilt from scratch every tick. Once a second a hundredth of the boxes
+// are removed and as many added elsewhere. Every tick's events are compared between the two.
+int BenchmarkSweepAndPrune(int objects, int ticks)
+{
+    if (objects < 100 || ticks <= 0)
+    {
+        printf("--bench-sap needs at least 100 objects and a positive tick count\n");
+        return 1;
+    }
+
+    const float tickSeconds = 1.0f / 120.0f;
+    const float boxSize = 64.0f;
+    const float speed = 100.0f;
+    const float turnRate = 60.0f * DEG2RAD;
+    uint32_t seed = 0x2545F491u;
+    auto random = [&seed]() {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return (seed >> 8) * (1.0f / 16777216.0f);
+    };
+    auto eventOrder = [](const PairEvent& a, const PairEvent& b) {
+        return a.a != b.a ? a.a < b.a : (a.b != b.b ? a.b < b.b : a.added < b.added);
+    };
+
+    printf("%d ticks at 120 Hz, %.0fx%.0f px boxes at %.0f px/s, 1%% of boxes replaced every 120 ticks\n", ticks, boxSize, boxSize, speed);
+    printf("objects  pairs  events/tick  swaps/tick  incremental ms  scratch ms  speedup  mismatched ticks\n");
+    int totalMismatches = 0;
+    const int counts[] = { objects / 10, objects };
+    for (int count : counts)
+    {
+        // Room for about four boxes' worth of space around each one
+        float side = sqrtf((float)count) * boxSize * 2.0f;
+        std::vector<Vector2> positions(count);
+        std::vector<float> headings(count);
+        std::vector<int32_t> proxies(count);
+        SweepAndPrune incremental, scratch;
+        for (int i = 0; i < count; ++i)
+        {
+            positions[i] = { random() * (side - boxSize), random() * (side - boxSize) };
+            headings[i] = random() * 2.0f * PI;
+            Rectangle box = { positions[i].x, positions[i].y, boxSize, boxSize };
+            proxies[i] = incremental.Add(box);
+            scratch.Add(box);
+        }
+        incremental.UpdateFromScratch();
+        scratch.UpdateFromScratch();
+
+        double incrementalMs = 0.0, scratchMs = 0.0;
+        size_t events = 0, swaps = 0, pairs = 0;
+        int mismatchedTicks = 0;
+        std::vector<PairEvent> incrementalEvents, scratchEvents;
+        for (int tick = 0; tick < ticks; ++tick)
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                headings[i] += (random() * 2.0f - 1.0f) * turnRate * tickSeconds;
+                Vector2& position = positions[i];
+                position.x += cosf(headings[i]) * speed * tickSeconds;
+                position.y += sinf(headings[i]) * speed * tickSeconds;
+                if (position.x < 0.0f || position.x > side - boxSize || position.y < 0.0f || position.y > side - boxSize)
+                {
+                    headings[i] += PI;
+                    position.x = std::min(std::max(position.x, 0.0f), side - boxSize);
+                    position.y = std::min(std::max(position.y, 0.0f), side - boxSize);
+                }
+            }
+
+            if (tick % 120 == 119)
+            {
+                for (int replaced = 0; replaced < count / 100; ++replaced)
+                {
+                    int i = (int)(random() * count) % count;
+                    incremental.Remove(proxies[i]);
+                    scratch.Remove(proxies[i]);
+                    positions[i] = { random() * (side - boxSize), random() * (side - boxSize) };
+                    Rectangle box = { positions[i].x, positions[i].y, boxSize, boxSize };
+                    proxies[i] = incremental.Add(box);
+                    scratch.Add(box);
+                }
+            }
+
+            for (int i = 0; i < count; ++i)
+            {
+                Rectangle box = { positions[i].x, positions[i].y, boxSize, boxSize };
+                incremental.SetBox(proxies[i], box);
+                scratch.SetBox(proxies[i], box);
+            }
+
+            uint64_t startNs = Profiler::NowNs();
+            incremental.Update();
+            incrementalMs += (Profiler::NowNs() - startNs) / 1000000.0;
+            startNs = Profiler::NowNs();
+            scratch.UpdateFromScratch();
+            scratchMs += (Profiler::NowNs() - startNs) / 1000000.0;
+
+            incrementalEvents = incremental.GetEvents();
+            scratchEvents = scratch.GetEvents();
+            std::sort(incrementalEvents.begin(), incrementalEvents.end(), eventOrder);
+            std::sort(scratchEvents.begin(), scratchEvents.end(), eventOrder);
+            bool same = incrementalEvents.size() == scratchEvents.size();
+            for (size_t i = 0; same && i < incrementalEvents.size(); ++i)
+            {
+                same = incrementalEvents[i].a == scratchEvents[i].a && incrementalEvents[i].b == scratchEvents[i].b &&
+                    incrementalEvents[i].added == scratchEvents[i].added;
+            }
+            mismatchedTicks += same ? 0 : 1;
+            events += incrementalEvents.size();
+            swaps += incremental.GetSwapCount();
+            pairs += incremental.GetPairCount();
+        }
+
+        std::vector<ProxyPair> incrementalPairs, scratchPairs;
+        incremental.GetPairs(incrementalPairs);
+        scratch.GetPairs(scratchPairs);
+        bool samePairs = incrementalPairs.size() == scratchPairs.size();
+        for (size_t i = 0; samePairs && i < incrementalPairs.size(); ++i)
+        {
+            samePairs = incrementalPairs[i].a == scratchPairs[i].a && incrementalPairs[i].b == scratchPairs[i].b;
+        }
+        mismatchedTicks += samePairs ? 0 : 1;
+        totalMismatches += mismatchedTicks;
+
+        printf("%7d  %5zu  %11.1f  %10.1f  %14.4f  %10.4f  %6.1fx  %16d\n", count, pairs / ticks, (double)events / ticks, (double)swaps / ticks,
+            incrementalMs / ticks, scratchMs / ticks, scratchMs / incrementalMs, mismatchedTicks);
+    }
+    return totalMismatches == 0 ? 0 : 1;
+}
+
+// Build collision masks from the body, turret and bullet art, then throw bullets at randomly turned tanks
+// and compare the centre-in-rotated-box test the arena used to rely on with the masks' answer. The
+// word-wide overlap is timed against the same test made one pixel at a time, and their answers compared.
+int BenchmarkMasks(int tests)
+{
+    if (tests <= 0)
+    {
+        printf("--bench-masks needs a positive test count\n");
+        return 1;
+    }
+
+    const int repeats = 5;
+    const unsigned char alphaThreshold = 128;
+    SimulationConfig config = MakeHeadlessConfig();
+    bool synthetic = false;
+    Image images[3] = {
+        LoadMaskImage("../assets/images/body.png", config.bodyWidth, config.bodyHeight, synthetic),
+        LoadMaskImage("../assets/images/turret.png", config.turretWidth, config.turretHeight, synthetic),
+        LoadMaskImage("../assets/images/bullet.png", config.bulletWidth, config.bulletHeight, synthetic)
+    };
+    const char* names[3] = { "body", "turret", "bullet" };
+    if (synthetic)
+    {
+        printf("Sprite art missing or fully transparent, using rounded boxes in its place\n");
+    }
+
+    CollisionMask masks[3];
+    printf("%d rotation steps per mask\n", CollisionMask::rotationSteps);
+    printf("sprite  size     solid px  frame px  build ms\n");
+    for (int i = 0; i < 3; ++i)
+    {
+        uint64_t startNs = Profiler::NowNs();
+        masks[i].Build(images[i], alphaThreshold);
+        double buildMs = (Profiler::NowNs() - startNs) / 1000000.0;
+        printf("%-6s  %3dx%-3d  %8zu  %8d  %8.3f\n", names[i], images[i].width, images[i].height, masks[i].GetSolidCount(),
+            masks[i].GetFrame(0.0f).size, buildMs);
+        UnloadImage(images[i]);
+    }
+    const CollisionMask& bodyMask = masks[0];
+    const CollisionMask& turretMask = masks[1];
+    const CollisionMask& bulletMask = masks[2];
+
+    uint32_t seed = 0xA511E9B3u;
+    auto random = [&seed]() {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return (seed >> 8) * (1.0f / 16777216.0f);
+    };
+
+    // Each test is a freshly turned tank and a bullet somewhere over its body, placed and turned as the arena draws them
+    struct MaskTest
+    {
+        const MaskFrame* body;
+        const MaskFrame* turret;
+        const MaskFrame* bullet;
+        Vector2 bodyCentre, turretCentre, bulletCentre;
+        bool inBox;
+    };
+    Sprite body = Sprite::FromSize(bodyMask.GetWidth(), bodyMask.GetHeight());
+    Sprite turret = Sprite::FromSize(turretMask.GetWidth(), turretMask.GetHeight());
+    MemoryPool bulletPool(64 * 1024);
+    std::vector<MaskTest> cases(tests);
+    float reach = 0.5f * sqrtf((float)(body.Width() * body.Width() + body.Height() * body.Height()));
+    for (MaskTest& test : cases)
+    {
+        Tank tank(MathClasses::Vector3(0.0f, 0.0f, 0.0f), body, turret, body, bulletPool, 0);
+        tank.RotateBody(random() * 360.0f);
+        tank.RotateTurret(random() * 360.0f);
+        Vector2 bulletCentre = { (random() * 2.0f - 1.0f) * reach, (random() * 2.0f - 1.0f) * reach };
+
+        float angle = tank.GetBodyRotation() * DEG2RAD;
+        float localX = bulletCentre.x * cosf(angle) + bulletCentre.y * sinf(angle);
+        float localY = -bulletCentre.x * sinf(angle) + bulletCentre.y * cosf(angle);
+        test.inBox = fabsf(localX) <= body.Width() * 0.5f && fabsf(localY) <= body.Height() * 0.5f;
+        test.body = &bodyMask.GetFrame(tank.GetBodyRotation());
+        test.turret = &turretMask.GetFrame(tank.GetBodyRotation() + tank.GetTurretRotation());
+        test.bullet = &bulletMask.GetFrame(random() * 360.0f);
+        test.bodyCentre = { 0.0f, 0.0f };
+        test.turretCentre = tank.GetTurretPosition();
+        test.bulletCentre = bulletCentre;
+    }
+
+    std::vector<uint8_t> wordHits(tests), pixelHits(tests);
+    double wordMs = 1e9, pixelMs = 1e9;
+    for (int repeat = 0; repeat < repeats; ++repeat)
+    {
+        uint64_t startNs = Profiler::NowNs();
+        for (int i = 0; i < tests; ++i)
+        {
+            const MaskTest& test = cases[i];
+            wordHits[i] = CollisionMask::Overlaps(*test.bullet, test.bulletCentre, *test.body, test.bodyCentre) ||
+                CollisionMask::Overlaps(*test.bullet, test.bulletCentre, *test.turret, test.turretCentre);
+        }
+        wordMs = std::min(wordMs, (Profiler::NowNs() - startNs) / 1000000.0);
+
+        startNs = Profiler::NowNs();
+        for (int i = 0; i < tests; ++i)
+        {
+            const MaskTest& test = cases[i];
+            pixelHits[i] = CollisionMask::OverlapsPerPixel(*test.bullet, test.bulletCentre, *test.body, test.bodyCentre) ||
+                CollisionMask::OverlapsPerPixel(*test.bullet, test.bulletCentre, *test.turret, test.turretCentre);
+        }
+        pixelMs = std::min(pixelMs, (Profiler::NowNs() - startNs) / 1000000.0);
+    }
+
+    int boxHits = 0, maskHits = 0, emptyCorners = 0, mismatches = 0;
+    for (int i = 0; i < tests; ++i)
+    {
+        boxHits += cases[i].inBox ? 1 : 0;
+        maskHits += wordHits[i] ? 1 : 0;
+        emptyCorners += cases[i].inBox && !wordHits[i] ? 1 : 0;
+        mismatches += wordHits[i] != pixelHits[i] ? 1 : 0;
+    }
+
+    printf("\n%d bullets over randomly turned tanks, best of %d runs\n", tests, repeats);
+    printf("box hits  mask hits  box hits on empty pixels  word AND ms  per pixel ms  speedup  ns/test  mismatches\n");
+    printf("%8d  %9d  %24d  %10.3f  %12.3f  %6.2fx  %7.1f  %10d\n", boxHits, maskHits, emptyCorners, wordMs, pixelMs,
+        pixelMs / wordMs, wordMs * 1000000.0 / tests, mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Cast a tick's worth of rays into an arena of targets, walls and turned tanks: hitscan shots from each
+// tank's turret, line-of-sight checks between tanks, and short sensor rays from anywhere. The rays go
+// through RayCaster on this thread and on a pool, and a sample is checked against every shape one by one.
+int BenchmarkRays(int rayCount)
+{
+    if (rayCount < 100)
+    {
+        printf("--bench-rays needs at least 100 rays\n");
+        return 1;
+    }
+
+    const int repeats = 5;
+    const int shapeCount = 2000;
+    const float tickBudgetMs = 1000.0f / 120.0f;
+    const float side = 4096.0f;
+    const float shotRange = 1500.0f;
+    const float sensorRange = 300.0f;
+    SimulationConfig config = MakeHeadlessConfig();
+    Sprite body = Sprite::FromSize(config.bodyWidth, config.bodyHeight);
+    Sprite turret = Sprite::FromSize(config.turretWidth, config.turretHeight);
+    Sprite bullet = Sprite::FromSize(config.bulletWidth, config.bulletHeight);
+    uint32_t seed = 0x68E31DA4u;
+    auto random = [&seed]() {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return (seed >> 8) * (1.0f / 16777216.0f);
+    };
+
+    std::vector<Rectangle> targets(shapeCount), walls(shapeCount);
+    for (Rectangle& target : targets)
+    {
+        target = { random() * side, random() * side, 20.0f + random() * 40.0f, 20.0f + random() * 40.0f };
+    }
+    for (Rectangle& wall : walls)
+    {
+        float length = 100.0f + random() * 400.0f;
+        float thickness = 16.0f + random() * 24.0f;
+        bool horizontal = random() < 0.5f;
+        wall = { random() * side, random() * side, horizontal ? length : thickness, horizontal ? thickness : length };
+    }
+    MemoryPool bulletPool(64 * 1024);
+    std::vector<Tank> tanks;
+    tanks.reserve(shapeCount);
+    for (int i = 0; i < shapeCount; ++i)
+    {
+        tanks.emplace_back(MathClasses::Vector3(random() * side, random() * side, 0.0f), body, turret, bullet, bulletPool, 0);
+        tanks.back().RotateBody(random() * 360.0f);
+        tanks.back().RotateTurret(random() * 360.0f);
+    }
+
+    RayCaster caster;
+    uint64_t startNs = Profiler::NowNs();
+    caster.SetBoxes(targets, walls);
+    double setBoxesMs = (Profiler::NowNs() - startNs) / 1000000.0;
+    startNs = Profiler::NowNs();
+    caster.UpdateTanks(tanks);
+    double firstUpdateMs = (Profiler::NowNs() - startNs) / 1000000.0;
+
+    // Drive every tank forward a tick and time the refresh the caster needs each tick
+    for (Tank& tank : tanks)
+    {
+        tank.MoveBody(100.0f / 120.0f);
+    }
+    startNs = Profiler::NowNs();
+    caster.UpdateTanks(tanks);
+    double updateMs = (Profiler::NowNs() - startNs) / 1000000.0;
+
+    // Half hitscan shots, a quarter line-of-sight checks, a quarter sensors
+    std::vector<Ray2D> rays(rayCount);
+    int kindCounts[3] = {};
+    for (int i = 0; i < rayCount; ++i)
+    {
+        int32_t from = (int32_t)(random() * shapeCount) % shapeCount;
+        MathClasses::Vector3 position = tanks[from].GetPosition();
+        Ray2D& ray = rays[i];
+        kindCounts[std::max(i % 4 - 1, 0)]++;
+        if (i % 4 < 2)
+        {
+            float angle = (tanks[from].GetBodyRotation() + tanks[from].GetTurretRotation() + 90.0f) * DEG2RAD;
+            ray = { { position.x, position.y }, { cosf(angle), sinf(angle) }, shotRange, RayCaster::hitAll, from };
+        }
+        else if (i % 4 == 2)
+        {
+            MathClasses::Vector3 other = tanks[(from + 1 + (int32_t)(random() * (shapeCount - 1))) % shapeCount].GetPosition();
+            ray = { { position.x, position.y }, { other.x - position.x, other.y - position.y }, 1.0f, RayCaster::hitWalls, -1 };
+        }
+        else
+        {
+            float angle = random() * 2.0f * PI;
+            ray = { { random() * side, random() * side }, { cosf(angle), sinf(angle) }, sensorRange, RayCaster::hitAll, -1 };
+        }
+    }
+
+    std::vector<RayHit> hits(rayCount);
+    double serialMs = 1e9, pooledMs = 1e9;
+    ThreadPool pool;
+    for (int repeat = 0; repeat < repeats; ++repeat)
+    {
+        startNs = Profiler::NowNs();
+        caster.CastAll(rays.data(), rays.size(), hits.data());
+        serialMs = std::min(serialMs, (Profiler::NowNs() - startNs) / 1000000.0);
+        startNs = Profiler::NowNs();
+        caster.CastAll(rays.data(), rays.size(), hits.data(), &pool);
+        pooledMs = std::min(pooledMs, (Profiler::NowNs() - startNs) / 1000000.0);
+    }
+
+    // Every shape against an evenly spread sample, scaled up to the full ray count for the timing
+    const int sampleStride = 50;
+    std::vector<Ray2D> sample;
+    std::vector<int> sampleIndices;
+    for (int i = 0; i < rayCount; i += sampleStride)
+    {
+        sample.push_back(rays[i]);
+        sampleIndices.push_back(i);
+    }
+    std::vector<RayHit> bruteHits(sample.size());
+    startNs = Profiler::NowNs();
+    caster.CastAllBruteForce(sample.data(), sample.size(), bruteHits.data());
+    double bruteMs = (Profiler::NowNs() - startNs) / 1000000.0 * rayCount / sample.size();
+
+    int mismatches = 0;
+    for (size_t i = 0; i < sample.size(); ++i)
+    {
+        const RayHit& a = hits[sampleIndices[i]];
+        const RayHit& b = bruteHits[i];
+        mismatches += a.shape != b.shape || a.index != b.index || a.distance != b.distance ? 1 : 0;
+    }
+    int shapeHits[4] = {};
+    for (const RayHit& hit : hits)
+    {
+        shapeHits[(int)hit.shape]++;
+    }
+
+    printf("%d targets, %d walls and %d tanks in a %.0f px square\n", shapeCount, shapeCount, shapeCount, side);
+    printf("set boxes %.3f ms, first tank update %.3f ms, per-tick tank update %.3f ms\n", setBoxesMs, firstUpdateMs, updateMs);
+    printf("%d rays: %d shots of %.0f px, %d line-of-sight checks, %d sensors of %.0f px, best of %d runs\n",
+        rayCount, kindCounts[0], shotRange, kindCounts[1], kindCounts[2], sensorRange, repeats);
+    printf("misses  targets  walls  tanks   bvh ms  pool ms  threads  Mrays/s  tick share  brute ms (est)  speedup  mismatches\n");
+    printf("%6d  %7d  %5d  %5d  %7.3f  %7.3f  %7u  %7.2f  %9.1f%%  %14.1f  %6.0fx  %10d\n", shapeHits[0], shapeHits[1], shapeHits[2], shapeHits[3],
+        serialMs, pooledMs, pool.GetThreadCount(), rayCount / std::min(serialMs, pooledMs) / 1000.0,
+        std::min(serialMs, pooledMs) / tickBudgetMs * 100.0f, bruteMs, bruteMs / serialMs, mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Set off a tick's worth of explosions of mixed sizes among scattered targets and turned tanks, once
+// through the grids and once against every shape, and check both found the same shapes for the same damage
+int BenchmarkSplash(int explosionCount)
+{
+    if (explosionCount <= 0)
+    {
+        printf("--bench-splash needs a positive explosion count\n");
+        return 1;
+    }
+
+    const int repeats = 5;
+    const int shapeCount = 2000;
+    const float tickBudgetMs = 1000.0f / 120.0f;
+    const float side = 4096.0f;
+    const float cellSize = 128.0f;
+    const size_t eventsPerExplosion = 64;
+    SimulationConfig config = MakeHeadlessConfig();
+    Sprite body = Sprite::FromSize(config.bodyWidth, config.bodyHeight);
+    Sprite turret = Sprite::FromSize(config.turretWidth, config.turretHeight);
+    Sprite bullet = Sprite::FromSize(config.bulletWidth, config.bulletHeight);
+    uint32_t seed = 0x2545F491u;
+    auto random = [&seed]() {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return (seed >> 8) * (1.0f / 16777216.0f);
+    };
+
+    std::vector<Rectangle> targets(shapeCount);
+    for (Rectangle& target : targets)
+    {
+        target = { random() * side, random() * side, 20.0f + random() * 40.0f, 20.0f + random() * 40.0f };
+    }
+    MemoryPool bulletPool(64 * 1024);
+    std::vector<Tank> tanks;
+    tanks.reserve(shapeCount);
+    for (int i = 0; i < shapeCount; ++i)
+    {
+        tanks.emplace_back(MathClasses::Vector3(random() * side, random() * side, 0.0f), body, turret, bullet, bulletPool, 0);
+        tanks.back().RotateBody(random() * 360.0f);
+    }
+
+    // Mostly shell-sized blasts with the odd big one
+    std::vector<Explosion> explosions(explosionCount);
+    for (Explosion& explosion : explosions)
+    {
+        float radius = random() < 0.9f ? 32.0f + random() * 64.0f : 160.0f + random() * 96.0f;
+        explosion = { { random() * side, random() * side }, radius, 100.0f };
+    }
+
+    SplashDamage splash(side, side, cellSize, (size_t)explosionCount * eventsPerExplosion);
+    uint64_t startNs = Profiler::NowNs();
+    splash.SetTargets(targets);
+    double setTargetsMs = (Profiler::NowNs() - startNs) / 1000000.0;
+    startNs = Profiler::NowNs();
+    splash.UpdateTanks(tanks);
+    double updateMs = (Profiler::NowNs() - startNs) / 1000000.0;
+
+    double gridMs = 1e9;
+    for (int repeat = 0; repeat < repeats; ++repeat)
+    {
+        startNs = Profiler::NowNs();
+        splash.Explode(explosions.data(), explosions.size());
+        gridMs = std::min(gridMs, (Profiler::NowNs() - startNs) / 1000000.0);
+    }
+    std::vector<DamageEvent> gridEvents(splash.GetEvents(), splash.GetEvents() + splash.GetEventCount());
+    size_t gridDropped = splash.GetDroppedCount();
+
+    startNs = Profiler::NowNs();
+    splash.ExplodeBruteForce(explosions.data(), explosions.size());
+    double bruteMs = (Profiler::NowNs() - startNs) / 1000000.0;
+    std::vector<DamageEvent> bruteEvents(splash.GetEvents(), splash.GetEvents() + splash.GetEventCount());
+
+    // The grids hand back each explosion's shapes in cell order, so line both lists up before comparing
+    auto byShape = [](const DamageEvent& a, const DamageEvent& b) {
+        if (a.explosion != b.explosion)
+        {
+            return a.explosion < b.explosion;
+        }
+        if (a.shape != b.shape)
+        {
+            return a.shape < b.shape;
+        }
+        return a.index < b.index;
+    };
+    std::sort(gridEvents.begin(), gridEvents.end(), byShape);
+    std::sort(bruteEvents.begin(), bruteEvents.end(), byShape);
+    int mismatches = (int)(gridEvents.size() > bruteEvents.size() ? gridEvents.size() - bruteEvents.size() : bruteEvents.size() - gridEvents.size());
+    int tankEvents = 0;
+    double totalDamage = 0.0;
+    for (size_t i = 0; i < std::min(gridEvents.size(), bruteEvents.size()); ++i)
+    {
+        const DamageEvent& a = gridEvents[i];
+        const DamageEvent& b = bruteEvents[i];
+        mismatches += a.explosion != b.explosion || a.index != b.index || a.shape != b.shape || a.distance != b.distance || a.damage != b.damage ? 1 : 0;
+        tankEvents += a.shape == SplashShape::Tank ? 1 : 0;
+        totalDamage += a.damage;
+    }
+
+    // Run again into a buffer with room for a tenth of the events to show the overflow is counted, not lost track of
+    SplashDamage tight(side, side, cellSize, gridEvents.size() / 10);
+    tight.SetTargets(targets);
+    tight.UpdateTanks(tanks);
+    tight.Explode(explosions.data(), explosions.size());
+    if (tight.GetEventCount() + tight.GetDroppedCount() != gridEvents.size())
+    {
+        mismatches++;
+    }
+
+    printf("%d targets and %d turned tanks in a %.0f px square, %.0f px cells\n", shapeCount, shapeCount, side, cellSize);
+    printf("set targets %.3f ms, tank update %.3f ms\n", setTargetsMs, updateMs);
+    printf("%d explosions, best of %d runs; a buffer a tenth the size kept %d events and dropped %d\n", explosionCount, repeats,
+        (int)tight.GetEventCount(), (int)tight.GetDroppedCount());
+    printf("events  on tanks  dropped  mean damage  grid ms  ns/explosion  tick share  brute ms  speedup  mismatches\n");
+    printf("%6d  %8d  %7d  %11.2f  %7.3f  %12.1f  %9.1f%%  %8.3f  %6.1fx  %10d\n", (int)gridEvents.size(), tankEvents, (int)gridDropped,
+        gridEvents.empty() ? 0.0 : totalDamage / gridEvents.size(), gridMs, gridMs * 1000000.0 / explosionCount,
+        gridMs / tickBudgetMs * 100.0f, bruteMs, bruteMs / gridMs, mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Solve flow fields over growing grids scattered with walls: serial Dijkstra, the tiled solver on the
+// calling thread and on a pool, then incremental updates as one extra wall is added and removed
+// Every field is compared with a serial rebuild over the same walls
+int BenchmarkFlowField(int repeats)
+{
+    if (repeats <= 0)
+    {
+        printf("--bench-flow needs a positive repeat count\n");
+        return 1;
+    }
+
+    ThreadPool pool;
+    const int sizes[] = { 128, 256, 512, 1024 };
+    const float cellSize = 16.0f;
+    uint32_t seed = 0x2545F491u;
+    auto random = [&seed]() {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return (seed >> 8) * (1.0f / 16777216.0f);
+    };
+
+    printf("%d repeats, %d px cells in %d px tiles, pool of %u threads\n", repeats, (int)cellSize, FlowField::tileSize * (int)cellSize, pool.GetThreadCount());
+    printf("cells        serial ms  tiled ms  pool ms  passes  tiles solved  add ms  remove ms  tiles/update  cells reset  matches\n");
+    for (int size : sizes)
+    {
+        float side = size * cellSize;
+        FlowField field(side, side, cellSize);
+        for (int i = 0; i < size * size / 64; ++i)
+        {
+            float length = (2.0f + random() * 10.0f) * cellSize;
+            bool across = random() < 0.5f;
+            field.SetBlocked({ random() * side, random() * side, across ? length : cellSize, across ? cellSize : length }, true);
+        }
+        Vector2 centre = { side / 2.0f, side / 2.0f };
+        field.SetBlocked({ centre.x - 2 * cellSize, centre.y - 2 * cellSize, 4 * cellSize, 4 * cellSize }, false);
+        field.SetGoal(centre);
+
+        FlowField reference = field;
+        double serialMs = 0.0, tiledMs = 0.0, poolMs = 0.0;
+        uint32_t passes = 0, tilesSolved = 0;
+        for (int repeat = 0; repeat < repeats; ++repeat)
+        {
+            reference.BuildSerial();
+            serialMs += reference.GetStats().integrateMs + reference.GetStats().directionMs;
+
+            field.SetGoal(centre);
+            field.Build(nullptr);
+            tiledMs += field.GetStats().integrateMs + field.GetStats().directionMs;
+
+            field.SetGoal(centre);
+            field.Build(&pool);
+            poolMs += field.GetStats().integrateMs + field.GetStats().directionMs;
+            passes = field.GetStats().passes;
+            tilesSolved = field.GetStats().tilesSolved;
+        }
+        int checks = 1;
+        int matches = field.GetCosts() == reference.GetCosts() && field.GetDirections() == reference.GetDirections() ? 1 : 0;
+
+        double addMs = 0.0, removeMs = 0.0;
+        uint64_t updateTiles = 0, cellsReset = 0;
+        for (int repeat = 0; repeat < repeats; ++repeat)
+        {
+            Rectangle wall = { random() * side, random() * side, 12 * cellSize, cellSize };
+            for (bool block : { true, false })
+            {
+                field.SetBlocked(wall, block);
+                field.Update(&pool);
+                (block ? addMs : removeMs) += field.GetStats().integrateMs + field.GetStats().directionMs;
+                updateTiles += field.GetStats().tilesSolved;
+                cellsReset += field.GetStats().cellsReset;
+
+                reference.SetBlocked(wall, block);
+                reference.BuildSerial();
+                checks++;
+                matches += field.GetCosts() == reference.GetCosts() && field.GetDirections() == reference.GetDirections() ? 1 : 0;
+            }
+        }
+
+        printf("%4d x %-4d  %9.3f  %8.3f  %7.3f  %6u  %12u  %6.3f  %9.3f  %12.1f  %11.1f  %4d/%d\n",
+            size, size, serialMs / repeats, tiledMs / repeats, poolMs / repeats, passes, tilesSolved,
+            addMs / repeats, removeMs / repeats, (double)updateTiles / (repeats * 2), (double)cellsReset / repeats, matches, checks);
+    }
+    return 0;
+}
@@ -0,0 +1,228 @@
+#include "SpatialGrid.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+// Constructor sizing the cell table, rounding the last row and column up to whole cells
+SpatialGrid::SpatialGrid(float width, float height, float cellSize)
+    : cellSize(cellSize), inverseCellSize(1.0f / cellSize)
+{
+    columns = (int)std::ceil(width * inverseCellSize);
+    rows = (int)std::ceil(height * inverseCellSize);
+    if (columns < 1)
+    {
+        columns = 1;
+    }
+    if (rows < 1)
+    {
+        rows = 1;
+    }
+    cellStart.assign((size_t)columns * rows + 1, 0);
+}
+
+// Cell a point falls in, clamped to the grid
+int SpatialGrid::CellIndex(Vector2 point) const
+{
+    int x = (int)(point.x * inverseCellSize);
+    int y = (int)(point.y * inverseCellSize);
+    x = x < 0 ? 0 : (x >= columns ? columns - 1 : x);
+    y = y < 0 ? 0 : (y >= rows ? rows - 1 : y);
+    return y * columns + x;
+}
+
+// Counting sort: count points per cell, turn the counts into offsets, then scatter the points
+// Points keep their input order within a cell, so equal-distance ties always resolve the same way
+void SpatialGrid::Build(const Vector2* points, size_t count)
+{
+    PROFILE_SCOPE("SpatialGrid::Build");
+    std::fill(cellStart.begin(), cellStart.end(), 0);
+    pointCells.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t cell = (uint32_t)CellIndex(points[i]);
+        pointCells[i] = cell;
+        cellStart[cell + 1]++;
+    }
+    for (size_t cell = 1; cell < cellStart.size(); ++cell)
+    {
+        cellStart[cell] += cellStart[cell - 1];
+    }
+
+    sortedPoints.resize(count);
+    sortedIndices.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        // cellStart[cell] is used as the write cursor and ends up at the next cell's start, so shift back after
+        uint32_t slot = cellStart[pointCells[i]]++;
+        sortedPoints[slot] = points[i];
+        sortedIndices[slot] = (int32_t)i;
+    }
+    for (size_t cell = cellStart.size() - 1; cell > 0; --cell)
+    {
+        cellStart[cell] = cellStart[cell - 1];
+    }
+    cellStart[0] = 0;
+}
+
+// Run the single-point search for every query in turn
+void SpatialGrid::FindNearest(const Vector2* queries, size_t count, float maxDistance, int32_t* results) const
+{
+    PROFILE_SCOPE("SpatialGrid::FindNearest");
+    for (size_t i = 0; i < count; ++i)
+    {
+        results[i] = FindNearest(queries[i], maxDistance);
+    }
+}
+
+// Search square rings of cells outward from the query's cell. Every point in ring r is at least
+// (r - 1) cells away, so the search stops at the first ring that cannot beat the best point found.
+int32_t SpatialGrid::FindNearest(Vector2 query, float maxDistance) const
+{
+    int cell = CellIndex(query);
+    int centreX = cell % columns;
+    int centreY = cell / columns;
+    int maxRing = (int)std::ceil(maxDistance * inverseCellSize) + 1;
+    int gridRings = columns > rows ? columns : rows;
+    if (maxRing > gridRings)
+    {
+        maxRing = gridRings;
+    }
+
+    int32_t best = -1;
+    float bestDistanceSq = maxDistance * maxDistance;
+    for (int ring = 0; ring <= maxRing; ++ring)
+    {
+        float reach = (ring - 1) * cellSize;
+        if (ring > 1 && reach * reach > bestDistanceSq)
+        {
+            break;
+        }
+
+        for (int y = centreY - ring; y <= centreY + ring; ++y)
+        {
+            if (y < 0 || y >= rows)
+            {
+                continue;
+            }
+
+            // Rows on the ring's edge take every column, rows in between only its two sides
+            bool edgeRow = y == centreY - ring || y == centreY + ring;
+            int step = edgeRow || ring == 0 ? 1 : ring * 2;
+            for (int x = centreX - ring; x <= centreX + ring; x += step)
+            {
+                if (x < 0 || x >= columns)
+                {
+                    continue;
+                }
+                int index = y * columns + x;
+                for (uint32_t slot = cellStart[index]; slot < cellStart[index + 1]; ++slot)
+                {
+                    float dx = sortedPoints[slot].x - query.x;
+                    float dy = sortedPoints[slot].y - query.y;
+                    float distanceSq = dx * dx + dy * dy;
+                    int32_t id = sortedIndices[slot];
+                    if (distanceSq < bestDistanceSq || (distanceSq == bestDistanceSq && best >= 0 && id < best))
+                    {
+                        bestDistanceSq = distanceSq;
+                        best = id;
+                    }
+                }
+            }
+        }
+    }
+    return best;
+}
+
+// Scan the square of cells the circle's bounding box covers, clamped to the grid like the points are
+size_t SpatialGrid::FindWithin(Vector2 query, float maxDistance, int32_t* results, size_t capacity) const
+{
+    int first = CellIndex({ query.x - maxDistance, query.y - maxDistance });
+    int last = CellIndex({ query.x + maxDistance, query.y + maxDistance });
+    float maxDistanceSq = maxDistance * maxDistance;
+    size_t found = 0;
+    for (int y = first / columns; y <= last / columns; ++y)
+    {
+        for (int x = first % columns; x <= last % columns; ++x)
+        {
+            int cell = y * columns + x;
+            for (uint32_t slot = cellStart[cell]; slot < cellStart[cell + 1]; ++slot)
+            {
+                float dx = sortedPoints[slot].x - query.x;
+                float dy = sortedPoints[slot].y - query.y;
+                if (dx * dx + dy * dy <= maxDistanceSq)
+                {
+                    if (found < capacity)
+                    {
+                        results[found] = sortedIndices[slot];
+                    }
+                    found++;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+// Each cell pairs its own points, then looks only at cells ahead of it in row order, so every pair is found once
+void SpatialGrid::FindPairs(float maxDistance, std::vector<int32_t>& first, std::vector<int32_t>& second) const
+{
+    PROFILE_SCOPE("SpatialGrid::FindPairs");
+    first.clear();
+    second.clear();
+    float maxDistanceSq = maxDistance * maxDistance;
+    int reach = (int)std::ceil(maxDistance * inverseCellSize);
+
+    for (int y = 0; y < rows; ++y)
+    {
+        for (int x = 0; x < columns; ++x)
+        {
+            int cell = y * columns + x;
+            for (uint32_t slot = cellStart[cell]; slot < cellStart[cell + 1]; ++slot)
+            {
+                Vector2 point = sortedPoints[slot];
+                for (int dy = 0; dy <= reach && y + dy < rows; ++dy)
+                {
+                    for (int dx = dy == 0 ? 0 : -reach; dx <= reach; ++dx)
+                    {
+                        if (x + dx < 0 || x + dx >= columns)
+                        {
+                            continue;
+                        }
+                        int other = cell + dy * columns + dx;
+                        uint32_t otherSlot = dx == 0 && dy == 0 ? slot + 1 : cellStart[other];
+                        for (; otherSlot < cellStart[other + 1]; ++otherSlot)
+                        {
+                            float offsetX = sortedPoints[otherSlot].x - point.x;
+                            float offsetY = sortedPoints[otherSlot].y - point.y;
+                            if (offsetX * offsetX + offsetY * offsetY < maxDistanceSq)
+                            {
+                                int32_t a = sortedIndices[slot];
+                                int32_t b = sortedIndices[otherSlot];
+                                first.push_back(a < b ? a : b);
+                                second.push_back(a < b ? b : a);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Get the points in the order Build sorted them
+const std::vector<Vector2>& SpatialGrid::GetSortedPoints() const
+{
+    return sortedPoints;
+}
+
+// Get the original index of each sorted point
+const std::vector<int32_t>& SpatialGrid::GetSortedIndices() const
+{
+    return sortedIndices;
+}
+
+// Get the number of points in the grid
+size_t SpatialGrid::GetPointCount() const
+{
+    return sortedPoints.size();
+}
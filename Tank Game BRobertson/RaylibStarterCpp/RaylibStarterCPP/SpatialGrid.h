@@ -0,0 +1,51 @@
+#pragma once
+#include "raylib.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Uniform grid of points, rebuilt from scratch whenever the points move
+// Build counting-sorts the points by cell, so every cell's points sit next to each other and a
+// nearest-point query reads a few short contiguous runs instead of every point.
+class SpatialGrid
+{
+public:
+    // Covers [0, width) x [0, height), points and queries outside are clamped into the edge cells
+    SpatialGrid(float width, float height, float cellSize);
+
+    // Replaces the contents with count points, identified afterwards by their index in the array
+    void Build(const Vector2* points, size_t count);
+
+    // Writes, for each query, the index of the nearest point within maxDistance or -1 if there is none
+    // Equally near points resolve to the lower index. Queries in spatial order, such as another grid's
+    // GetSortedPoints, keep neighbouring queries reading the same cells while they are still in cache.
+    void FindNearest(const Vector2* queries, size_t count, float maxDistance, int32_t* results) const;
+
+    // Index of the nearest point within maxDistance, or -1
+    int32_t FindNearest(Vector2 query, float maxDistance) const;
+
+    // Writes the index of every point within maxDistance of query, up to capacity of them, in cell order
+    // Returns how many there are, which is more than capacity when some did not fit
+    size_t FindWithin(Vector2 query, float maxDistance, int32_t* results, size_t capacity) const;
+
+    // Every pair of points closer than maxDistance, as indices with first[i] < second[i]
+    // Pairs come out in cell order, so consecutive pairs tend to share points
+    void FindPairs(float maxDistance, std::vector<int32_t>& first, std::vector<int32_t>& second) const;
+
+    // Points in cell order, and the index each one was given to Build with
+    const std::vector<Vector2>& GetSortedPoints() const;
+    const std::vector<int32_t>& GetSortedIndices() const;
+
+    size_t GetPointCount() const;
+
+private:
+    int CellIndex(Vector2 point) const;
+
+    float cellSize;
+    float inverseCellSize;
+    int columns, rows;
+    std::vector<uint32_t> cellStart;     // Offset of each cell's first point, with one extra entry for the end
+    std::vector<uint32_t> pointCells;    // Scratch for Build, the cell of each point in input order
+    std::vector<Vector2> sortedPoints;
+    std::vector<int32_t> sortedIndices;
+};
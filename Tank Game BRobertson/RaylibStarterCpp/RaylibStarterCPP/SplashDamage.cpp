@@ -0,0 +1,187 @@
+#include "SplashDamage.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Distance from a centre to the box's corners
+    float HalfDiagonal(float halfWidth, float halfHeight)
+    {
+        return sqrtf(halfWidth * halfWidth + halfHeight * halfHeight);
+    }
+}
+
+// Constructor allocating the event buffer, grids start empty
+SplashDamage::SplashDamage(float width, float height, float cellSize, size_t eventCapacity)
+    : targetGrid(width, height, cellSize), tankGrid(width, height, cellSize), targetReach(0.0f), tankReach(0.0f),
+    events(eventCapacity), eventCount(0), droppedCount(0)
+{
+}
+
+// Targets never move, so their grid is only built here
+void SplashDamage::SetTargets(const std::vector<Rectangle>& targetList)
+{
+    PROFILE_SCOPE("SplashDamage::SetTargets");
+    targets.resize(targetList.size());
+    centres.resize(targetList.size());
+    targetReach = 0.0f;
+    for (size_t i = 0; i < targetList.size(); ++i)
+    {
+        const Rectangle& rect = targetList[i];
+        Box& box = targets[i];
+        box.halfWidth = rect.width * 0.5f;
+        box.halfHeight = rect.height * 0.5f;
+        box.centre = { rect.x + box.halfWidth, rect.y + box.halfHeight };
+        box.axisX = { 1.0f, 0.0f };
+        box.axisY = { 0.0f, 1.0f };
+        centres[i] = box.centre;
+        targetReach = std::max(targetReach, HalfDiagonal(box.halfWidth, box.halfHeight));
+    }
+    targetGrid.Build(centres.data(), centres.size());
+    candidates.resize(std::max(targets.size(), tanks.size()));
+}
+
+// Same body box RayCaster casts against: the sprite's size about the tank's centre, turned with the body
+void SplashDamage::UpdateTanks(const std::vector<Tank>& tankList)
+{
+    PROFILE_SCOPE("SplashDamage::UpdateTanks");
+    tanks.resize(tankList.size());
+    centres.resize(tankList.size());
+    tankReach = 0.0f;
+    for (size_t i = 0; i < tankList.size(); ++i)
+    {
+        const Tank& tank = tankList[i];
+        MathClasses::Vector3 position = tank.GetPosition();
+        Matrix3 transform = tank.GetBodyTransform();
+        MathClasses::Vector3 axisX = transform.axis[0].Normalised();
+        MathClasses::Vector3 axisY = transform.axis[1].Normalised();
+        Vector2 size = tank.GetBodySize();
+
+        Box& box = tanks[i];
+        box.centre = { position.x, position.y };
+        box.axisX = { axisX.x, axisX.y };
+        box.axisY = { axisY.x, axisY.y };
+        box.halfWidth = size.x * 0.5f;
+        box.halfHeight = size.y * 0.5f;
+        centres[i] = box.centre;
+        tankReach = std::max(tankReach, HalfDiagonal(box.halfWidth, box.halfHeight));
+    }
+    tankGrid.Build(centres.data(), centres.size());
+    candidates.resize(std::max(targets.size(), tanks.size()));
+}
+
+// Move the explosion's centre into the box's frame and clamp it to the box for the nearest point
+void SplashDamage::Catch(const Explosion& explosion, int32_t explosionIndex, SplashShape shape, int32_t index,
+    DamageEvent* eventOut, size_t capacity, size_t& found) const
+{
+    const Box& box = shape == SplashShape::Target ? targets[index] : tanks[index];
+    float offsetX = explosion.centre.x - box.centre.x;
+    float offsetY = explosion.centre.y - box.centre.y;
+    float outsideX = std::max(fabsf(offsetX * box.axisX.x + offsetY * box.axisX.y) - box.halfWidth, 0.0f);
+    float outsideY = std::max(fabsf(offsetX * box.axisY.x + offsetY * box.axisY.y) - box.halfHeight, 0.0f);
+    float distanceSq = outsideX * outsideX + outsideY * outsideY;
+    if (distanceSq > explosion.radius * explosion.radius)
+    {
+        return;
+    }
+
+    if (found < capacity)
+    {
+        float distance = sqrtf(distanceSq);
+        float falloff = explosion.radius > 0.0f ? 1.0f - distance / explosion.radius : 1.0f;
+        eventOut[found] = { explosionIndex, index, shape, distance, explosion.damage * falloff };
+    }
+    found++;
+}
+
+// Each grid returns every shape whose centre is close enough for some part of it to reach the circle,
+// and the candidate buffer holds a whole grid, so nothing the grid finds is lost
+size_t SplashDamage::Query(const Explosion& explosion, int32_t explosionIndex, DamageEvent* eventOut, size_t capacity)
+{
+    size_t found = 0;
+    size_t count = targetGrid.FindWithin(explosion.centre, explosion.radius + targetReach, candidates.data(), candidates.size());
+    for (size_t i = 0; i < count; ++i)
+    {
+        Catch(explosion, explosionIndex, SplashShape::Target, candidates[i], eventOut, capacity, found);
+    }
+    count = tankGrid.FindWithin(explosion.centre, explosion.radius + tankReach, candidates.data(), candidates.size());
+    for (size_t i = 0; i < count; ++i)
+    {
+        Catch(explosion, explosionIndex, SplashShape::Tank, candidates[i], eventOut, capacity, found);
+    }
+    return found;
+}
+
+// Keep what fit and count the rest as dropped
+void SplashDamage::Commit(size_t found)
+{
+    size_t written = std::min(found, events.size() - eventCount);
+    eventCount += written;
+    droppedCount += found - written;
+}
+
+// Each explosion writes straight into the buffer after the last one's events
+void SplashDamage::Explode(const Explosion* explosions, size_t count)
+{
+    PROFILE_SCOPE("SplashDamage::Explode");
+    eventCount = 0;
+    droppedCount = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        Commit(Query(explosions[i], (int32_t)i, events.data() + eventCount, events.size() - eventCount));
+    }
+}
+
+// Every target, then every tank, for every explosion
+void SplashDamage::ExplodeBruteForce(const Explosion* explosions, size_t count)
+{
+    PROFILE_SCOPE("SplashDamage::ExplodeBruteForce");
+    eventCount = 0;
+    droppedCount = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        DamageEvent* eventOut = events.data() + eventCount;
+        size_t capacity = events.size() - eventCount;
+        size_t found = 0;
+        for (size_t target = 0; target < targets.size(); ++target)
+        {
+            Catch(explosions[i], (int32_t)i, SplashShape::Target, (int32_t)target, eventOut, capacity, found);
+        }
+        for (size_t tank = 0; tank < tanks.size(); ++tank)
+        {
+            Catch(explosions[i], (int32_t)i, SplashShape::Tank, (int32_t)tank, eventOut, capacity, found);
+        }
+        Commit(found);
+    }
+}
+
+// Get the first event of the last batch
+const DamageEvent* SplashDamage::GetEvents() const
+{
+    return events.data();
+}
+
+// Get the number of events the last batch kept
+size_t SplashDamage::GetEventCount() const
+{
+    return eventCount;
+}
+
+// Get the number of events the last batch dropped
+size_t SplashDamage::GetDroppedCount() const
+{
+    return droppedCount;
+}
+
+// Get the number of targets
+size_t SplashDamage::GetTargetCount() const
+{
+    return targets.size();
+}
+
+// Get the number of tanks
+size_t SplashDamage::GetTankCount() const
+{
+    return tanks.size();
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "raylib.h"
+#include "SpatialGrid.h"
+#include "Tank.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A blast at a point, hurting every shape that reaches inside its radius
+struct Explosion
+{
+    Vector2 centre;
+    float radius;
+    float damage; // Dealt to a shape touching the centre, falling linearly to none at the radius
+};
+
+// Kind of shape caught in an explosion
+enum class SplashShape : uint8_t
+{
+    Target,
+    Tank
+};
+
+// One shape caught in one explosion
+struct DamageEvent
+{
+    int32_t explosion; // Index of the explosion in its batch
+    int32_t index;     // Index in the target or tank list the shape came from
+    SplashShape shape;
+    float distance;    // From the centre to the nearest point of the shape, 0 when the centre is inside it
+    float damage;
+};
+
+// Area queries for splash damage: every target and tank within an explosion's radius.
+// Targets and tanks each go into a SpatialGrid by their centres. A query pads the radius by the furthest
+// any shape's corner lies from its centre, so the grid hands back every shape that could reach the circle,
+// then measures the exact distance to each one's box, in the tank's own frame for tanks.
+// Explode runs a whole batch of explosions into one event buffer allocated up front, so a busy tick
+// never allocates and the caller reads every hit at once instead of taking a callback per shape.
+// Events that do not fit are counted and dropped.
+class SplashDamage
+{
+public:
+    // Covers [0, width) x [0, height) like SpatialGrid, with room for eventCapacity events per batch
+    SplashDamage(float width, float height, float cellSize, size_t eventCapacity);
+
+    // Replaces the targets and sorts them into their grid
+    void SetTargets(const std::vector<Rectangle>& targets);
+
+    // Copies each tank's body box and sorts the tanks into their grid
+    void UpdateTanks(const std::vector<Tank>& tanks);
+
+    // Writes the shapes one explosion catches into events, up to capacity of them, targets first and then tanks
+    // Returns how many it caught, which is more than capacity when some did not fit
+    size_t Query(const Explosion& explosion, int32_t explosionIndex, DamageEvent* events, size_t capacity);
+
+    // Runs count explosions into the event buffer, replacing the last batch's events
+    void Explode(const Explosion* explosions, size_t count);
+
+    // Tests every shape against every explosion into the event buffer, kept to check Explode against
+    void ExplodeBruteForce(const Explosion* explosions, size_t count);
+
+    // Events from the last batch, in explosion order
+    const DamageEvent* GetEvents() const;
+    size_t GetEventCount() const;
+
+    // Events the last batch had no room for
+    size_t GetDroppedCount() const;
+
+    size_t GetTargetCount() const;
+    size_t GetTankCount() const;
+
+private:
+    // Box around a shape's centre, along unit axes that are the world's own for targets
+    struct Box
+    {
+        Vector2 centre;
+        Vector2 axisX, axisY;
+        float halfWidth, halfHeight;
+    };
+
+    // Records an event when the shape reaches inside the explosion, counting it in found either way it fits
+    void Catch(const Explosion& explosion, int32_t explosionIndex, SplashShape shape, int32_t index,
+        DamageEvent* events, size_t capacity, size_t& found) const;
+
+    // Adds a batch's worth of found events to the buffer's totals
+    void Commit(size_t found);
+
+    SpatialGrid targetGrid, tankGrid;
+    std::vector<Box> targets;
+    std::vector<Box> tanks;
+    float targetReach, tankReach;    // Furthest corner from its centre among the targets, and among the tanks
+    std::vector<Vector2> centres;    // Scratch for sorting shapes into their grids
+    std::vector<int32_t> candidates; // Scratch for one grid query, with room for every shape in either grid
+    std::vector<DamageEvent> events;
+    size_t eventCount, droppedCount;
+};
@@ -0,0 +1,28 @@
+#pragma once
+#include "raylib.h"
+
+// A region of a texture, either a whole loose texture or one entry of a texture atlas
+struct Sprite
+{
+    Texture2D texture; // Texture the sprite is drawn from
+    Rectangle source;  // Pixel rectangle of the sprite inside the texture
+
+    // Wraps a whole texture as a sprite
+    static Sprite FromTexture(Texture2D texture)
+    {
+        return { texture, { 0.0f, 0.0f, (float)texture.width, (float)texture.height } };
+    }
+
+    // Sprite with no texture behind it, for headless runs that only need its size
+    static Sprite FromSize(int width, int height)
+    {
+        Texture2D texture = {};
+        texture.width = width;
+        texture.height = height;
+        texture.mipmaps = 1;
+        return FromTexture(texture);
+    }
+
+    float Width() const { return source.width; }
+    float Height() const { return source.height; }
+};
@@ -0,0 +1,126 @@
+#include "SpriteAtlas.h"
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    // Parse one "name x y w h" line, skipping # comments
+    void ParseAtlasLine(const char* line, std::vector<AtlasEntry>& entries)
+    {
+        if (line[0] == '#')
+        {
+            return;
+        }
+
+        char name[128];
+        Rectangle source;
+        if (sscanf(line, "%127s %f %f %f %f", name, &source.x, &source.y, &source.width, &source.height) == 5)
+        {
+            entries.push_back({ name, source });
+        }
+    }
+}
+
+// Read a table file line by line
+bool ReadAtlasTable(const char* tableFile, std::vector<AtlasEntry>& entries)
+{
+    FILE* file = fopen(tableFile, "r");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    entries.clear();
+    char line[256];
+    while (fgets(line, sizeof(line), file) != nullptr)
+    {
+        ParseAtlasLine(line, entries);
+    }
+    fclose(file);
+    return !entries.empty();
+}
+
+// Copy each line into a terminated buffer, lines longer than the buffer are truncated
+bool ParseAtlasTable(const char* text, size_t length, std::vector<AtlasEntry>& entries)
+{
+    entries.clear();
+    char line[256];
+    size_t start = 0;
+    while (start < length)
+    {
+        const char* newline = static_cast<const char*>(memchr(text + start, '\n', length - start));
+        size_t end = newline != nullptr ? static_cast<size_t>(newline - text) : length;
+        size_t lineLength = end - start < sizeof(line) - 1 ? end - start : sizeof(line) - 1;
+        memcpy(line, text + start, lineLength);
+        line[lineLength] = '\0';
+        ParseAtlasLine(line, entries);
+        start = end + 1;
+    }
+    return !entries.empty();
+}
+
+// Load the table first so a missing table does not leave a texture behind
+bool SpriteAtlas::Load(const char* imageFile, const char* tableFile)
+{
+    if (!LoadTable(tableFile))
+    {
+        return false;
+    }
+
+    texture = LoadTexture(imageFile);
+    if (texture.id == 0)
+    {
+        entries.clear();
+        return false;
+    }
+    return true;
+}
+
+// Read the rectangle table without touching the GPU
+bool SpriteAtlas::LoadTable(const char* tableFile)
+{
+    return ReadAtlasTable(tableFile, entries);
+}
+
+// Parse a table that is already in memory
+bool SpriteAtlas::LoadTable(const char* text, size_t length)
+{
+    return ParseAtlasTable(text, length, entries);
+}
+
+// Use a texture loaded elsewhere, such as by the AssetLoader
+void SpriteAtlas::SetTexture(Texture2D atlasTexture)
+{
+    texture = atlasTexture;
+}
+
+// Release the atlas texture
+void SpriteAtlas::Unload()
+{
+    if (texture.id != 0)
+    {
+        UnloadTexture(texture);
+    }
+    texture = {};
+    entries.clear();
+}
+
+// Linear search is fine, an atlas is only queried while loading
+bool SpriteAtlas::Find(const char* name, Sprite& sprite) const
+{
+    for (const AtlasEntry& entry : entries)
+    {
+        if (entry.name == name)
+        {
+            sprite = { texture, entry.source };
+            return true;
+        }
+    }
+    return false;
+}
+
+// Get every entry in the atlas
+const std::vector<AtlasEntry>& SpriteAtlas::GetEntries() const
+{
+    return entries;
+}
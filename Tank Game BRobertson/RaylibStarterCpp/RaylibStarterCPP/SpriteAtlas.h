@@ -0,0 +1,47 @@
+#pragma once
+#include "Sprite.h"
+#include <string>
+#include <vector>
+
+// One packed image inside an atlas
+struct AtlasEntry
+{
+    std::string name;  // Source file name without extension
+    Rectangle source;  // Where the image was placed in the atlas
+};
+
+// Runtime side of the texture atlas: one texture plus the rectangle table written by BuildAtlas
+// Drawing every sprite from one texture lets raylib batch a whole frame's sprites together
+class SpriteAtlas
+{
+public:
+    // Loads the atlas texture and its rectangle table, requires a window
+    bool Load(const char* imageFile, const char* tableFile);
+
+    // Reads only the rectangle table, for when the texture is loaded separately
+    bool LoadTable(const char* tableFile);
+
+    // Parses a rectangle table already in memory, such as an archive entry
+    bool LoadTable(const char* text, size_t length);
+
+    // Sets the texture the table's rectangles refer to, taking ownership of it
+    void SetTexture(Texture2D atlasTexture);
+
+    // Unloads the atlas texture
+    void Unload();
+
+    // Looks up a sprite by name, returns false if the atlas has no such entry
+    bool Find(const char* name, Sprite& sprite) const;
+
+    const std::vector<AtlasEntry>& GetEntries() const;
+
+private:
+    Texture2D texture = {};
+    std::vector<AtlasEntry> entries;
+};
+
+// Reads a rectangle table written by BuildAtlas
+bool ReadAtlasTable(const char* tableFile, std::vector<AtlasEntry>& entries);
+
+// Parses the text of a rectangle table, which does not need to be null terminated
+bool ParseAtlasTable(const char* text, size_t length, std::vector<AtlasEntry>& entries);
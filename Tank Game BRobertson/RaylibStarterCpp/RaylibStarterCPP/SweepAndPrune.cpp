@@ -0,0 +1,378 @@
+#include "SweepAndPrune.h"
+#include "Profiler.h"
+#include <algorithm>
+
+const uint64_t SweepAndPrune::PairSet::emptyKey;
+
+namespace
+{
+    // The lower proxy goes in the high half, so sorted keys come out ordered by a then b
+    uint64_t PairKey(int32_t a, int32_t b)
+    {
+        if (a > b)
+        {
+            std::swap(a, b);
+        }
+        return ((uint64_t)(uint32_t)a << 32) | (uint32_t)b;
+    }
+
+    PairEvent MakeEvent(uint64_t key, bool added)
+    {
+        return { (int32_t)(key >> 32), (int32_t)(uint32_t)key, added };
+    }
+}
+
+// Constructor for an empty set with a small table
+SweepAndPrune::PairSet::PairSet()
+    : slots(64, emptyKey), count(0), shift(64 - 6)
+{
+}
+
+// Fibonacci hashing: multiply by 2^64 over the golden ratio and keep the top bits
+size_t SweepAndPrune::PairSet::HomeSlot(uint64_t key) const
+{
+    return (size_t)((key * 0x9E3779B97F4A7C15ull) >> shift);
+}
+
+// Probe forward from the key's home slot to the key or the first empty slot
+bool SweepAndPrune::PairSet::Insert(uint64_t key)
+{
+    if ((count + 1) * 2 > slots.size())
+    {
+        Grow();
+    }
+    size_t mask = slots.size() - 1;
+    for (size_t slot = HomeSlot(key);; slot = (slot + 1) & mask)
+    {
+        if (slots[slot] == key)
+        {
+            return false;
+        }
+        if (slots[slot] == emptyKey)
+        {
+            slots[slot] = key;
+            count++;
+            return true;
+        }
+    }
+}
+
+// Empty the key's slot, then pull back any later key in the run whose home slot is not between the gap and itself
+bool SweepAndPrune::PairSet::Erase(uint64_t key)
+{
+    size_t mask = slots.size() - 1;
+    size_t gap = HomeSlot(key);
+    while (slots[gap] != key)
+    {
+        if (slots[gap] == emptyKey)
+        {
+            return false;
+        }
+        gap = (gap + 1) & mask;
+    }
+
+    for (size_t slot = (gap + 1) & mask; slots[slot] != emptyKey; slot = (slot + 1) & mask)
+    {
+        size_t home = HomeSlot(slots[slot]);
+        bool staysPut = gap <= slot ? (gap < home && home <= slot) : (gap < home || home <= slot);
+        if (!staysPut)
+        {
+            slots[gap] = slots[slot];
+            gap = slot;
+        }
+    }
+    slots[gap] = emptyKey;
+    count--;
+    return true;
+}
+
+// Double the table and reinsert every key
+void SweepAndPrune::PairSet::Grow()
+{
+    std::vector<uint64_t> old;
+    old.swap(slots);
+    slots.assign(old.size() * 2, emptyKey);
+    shift--;
+    count = 0;
+    for (uint64_t key : old)
+    {
+        if (key != emptyKey)
+        {
+            Insert(key);
+        }
+    }
+}
+
+// Get the number of keys held
+size_t SweepAndPrune::PairSet::GetCount() const
+{
+    return count;
+}
+
+// Get the raw table
+const std::vector<uint64_t>& SweepAndPrune::PairSet::GetSlots() const
+{
+    return slots;
+}
+
+// Constructor for an empty broadphase
+SweepAndPrune::SweepAndPrune()
+    : swapCount(0)
+{
+}
+
+// Reuse a freed id if there is one, and append the endpoints for the next sort to move into place
+int32_t SweepAndPrune::Add(Rectangle box)
+{
+    int32_t proxy;
+    if (!freeProxies.empty())
+    {
+        proxy = freeProxies.back();
+        freeProxies.pop_back();
+    }
+    else
+    {
+        proxy = (int32_t)boxes.size();
+        boxes.emplace_back();
+    }
+    boxes[proxy] = AabbBounds::FromRectangle(box);
+
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        endpoints[axis].push_back({ 0.0f, (uint32_t)proxy << 1 });
+        endpoints[axis].push_back({ 0.0f, ((uint32_t)proxy << 1) | 1u });
+    }
+    return proxy;
+}
+
+// Scan the pair set for the proxy's pairs, then drop its endpoints
+void SweepAndPrune::Remove(int32_t proxy)
+{
+    std::vector<uint64_t> removed;
+    for (uint64_t key : pairs.GetSlots())
+    {
+        if (key != PairSet::emptyKey && ((int32_t)(key >> 32) == proxy || (int32_t)(uint32_t)key == proxy))
+        {
+            removed.push_back(key);
+        }
+    }
+    for (uint64_t key : removed)
+    {
+        pairs.Erase(key);
+        pendingEvents.push_back(MakeEvent(key, false));
+    }
+
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        std::vector<Endpoint>& list = endpoints[axis];
+        list.erase(std::remove_if(list.begin(), list.end(), [proxy](const Endpoint& endpoint) {
+            return endpoint.Proxy() == proxy;
+            }), list.end());
+    }
+    freeProxies.push_back(proxy);
+}
+
+// Store the box for the next update
+void SweepAndPrune::SetBox(int32_t proxy, Rectangle box)
+{
+    boxes[proxy] = AabbBounds::FromRectangle(box);
+}
+
+// Read min and max for one axis from the boxes into the endpoints
+void SweepAndPrune::RefreshEndpoints(int axis)
+{
+    for (Endpoint& endpoint : endpoints[axis])
+    {
+        const AabbBounds& box = boxes[endpoint.Proxy()];
+        if (axis == 0)
+        {
+            endpoint.value = endpoint.IsMax() ? box.maxX : box.minX;
+        }
+        else
+        {
+            endpoint.value = endpoint.IsMax() ? box.maxY : box.minY;
+        }
+    }
+}
+
+// Endpoints moving left past others: a min passing a max may start a pair, a max passing a min ends one
+// Insertion sort swaps each out-of-order pair of endpoints exactly once and never swaps it back, so
+// every swap reflects the final order and the box test uses the final boxes
+void SweepAndPrune::SortAxis(int axis)
+{
+    std::vector<Endpoint>& list = endpoints[axis];
+    for (size_t i = 1; i < list.size(); ++i)
+    {
+        Endpoint moving = list[i];
+        size_t j = i;
+        while (j > 0)
+        {
+            const Endpoint& passed = list[j - 1];
+            bool before = moving.value < passed.value || (moving.value == passed.value && !moving.IsMax() && passed.IsMax());
+            if (!before)
+            {
+                break;
+            }
+
+            if (!moving.IsMax() && passed.IsMax())
+            {
+                if (Overlaps(moving.Proxy(), passed.Proxy()))
+                {
+                    AddPair(moving.Proxy(), passed.Proxy());
+                }
+            }
+            else if (moving.IsMax() && !passed.IsMax())
+            {
+                RemovePair(moving.Proxy(), passed.Proxy());
+            }
+            list[j] = passed;
+            --j;
+            swapCount++;
+        }
+        list[j] = moving;
+    }
+}
+
+// Closed overlap test on both axes
+bool SweepAndPrune::Overlaps(int32_t a, int32_t b) const
+{
+    return boxes[a].Overlaps(boxes[b]);
+}
+
+// Record a pair, with an event only when it is new
+void SweepAndPrune::AddPair(int32_t a, int32_t b)
+{
+    uint64_t key = PairKey(a, b);
+    if (pairs.Insert(key))
+    {
+        events.push_back(MakeEvent(key, true));
+    }
+}
+
+// Forget a pair, with an event only when it was there
+void SweepAndPrune::RemovePair(int32_t a, int32_t b)
+{
+    uint64_t key = PairKey(a, b);
+    if (pairs.Erase(key))
+    {
+        events.push_back(MakeEvent(key, false));
+    }
+}
+
+// Start from the separations Remove queued, then let both sorts add the rest
+void SweepAndPrune::Update()
+{
+    PROFILE_SCOPE("SweepAndPrune::Update");
+    events.swap(pendingEvents);
+    pendingEvents.clear();
+    swapCount = 0;
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        RefreshEndpoints(axis);
+        SortAxis(axis);
+    }
+}
+
+// Sweep x keeping the boxes whose x range is open, testing y against each of them as a new box opens
+void SweepAndPrune::UpdateFromScratch()
+{
+    PROFILE_SCOPE("SweepAndPrune::UpdateFromScratch");
+    events.swap(pendingEvents);
+    pendingEvents.clear();
+    swapCount = 0;
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        RefreshEndpoints(axis);
+        std::sort(endpoints[axis].begin(), endpoints[axis].end(), [](const Endpoint& a, const Endpoint& b) {
+            return a.value < b.value || (a.value == b.value && !a.IsMax() && b.IsMax());
+            });
+    }
+
+    sweptPairs.clear();
+    active.clear();
+    for (const Endpoint& endpoint : endpoints[0])
+    {
+        int32_t proxy = endpoint.Proxy();
+        if (endpoint.IsMax())
+        {
+            auto found = std::find(active.begin(), active.end(), proxy);
+            *found = active.back();
+            active.pop_back();
+            continue;
+        }
+
+        const AabbBounds& box = boxes[proxy];
+        for (int32_t other : active)
+        {
+            if (box.minY <= boxes[other].maxY && boxes[other].minY <= box.maxY)
+            {
+                sweptPairs.push_back(PairKey(proxy, other));
+            }
+        }
+        active.push_back(proxy);
+    }
+    std::sort(sweptPairs.begin(), sweptPairs.end());
+
+    for (uint64_t key : sweptPairs)
+    {
+        if (pairs.Insert(key))
+        {
+            events.push_back(MakeEvent(key, true));
+        }
+    }
+
+    // Anything in the set the sweep did not find has separated
+    std::vector<uint64_t> removed;
+    for (uint64_t key : pairs.GetSlots())
+    {
+        if (key != PairSet::emptyKey && !std::binary_search(sweptPairs.begin(), sweptPairs.end(), key))
+        {
+            removed.push_back(key);
+        }
+    }
+    for (uint64_t key : removed)
+    {
+        pairs.Erase(key);
+        events.push_back(MakeEvent(key, false));
+    }
+}
+
+// Get the events from the last update
+const std::vector<PairEvent>& SweepAndPrune::GetEvents() const
+{
+    return events;
+}
+
+// Unpack every key in the set and sort them
+void SweepAndPrune::GetPairs(std::vector<ProxyPair>& out) const
+{
+    out.clear();
+    for (uint64_t key : pairs.GetSlots())
+    {
+        if (key != PairSet::emptyKey)
+        {
+            out.push_back({ (int32_t)(key >> 32), (int32_t)(uint32_t)key });
+        }
+    }
+    std::sort(out.begin(), out.end(), [](const ProxyPair& a, const ProxyPair& b) {
+        return a.a < b.a || (a.a == b.a && a.b < b.b);
+        });
+}
+
+// Get the number of overlapping pairs
+size_t SweepAndPrune::GetPairCount() const
+{
+    return pairs.GetCount();
+}
+
+// Get the number of live boxes
+size_t SweepAndPrune::GetProxyCount() const
+{
+    return boxes.size() - freeProxies.size();
+}
+
+// Get the swaps made by the last Update
+size_t SweepAndPrune::GetSwapCount() const
+{
+    return swapCount;
+}
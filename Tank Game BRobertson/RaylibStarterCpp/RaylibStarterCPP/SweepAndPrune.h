@@ -0,0 +1,121 @@
+#pragma once
+#include "raylib.h"
+#include "AabbTree.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Two proxies whose boxes overlap, a < b
+struct ProxyPair
+{
+    int32_t a, b;
+};
+
+// A pair that started or stopped overlapping
+struct PairEvent
+{
+    int32_t a, b; // Proxy ids, a < b
+    bool added;   // True when the boxes began to overlap, false when they separated
+};
+
+// Sweep-and-prune broadphase over boxes that move a little every tick
+// Each axis keeps every box's min and max endpoint in one sorted list. Objects barely move between
+// ticks, so an insertion sort puts the lists back in order with a handful of swaps. When a min
+// endpoint passes another box's max the two may have started overlapping, and a full box test
+// decides; when a max passes a min they have separated on that axis. Only these changes are reported,
+// as events, and the overlapping pairs are kept in a hash set.
+// Boxes are closed, so touching edges overlap. Equal endpoints sort min before max to agree with that.
+class SweepAndPrune
+{
+public:
+    SweepAndPrune();
+
+    // Adds a box, whose pairs are reported by the next Update
+    int32_t Add(Rectangle box);
+
+    // Drops a box and its pairs straight away, reporting the separations in the next Update's events
+    void Remove(int32_t proxy);
+
+    // Stores a box's new position, the lists catch up on the next Update
+    void SetBox(int32_t proxy, Rectangle box);
+
+    // Refreshes the endpoints from the boxes and insertion sorts both axes, collecting pair events
+    void Update();
+
+    // Sorts both axes with std::sort, sweeps for every overlapping pair and diffs them against the
+    // previous set. Gives the same events as Update; kept for large jumps, which make the insertion
+    // sort slow, and as the baseline Update is measured against.
+    void UpdateFromScratch();
+
+    // Pairs that began or stopped overlapping in the last Update or UpdateFromScratch
+    const std::vector<PairEvent>& GetEvents() const;
+
+    // Every overlapping pair, sorted by a then b
+    void GetPairs(std::vector<ProxyPair>& out) const;
+
+    size_t GetPairCount() const;
+    size_t GetProxyCount() const;
+
+    // Endpoint swaps the last Update's insertion sorts made
+    size_t GetSwapCount() const;
+
+private:
+    struct Endpoint
+    {
+        float value;
+        uint32_t data; // Proxy id shifted up one, with the low bit set for a max endpoint
+
+        bool IsMax() const
+        {
+            return (data & 1u) != 0;
+        }
+
+        int32_t Proxy() const
+        {
+            return (int32_t)(data >> 1);
+        }
+    };
+
+    // Open-addressing hash set of pair keys with linear probing, erasing by shifting later keys back
+    class PairSet
+    {
+    public:
+        static const uint64_t emptyKey = UINT64_MAX;
+
+        PairSet();
+        bool Insert(uint64_t key); // False when the key was already present
+        bool Erase(uint64_t key);  // False when the key was absent
+        size_t GetCount() const;
+
+        // Every slot, emptyKey where unused
+        const std::vector<uint64_t>& GetSlots() const;
+
+    private:
+        size_t HomeSlot(uint64_t key) const;
+        void Grow();
+
+        std::vector<uint64_t> slots;
+        size_t count;
+        int shift; // 64 minus the log2 of the slot count
+    };
+
+    // Copies each box's min and max along an axis into its endpoints
+    void RefreshEndpoints(int axis);
+
+    // Insertion sorts one axis, adding or removing a pair wherever a min and a max swap
+    void SortAxis(int axis);
+
+    bool Overlaps(int32_t a, int32_t b) const;
+    void AddPair(int32_t a, int32_t b);
+    void RemovePair(int32_t a, int32_t b);
+
+    std::vector<AabbBounds> boxes;
+    std::vector<int32_t> freeProxies;
+    std::vector<Endpoint> endpoints[2];
+    PairSet pairs;
+    std::vector<PairEvent> events;
+    std::vector<PairEvent> pendingEvents; // Separations from Remove, reported by the next update
+    std::vector<int32_t> active;          // Scratch for UpdateFromScratch's sweep
+    std::vector<uint64_t> sweptPairs;     // Scratch for UpdateFromScratch's pair list
+    size_t swapCount;
+};
@@ -1,52 +1,59 @@
 #include "Tank.h"
+#include "Profiler.h"
 #include <iostream>
 
 using namespace MathClasses;
 
 // Constructor initialising tank properties
-Tank::Tank(MathClasses::Vector3 position, Texture2D bodyTexture, Texture2D turretTexture, Texture2D bulletTexture)
-    : position(position), bodyTexture(bodyTexture), turretTexture(turretTexture), bulletTexture(bulletTexture), bodyRotation(-180.0f), turretRotation(0.0f)
+Tank::Tank(MathClasses::Vector3 position, Sprite bodySprite, Sprite turretSprite, Sprite bulletSprite, MemoryPool& bulletPool, size_t bulletReserve)
+    : position(position), bodySprite(bodySprite), turretSprite(turretSprite), bulletSprite(bulletSprite), bodyRotation(-180.0f), turretRotation(0.0f),
+    bullets(PoolAllocator<Bullet>(bulletPool))
 {
     bodyTransform = Matrix3::MakeIdentity();
     turretTransform = Matrix3::MakeIdentity();
-    turretOffset = MathClasses::Vector3(0.0f, -bodyTexture.height / 3.0f, 0.0f);
+    turretOffset = MathClasses::Vector3(0.0f, -bodySprite.Height() / 3.0f, 0.0f);
+
+    // Reserve up front so firing does not grow the vector mid-frame, growth past this comes from the pool
+    bullets.reserve(bulletReserve);
 }
 
-// Update the tank's state based on player input
-void Tank::Update(float deltaTime)
+// Update the tank's state based on one tick of input
+void Tank::Update(const TankInput& input, float deltaTime)
 {
+    PROFILE_SCOPE("Tank::Update");
+
     // Rotate tank body
-    if (IsKeyDown(KEY_A))
+    if (input.IsDown(TankInput::RotateLeft))
     {
         RotateBody(-60.0f * deltaTime);
     }
-    if (IsKeyDown(KEY_D))
+    if (input.IsDown(TankInput::RotateRight))
     {
         RotateBody(60.0f * deltaTime);
     }
 
     // Move tank
-    if (IsKeyDown(KEY_W))
+    if (input.IsDown(TankInput::MoveForward))
     {
         MoveBody(-100.0f * deltaTime);
     }
-    if (IsKeyDown(KEY_S))
+    if (input.IsDown(TankInput::MoveBackward))
     {
         MoveBody(100.0f * deltaTime);
     }
 
     // Rotate turret
-    if (IsKeyDown(KEY_Q))
+    if (input.IsDown(TankInput::TurretLeft))
     {
         RotateTurret(-60.0f * deltaTime);
     }
-    if (IsKeyDown(KEY_E))
+    if (input.IsDown(TankInput::TurretRight))
     {
         RotateTurret(60.0f * deltaTime);
     }
 
     // Fire bullet
-    if (IsKeyPressed(KEY_SPACE))
+    if (input.IsDown(TankInput::Fire))
     {
         FireBullet();
     }
@@ -60,33 +67,21 @@ void Tank::Update(float deltaTime)
 // Draw the tank and its components
 void Tank::Draw()
 {
+    PROFILE_SCOPE("Tank::Draw");
+
     Vector2 bodyPos = {position.x, position.y};
 
     // Draw tank body
-    DrawTexturePro(bodyTexture, {0, 0, (float)bodyTexture.width, (float)bodyTexture.height},
-                  {bodyPos.x, bodyPos.y, (float)bodyTexture.width, (float)bodyTexture.height},
-                  {bodyTexture.width / 2.0f, bodyTexture.height / 2.0f}, bodyRotation, WHITE);
-
-    // Calculate turret position with offset and apply body transformation
-    MathClasses::Vector3 turretBottomOffset = MathClasses::Vector3(0.0f, turretTexture.height / 2.0f, 0.0f);
-
-    Matrix3 turretTranslationToTank = Matrix3::MakeTranslation(turretOffset.x, turretOffset.y, 0.0f);
-
-    Matrix3 turretPivotTranslation = Matrix3::MakeTranslation(-turretBottomOffset.x, -turretBottomOffset.y, 0.0f);
-
-    Matrix3 turretRotationMatrix = Matrix3::MakeRotateZ(turretRotation * DEG2RAD);
-
-    Matrix3 turretTranslationBack = Matrix3::MakeTranslation(turretBottomOffset.x, turretBottomOffset.y, 0.0f);
-
-    Matrix3 turretTransform = turretTranslationToTank * turretTranslationBack * turretRotationMatrix * turretPivotTranslation;
-    Matrix3 combinedTransform = bodyTransform * turretTransform;
+    DrawTexturePro(bodySprite.texture, bodySprite.source,
+                  {bodyPos.x, bodyPos.y, bodySprite.Width(), bodySprite.Height()},
+                  {bodySprite.Width() / 2.0f, bodySprite.Height() / 2.0f}, bodyRotation, WHITE);
 
-    Vector2 turretPos = {combinedTransform.mm[2][0] + position.x, combinedTransform.mm[2][1] + position.y};
+    Vector2 turretPos = GetTurretPosition();
 
     // Draw turret
-    DrawTexturePro(turretTexture, { 0, 0, (float)turretTexture.width, (float)turretTexture.height},
-     {turretPos.x, turretPos.y, (float)turretTexture.width, (float)turretTexture.height},
-     {turretTexture.width / 2.0f, turretTexture.height / 2.0f}, bodyRotation + turretRotation, WHITE);
+    DrawTexturePro(turretSprite.texture, turretSprite.source,
+     {turretPos.x, turretPos.y, turretSprite.Width(), turretSprite.Height()},
+     {turretSprite.Width() / 2.0f, turretSprite.Height() / 2.0f}, bodyRotation + turretRotation, WHITE);
 
 
     for (auto& bullet : bullets)
@@ -127,7 +122,7 @@ void Tank::FireBullet()
     MathClasses::Vector3 bulletDirection = MathClasses::Vector3{ cosf(adjustedRotation), sinf(adjustedRotation), 0.0f };
 
     // Calculate bullet spawn position at the end of the turret
-    float turretLength = static_cast<float>(turretTexture.height);
+    float turretLength = turretSprite.Height();
     MathClasses::Vector3 turretEndOffset = MathClasses::Vector3(0.0f, -turretLength, 0.0f); 
     Matrix3 turretTranslation = Matrix3::MakeTranslation(turretOffset.x, turretOffset.y, 0.0f); 
     Matrix3 turretRotationMatrix = Matrix3::MakeRotateZ(turretRotation * DEG2RAD);
@@ -136,7 +131,13 @@ void Tank::FireBullet()
     MathClasses::Vector3 bulletPosition = position + turretEnd;
 
     // Create and store the bullet
-    bullets.emplace_back(bulletPosition, bulletDirection, bulletTexture);
+    bullets.emplace_back(bulletPosition, bulletDirection, bulletSprite);
+}
+
+// Shift the tank's position, leaving its rotation alone
+void Tank::Nudge(MathClasses::Vector3 offset)
+{
+    position = position + offset;
 }
 
 // Get the current position of the tank
@@ -145,13 +146,89 @@ MathClasses::Vector3 Tank::GetPosition() const
     return position;
 }
 
+// Get the body angle in degrees
+float Tank::GetBodyRotation() const
+{
+    return bodyRotation;
+}
+
+// Get the turret angle in degrees
+float Tank::GetTurretRotation() const
+{
+    return turretRotation;
+}
+
+// Get the rotation matrix of the body
+Matrix3 Tank::GetBodyTransform() const
+{
+    return bodyTransform;
+}
+
 // Get the transformation matrix of the turret
 Matrix3 Tank::GetTurretTransform() const
 {
     return turretTransform;
 }
 
-std::vector<Bullet>& Tank::GetBullets()
+// Calculate turret position with offset and apply body transformation
+Vector2 Tank::GetTurretPosition() const
+{
+    MathClasses::Vector3 turretBottomOffset = MathClasses::Vector3(0.0f, turretSprite.Height() / 2.0f, 0.0f);
+
+    Matrix3 turretTranslationToTank = Matrix3::MakeTranslation(turretOffset.x, turretOffset.y, 0.0f);
+
+    Matrix3 turretPivotTranslation = Matrix3::MakeTranslation(-turretBottomOffset.x, -turretBottomOffset.y, 0.0f);
+
+    Matrix3 turretRotationMatrix = Matrix3::MakeRotateZ(turretRotation * DEG2RAD);
+
+    Matrix3 turretTranslationBack = Matrix3::MakeTranslation(turretBottomOffset.x, turretBottomOffset.y, 0.0f);
+
+    Matrix3 turretTransform = turretTranslationToTank * turretTranslationBack * turretRotationMatrix * turretPivotTranslation;
+    Matrix3 combinedTransform = bodyTransform * turretTransform;
+
+    return { combinedTransform.mm[2][0] + position.x, combinedTransform.mm[2][1] + position.y };
+}
+
+// Get the width and height the body is drawn at
+Vector2 Tank::GetBodySize() const
+{
+    return { bodySprite.Width(), bodySprite.Height() };
+}
+
+// Get the width and height the turret is drawn at
+Vector2 Tank::GetTurretSize() const
+{
+    return { turretSprite.Width(), turretSprite.Height() };
+}
+
+// Copy out the state needed to resume the tank later
+TankState Tank::GetState() const
+{
+    TankState state;
+    state.position = position;
+    state.bodyRotation = bodyRotation;
+    state.turretRotation = turretRotation;
+    state.bodyTransform = bodyTransform;
+    state.turretTransform = turretTransform;
+    return state;
+}
+
+// Resume the tank from a saved state
+void Tank::SetState(const TankState& state)
+{
+    position = state.position;
+    bodyRotation = state.bodyRotation;
+    turretRotation = state.turretRotation;
+    bodyTransform = state.bodyTransform;
+    turretTransform = state.turretTransform;
+}
+
+BulletList& Tank::GetBullets()
+{
+    return bullets;
+}
+
+const BulletList& Tank::GetBullets() const
 {
     return bullets;
 }
\ No newline at end of file
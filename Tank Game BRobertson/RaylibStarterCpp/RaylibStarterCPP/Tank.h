@@ -3,32 +3,58 @@
 #include "Vector3.h"
 #include "Matrix3.h"
 #include "Bullet.h"
+#include "Pool.h"
+#include "Sprite.h"
+#include "TankInput.h"
 #include <vector>
 
 using namespace MathClasses;
 
+// Bullets live in a vector whose storage comes from the simulation's entity pool
+using BulletList = PoolVector<Bullet>;
+
+// Plain copy of everything about a tank that changes while it is simulated
+struct TankState
+{
+    MathClasses::Vector3 position;
+    float bodyRotation;
+    float turretRotation;
+    Matrix3 bodyTransform;
+    Matrix3 turretTransform;
+};
+
 // Tank class controls movement, rotation, firing and drawing of a tank
 class Tank
 {
 public:
-    Tank(MathClasses::Vector3 position, Texture2D bodyTexture, Texture2D turretTexture, Texture2D bulletTexture);
-    void Update(float deltaTime); // Handles player input and updates bullets
+    Tank(MathClasses::Vector3 position, Sprite bodySprite, Sprite turretSprite, Sprite bulletSprite, MemoryPool& bulletPool, size_t bulletReserve = 256);
+    void Update(const TankInput& input, float deltaTime); // Applies one tick of input and updates bullets
     void Draw(); // Renders the tank and its bullets
     void RotateBody(float angle); // Rotates the tank's body
     void MoveBody(float distance); // Moves the tank along its facing direction
     void RotateTurret(float angle); // Rotates the turret independently of the body
     void FireBullet(); // Spawns a new bullet from the turret's tip
+    void Nudge(MathClasses::Vector3 offset); // Moves the tank without turning it, used to push overlapping tanks apart
     MathClasses::Vector3 GetPosition() const;
+    float GetBodyRotation() const; // Body angle in degrees
+    float GetTurretRotation() const; // Turret angle in degrees, relative to the body
+    Matrix3 GetBodyTransform() const;
     Matrix3 GetTurretTransform() const;
-    std::vector<Bullet>& GetBullets(); // Returns a reference to the bullets vector
+    Vector2 GetBodySize() const; // Size of the body sprite, which is also the body's collision box
+    Vector2 GetTurretPosition() const; // Centre the turret sprite is drawn at
+    Vector2 GetTurretSize() const; // Size of the turret sprite
+    TankState GetState() const; // Copies out the simulated state, excluding bullets
+    void SetState(const TankState& state); // Restores state previously returned by GetState
+    BulletList& GetBullets(); // Returns a reference to the bullets vector
+    const BulletList& GetBullets() const;
 
 private:
     MathClasses::Vector3 position; // Tank's world position
     float bodyRotation; // Angle in degrees for tank body
     float turretRotation; // Angle in degrees for turret
-    Texture2D bodyTexture, turretTexture, bulletTexture; // Textures used
+    Sprite bodySprite, turretSprite, bulletSprite; // Sprites used, possibly all from one atlas texture
     Matrix3 bodyTransform, turretTransform; // Local transformation matrices
     MathClasses::Vector3 turretOffset; // Offset from tank centre to turret base
-    std::vector<Bullet> bullets; // Collection of active bullets
+    BulletList bullets; // Collection of active bullets
 };
 
@@ -0,0 +1,297 @@
+#include "TankCollider.h"
+#include "Profiler.h"
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TANK_COLLIDER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    // Grid cells a bit wider than a tank body, so pairs are only searched in neighbouring cells
+    const float gridCellSize = 128.0f;
+}
+
+// Constructor for an empty collider over an arena
+TankCollider::TankCollider(float width, float height)
+    : grid(width, height, gridCellSize), pairDistance(0.0f), stats()
+{
+}
+
+// Read each body box from the tank's position, body transform and sprite size
+void TankCollider::Gather(const std::vector<Tank>& tanks)
+{
+    size_t count = tanks.size();
+    centres.resize(count);
+    axisXx.resize(count);
+    axisXy.resize(count);
+    axisYx.resize(count);
+    axisYy.resize(count);
+    halfWidths.resize(count);
+    halfHeights.resize(count);
+
+    float largestRadius = 0.0f;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Tank& tank = tanks[i];
+        MathClasses::Vector3 position = tank.GetPosition();
+        Matrix3 transform = tank.GetBodyTransform();
+        MathClasses::Vector3 axisX = transform.axis[0].Normalised();
+        MathClasses::Vector3 axisY = transform.axis[1].Normalised();
+        Vector2 size = tank.GetBodySize();
+
+        centres[i] = { position.x, position.y };
+        axisXx[i] = axisX.x;
+        axisXy[i] = axisX.y;
+        axisYx[i] = axisY.x;
+        axisYy[i] = axisY.y;
+        halfWidths[i] = size.x * 0.5f;
+        halfHeights[i] = size.y * 0.5f;
+
+        float radius = sqrtf(halfWidths[i] * halfWidths[i] + halfHeights[i] * halfHeights[i]);
+        largestRadius = radius > largestRadius ? radius : largestRadius;
+    }
+    pairDistance = largestRadius * 2.0f;
+    grid.Build(centres.data(), count);
+}
+
+// Pairs closer than two of the largest bounding radii might touch
+void TankCollider::FindPairs()
+{
+    grid.FindPairs(pairDistance, pairFirst, pairSecond);
+}
+
+// Four pairs per step: their boxes are loaded into the four lanes, every axis is tested in every lane,
+// and only lanes that overlap on all four axes are written out. Leftover pairs go through TestRange.
+void TankCollider::TestPairs()
+{
+    PROFILE_SCOPE("TankCollider::TestPairs");
+    contacts.clear();
+    size_t count = pairFirst.size();
+    size_t first = 0;
+
+#if defined(TANK_COLLIDER_SSE2)
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+    for (; first + 4 <= count; first += 4)
+    {
+        const int32_t* a = &pairFirst[first];
+        const int32_t* b = &pairSecond[first];
+
+        __m128 tx = _mm_sub_ps(_mm_setr_ps(centres[b[0]].x, centres[b[1]].x, centres[b[2]].x, centres[b[3]].x),
+            _mm_setr_ps(centres[a[0]].x, centres[a[1]].x, centres[a[2]].x, centres[a[3]].x));
+        __m128 ty = _mm_sub_ps(_mm_setr_ps(centres[b[0]].y, centres[b[1]].y, centres[b[2]].y, centres[b[3]].y),
+            _mm_setr_ps(centres[a[0]].y, centres[a[1]].y, centres[a[2]].y, centres[a[3]].y));
+        __m128 aux = _mm_setr_ps(axisXx[a[0]], axisXx[a[1]], axisXx[a[2]], axisXx[a[3]]);
+        __m128 auy = _mm_setr_ps(axisXy[a[0]], axisXy[a[1]], axisXy[a[2]], axisXy[a[3]]);
+        __m128 avx = _mm_setr_ps(axisYx[a[0]], axisYx[a[1]], axisYx[a[2]], axisYx[a[3]]);
+        __m128 avy = _mm_setr_ps(axisYy[a[0]], axisYy[a[1]], axisYy[a[2]], axisYy[a[3]]);
+        __m128 ahx = _mm_setr_ps(halfWidths[a[0]], halfWidths[a[1]], halfWidths[a[2]], halfWidths[a[3]]);
+        __m128 ahy = _mm_setr_ps(halfHeights[a[0]], halfHeights[a[1]], halfHeights[a[2]], halfHeights[a[3]]);
+        __m128 bux = _mm_setr_ps(axisXx[b[0]], axisXx[b[1]], axisXx[b[2]], axisXx[b[3]]);
+        __m128 buy = _mm_setr_ps(axisXy[b[0]], axisXy[b[1]], axisXy[b[2]], axisXy[b[3]]);
+        __m128 bvx = _mm_setr_ps(axisYx[b[0]], axisYx[b[1]], axisYx[b[2]], axisYx[b[3]]);
+        __m128 bvy = _mm_setr_ps(axisYy[b[0]], axisYy[b[1]], axisYy[b[2]], axisYy[b[3]]);
+        __m128 bhx = _mm_setr_ps(halfWidths[b[0]], halfWidths[b[1]], halfWidths[b[2]], halfWidths[b[3]]);
+        __m128 bhy = _mm_setr_ps(halfHeights[b[0]], halfHeights[b[1]], halfHeights[b[2]], halfHeights[b[3]]);
+
+        // Absolute cosines between a's and b's axes, shared by all four projections
+        __m128 uu = _mm_andnot_ps(signMask, _mm_add_ps(_mm_mul_ps(aux, bux), _mm_mul_ps(auy, buy)));
+        __m128 uv = _mm_andnot_ps(signMask, _mm_add_ps(_mm_mul_ps(aux, bvx), _mm_mul_ps(auy, bvy)));
+        __m128 vu = _mm_andnot_ps(signMask, _mm_add_ps(_mm_mul_ps(avx, bux), _mm_mul_ps(avy, buy)));
+        __m128 vv = _mm_andnot_ps(signMask, _mm_add_ps(_mm_mul_ps(avx, bvx), _mm_mul_ps(avy, bvy)));
+
+        // Signed distance between the centres along each axis
+        __m128 dau = _mm_add_ps(_mm_mul_ps(tx, aux), _mm_mul_ps(ty, auy));
+        __m128 dav = _mm_add_ps(_mm_mul_ps(tx, avx), _mm_mul_ps(ty, avy));
+        __m128 dbu = _mm_add_ps(_mm_mul_ps(tx, bux), _mm_mul_ps(ty, buy));
+        __m128 dbv = _mm_add_ps(_mm_mul_ps(tx, bvx), _mm_mul_ps(ty, bvy));
+
+        // Overlap on each axis: both boxes' extents projected onto it, less the centre distance
+        __m128 overlapAu = _mm_sub_ps(_mm_add_ps(ahx, _mm_add_ps(_mm_mul_ps(bhx, uu), _mm_mul_ps(bhy, uv))), _mm_andnot_ps(signMask, dau));
+        __m128 overlapAv = _mm_sub_ps(_mm_add_ps(ahy, _mm_add_ps(_mm_mul_ps(bhx, vu), _mm_mul_ps(bhy, vv))), _mm_andnot_ps(signMask, dav));
+        __m128 overlapBu = _mm_sub_ps(_mm_add_ps(bhx, _mm_add_ps(_mm_mul_ps(ahx, uu), _mm_mul_ps(ahy, vu))), _mm_andnot_ps(signMask, dbu));
+        __m128 overlapBv = _mm_sub_ps(_mm_add_ps(bhy, _mm_add_ps(_mm_mul_ps(ahx, uv), _mm_mul_ps(ahy, vv))), _mm_andnot_ps(signMask, dbv));
+
+        __m128 hit = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(overlapAu, zero), _mm_cmpgt_ps(overlapAv, zero)),
+            _mm_and_ps(_mm_cmpgt_ps(overlapBu, zero), _mm_cmpgt_ps(overlapBv, zero)));
+        int hitMask = _mm_movemask_ps(hit);
+        if (hitMask == 0)
+        {
+            continue;
+        }
+
+        // Keep the axis of least overlap in each lane, the earlier axis winning ties as in TestRange
+        __m128 depth = overlapAu, nx = aux, ny = auy, side = dau;
+        __m128 pick = _mm_cmplt_ps(overlapAv, depth);
+        depth = _mm_or_ps(_mm_and_ps(pick, overlapAv), _mm_andnot_ps(pick, depth));
+        nx = _mm_or_ps(_mm_and_ps(pick, avx), _mm_andnot_ps(pick, nx));
+        ny = _mm_or_ps(_mm_and_ps(pick, avy), _mm_andnot_ps(pick, ny));
+        side = _mm_or_ps(_mm_and_ps(pick, dav), _mm_andnot_ps(pick, side));
+        pick = _mm_cmplt_ps(overlapBu, depth);
+        depth = _mm_or_ps(_mm_and_ps(pick, overlapBu), _mm_andnot_ps(pick, depth));
+        nx = _mm_or_ps(_mm_and_ps(pick, bux), _mm_andnot_ps(pick, nx));
+        ny = _mm_or_ps(_mm_and_ps(pick, buy), _mm_andnot_ps(pick, ny));
+        side = _mm_or_ps(_mm_and_ps(pick, dbu), _mm_andnot_ps(pick, side));
+        pick = _mm_cmplt_ps(overlapBv, depth);
+        depth = _mm_or_ps(_mm_and_ps(pick, overlapBv), _mm_andnot_ps(pick, depth));
+        nx = _mm_or_ps(_mm_and_ps(pick, bvx), _mm_andnot_ps(pick, nx));
+        ny = _mm_or_ps(_mm_and_ps(pick, bvy), _mm_andnot_ps(pick, ny));
+        side = _mm_or_ps(_mm_and_ps(pick, dbv), _mm_andnot_ps(pick, side));
+
+        // Flip the normal where b lies on the negative side of the axis, so it always points from a to b
+        __m128 flip = _mm_and_ps(side, signMask);
+        nx = _mm_xor_ps(nx, flip);
+        ny = _mm_xor_ps(ny, flip);
+
+        float depths[4], normalsX[4], normalsY[4];
+        _mm_storeu_ps(depths, depth);
+        _mm_storeu_ps(normalsX, nx);
+        _mm_storeu_ps(normalsY, ny);
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            if (hitMask & (1 << lane))
+            {
+                contacts.push_back({ a[lane], b[lane], depths[lane], normalsX[lane], normalsY[lane] });
+            }
+        }
+    }
+#endif
+
+    TestRange(first, count);
+    stats.contacts += (uint32_t)contacts.size();
+}
+
+// Test every pair with the scalar code
+void TankCollider::TestPairsScalar()
+{
+    PROFILE_SCOPE("TankCollider::TestPairsScalar");
+    contacts.clear();
+    TestRange(0, pairFirst.size());
+    stats.contacts += (uint32_t)contacts.size();
+}
+
+// Scalar separating-axis test, step for step the same as one lane of TestPairs
+void TankCollider::TestRange(size_t first, size_t last)
+{
+    for (size_t i = first; i < last; ++i)
+    {
+        int32_t a = pairFirst[i];
+        int32_t b = pairSecond[i];
+        float tx = centres[b].x - centres[a].x;
+        float ty = centres[b].y - centres[a].y;
+
+        float uu = fabsf(axisXx[a] * axisXx[b] + axisXy[a] * axisXy[b]);
+        float uv = fabsf(axisXx[a] * axisYx[b] + axisXy[a] * axisYy[b]);
+        float vu = fabsf(axisYx[a] * axisXx[b] + axisYy[a] * axisXy[b]);
+        float vv = fabsf(axisYx[a] * axisYx[b] + axisYy[a] * axisYy[b]);
+
+        float dau = tx * axisXx[a] + ty * axisXy[a];
+        float dav = tx * axisYx[a] + ty * axisYy[a];
+        float dbu = tx * axisXx[b] + ty * axisXy[b];
+        float dbv = tx * axisYx[b] + ty * axisYy[b];
+
+        float overlaps[4] = {
+            halfWidths[a] + (halfWidths[b] * uu + halfHeights[b] * uv) - fabsf(dau),
+            halfHeights[a] + (halfWidths[b] * vu + halfHeights[b] * vv) - fabsf(dav),
+            halfWidths[b] + (halfWidths[a] * uu + halfHeights[a] * vu) - fabsf(dbu),
+            halfHeights[b] + (halfWidths[a] * uv + halfHeights[a] * vv) - fabsf(dbv)
+        };
+        if (overlaps[0] <= 0.0f || overlaps[1] <= 0.0f || overlaps[2] <= 0.0f || overlaps[3] <= 0.0f)
+        {
+            continue;
+        }
+
+        const float normalsX[4] = { axisXx[a], axisYx[a], axisXx[b], axisYx[b] };
+        const float normalsY[4] = { axisXy[a], axisYy[a], axisXy[b], axisYy[b] };
+        const float sides[4] = { dau, dav, dbu, dbv };
+        int axis = 0;
+        for (int k = 1; k < 4; ++k)
+        {
+            if (overlaps[k] < overlaps[axis])
+            {
+                axis = k;
+            }
+        }
+        float flip = std::signbit(sides[axis]) ? -1.0f : 1.0f;
+        contacts.push_back({ a, b, overlaps[axis], normalsX[axis] * flip, normalsY[axis] * flip });
+    }
+}
+
+// Sum every push before moving anything, so the result does not depend on contact order
+void TankCollider::Resolve(std::vector<Tank>& tanks)
+{
+    PROFILE_SCOPE("TankCollider::Resolve");
+    pushes.assign(tanks.size(), { 0.0f, 0.0f });
+    for (const TankContact& contact : contacts)
+    {
+        float half = contact.depth * 0.5f;
+        pushes[contact.a].x -= contact.normalX * half;
+        pushes[contact.a].y -= contact.normalY * half;
+        pushes[contact.b].x += contact.normalX * half;
+        pushes[contact.b].y += contact.normalY * half;
+    }
+    for (size_t i = 0; i < tanks.size(); ++i)
+    {
+        if (pushes[i].x != 0.0f || pushes[i].y != 0.0f)
+        {
+            tanks[i].Nudge(MathClasses::Vector3(pushes[i].x, pushes[i].y, 0.0f));
+        }
+    }
+}
+
+// Each round works from fresh positions, since pushing one pair apart can move a tank into another
+void TankCollider::Collide(std::vector<Tank>& tanks, int iterations)
+{
+    stats = CollisionStats();
+    for (int iteration = 0; iteration < iterations; ++iteration)
+    {
+        stats.iterations++;
+        {
+            ScopedTimer timer(stats.broadphaseMs);
+            Gather(tanks);
+            FindPairs();
+            stats.pairs += (uint32_t)pairFirst.size();
+        }
+        {
+            ScopedTimer timer(stats.narrowphaseMs);
+            TestPairs();
+        }
+        if (contacts.empty())
+        {
+            break;
+        }
+        ScopedTimer timer(stats.resolveMs);
+        Resolve(tanks);
+    }
+}
+
+// Get the overlaps found by the last test
+const std::vector<TankContact>& TankCollider::GetContacts() const
+{
+    return contacts;
+}
+
+// Get the number of pairs the last FindPairs produced
+size_t TankCollider::GetPairCount() const
+{
+    return pairFirst.size();
+}
+
+// Get the counters for the last Collide
+const CollisionStats& TankCollider::GetStats() const
+{
+    return stats;
+}
+
+// Add up the depth of every contact from the last test
+float TankCollider::GetTotalDepth() const
+{
+    float total = 0.0f;
+    for (const TankContact& contact : contacts)
+    {
+        total += contact.depth;
+    }
+    return total;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "raylib.h"
+#include "SpatialGrid.h"
+#include "Tank.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Two overlapping tank bodies, with the shortest push that separates them
+struct TankContact
+{
+    int32_t a, b;           // Tank indices, a < b
+    float depth;            // Overlap along the normal
+    float normalX, normalY; // Unit axis of least overlap, pointing from a towards b
+};
+
+// Counters and times for the most recent Collide, summed over its iterations
+struct CollisionStats
+{
+    uint32_t iterations;  // Find, test and push rounds run before nothing overlapped or the limit was hit
+    uint32_t pairs;       // Pairs whose bounding circles overlapped
+    uint32_t contacts;    // Pairs the separating-axis test found overlapping
+    float broadphaseMs;   // Copying boxes out and finding pairs in the grid
+    float narrowphaseMs;  // Separating-axis tests
+    float resolveMs;      // Pushing tanks apart
+};
+
+// Oriented-box collision between tank bodies
+// Each body is a box the size of its sprite, centred on the tank and turned by its body transform.
+// The boxes are copied into flat arrays, close pairs are found with a SpatialGrid, and each pair gets
+// a separating-axis test on the four box axes. With SSE2 the test runs on four pairs at once. Every
+// overlap is resolved by pushing both tanks apart along the axis of least overlap, half each.
+class TankCollider
+{
+public:
+    // The grid covers width x height, tanks outside still collide through its edge cells
+    TankCollider(float width, float height);
+
+    // Copies each tank's box into the flat arrays and builds the grid over their centres
+    void Gather(const std::vector<Tank>& tanks);
+
+    // Finds the pairs whose bounding circles overlap, from the last Gather
+    void FindPairs();
+
+    // Runs the separating-axis test over every pair, vectorised when SSE2 is available
+    void TestPairs();
+
+    // The same test one pair at a time, used where SSE2 is missing and to check the vector version
+    void TestPairsScalar();
+
+    // Moves each tank in a contact half the depth away from the other, summing pushes per tank
+    void Resolve(std::vector<Tank>& tanks);
+
+    // Gathers, finds, tests and resolves until no tank overlaps another or iterations runs out
+    void Collide(std::vector<Tank>& tanks, int iterations);
+
+    const std::vector<TankContact>& GetContacts() const;
+    size_t GetPairCount() const;
+    const CollisionStats& GetStats() const;
+
+    // Sum of every contact depth from the last test, zero once everything is separated
+    float GetTotalDepth() const;
+
+private:
+    // Tests pairs [first, last) one at a time, appending contacts
+    void TestRange(size_t first, size_t last);
+
+    SpatialGrid grid;
+    float pairDistance;        // Largest centre distance at which two boxes can touch
+    std::vector<Vector2> centres;
+    std::vector<float> axisXx, axisXy, axisYx, axisYy; // Unit box axes along the sprite's width and height
+    std::vector<float> halfWidths, halfHeights;
+    std::vector<int32_t> pairFirst, pairSecond;
+    std::vector<TankContact> contacts;
+    std::vector<Vector2> pushes;
+    CollisionStats stats;
+};
@@ -0,0 +1,16 @@
+#include "TankInput.h"
+#include "raylib.h"
+
+// Read the player's keys into an input snapshot
+TankInput TankInput::FromKeyboard()
+{
+    TankInput input;
+    input.Set(RotateLeft, IsKeyDown(KEY_A));
+    input.Set(RotateRight, IsKeyDown(KEY_D));
+    input.Set(MoveForward, IsKeyDown(KEY_W));
+    input.Set(MoveBackward, IsKeyDown(KEY_S));
+    input.Set(TurretLeft, IsKeyDown(KEY_Q));
+    input.Set(TurretRight, IsKeyDown(KEY_E));
+    input.Set(Fire, IsKeyPressed(KEY_SPACE));
+    return input;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+
+// One tick of tank controls packed into a bit set so it can be recorded and replayed
+struct TankInput
+{
+    enum Button : uint8_t
+    {
+        RotateLeft = 1 << 0,
+        RotateRight = 1 << 1,
+        MoveForward = 1 << 2,
+        MoveBackward = 1 << 3,
+        TurretLeft = 1 << 4,
+        TurretRight = 1 << 5,
+        Fire = 1 << 6
+    };
+
+    uint8_t buttons = 0; // Combination of Button flags
+
+    // Returns true if the given button is held this tick
+    bool IsDown(Button button) const { return (buttons & button) != 0; }
+
+    // Sets or clears a button
+    void Set(Button button, bool down) { buttons = down ? (buttons | button) : (buttons & ~button); }
+
+    // Samples the keyboard using the W/A/S/D, Q/E and Space bindings
+    static TankInput FromKeyboard();
+};
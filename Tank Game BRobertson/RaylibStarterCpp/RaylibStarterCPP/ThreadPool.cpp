@@ -0,0 +1,85 @@
+#include "ThreadPool.h"
+
+// Leave one hardware thread for the main loop
+ThreadPool::ThreadPool(unsigned threadCount) : activeJobs(0), stopping(false)
+{
+    if (threadCount == 0)
+    {
+        unsigned hardware = std::thread::hardware_concurrency();
+        threadCount = hardware > 1 ? hardware - 1 : 1;
+    }
+
+    workers.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; ++i)
+    {
+        workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+// Workers drain the queue before they see the stop flag
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobAvailable.notify_all();
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+// Queue a job and wake one worker
+void ThreadPool::Submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    jobAvailable.notify_one();
+}
+
+// Wait until there is nothing queued or running
+void ThreadPool::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return jobs.empty() && activeJobs == 0; });
+}
+
+// Get the number of worker threads
+unsigned ThreadPool::GetThreadCount() const
+{
+    return static_cast<unsigned>(workers.size());
+}
+
+// Take jobs off the queue until the pool is stopped and the queue is empty
+void ThreadPool::WorkerLoop()
+{
+    for (;;)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty())
+            {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            activeJobs++;
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            activeJobs--;
+            if (activeJobs == 0 && jobs.empty())
+            {
+                idle.notify_all();
+            }
+        }
+    }
+}
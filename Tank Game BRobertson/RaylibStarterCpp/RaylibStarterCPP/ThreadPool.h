@@ -0,0 +1,41 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads pulling jobs from one shared queue
+class ThreadPool
+{
+public:
+    // Starts threadCount workers, or one per spare hardware thread when zero
+    explicit ThreadPool(unsigned threadCount = 0);
+
+    // Finishes every queued job, then joins the workers
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queues a job to run on any worker
+    void Submit(std::function<void()> job);
+
+    // Blocks until the queue is empty and no worker is running a job
+    void WaitIdle();
+
+    unsigned GetThreadCount() const;
+
+private:
+    // Loop run by each worker thread
+    void WorkerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable jobAvailable; // Signalled when a job is queued or the pool stops
+    std::condition_variable idle;         // Signalled when the last running job finishes
+    unsigned activeJobs;
+    bool stopping;
+};
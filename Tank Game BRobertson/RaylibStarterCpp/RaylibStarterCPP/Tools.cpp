@@ -0,0 +1,83 @@
+#include "Tools.h"
+#include "AssetArchive.h"
+#include "AtlasBuilder.h"
+#include "Level.h"
+#include "Replay.h"
+#include "Simulation.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+// Re-run a recording headless at full speed and check every tick's checksum
+int VerifyReplay(const char* replayFile)
+{
+    ReplayPlayer player;
+    if (!player.Load(replayFile))
+    {
+        printf("Could not load replay %s\n", replayFile);
+        return 1;
+    }
+
+    Simulation simulation(player.GetConfig());
+
+    auto start = std::chrono::steady_clock::now();
+    int64_t mismatch = player.Verify(simulation);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%u ticks in %.1f ms (%.0f ticks/s)\n", player.GetTickCount(), seconds * 1000.0,
+        seconds > 0.0 ? player.GetTickCount() / seconds : 0.0);
+
+    if (mismatch >= 0)
+    {
+        printf("Desync at tick %lld\n", (long long)mismatch);
+        return 1;
+    }
+    printf("All checksums match\n");
+    return 0;
+}
+
+// Turn a text arena description into a streamable binary level
+int CompileLevelFile(const char* sourceFile, const char* outputFile)
+{
+    std::string error;
+    if (!CompileLevel(sourceFile, outputFile, error))
+    {
+        printf("%s\n", error.c_str());
+        return 1;
+    }
+    printf("Compiled %s to %s\n", sourceFile, outputFile);
+    return 0;
+}
+
+// Pack a directory of PNGs into one atlas image and its rectangle table, no window needed
+int BuildAtlasFiles(const char* imageDirectory, const char* outputImage, const char* outputTable)
+{
+    std::string error;
+    if (!BuildAtlas(imageDirectory, outputImage, outputTable, error))
+    {
+        printf("%s\n", error.c_str());
+        return 1;
+    }
+    printf("Built atlas %s from %s\n", outputImage, imageDirectory);
+    return 0;
+}
+
+// Pack the whole assets directory into one archive, no window needed
+int BuildArchiveFile(const char* assetDirectory, const char* outputFile)
+{
+    std::string error;
+    if (!BuildArchive(assetDirectory, outputFile, error))
+    {
+        printf("%s\n", error.c_str());
+        return 1;
+    }
+
+    AssetArchive archive;
+    if (!archive.Open(outputFile))
+    {
+        printf("Wrote %s but could not read it back\n", outputFile);
+        return 1;
+    }
+    printf("Packed %u assets into %s\n", archive.GetEntryCount(), outputFile);
+    return 0;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+// Command line tools that run without a window and exit with 0 on success or 1 on failure
+
+// Re-runs a recording headless at full speed and checks every tick's checksum
+int VerifyReplay(const char* replayFile);
+
+// Turns a text arena description into a streamable binary level
+int CompileLevelFile(const char* sourceFile, const char* outputFile);
+
+// Packs a directory of PNGs into one atlas image and its rectangle table
+int BuildAtlasFiles(const char* imageDirectory, const char* outputImage, const char* outputTable);
+
+// Packs the whole assets directory into one archive and checks it opens
+int BuildArchiveFile(const char* assetDirectory, const char* outputFile);
@@ -0,0 +1,125 @@
+#include "VirtualListView.h"
+#include "raygui.h"
+#include <algorithm>
+#include <utility>
+
+VirtualListView::VirtualListView(RowTextFunction rowText) : rowText(std::move(rowText))
+{
+}
+
+// Same layout rules and styles as GuiListViewEx, but rows outside the view are never touched
+int VirtualListView::Draw(Rectangle bounds, int rowCount)
+{
+    frame++;
+    rowsFormatted = 0;
+
+    float rowHeight = (float)GuiGetStyle(LISTVIEW, LIST_ITEMS_HEIGHT);
+    float rowStride = rowHeight + GuiGetStyle(LISTVIEW, LIST_ITEMS_PADDING);
+    float padding = (float)GuiGetStyle(LISTVIEW, LIST_ITEMS_PADDING);
+    float border = (float)GuiGetStyle(DEFAULT, BORDER_WIDTH);
+
+    int visibleRows = std::min(rowCount, (int)(bounds.height / rowStride));
+    bool useScrollBar = rowCount > visibleRows;
+    int maxFirstRow = rowCount - visibleRows;
+
+    Rectangle rowBounds = { bounds.x + padding, bounds.y + padding + border, bounds.width - 2.0f * padding - border, rowHeight };
+    if (useScrollBar)
+    {
+        rowBounds.width -= GuiGetStyle(LISTVIEW, SCROLLBAR_WIDTH);
+    }
+
+    if (selected >= rowCount)
+    {
+        selected = -1;
+    }
+
+    Vector2 mouse = GetMousePosition();
+    bool hovered = CheckCollisionPointRec(mouse, bounds);
+    if (hovered && useScrollBar)
+    {
+        firstRow -= GetMouseWheelMove() * 3;
+    }
+    firstRow = std::max(0, std::min(firstRow, maxFirstRow));
+
+    DrawRectangleRec(bounds, GetColor(GuiGetStyle(DEFAULT, BACKGROUND_COLOR)));
+    DrawRectangleLinesEx(bounds, (int)border, GetColor(GuiGetStyle(LISTVIEW, hovered ? BORDER_COLOR_FOCUSED : BORDER_COLOR_NORMAL)));
+
+    for (int i = 0; i < visibleRows; ++i)
+    {
+        int index = firstRow + i;
+        bool rowHovered = hovered && CheckCollisionPointRec(mouse, rowBounds);
+        if (rowHovered && IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+        {
+            selected = selected == index ? -1 : index;
+        }
+
+        if (index == selected)
+        {
+            DrawRectangleRec(rowBounds, GetColor(GuiGetStyle(LISTVIEW, BASE_COLOR_PRESSED)));
+        }
+        else if (rowHovered)
+        {
+            DrawRectangleRec(rowBounds, GetColor(GuiGetStyle(LISTVIEW, BASE_COLOR_FOCUSED)));
+        }
+        GuiLabel(rowBounds, GetRowText(index));
+
+        rowBounds.y += rowStride;
+    }
+
+    if (useScrollBar)
+    {
+        Rectangle scrollBar = { bounds.x + bounds.width - border - GuiGetStyle(LISTVIEW, SCROLLBAR_WIDTH), bounds.y + border,
+            (float)GuiGetStyle(LISTVIEW, SCROLLBAR_WIDTH), bounds.height - 2.0f * border };
+        firstRow = GuiScrollBar(scrollBar, firstRow, 0, maxFirstRow);
+    }
+
+    return selected;
+}
+
+// Mark every cached row as empty
+void VirtualListView::Invalidate()
+{
+    for (CachedRow& row : cache)
+    {
+        row.index = -1;
+    }
+}
+
+// Set how long cached text lives
+void VirtualListView::SetRefreshFrames(int frames)
+{
+    refreshFrames = std::max(1, frames);
+}
+
+// Get the selected row, or -1
+int VirtualListView::GetSelected() const
+{
+    return selected;
+}
+
+// Select a row, or -1 for none
+void VirtualListView::SetSelected(int index)
+{
+    selected = index;
+}
+
+// Get the number of rows formatted in the last Draw
+int VirtualListView::GetRowsFormatted() const
+{
+    return rowsFormatted;
+}
+
+// Visible rows are consecutive, so a direct-mapped cache bigger than the view never evicts a visible row
+const char* VirtualListView::GetRowText(int index)
+{
+    CachedRow& row = cache[index % VIRTUAL_LIST_CACHE_ROWS];
+    if (row.index != index || frame - row.formattedFrame >= (uint32_t)refreshFrames)
+    {
+        row.index = index;
+        row.formattedFrame = frame;
+        row.text[0] = '\0';
+        rowText(index, row.text, VIRTUAL_LIST_TEXT_LENGTH);
+        rowsFormatted++;
+    }
+    return row.text;
+}
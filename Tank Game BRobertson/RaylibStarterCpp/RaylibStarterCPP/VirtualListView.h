@@ -0,0 +1,55 @@
+#pragma once
+#include "raylib.h"
+#include <cstdint>
+#include <functional>
+
+const int VIRTUAL_LIST_CACHE_ROWS = 256;  // Must exceed the number of rows that fit on screen
+const int VIRTUAL_LIST_TEXT_LENGTH = 96;
+
+// List view for very large row counts, laid out like raygui's GuiListViewEx
+// Only the visible rows are laid out and drawn, and their text comes from a callback instead of an
+// array of strings. Formatted text is cached per row and reused for a few frames, so the cost of a
+// frame depends on the height of the list rather than the number of rows.
+class VirtualListView
+{
+public:
+    // Writes the text for one row into a buffer of textSize bytes
+    typedef std::function<void(int index, char* text, int textSize)> RowTextFunction;
+
+    explicit VirtualListView(RowTextFunction rowText);
+
+    // Handles scrolling and selection, draws the visible rows and returns the selected row or -1
+    int Draw(Rectangle bounds, int rowCount);
+
+    // Forgets all cached text, for when rows have been added, removed or reordered
+    void Invalidate();
+
+    // Sets how many frames a row's cached text is reused before the callback is asked again
+    void SetRefreshFrames(int frames);
+
+    int GetSelected() const;
+    void SetSelected(int index);
+
+    // Returns how many rows the callback formatted during the last Draw
+    int GetRowsFormatted() const;
+
+private:
+    // Cached text for one row, found by index modulo the cache size
+    struct CachedRow
+    {
+        int index = -1;
+        uint32_t formattedFrame = 0;
+        char text[VIRTUAL_LIST_TEXT_LENGTH] = {};
+    };
+
+    // Returns the text for a row, formatting it if the cached copy is missing or stale
+    const char* GetRowText(int index);
+
+    RowTextFunction rowText;
+    CachedRow cache[VIRTUAL_LIST_CACHE_ROWS];
+    int firstRow = 0;       // Index of the top visible row
+    int selected = -1;
+    int refreshFrames = 15;
+    uint32_t frame = 0;     // Number of Draw calls so far
+    int rowsFormatted = 0;
+};
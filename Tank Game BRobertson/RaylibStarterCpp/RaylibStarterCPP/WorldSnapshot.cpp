@@ -0,0 +1,185 @@
+#include "WorldSnapshot.h"
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    const char SNAPSHOT_MAGIC[4] = { 'T', 'K', 'W', 'S' };
+
+    // Round a byte offset up to the next 16-byte boundary
+    size_t AlignSection(size_t offset)
+    {
+        return (offset + 15) & ~static_cast<size_t>(15);
+    }
+
+    // True when count records starting at offset end inside length bytes, written so no sum can wrap
+    bool SectionFits(uint64_t offset, uint32_t count, size_t recordSize, size_t length)
+    {
+        return offset <= length && static_cast<uint64_t>(count) * recordSize <= length - offset;
+    }
+}
+
+// Lay out the header, tank records and bullet records in one contiguous buffer
+void WriteSnapshot(const Simulation& simulation, std::vector<unsigned char>& out)
+{
+    const Tank& tank = simulation.GetTank();
+    const BulletList& bullets = tank.GetBullets();
+    const Level& level = simulation.GetLevel();
+
+    SnapshotHeader header = {};
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.tankRecordSize = sizeof(TankRecord);
+    header.bulletRecordSize = sizeof(BulletRecord);
+    header.tick = simulation.GetTick();
+    header.config = simulation.GetConfig();
+    header.tankCount = 1;
+    header.bulletCount = static_cast<uint32_t>(bullets.size());
+    header.tanksOffset = AlignSection(sizeof(SnapshotHeader));
+    header.targetCount = static_cast<uint32_t>(level.targets.size());
+    header.wallCount = static_cast<uint32_t>(level.walls.size());
+    header.spawnCount = static_cast<uint32_t>(level.spawnPoints.size());
+    header.bulletsOffset = AlignSection(header.tanksOffset + header.tankCount * sizeof(TankRecord));
+    header.targetsOffset = AlignSection(header.bulletsOffset + header.bulletCount * sizeof(BulletRecord));
+    header.wallsOffset = AlignSection(header.targetsOffset + header.targetCount * sizeof(Rectangle));
+    header.spawnsOffset = AlignSection(header.wallsOffset + header.wallCount * sizeof(Rectangle));
+    header.worldChecksum = simulation.Checksum();
+
+    // assign rather than resize so reused buffers keep their capacity without zero filling twice
+    out.assign(header.spawnsOffset + header.spawnCount * sizeof(Vector2), 0);
+    memcpy(out.data(), &header, sizeof(header));
+
+    TankState state = tank.GetState();
+    TankRecord tankRecord = {};
+    tankRecord.position[0] = state.position.x;
+    tankRecord.position[1] = state.position.y;
+    tankRecord.bodyRotation = state.bodyRotation;
+    tankRecord.turretRotation = state.turretRotation;
+    memcpy(tankRecord.bodyTransform, state.bodyTransform.v, sizeof(tankRecord.bodyTransform));
+    memcpy(tankRecord.turretTransform, state.turretTransform.v, sizeof(tankRecord.turretTransform));
+    tankRecord.firstBullet = 0;
+    tankRecord.bulletCount = header.bulletCount;
+    memcpy(out.data() + header.tanksOffset, &tankRecord, sizeof(tankRecord));
+
+    BulletRecord* bulletRecords = reinterpret_cast<BulletRecord*>(out.data() + header.bulletsOffset);
+    for (size_t i = 0; i < bullets.size(); ++i)
+    {
+        MathClasses::Vector3 position = bullets[i].GetPosition();
+        MathClasses::Vector3 direction = bullets[i].GetDirection();
+        bulletRecords[i] = { { position.x, position.y }, { direction.x, direction.y }, bullets[i].GetSpeed(), bullets[i].GetRotation() };
+    }
+
+    memcpy(out.data() + header.targetsOffset, level.targets.data(), header.targetCount * sizeof(Rectangle));
+    memcpy(out.data() + header.wallsOffset, level.walls.data(), header.wallCount * sizeof(Rectangle));
+    memcpy(out.data() + header.spawnsOffset, level.spawnPoints.data(), header.spawnCount * sizeof(Vector2));
+}
+
+// Write the snapshot buffer straight to disk
+bool SaveSnapshot(const Simulation& simulation, const char* fileName)
+{
+    std::vector<unsigned char> buffer;
+    WriteSnapshot(simulation, buffer);
+
+    FILE* file = fopen(fileName, "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    bool ok = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    ok = fclose(file) == 0 && ok;
+    return ok;
+}
+
+// Map a snapshot from disk
+bool SnapshotView::Open(const char* fileName)
+{
+    if (!file.Open(fileName))
+    {
+        return false;
+    }
+    if (!Attach(file.GetData(), file.GetSize()))
+    {
+        file.Close();
+        return false;
+    }
+    return true;
+}
+
+// Check that the header matches this build, that every section lies inside the buffer and that every
+// tank's bullet range lies inside the bullet section
+bool SnapshotView::Attach(const unsigned char* buffer, size_t length)
+{
+    data = nullptr;
+    size = 0;
+    if (buffer == nullptr || length < sizeof(SnapshotHeader))
+    {
+        return false;
+    }
+
+    const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(buffer);
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 || header->version != SNAPSHOT_VERSION ||
+        header->headerSize != sizeof(SnapshotHeader) || header->tankRecordSize != sizeof(TankRecord) ||
+        header->bulletRecordSize != sizeof(BulletRecord))
+    {
+        return false;
+    }
+    if (!SectionFits(header->tanksOffset, header->tankCount, sizeof(TankRecord), length) ||
+        !SectionFits(header->bulletsOffset, header->bulletCount, sizeof(BulletRecord), length) ||
+        !SectionFits(header->targetsOffset, header->targetCount, sizeof(Rectangle), length) ||
+        !SectionFits(header->wallsOffset, header->wallCount, sizeof(Rectangle), length) ||
+        !SectionFits(header->spawnsOffset, header->spawnCount, sizeof(Vector2), length))
+    {
+        return false;
+    }
+
+    // Each tank's bullets must be a range of the bullet section, so readers can index records without checking
+    const TankRecord* tanks = reinterpret_cast<const TankRecord*>(buffer + header->tanksOffset);
+    for (uint32_t i = 0; i < header->tankCount; ++i)
+    {
+        if (static_cast<uint64_t>(tanks[i].firstBullet) + tanks[i].bulletCount > header->bulletCount)
+        {
+            return false;
+        }
+    }
+
+    data = buffer;
+    size = length;
+    return true;
+}
+
+// Get the snapshot header
+const SnapshotHeader& SnapshotView::GetHeader() const
+{
+    return *reinterpret_cast<const SnapshotHeader*>(data);
+}
+
+// Get the tank records, used in place
+const TankRecord* SnapshotView::GetTanks() const
+{
+    return reinterpret_cast<const TankRecord*>(data + GetHeader().tanksOffset);
+}
+
+// Get the bullet records, used in place
+const BulletRecord* SnapshotView::GetBullets() const
+{
+    return reinterpret_cast<const BulletRecord*>(data + GetHeader().bulletsOffset);
+}
+
+// Get the target boxes, used in place
+const Rectangle* SnapshotView::GetTargets() const
+{
+    return reinterpret_cast<const Rectangle*>(data + GetHeader().targetsOffset);
+}
+
+// Get the wall boxes, used in place
+const Rectangle* SnapshotView::GetWalls() const
+{
+    return reinterpret_cast<const Rectangle*>(data + GetHeader().wallsOffset);
+}
+
+// Get the spawn points, used in place
+const Vector2* SnapshotView::GetSpawnPoints() const
+{
+    return reinterpret_cast<const Vector2*>(data + GetHeader().spawnsOffset);
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "MappedFile.h"
+#include "Simulation.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// World snapshot layout (little endian, every section 16-byte aligned):
+//   SnapshotHeader
+//   tankCount x TankRecord
+//   bulletCount x BulletRecord
+//   targetCount x Rectangle, wallCount x Rectangle, spawnCount x Vector2
+// Records are plain floats so a mapped file can be read in place without parsing.
+const uint32_t SNAPSHOT_VERSION = 2;
+
+struct SnapshotHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t headerSize;       // sizeof(SnapshotHeader) when written
+    uint32_t tankRecordSize;   // sizeof(TankRecord) when written
+    uint32_t bulletRecordSize; // sizeof(BulletRecord) when written
+    uint32_t tick;             // Simulation tick the snapshot was taken on
+    SimulationConfig config;   // Arena the world was built in
+    uint32_t tankCount;
+    uint32_t bulletCount;
+    uint32_t targetCount;
+    uint32_t wallCount;
+    uint32_t spawnCount;
+    uint64_t tanksOffset;      // Byte offset of the first TankRecord
+    uint64_t bulletsOffset;    // Byte offset of the first BulletRecord
+    uint64_t targetsOffset;    // Byte offsets of the level geometry
+    uint64_t wallsOffset;
+    uint64_t spawnsOffset;
+    uint64_t worldChecksum;    // Simulation::Checksum() at the time of the snapshot
+};
+
+// One tank, its bullets are bulletCount records starting at firstBullet
+struct TankRecord
+{
+    float position[2];
+    float bodyRotation;
+    float turretRotation;
+    float bodyTransform[9];
+    float turretTransform[9];
+    uint32_t firstBullet;
+    uint32_t bulletCount;
+};
+
+// One bullet in flight
+struct BulletRecord
+{
+    float position[2];
+    float direction[2];
+    float speed;
+    float rotation;
+};
+
+// Serialises the whole world into a buffer laid out exactly as the file on disk
+void WriteSnapshot(const Simulation& simulation, std::vector<unsigned char>& out);
+
+// Writes a snapshot file
+bool SaveSnapshot(const Simulation& simulation, const char* fileName);
+
+// Read-only view over a snapshot that is either memory mapped from disk or already in memory
+class SnapshotView
+{
+public:
+    // Maps a snapshot file and validates its header
+    bool Open(const char* fileName);
+
+    // Views a snapshot buffer owned by the caller, which must outlive the view
+    bool Attach(const unsigned char* data, size_t size);
+
+    const SnapshotHeader& GetHeader() const;
+    const TankRecord* GetTanks() const;
+    const BulletRecord* GetBullets() const;
+    const Rectangle* GetTargets() const;
+    const Rectangle* GetWalls() const;
+    const Vector2* GetSpawnPoints() const;
+
+private:
+    MappedFile file;
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+};
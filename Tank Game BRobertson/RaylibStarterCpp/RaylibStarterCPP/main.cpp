@@ -1,68 +1,90 @@
-#include <iostream>
 #include "raylib.h"
-#include <filesystem>
-#include "Tank.h"
-#include "Bullet.h"
-#include <vector>
+// raygui's implementation uses raylib's Vector3, so it is compiled before anything brings in MathClasses
 #define RAYGUI_IMPLEMENTATION
 #define RAYGUI_SUPPORT_ICONS
-
-using namespace MathClasses;
-
-int main()
+#include "raygui.h"
+#include "Commands.h"
+#include "GameModes.h"
+#include "GameSetup.h"
+#include <cstdlib>
+#include <cstring>
+
+// Tools and benchmarks run through RunCommand and exit; otherwise the flags choose a windowed mode
+int main(int argc, char** argv)
 {
-    const int screenWidth = 1280;
-    const int screenHeight = 720;
-
-    InitWindow(screenWidth, screenHeight, "Tank Game - Bradley Robertson");
-
-    // Loading in textures for the tank body, turret, and bullet
-    Texture2D bodyTexture = LoadTexture("../assets/images/body.png");
-    Texture2D turretTexture = LoadTexture("../assets/images/turret.png");
-    Texture2D bulletTexture = LoadTexture("../assets/images/bullet.png");
-
-    // Initialise the starting location of the tank
-    Tank tank(MathClasses::Vector3{screenWidth / 2.0f, screenHeight / 2.0f, 0.0f}, bodyTexture, turretTexture, bulletTexture);
-
-    // Box position and size
-    Vector2 boxPosition = {1000, 100};
-    Vector2 boxSize = {140, 140}; 
-    Color boxColor = GREEN;
-
-
-    SetTargetFPS(120);
-
-    while (!WindowShouldClose())
+    const char* recordFile = "last_session.tkr";
+    const char* snapshotFile = nullptr;
+    const char* levelFile = nullptr;
+    const char* replayFile = nullptr;
+    const char* archiveFile = nullptr;
+    bool usePhysics = false;
+    int loopbackBots = -1;
+    int rollbackLatencyMs = -1;
+    int aiTanks = -1;
+
+    for (int i = 1; i < argc; ++i)
     {
-        float deltaTime = GetFrameTime();
-
-        tank.Update(deltaTime);
-
-        // Destroy bullets that are out of bounds or have collided with the box
-        tank.GetBullets().erase(std::remove_if(tank.GetBullets().begin(), tank.GetBullets().end(), [&](const Bullet& bullet) {
-            return bullet.IsOutOfBounds() || bullet.BoxCollision(boxPosition, boxSize);
-            }), tank.GetBullets().end());
-
-        BeginDrawing();
-
-        ClearBackground(RAYWHITE);
-
-        tank.Draw();
-
-        // Draw the box for testing collision
-        DrawRectangleV(boxPosition, boxSize, boxColor);
-
-        EndDrawing();
+        int exitCode = 0;
+        if (RunCommand(argc, argv, i, exitCode))
+        {
+            return exitCode;
+        }
+        if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+        {
+            replayFile = argv[++i];
+        }
+        if (strcmp(argv[i], "--archive") == 0 && i + 1 < argc)
+        {
+            archiveFile = argv[++i];
+        }
+        if (strcmp(argv[i], "--ai") == 0)
+        {
+            aiTanks = i + 1 < argc && argv[i + 1][0] != '-' ? atoi(argv[++i]) : 40;
+        }
+        if (strcmp(argv[i], "--rollback") == 0)
+        {
+            rollbackLatencyMs = i + 1 < argc && argv[i + 1][0] != '-' ? atoi(argv[++i]) : 100;
+        }
+        if (strcmp(argv[i], "--loopback") == 0)
+        {
+            loopbackBots = i + 1 < argc && argv[i + 1][0] != '-' ? atoi(argv[++i]) : 3;
+        }
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+        {
+            recordFile = argv[++i];
+        }
+        if (strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc)
+        {
+            snapshotFile = argv[++i];
+        }
+        if (strcmp(argv[i], "--level") == 0 && i + 1 < argc)
+        {
+            levelFile = argv[++i];
+        }
+        if (strcmp(argv[i], "--physics") == 0)
+        {
+            usePhysics = true;
+        }
     }
 
-    // Unloading the textures
-    UnloadTexture(bodyTexture);
-    UnloadTexture(turretTexture);
-    UnloadTexture(bulletTexture);
+    OpenAssetArchive(archiveFile, argv[0]);
 
-    CloseWindow();
-
-    system("pause");
+    if (replayFile != nullptr)
+    {
+        return RunReplay(replayFile);
+    }
+    if (loopbackBots >= 0)
+    {
+        return RunLoopbackGame(loopbackBots);
+    }
+    if (rollbackLatencyMs >= 0)
+    {
+        return RunRollbackGame(rollbackLatencyMs);
+    }
+    if (aiTanks > 0)
+    {
+        return RunAiGame(aiTanks);
+    }
+    return RunGame(recordFile, snapshotFile, levelFile, usePhysics);
+}
 
-    return 0;
-}
\ No newline at end of file
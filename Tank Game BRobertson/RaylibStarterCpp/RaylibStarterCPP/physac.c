@@ -0,0 +1,54 @@
+// Builds raylib's physac physics module. Like rmem, the implementation is C99 (compound literals)
+// and does not compile as C++, so it lives in its own C translation unit.
+// PHYSAC_NO_THREADS leaves threading to PhysicsWorld, which steps at a fixed rate on a std::thread
+// instead of physac's pthread loop that spins without sleeping.
+
+// physac raises _POSIX_C_SOURCE for clock_gettime only after <time.h> has been included
+#if defined(__linux__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "raylib.h"
+
+#define PHYSAC_IMPLEMENTATION
+#define PHYSAC_NO_THREADS
+#include "physac.h"
+
+// PhysicsBodyData is only defined in this file, so PhysicsWorld reads and writes bodies through these
+
+// Runs exactly one step of SetPhysicsTimeStep milliseconds
+// RunPhysicsStep instead steps by however much wall-clock time has passed since its last call
+void StepPhysicsFixed(void)
+{
+    PhysicsStep();
+}
+
+// Turns a body into an immovable obstacle that still collides, and skips pairs of obstacles
+void MakePhysicsBodyStatic(PhysicsBody body)
+{
+    body->enabled = false;
+    body->inverseMass = 0.0f;
+    body->inverseInertia = 0.0f;
+    body->useGravity = false;
+}
+
+// Copies out where a body is, which way it faces and how fast it is moving (pixels per millisecond)
+void GetPhysicsBodyMotion(PhysicsBody body, Vector2 *position, float *orient, Vector2 *velocity)
+{
+    *position = body->position;
+    *orient = body->orient;
+    *velocity = body->velocity;
+}
+
+// Overrides a body's linear (pixels per millisecond) and angular (radians per millisecond) velocity
+void SetPhysicsBodyVelocity(PhysicsBody body, Vector2 velocity, float angularVelocity)
+{
+    body->velocity = velocity;
+    body->angularVelocity = angularVelocity;
+}
+
+// Moves a body without sweeping it through the space in between
+void SetPhysicsBodyPosition(PhysicsBody body, Vector2 position)
+{
+    body->position = position;
+}
@@ -0,0 +1,9 @@
+// Builds raylib's rmem allocators. The implementation is C99 (designated initialisers, restrict)
+// and does not compile as C++, so it lives in its own C translation unit.
+// rmem.h uses size_t, malloc and memset without including their headers itself.
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RMEM_IMPLEMENTATION
+#include "rmem.h"